@@ -0,0 +1,95 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Stress benchmark for the priority lanes of the Broker.
+ *
+ * A "bulk" topic is flooded at about twice the capacity of the pool, while
+ * an "alarm" topic is dispatched every millisecond. The dispatch-to-delivery
+ * latency of the alarms is reported twice: with the alarm subscribed at
+ * PRIORITY_HIGH and with the alarm sharing the PRIORITY_NORMAL lane with the
+ * bulk topic.
+ *
+ * Usage: BrokerPriorityBenchmark [seconds]
+ */
+
+#include "Broker.h"
+#include "SubscriptionOptions.h"
+#include "metrics/LatencyHistogram.h"
+#include "utils/LambdaListener.h"
+#include "time/Timestamp.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+static const uint64_t BULK_WORK = 200000; // ns of work per bulk event
+static const uint64_t ALARM_PERIOD = 1000000; // ns between alarms
+
+static void busy_wait(uint64_t nanos) {
+    uint64_t end = Timestamp::now().to_nanos() + nanos;
+    while (Timestamp::now().to_nanos() < end) {
+        ;
+    }
+}
+
+static void run(JobPriority alarm_priority, int seconds) {
+    LatencyHistogram latencies;
+    unsigned int threads = std::thread::hardware_concurrency() > 0? std::thread::hardware_concurrency() : 4;
+    // Twice as many bulk events per alarm period as the pool can handle
+    unsigned int burst = 2 * threads * (ALARM_PERIOD / BULK_WORK);
+    {
+        Broker broker;
+        broker.subscribe("bulk", std::make_shared<LambdaListener>([](std::string, std::shared_ptr<Data>) {
+            busy_wait(BULK_WORK);
+        }), SubscriptionOptions::concurrent(PRIORITY_NORMAL));
+        broker.subscribe("alarm", std::make_shared<LambdaListener>([&latencies](std::string, std::shared_ptr<Data> data) {
+            latencies.record(Timestamp::now().to_nanos() - data->get_timestamp().to_nanos());
+        }), SubscriptionOptions::concurrent(alarm_priority));
+
+        auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+        auto next = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() < end) {
+            for (unsigned int i = 0; i < burst; ++i) {
+                broker.dispatch("bulk", std::make_shared<Data>());
+            }
+            broker.dispatch("alarm", std::make_shared<Data>());
+            next += std::chrono::nanoseconds(ALARM_PERIOD);
+            std::this_thread::sleep_until(next);
+        }
+        // Delivers the backlog before returning
+        broker.stop();
+    }
+    std::cout << (alarm_priority == PRIORITY_HIGH? "high  " : "normal")
+        << " alarms=" << latencies.get_count()
+        << " p50=" << latencies.get_percentile(50.0) / 1000 << "us"
+        << " p99=" << latencies.get_percentile(99.0) / 1000 << "us"
+        << " max=" << latencies.get_max() / 1000 << "us" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    int seconds = argc > 1? std::atoi(argv[1]) : 2;
+    if (seconds <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [seconds]" << std::endl;
+        return 1;
+    }
+    run(PRIORITY_HIGH, seconds);
+    run(PRIORITY_NORMAL, seconds);
+    return 0;
+}
@@ -0,0 +1,372 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Log.h"
+
+#ifndef WITH_G3LOG
+
+#include "concurrent/SPSCRing.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+const std::size_t LogRecord::SIZE;
+const std::size_t LogRecord::PAYLOAD_SIZE;
+const std::size_t AsyncLogger::RING_CAPACITY;
+
+void LogRecord::format(std::ostream& out) const {
+    std::size_t offset = 0;
+    while (offset < size) {
+        ArgType type = (ArgType)payload[offset++];
+        switch (type) {
+            case ARG_INT: {
+                int64_t value;
+                std::memcpy(&value, payload + offset, sizeof(value));
+                offset += sizeof(value);
+                out << value;
+                break;
+            }
+            case ARG_UINT: {
+                uint64_t value;
+                std::memcpy(&value, payload + offset, sizeof(value));
+                offset += sizeof(value);
+                out << value;
+                break;
+            }
+            case ARG_DOUBLE: {
+                double value;
+                std::memcpy(&value, payload + offset, sizeof(value));
+                offset += sizeof(value);
+                out << value;
+                break;
+            }
+            case ARG_BOOL: {
+                bool value;
+                std::memcpy(&value, payload + offset, sizeof(value));
+                offset += sizeof(value);
+                out << value;
+                break;
+            }
+            case ARG_CHAR:
+                out << payload[offset++];
+                break;
+            case ARG_STRING: {
+                std::size_t length = (uint8_t)payload[offset++];
+                out.write(payload + offset, length);
+                offset += length;
+                break;
+            }
+            case ARG_POINTER: {
+                const void* value;
+                std::memcpy(&value, payload + offset, sizeof(value));
+                offset += sizeof(value);
+                out << value;
+                break;
+            }
+            default:
+                // Corrupted record, stop here
+                return;
+        }
+    }
+    if (truncated) {
+        out << "...";
+    }
+}
+
+namespace {
+
+class Backend;
+
+Backend& get_backend();
+
+struct ThreadRing {
+    SPSCRing<LogRecord, AsyncLogger::RING_CAPACITY> ring;
+    // Set when the owning thread exits. The ring is removed once drained.
+    std::atomic<bool> closed{false};
+};
+
+class Backend {
+
+public:
+
+    Backend() : running(false), dropped(0), stopped(false), reported_dropped(0), console(true) {
+
+    }
+
+    std::shared_ptr<ThreadRing> add_ring() {
+        auto ring = std::make_shared<ThreadRing>();
+        std::unique_lock<std::mutex> lck(rings_mtx);
+        rings.push_back(ring);
+        return ring;
+    }
+
+    void start() {
+        std::unique_lock<std::mutex> lck(rings_mtx);
+        if (running || stopped) {
+            return;
+        }
+        worker = std::thread(&Backend::run, this);
+        running = true;
+    }
+
+    void stop() {
+        {
+            std::unique_lock<std::mutex> lck(rings_mtx);
+            if (stopped) {
+                return;
+            }
+            stopped = true;
+            running = false;
+        }
+        wakeup.notify_one();
+        if (worker.joinable()) {
+            worker.join();
+        }
+        drain();
+    }
+
+    void notify() {
+        wakeup.notify_one();
+    }
+
+    void write_now(const LogRecord& record) {
+        std::unique_lock<std::mutex> lck(drain_mtx);
+        write(record);
+        flush_sinks();
+    }
+
+    void drain() {
+        std::unique_lock<std::mutex> lck(drain_mtx);
+        std::vector<std::shared_ptr<ThreadRing>> current;
+        {
+            std::unique_lock<std::mutex> rings_lck(rings_mtx);
+            // Forget the rings of finished threads once they are empty
+            rings.erase(std::remove_if(rings.begin(), rings.end(), [](const std::shared_ptr<ThreadRing>& ring) {
+                return ring->closed && ring->ring.empty();
+            }), rings.end());
+            current = rings;
+        }
+        pending.clear();
+        LogRecord record;
+        for (auto& ring : current) {
+            while (ring->ring.try_pop(record)) {
+                pending.push_back(record);
+            }
+        }
+        std::stable_sort(pending.begin(), pending.end(), [](const LogRecord& a, const LogRecord& b) {
+            return a.timestamp < b.timestamp;
+        });
+        for (auto& pending_record : pending) {
+            write(pending_record);
+        }
+        uint64_t total_dropped = dropped.load(std::memory_order_relaxed);
+        if (total_dropped != reported_dropped) {
+            for (auto* out : outputs()) {
+                *out << "[log] " << (total_dropped - reported_dropped) << " log records dropped\n";
+            }
+            reported_dropped = total_dropped;
+        }
+        if (!pending.empty()) {
+            flush_sinks();
+        }
+    }
+
+    void set_sinks(const std::string& file, bool console) {
+        std::unique_lock<std::mutex> lck(drain_mtx);
+        if (file.empty()) {
+            file_sink.reset();
+        }
+        else {
+            auto sink = std::make_unique<std::ofstream>(file, std::ofstream::out | std::ofstream::app);
+            if (sink->fail()) {
+                throw std::runtime_error("Cannot open log file " + file);
+            }
+            file_sink = std::move(sink);
+        }
+        this->console = console;
+    }
+
+    std::atomic<bool> running;
+
+    std::atomic<uint64_t> dropped;
+
+private:
+
+    void run() {
+        std::mutex wait_mtx;
+        std::unique_lock<std::mutex> lck(wait_mtx);
+        while (!stopped) {
+            // Producers notify without a lock, so a wakeup may be missed: poll as well
+            wakeup.wait_for(lck, std::chrono::milliseconds(5));
+            drain();
+        }
+    }
+
+    std::vector<std::ostream*> outputs() {
+        std::vector<std::ostream*> result;
+        if (console) {
+            result.push_back(&std::cout);
+        }
+        if (file_sink) {
+            result.push_back(file_sink.get());
+        }
+        return result;
+    }
+
+    void write(const LogRecord& record) {
+        time_t seconds = (time_t)(record.timestamp / 1000000000ULL);
+        struct tm time;
+        localtime_r(&seconds, &time);
+        char prefix[64];
+        int length = std::strftime(prefix, sizeof(prefix), "%Y/%m/%d %H:%M:%S", &time);
+        std::snprintf(prefix + length, sizeof(prefix) - length, ".%06u %-7s [%u] ",
+            (unsigned int)((record.timestamp % 1000000000ULL) / 1000),
+            AsyncLogger::level_name(record.level), record.thread);
+        for (auto* out : outputs()) {
+            *out << prefix;
+            record.format(*out);
+            *out << '\n';
+        }
+    }
+
+    void flush_sinks() {
+        for (auto* out : outputs()) {
+            out->flush();
+        }
+    }
+
+    std::atomic<bool> stopped;
+
+    uint64_t reported_dropped;
+
+    bool console;
+
+    std::unique_ptr<std::ofstream> file_sink;
+
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+
+    std::vector<LogRecord> pending;
+
+    std::mutex rings_mtx;
+
+    std::mutex drain_mtx;
+
+    std::condition_variable wakeup;
+
+    std::thread worker;
+
+};
+
+Backend* create_backend() {
+    // Never destroyed: objects destroyed at exit may still log. The background
+    // thread is stopped (and the rings drained) by an exit handler instead.
+    Backend* backend = new Backend();
+    std::atexit([]() {
+        get_backend().stop();
+    });
+    return backend;
+}
+
+Backend& get_backend() {
+    static Backend* backend = create_backend();
+    return *backend;
+}
+
+struct ThreadRingHolder {
+
+    ~ThreadRingHolder() {
+        if (ring) {
+            ring->closed = true;
+        }
+    }
+
+    std::shared_ptr<ThreadRing> ring;
+
+};
+
+thread_local ThreadRingHolder thread_ring;
+
+}
+
+void AsyncLogger::submit(const LogRecord& record) {
+    Backend& backend = get_backend();
+    if (!backend.running.load(std::memory_order_relaxed)) {
+        backend.start();
+        if (!backend.running) {
+            // Logging while the process exits, after the background thread was stopped
+            backend.write_now(record);
+            return;
+        }
+    }
+    if (!thread_ring.ring) {
+        thread_ring.ring = backend.add_ring();
+    }
+    if (!thread_ring.ring->ring.try_push(record)) {
+        backend.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    backend.notify();
+}
+
+void AsyncLogger::flush() {
+    get_backend().drain();
+}
+
+void AsyncLogger::set_sinks(const std::string& file, bool console) {
+    get_backend().set_sinks(file, console);
+}
+
+uint32_t AsyncLogger::current_thread() {
+    static thread_local uint32_t tid = (uint32_t)syscall(SYS_gettid);
+    return tid;
+}
+
+uint64_t AsyncLogger::get_dropped() {
+    return get_backend().dropped.load(std::memory_order_relaxed);
+}
+
+const char* AsyncLogger::level_name(uint8_t level) {
+    switch (level) {
+        case DEBUG:
+            return "DEBUG";
+        case INFO:
+            return "INFO";
+        case WARNING:
+            return "WARNING";
+        case FATAL:
+            return "FATAL";
+        default:
+            return "UNKNOWN";
+    }
+}
+
+#endif // WITH_G3LOG
@@ -0,0 +1,194 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#ifndef WITH_G3LOG
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <ostream>
+
+/**
+ * A fixed-size log record.
+ * The arguments of a log line are stored in binary form (tagged values) and
+ * only formatted to text by the AsyncLogger's background thread.
+ * Strings are copied; if a line does not fit in the record it is truncated.
+ */
+struct LogRecord {
+
+    enum ArgType : uint8_t {
+        ARG_INT = 0,
+        ARG_UINT,
+        ARG_DOUBLE,
+        ARG_BOOL,
+        ARG_CHAR,
+        ARG_STRING,
+        ARG_POINTER
+    };
+
+    static const std::size_t SIZE = 256;
+
+    static const std::size_t PAYLOAD_SIZE = SIZE - 16;
+
+    uint64_t timestamp;
+
+    uint32_t thread;
+
+    uint8_t level;
+
+    uint8_t truncated;
+
+    uint16_t size;
+
+    char payload[PAYLOAD_SIZE];
+
+    void put(int64_t value) {
+        put_value(ARG_INT, &value, sizeof(value));
+    }
+
+    void put(uint64_t value) {
+        put_value(ARG_UINT, &value, sizeof(value));
+    }
+
+    void put(double value) {
+        put_value(ARG_DOUBLE, &value, sizeof(value));
+    }
+
+    void put(bool value) {
+        put_value(ARG_BOOL, &value, sizeof(value));
+    }
+
+    void put(char value) {
+        put_value(ARG_CHAR, &value, sizeof(value));
+    }
+
+    void put(const void* value) {
+        put_value(ARG_POINTER, &value, sizeof(value));
+    }
+
+    void put(const char* value, std::size_t length) {
+        // tag + 1 byte length
+        std::size_t used = size;
+        if (used + 2 >= PAYLOAD_SIZE) {
+            truncated = 1;
+            return;
+        }
+        std::size_t available = PAYLOAD_SIZE - used - 2;
+        if (length > available) {
+            length = available;
+            truncated = 1;
+        }
+        if (length > 255) {
+            length = 255;
+            truncated = 1;
+        }
+        payload[size] = ARG_STRING;
+        payload[size + 1] = (char)(uint8_t)length;
+        std::memcpy(payload + size + 2, value, length);
+        size += 2 + length;
+    }
+
+    /**
+     * Format the arguments of the record as text
+     * @param out The stream where the text is written
+     */
+    void format(std::ostream& out) const;
+
+private:
+
+    void put_value(ArgType type, const void* value, std::size_t length) {
+        std::size_t used = size;
+        if (used + 1 + length > PAYLOAD_SIZE) {
+            truncated = 1;
+            return;
+        }
+        payload[size] = type;
+        std::memcpy(payload + size + 1, value, length);
+        size += 1 + length;
+    }
+
+};
+
+static_assert(sizeof(LogRecord) == LogRecord::SIZE, "LogRecord must be exactly LogRecord::SIZE bytes");
+
+/**
+ * \class AsyncLogger
+ *
+ * \brief The logging backend used by Log when g3log is not available
+ *
+ * Each thread that logs gets its own lock-free ring of LogRecords.
+ * Submitting a record is a copy into that ring: it never blocks nor allocates
+ * (except the very first time a thread logs). If the ring is full the record is
+ * dropped and counted. A background thread, started with the first record,
+ * formats the records (ordered by timestamp) and writes them to the sinks.
+ */
+class AsyncLogger {
+
+public:
+
+    AsyncLogger() = delete;
+
+    /**
+     * Queue a record to be written. Never blocks.
+     * @param record The record
+     */
+    static void submit(const LogRecord& record);
+
+    /**
+     * Write all the queued records. Blocks until they are written.
+     */
+    static void flush();
+
+    /**
+     * Configure the sinks. Records are written to the console (standard output) and/or a file.
+     * @param file The path of the log file. If empty, no file is written.
+     * @param console Whether the records are written to the console
+     * @throws std::runtime_error If the file cannot be opened
+     */
+    static void set_sinks(const std::string& file, bool console);
+
+    /**
+     * Get the number of records dropped because a ring was full
+     * @returns The number of dropped records
+     */
+    static uint64_t get_dropped();
+
+    /**
+     * Get the identifier (kernel thread id) of the calling thread
+     * @returns The thread id
+     */
+    static uint32_t current_thread();
+
+    /**
+     * Get the level name
+     * @param level A log level
+     * @returns The name of the level
+     */
+    static const char* level_name(uint8_t level);
+
+    /**
+     * Number of records each thread's ring can hold
+     */
+    static const std::size_t RING_CAPACITY = 256;
+
+};
+
+#endif // WITH_G3LOG
@@ -17,14 +17,25 @@
 */
 
 #include "Broker.h"
+#include "metrics/TraceAggregator.h"
 
 void Broker::start() {
     if (started) {
         throw std::runtime_error("Cannot start already started Broker");
     }
-    std::unique_lock<std::mutex> lck(mtx);
-    int priority = Thread::get_max_scheduling_priority(SchedulingPolicy::RT_ROUND_ROBIN) - 2;
-    pool.set_scheduling_policy(SchedulingPolicy::RT_ROUND_ROBIN, priority);
+    std::unique_lock<std::shared_mutex> lck(mtx);
+    MetricsRegistry& registry = MetricsRegistry::get_default();
+    events_total = &registry.counter("rtdata_broker_events_total", "", "Data objects dispatched to the Broker");
+    deliveries_total = &registry.counter("rtdata_broker_deliveries_total", "", "Data objects queued for delivery to a listener");
+    unrouted_total = &registry.counter("rtdata_broker_unrouted_total", "", "Data objects dispatched to a topic without listeners");
+    demoted_total = &registry.counter("rtdata_broker_demoted_listeners_total", "", "Inline listeners moved to the pool for exceeding their time budget");
+    blocked_total = &registry.counter("rtdata_broker_blocked_dispatches_total", "", "Deliveries that waited for room in a full listener mailbox");
+    const char* help = "Deliveries discarded by a full listener mailbox";
+    shed_total[OVERFLOW_DROP_OLDEST] = &registry.counter("rtdata_broker_shed_total", MetricsRegistry::label("policy", "drop_oldest"), help);
+    shed_total[OVERFLOW_CONFLATE] = &registry.counter("rtdata_broker_shed_total", MetricsRegistry::label("policy", "conflate"), help);
+    shed_total[OVERFLOW_SAMPLE] = &registry.counter("rtdata_broker_shed_total", MetricsRegistry::label("policy", "sample"), help);
+    conflated_total = &registry.counter("rtdata_broker_conflated_total", "", "Data objects replaced by a newer one before a conflated listener handled them");
+    ThreadPlacement::apply(pool, ROLE_BROKER, "broker");
     this->started = true;
 }
 
@@ -36,6 +47,10 @@ void Broker::stop() {
     this->started = false;
 }
 
+void Broker::apply_placement() {
+    ThreadPlacement::apply(pool, ROLE_BROKER, "broker");
+}
+
 bool Broker::is_started() const {
     return started;
 }
@@ -44,19 +59,242 @@ bool Broker::is_stopped() const {
     return !started;
 }
 
-void Broker::subscribe(std::string topic, std::shared_ptr<Listener> listener) {
-    std::unique_lock<std::mutex> lck(mtx);
-    listeners[topic].push_back(listener);
+void Broker::subscribe(std::string topic, std::shared_ptr<Listener> listener, const SubscriptionOptions& options) {
+    TopicTrie::validate(topic);
+    Subscription subscription{listener, options, nullptr, nullptr, nullptr, nullptr};
+    if (options.delivery == DELIVERY_ORDERED) {
+        subscription.executor = std::make_shared<SerialExecutor>(pool, options.priority,
+            options.capacity, options.overflow, options.sample_rate);
+    }
+    else if (options.delivery == DELIVERY_CONFLATED) {
+        // The slots bound the pending deliveries: no mailbox capacity
+        subscription.executor = std::make_shared<SerialExecutor>(pool, options.priority);
+        subscription.conflated = std::make_shared<ConflatedSlots>();
+    }
+    else if (options.delivery == DELIVERY_INLINE) {
+        subscription.inline_state = std::make_shared<InlineState>();
+    }
+    // A demoted inline subscription is bounded like a concurrent one
+    if ((options.delivery == DELIVERY_CONCURRENT || options.delivery == DELIVERY_INLINE) && options.capacity > 0) {
+        subscription.mailbox = std::make_shared<Mailbox>(options.capacity, options.overflow, options.sample_rate);
+    }
+    struct Replay {
+        std::string topic;
+        std::shared_ptr<Data> data;
+        std::shared_ptr<ConflatedSlot> slot;
+    };
+    std::vector<Replay> replays;
+    {
+        std::unique_lock<std::shared_mutex> lck(mtx);
+        patterns.insert(topic, subscriptions.size());
+        subscriptions.push_back(subscription);
+        resolved.clear();
+        if (options.replay_last_value) {
+            TopicTrie pattern;
+            pattern.insert(topic, 0);
+            for (auto& last_value : last_values) {
+                std::shared_ptr<Data> data = last_value.second->get();
+                if (data && !pattern.match(last_value.first).empty()) {
+                    replays.push_back(Replay{last_value.first, data, get_slot(subscription, last_value.first)});
+                }
+            }
+        }
+    }
+    // Delivered without the lock, like dispatch(). A concurrent dispatch to the
+    // same topic may be delivered before the replayed value.
+    for (auto& replay : replays) {
+        deliver_to(subscription, replay.slot, replay.topic, replay.data);
+    }
+}
+
+std::shared_ptr<const LastValue> Broker::get_last_value(const std::string& topic) {
+    if (TopicTrie::is_pattern(topic)) {
+        throw std::invalid_argument("Cannot get the last value of a topic with wildcards: " + topic);
+    }
+    std::unique_lock<std::shared_mutex> lck(mtx);
+    return get_last_value_slot(topic);
 }
 
 void Broker::dispatch(std::string topic, std::shared_ptr<Data> data) {
     if (!started) {
         throw std::runtime_error("Cannot dispatch before starting or after stopping the Broker");
     }
-    std::unique_lock<std::mutex> lck(mtx);
-    for (auto listener : listeners[topic]) {
-        pool.add_job([this, listener, topic, data]() {
-            listener->handle(topic, data);
-        });
+    if (Trace::is_enabled()) {
+        Trace& trace = data->get_trace();
+        trace.mark(STAGE_DISPATCHED);
+        TraceAggregator& aggregator = TraceAggregator::get_default();
+        aggregator.record(topic, STAGE_ENQUEUED, trace);
+        aggregator.record(topic, STAGE_FETCHED, trace);
+        aggregator.record(topic, STAGE_DISPATCHED, trace);
+    }
+    events_total->increment();
+    // The lock is only held to find the route: inline listeners can subscribe
+    // or dispatch, and a full mailbox does not block the other topics
+    std::shared_ptr<const Route> route = resolve(topic);
+    route->last_value->set(data);
+    if (route->subscriptions.empty()) {
+        unrouted_total->increment();
+        return;
+    }
+    deliveries_total->increment(route->subscriptions.size());
+    for (std::size_t i = 0; i < route->subscriptions.size(); ++i) {
+        deliver_to(route->subscriptions[i], route->slots[i], topic, data);
+    }
+}
+
+void Broker::deliver_to(const Subscription& subscription, const std::shared_ptr<ConflatedSlot>& slot, const std::string& topic, const std::shared_ptr<Data>& data) {
+    if (slot) {
+        deliver_conflated(subscription, slot, topic, data);
+    }
+    else if (subscription.inline_state && !subscription.inline_state->demoted) {
+        deliver_inline(subscription, topic, data);
+    }
+    else {
+        deliver(subscription, topic, data);
+    }
+}
+
+std::shared_ptr<const Broker::Route> Broker::resolve(const std::string& topic) {
+    {
+        std::shared_lock<std::shared_mutex> lck(mtx);
+        auto it = resolved.find(topic);
+        if (it != resolved.end()) {
+            return it->second;
+        }
+    }
+    if (TopicTrie::is_pattern(topic)) {
+        throw std::invalid_argument("Cannot dispatch to a topic with wildcards: " + topic);
+    }
+    std::unique_lock<std::shared_mutex> lck(mtx);
+    std::shared_ptr<const Route>& entry = resolved[topic];
+    if (!entry) {
+        auto route = std::make_shared<Route>();
+        for (std::size_t index : patterns.match(topic)) {
+            route->subscriptions.push_back(subscriptions[index]);
+            route->slots.push_back(get_slot(subscriptions[index], topic));
+        }
+        route->last_value = get_last_value_slot(topic);
+        entry = route;
+    }
+    return entry;
+}
+
+std::shared_ptr<LastValue> Broker::get_last_value_slot(const std::string& topic) {
+    std::shared_ptr<LastValue>& last_value = last_values[topic];
+    if (!last_value) {
+        last_value = std::make_shared<LastValue>();
+    }
+    return last_value;
+}
+
+std::shared_ptr<Broker::ConflatedSlot> Broker::get_slot(const Subscription& subscription, const std::string& topic) {
+    if (!subscription.conflated) {
+        return nullptr;
+    }
+    std::shared_ptr<ConflatedSlot>& slot = (*subscription.conflated)[topic];
+    if (!slot) {
+        slot = std::make_shared<ConflatedSlot>();
+    }
+    return slot;
+}
+
+void Broker::deliver_conflated(const Subscription& subscription, const std::shared_ptr<ConflatedSlot>& slot, std::string topic, const std::shared_ptr<Data>& data) {
+    if (slot->latest.exchange(data)) {
+        conflated_total->increment();
+    }
+    if (slot->pending.exchange(true)) {
+        // The queued delivery will take this value
+        return;
+    }
+    std::shared_ptr<Listener> listener = subscription.listener;
+    auto job = [this, listener, slot, topic = std::move(topic)]() {
+        // Cleared before taking the value: a value set after it queues another delivery
+        slot->pending = false;
+        std::shared_ptr<Data> latest = slot->latest.exchange(nullptr);
+        if (latest) {
+            handle(listener, topic, latest);
+        }
+    };
+    static_assert(Task::fits_inline<decltype(job)>(), "Delivery jobs must not allocate");
+    subscription.executor->submit(std::move(job));
+}
+
+void Broker::deliver(const Subscription& subscription, std::string topic, const std::shared_ptr<Data>& data) {
+    std::shared_ptr<Listener> listener = subscription.listener;
+    // topic is moved in: a const capture could not be moved without a copy, and the job would not fit inline
+    auto job = [this, listener, topic = std::move(topic), data]() {
+        handle(listener, topic, data);
+    };
+    static_assert(Task::fits_inline<decltype(job)>(), "Delivery jobs must not allocate");
+    if (!subscription.executor && !subscription.mailbox) {
+        pool.add_job(std::move(job), subscription.options.priority);
+        return;
+    }
+    PushResult result;
+    if (subscription.executor) {
+        result = subscription.executor->submit(std::move(job));
+    }
+    else {
+        std::shared_ptr<Mailbox> mailbox = subscription.mailbox;
+        result = mailbox->push(std::move(job));
+        // A push that discarded tasks did not grow the mailbox: the jobs already
+        // queued for it are enough to empty it
+        if (result.discarded == 0) {
+            pool.add_job([mailbox]() {
+                Task delivery;
+                if (mailbox->pop(delivery)) {
+                    delivery();
+                }
+            }, subscription.options.priority);
+        }
+    }
+    if (result.waited) {
+        blocked_total->increment();
+    }
+    if (result.discarded > 0 && shed_total[subscription.options.overflow] != nullptr) {
+        shed_total[subscription.options.overflow]->increment(result.discarded);
+    }
+}
+
+void Broker::deliver_inline(const Subscription& subscription, const std::string& topic, const std::shared_ptr<Data>& data) {
+    uint64_t start = Trace::now();
+    handle(subscription.listener, topic, data);
+    uint64_t elapsed = Trace::now() - start;
+    InlineState& state = *subscription.inline_state;
+    if (elapsed <= subscription.options.inline_budget) {
+        // Only consecutive overruns count: isolated preemptions or page faults are forgiven
+        state.overruns = 0;
+        return;
+    }
+    if (++state.overruns >= SubscriptionOptions::MAX_INLINE_OVERRUNS && !state.demoted.exchange(true)) {
+        demoted_total->increment();
+        RTDATA_LOG(WARNING) << "[broker] A listener of " << topic << " took " << elapsed << " ns, over its inline budget of "
+            << subscription.options.inline_budget << " ns. Moved to the pool.";
+    }
+}
+
+void Broker::handle(const std::shared_ptr<Listener>& listener, const std::string& topic, const std::shared_ptr<Data>& data) {
+    if (Trace::is_enabled()) {
+        handle_traced(listener, topic, data);
+    }
+    else {
+        listener->handle(topic, data);
+    }
+}
+
+void Broker::handle_traced(std::shared_ptr<Listener> listener, const std::string& topic, std::shared_ptr<Data> data) {
+    Trace& trace = data->get_trace();
+    TraceAggregator& aggregator = TraceAggregator::get_default();
+    // Several listeners may handle the same data concurrently, so the latencies
+    // are taken from local stamps instead of reading back the shared trace
+    uint64_t start = Trace::now();
+    trace.set(STAGE_HANDLER_START, start);
+    listener->handle(topic, data);
+    uint64_t end = Trace::now();
+    trace.set(STAGE_HANDLER_END, end);
+    uint64_t read = trace.get(STAGE_READ);
+    if (read != 0 && read <= start) {
+        aggregator.record(topic, STAGE_HANDLER_START, start - read);
+        aggregator.record(topic, STAGE_HANDLER_END, end - read);
     }
 }
\ No newline at end of file
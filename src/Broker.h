@@ -25,9 +25,17 @@
 #include <functional>
 #include <stdexcept>
 #include <mutex>
+#include <shared_mutex>
 
 #include "Listener.h"
+#include "SubscriptionOptions.h"
+#include "TopicTrie.h"
+#include "LastValue.h"
 #include "concurrent/ThreadPool.h"
+#include "concurrent/SerialExecutor.h"
+#include "concurrent/Mailbox.h"
+#include "concurrent/ThreadPlacement.h"
+#include "metrics/MetricsRegistry.h"
 
 class Broker {
 
@@ -61,7 +69,8 @@ public:
     void start();
 
     /**
-     * Stop the Broker. No more events will be dispatched after.
+     * Stop the Broker. The events already dispatched are delivered before it
+     * returns; no more events will be dispatched after.
      */
     void stop();
 
@@ -78,28 +87,160 @@ public:
     bool is_stopped() const;
 
     /**
-     * Subscribe a listener to a topic
-     * @param topic The topic to subscribe to
+     * Place the Broker's threads according to the current ROLE_BROKER placement.
+     * It is applied when the Broker starts; call it if the placement changed afterwards.
+     */
+    void apply_placement();
+
+    /**
+     * Subscribe a listener to a topic, or to every topic matching a pattern with
+     * wildcards (see TopicTrie): `sensors/#` receives the events of the sensors
+     * added later too.
+     * @param topic The topic or the pattern to subscribe to
      * @param listener A pointer to a Listener that will be executed when an event from the passed
      *      topic is dispatched.
+     * @param options How the listener receives the events, e.g. SubscriptionOptions::ordered()
+     *      for a listener that expects them in order, one at a time (like a StateMachine), and
+     *      how many may wait for it (SubscriptionOptions::bounded()).
+     * @throws std::invalid_argument If the pattern is not valid, or if the options are
+     *      bounded with a sample rate of 0
      */
-    void subscribe(std::string topic, std::shared_ptr<Listener> listener);
+    void subscribe(std::string topic, std::shared_ptr<Listener> listener, const SubscriptionOptions& options = SubscriptionOptions());
 
     /**
      * Dipatch an event to a topic with an associated data
      * @param topic The topic where the event will be dispatched
      * @param data The data associated with the event
+     * @throws std::invalid_argument If the topic has wildcards
      */
     void dispatch(std::string topic, std::shared_ptr<Data> data);
 
+    /**
+     * Get the last value dispatched to a topic. The LastValue is updated by every
+     * dispatch to the topic: it can be kept and read without taking the Broker lock,
+     * e.g. by a dashboard, instead of subscribing to every event.
+     * @param topic A topic without wildcards
+     * @returns The last value of the topic. Its get() returns nullptr until the
+     *      first dispatch to the topic.
+     * @throws std::invalid_argument If the topic has wildcards
+     */
+    std::shared_ptr<const LastValue> get_last_value(const std::string& topic);
+
 private:
 
+    struct InlineState {
+        // Consecutive calls over the budget
+        std::atomic<int> overruns{0};
+        std::atomic<bool> demoted{false};
+    };
+
+    struct ConflatedSlot {
+        // The latest event of the topic not handled yet
+        LastValue latest;
+        // Whether a delivery of the slot is queued
+        std::atomic<bool> pending{false};
+    };
+
+    // The slot of each topic of a conflated subscription
+    typedef std::unordered_map<std::string, std::shared_ptr<ConflatedSlot>> ConflatedSlots;
+
+    struct Subscription {
+        std::shared_ptr<Listener> listener;
+        SubscriptionOptions options;
+        // Runs the deliveries of an ordered or conflated subscription
+        std::shared_ptr<SerialExecutor> executor;
+        // Watches the time taken by an inline subscription
+        std::shared_ptr<InlineState> inline_state;
+        // Holds the deliveries of a bounded concurrent or inline subscription
+        std::shared_ptr<Mailbox> mailbox;
+        // The slots of a conflated subscription. Guarded by the Broker's mutex.
+        std::shared_ptr<ConflatedSlots> conflated;
+    };
+
+    struct Route {
+        // The subscriptions matching the topic
+        std::vector<Subscription> subscriptions;
+        // The slot of the topic for each conflated subscription, nullptr for the others
+        std::vector<std::shared_ptr<ConflatedSlot>> slots;
+        std::shared_ptr<LastValue> last_value;
+    };
+
+    /**
+     * Get the route of a topic, from the cache or from the trie
+     */
+    std::shared_ptr<const Route> resolve(const std::string& topic);
+
+    /**
+     * Get the last value of a topic, creating it. The mutex must be held exclusively.
+     */
+    std::shared_ptr<LastValue> get_last_value_slot(const std::string& topic);
+
+    /**
+     * Get the slot of a topic for a conflated subscription, creating it, or nullptr if the
+     * subscription is not conflated. The mutex must be held exclusively.
+     */
+    std::shared_ptr<ConflatedSlot> get_slot(const Subscription& subscription, const std::string& topic);
+
+    /**
+     * Deliver an event to a subscription according to its delivery mode
+     */
+    void deliver_to(const Subscription& subscription, const std::shared_ptr<ConflatedSlot>& slot, const std::string& topic, const std::shared_ptr<Data>& data);
+
+    /**
+     * Store the latest event in the slot, and queue a delivery unless one is pending
+     */
+    void deliver_conflated(const Subscription& subscription, const std::shared_ptr<ConflatedSlot>& slot, std::string topic, const std::shared_ptr<Data>& data);
+
+    /**
+     * Queue a delivery to a listener in the pool, its executor or its mailbox
+     */
+    void deliver(const Subscription& subscription, std::string topic, const std::shared_ptr<Data>& data);
+
+    /**
+     * Call an inline listener and demote it if it exceeds its budget
+     */
+    void deliver_inline(const Subscription& subscription, const std::string& topic, const std::shared_ptr<Data>& data);
+
+    /**
+     * Run a listener, tracing it if tracing is enabled
+     */
+    void handle(const std::shared_ptr<Listener>& listener, const std::string& topic, const std::shared_ptr<Data>& data);
+
+    /**
+     * Run a listener stamping and recording the handler stages of the data trace
+     */
+    void handle_traced(std::shared_ptr<Listener> listener, const std::string& topic, std::shared_ptr<Data> data);
+
     std::atomic<bool> started;
 
-    std::unordered_map<std::string, std::vector<std::shared_ptr<Listener>>> listeners;
+    // Every subscription, in subscription order. The trie holds their indices.
+    std::vector<Subscription> subscriptions;
+
+    TopicTrie patterns;
+
+    // The route of each topic dispatched so far. Cleared on subscribe.
+    std::unordered_map<std::string, std::shared_ptr<const Route>> resolved;
 
-    std::mutex mtx;
+    // The last value of each topic dispatched so far. Kept on subscribe.
+    std::unordered_map<std::string, std::shared_ptr<LastValue>> last_values;
+
+    std::shared_mutex mtx;
 
     ThreadPool pool;
 
+    Counter* events_total = nullptr;
+
+    Counter* deliveries_total = nullptr;
+
+    Counter* unrouted_total = nullptr;
+
+    Counter* demoted_total = nullptr;
+
+    Counter* blocked_total = nullptr;
+
+    // Deliveries discarded by a full mailbox, by OverflowPolicy
+    Counter* shed_total[OVERFLOW_SAMPLE + 1] = {};
+
+    Counter* conflated_total = nullptr;
+
 };
\ No newline at end of file
@@ -22,7 +22,11 @@ Timestamp Data::get_timestamp() const {
     return time;
 }
 
-std::string Data::get_origin() const {
+const std::string& Data::get_origin() const {
+    return OriginRegistry::get_name(origin);
+}
+
+OriginId Data::get_origin_id() const {
     return origin;
 }
 
@@ -31,5 +35,17 @@ void Data::set_timestamp(const Timestamp& time) {
 }
 
 void Data::set_origin(const std::string& origin) {
+    this->origin = OriginRegistry::intern(origin);
+}
+
+void Data::set_origin(OriginId origin) {
     this->origin = origin;
+}
+
+Trace& Data::get_trace() {
+    return trace;
+}
+
+const Trace& Data::get_trace() const {
+    return trace;
 }
\ No newline at end of file
@@ -23,6 +23,8 @@
 
 #include "time/Timestamp.h"
 #include "serialization/Serializable.h"
+#include "metrics/Trace.h"
+#include "OriginRegistry.h"
 
 /**
  * Class that represents data
@@ -35,14 +37,14 @@ public:
      * Default constructor
      * Sets the data time to the current time
      */
-    Data() : time(Timestamp::now()), origin("unknown") {
-
+    Data() : time(Timestamp::now()), origin(OriginRegistry::UNKNOWN) {
+        trace.mark(STAGE_READ);
     }
 
     /**
      * Copy constructor
      */
-    Data(const Data& other) : time(other.time), origin(other.origin) {
+    Data(const Data& other) : time(other.time), origin(other.origin), trace(other.trace) {
 
     }
 
@@ -50,8 +52,16 @@ public:
      * Constructor with origin. Sets the data time to the current time
      * @param origin The origin of the data
      */
-    explicit Data(const std::string& origin) : time(Timestamp::now()), origin(origin)  {
+    explicit Data(const std::string& origin) : time(Timestamp::now()), origin(OriginRegistry::intern(origin))  {
+        trace.mark(STAGE_READ);
+    }
 
+    /**
+     * Constructor with an interned origin. Sets the data time to the current time
+     * @param origin The id of the origin of the data (see OriginRegistry)
+     */
+    explicit Data(OriginId origin) : time(Timestamp::now()), origin(origin)  {
+        trace.mark(STAGE_READ);
     }
 
     /**
@@ -59,8 +69,17 @@ public:
      * @param time When this data was created
      * @param origin The origin of the data
      */
-    Data(const Timestamp& time, const std::string& origin) : time(time), origin(origin)  {
+    Data(const Timestamp& time, const std::string& origin) : time(time), origin(OriginRegistry::intern(origin))  {
+        trace.mark(STAGE_READ);
+    }
 
+    /**
+     * Constructor with time and an interned origin
+     * @param time When this data was created
+     * @param origin The id of the origin of the data (see OriginRegistry)
+     */
+    Data(const Timestamp& time, OriginId origin) : time(time), origin(origin)  {
+        trace.mark(STAGE_READ);
     }
 
     /**
@@ -69,7 +88,8 @@ public:
     Data& operator=(const Data& other) {
         if (this != &other) {
             this->time = Timestamp(other.time.to_nanos());
-            this->origin = std::string(other.origin);
+            this->origin = other.origin;
+            this->trace = other.trace;
         }
         return *this;
     }
@@ -82,7 +102,12 @@ public:
     /**
      * Returns who generated this data.
      */
-    std::string get_origin() const;
+    const std::string& get_origin() const;
+
+    /**
+     * Returns the interned id of who generated this data.
+     */
+    OriginId get_origin_id() const;
 
     /**
      * Set the timestamp when this data was created.
@@ -94,13 +119,29 @@ public:
      */
     void set_origin(const std::string& origin);
 
+    /**
+     * Sets who generated this data from an interned id.
+     */
+    void set_origin(OriginId origin);
+
+    /**
+     * Get the per-stage latency trace of this data.
+     * Stages are only stamped while tracing is enabled (see Trace::set_enabled()).
+     */
+    Trace& get_trace();
+
+    /**
+     * Get the per-stage latency trace of this data.
+     */
+    const Trace& get_trace() const;
+
     /**
      * Serialize the Data. Do not call directly.
      * @param object The resulting SerializedObject where the data must be saved.
      */
     virtual void serialize(SerializedObject* object) override {
         object->put("timestamp", time.to_nanos());
-        object->put("origin", origin);
+        object->put("origin", get_origin());
     }
 
     /**
@@ -109,7 +150,7 @@ public:
      */
     virtual void deserialize(SerializedObject* object) override {
         time = Timestamp(object->get_long_int("timestamp"));
-        origin = object->get_string("origin");
+        origin = OriginRegistry::intern(object->get_string("origin"));
     }
 
 protected:
@@ -120,8 +161,14 @@ protected:
     Timestamp time;
 
     /**
-     * Who generated this data.
+     * Who generated this data, interned in the OriginRegistry.
+     */
+    OriginId origin;
+
+    /**
+     * When this data went through each stage of the pipeline.
+     * Not serialized.
      */
-    std::string origin;
+    Trace trace;
 
 };
\ No newline at end of file
@@ -0,0 +1,101 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <memory>
+#include <atomic>
+
+#include "Data.h"
+
+/**
+ * \class LastValue
+ *
+ * \brief Holds the latest Data of a topic. Read and written atomically, without
+ * taking the Broker lock.
+ *
+ * Atomic operations on a shared_ptr are not necessarily lock-free: libstdc++
+ * implements them with a small pool of internal mutexes, held only for the
+ * duration of the pointer copy.
+ *
+ * The Broker keeps one per dispatched topic (see Broker::get_last_value()),
+ * so consumers that only need the current value, such as dashboards or
+ * StateMachine conditions, can read it instead of handling every event.
+ */
+class LastValue {
+
+public:
+
+    /**
+     * Default constructor. Holds no value.
+     */
+    LastValue() = default;
+
+    // Do not allow copy or assignment.
+
+    LastValue(const LastValue&) = delete;
+
+    LastValue& operator=(const LastValue&) = delete;
+
+    /**
+     * Get the value
+     * @returns The latest value, or nullptr if none was set
+     */
+    std::shared_ptr<Data> get() const {
+#ifdef __cpp_lib_atomic_shared_ptr
+        return value.load();
+#else
+        return std::atomic_load(&value);
+#endif
+    }
+
+    /**
+     * Replace the value
+     * @param data The new value
+     */
+    void set(std::shared_ptr<Data> data) {
+#ifdef __cpp_lib_atomic_shared_ptr
+        value.store(std::move(data));
+#else
+        std::atomic_store(&value, std::move(data));
+#endif
+    }
+
+    /**
+     * Replace the value and get the previous one
+     * @param data The new value
+     * @returns The previous value, or nullptr if none was set
+     */
+    std::shared_ptr<Data> exchange(std::shared_ptr<Data> data) {
+#ifdef __cpp_lib_atomic_shared_ptr
+        return value.exchange(std::move(data));
+#else
+        return std::atomic_exchange(&value, std::move(data));
+#endif
+    }
+
+private:
+
+#ifdef __cpp_lib_atomic_shared_ptr
+    std::atomic<std::shared_ptr<Data>> value;
+#else
+    // Accessed with the std::atomic_* overloads for shared_ptr
+    std::shared_ptr<Data> value;
+#endif
+
+};
@@ -28,12 +28,28 @@
 #include <iostream>
 
 #ifndef WITH_G3LOG
+#include <string>
+#include <sstream>
+#include <cstring>
+#include <ctime>
+#include <type_traits>
+
 enum Level {
     DEBUG,
     INFO,
     WARNING,
     FATAL
 };
+
+/**
+ * The lowest level that is compiled in. RTDATA_LOG() lines with a lower level
+ * are discarded at compile time (e.g. -DRTDATA_LOG_LEVEL=WARNING)
+ */
+#ifndef RTDATA_LOG_LEVEL
+#define RTDATA_LOG_LEVEL INFO
+#endif
+
+#include "AsyncLogger.h"
 #endif
 
 #ifdef WITH_G3LOG
@@ -77,6 +93,88 @@ template<typename T>
 LogLine& operator<<(LogLine&& line, T&& value) {
     return line << std::forward<T>(value);
 }
+#else
+/**
+ * A log line being built. The streamed values are stored, unformatted, in a
+ * LogRecord that is queued to the AsyncLogger when the line is destroyed
+ * (at the end of the logging statement).
+ * An inactive line (level below RTDATA_LOG_LEVEL) ignores all the values, which
+ * are still evaluated: RTDATA_LOG() does not even build it.
+ */
+class LogLine {
+
+public:
+
+    LogLine(Level level, bool active) : active(active) {
+        if (active) {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            record.timestamp = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+            record.thread = AsyncLogger::current_thread();
+            record.level = level;
+            record.truncated = 0;
+            record.size = 0;
+        }
+    }
+
+    ~LogLine() {
+        if (active) {
+            AsyncLogger::submit(record);
+            if (record.level == FATAL) {
+                AsyncLogger::flush();
+            }
+        }
+    }
+
+    LogLine(const LogLine&) = delete;
+
+    LogLine& operator=(const LogLine&) = delete;
+
+    template<typename T>
+    LogLine& operator<<(const T& value) {
+        if (!active) {
+            return *this;
+        }
+        if constexpr (std::is_same<T, bool>::value || std::is_same<T, char>::value) {
+            record.put(value);
+        }
+        else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+            record.put((int64_t)value);
+        }
+        else if constexpr (std::is_integral<T>::value || std::is_enum<T>::value) {
+            record.put((uint64_t)value);
+        }
+        else if constexpr (std::is_floating_point<T>::value) {
+            record.put((double)value);
+        }
+        else if constexpr (std::is_convertible<const T&, const char*>::value) {
+            const char* text = value;
+            text = text != nullptr ? text : "(null)";
+            record.put(text, std::strlen(text));
+        }
+        else if constexpr (std::is_same<T, std::string>::value) {
+            record.put(value.data(), value.size());
+        }
+        else if constexpr (std::is_pointer<T>::value) {
+            record.put((const void*)value);
+        }
+        else {
+            // Any other streamable type is formatted here, at the cost of an allocation
+            std::ostringstream stream;
+            stream << value;
+            std::string text = stream.str();
+            record.put(text.data(), text.size());
+        }
+        return *this;
+    }
+
+private:
+
+    bool active;
+
+    LogRecord record;
+
+};
 #endif //WITH_G3LOG
 
 class Log {
@@ -102,6 +200,8 @@ public:
             auto consoleSinkHandle = Log::logWorker->addSink(std::make_unique<ConsoleSink>(), &ConsoleSink::ReceiveLogMessage);
         }
         g3::initializeLogging(Log::logWorker.get());
+        #else
+        AsyncLogger::set_sinks(logFilePath + logPrefix + ".log", enableConsole);
         #endif
     }
 
@@ -110,17 +210,27 @@ public:
      * @param level The level of the log. Possible values = DEBUG, INFO, WARNING, FATAL
      * @param message The message to be written to the log. It can contain printf-like format specifiers that are replaced by the values specified in the additional arguments
      * @param ... (additional arguments) If message contains format specifiers, the function expects additional arguments each containing a value to be used to replace a format specifier 
+     * The level is checked at runtime: log through RTDATA_LOG() so disabled levels cost nothing.
      */
     #ifdef WITH_G3LOG
     static inline LogLine log(LEVELS level = INFO, std::experimental::source_location loc = std::experimental::source_location::current()) {
         return LogLine(loc.file_name(), loc.line(), loc.function_name(), level);
     }
     #else
-    static inline std::ostream& log(Level level) {
-        return std::cout;
+    static inline LogLine log(Level level) {
+        return LogLine(level, level >= RTDATA_LOG_LEVEL);
     }
     #endif // WITH_G3LOG
 
+    /**
+     * Write all the pending log lines. Blocks until they are written.
+     */
+    static void flush() {
+        #ifndef WITH_G3LOG
+        AsyncLogger::flush();
+        #endif
+    }
+
 private:
 
     #ifdef WITH_G3LOG
@@ -149,3 +259,14 @@ private:
     #endif // WITH_G3LOG
 
 };
+
+/**
+ * Log a line: RTDATA_LOG(WARNING) << "[name] ...";
+ * Below RTDATA_LOG_LEVEL the whole statement is discarded at compile time, so the
+ * streamed values are not evaluated, even without optimizations.
+ */
+#ifdef WITH_G3LOG
+#define RTDATA_LOG(level) Log::log(level)
+#else
+#define RTDATA_LOG(level) if constexpr ((level) < RTDATA_LOG_LEVEL) {} else Log::log(level)
+#endif
@@ -0,0 +1,69 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "OriginRegistry.h"
+
+#include <mutex>
+#include <stdexcept>
+
+const OriginId OriginRegistry::UNKNOWN;
+
+OriginRegistry::Table::Table() {
+    names.push_back("unknown");
+    ids.emplace("unknown", UNKNOWN);
+}
+
+OriginRegistry::Table& OriginRegistry::get_table() {
+    static Table table;
+    return table;
+}
+
+OriginId OriginRegistry::intern(const std::string& name) {
+    Table& table = get_table();
+    {
+        std::shared_lock<std::shared_mutex> lck(table.mtx);
+        auto it = table.ids.find(name);
+        if (it != table.ids.end()) {
+            return it->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lck(table.mtx);
+    auto it = table.ids.find(name);
+    if (it != table.ids.end()) {
+        return it->second;
+    }
+    OriginId id = (OriginId)table.names.size();
+    table.names.push_back(name);
+    table.ids.emplace(name, id);
+    return id;
+}
+
+const std::string& OriginRegistry::get_name(OriginId id) {
+    Table& table = get_table();
+    std::shared_lock<std::shared_mutex> lck(table.mtx);
+    if (id >= table.names.size()) {
+        throw std::out_of_range("Unknown origin id " + std::to_string(id));
+    }
+    return table.names[id];
+}
+
+std::size_t OriginRegistry::size() {
+    Table& table = get_table();
+    std::shared_lock<std::shared_mutex> lck(table.mtx);
+    return table.names.size();
+}
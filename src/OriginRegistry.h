@@ -0,0 +1,84 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <shared_mutex>
+#include <cstdint>
+
+/**
+ * Compact identifier of an interned origin name
+ */
+typedef uint32_t OriginId;
+
+/**
+ * \class OriginRegistry
+ *
+ * \brief Process-wide table of the origin names of Data
+ *
+ * Each distinct origin name is stored once and identified by a small integer,
+ * so Data objects only carry an OriginId. Ids are never reused and names are
+ * never removed, so a name returned by get_name() stays valid for the whole
+ * life of the process. The id 0 is the "unknown" origin.
+ */
+class OriginRegistry {
+
+public:
+
+    /**
+     * Get the id of a name, registering it if it is new
+     * @param name The origin name
+     * @returns The id of the name
+     */
+    static OriginId intern(const std::string& name);
+
+    /**
+     * Get the name of an id
+     * @param id An id returned by intern()
+     * @returns The origin name
+     * @throws std::out_of_range If the id was never returned by intern()
+     */
+    static const std::string& get_name(OriginId id);
+
+    /**
+     * Get the number of registered names
+     * @returns The number of registered names, including "unknown"
+     */
+    static std::size_t size();
+
+    /**
+     * The id of the "unknown" origin
+     */
+    static const OriginId UNKNOWN = 0;
+
+private:
+
+    struct Table {
+        Table();
+        // A deque never moves its elements, so references to the names stay valid
+        std::deque<std::string> names;
+        std::unordered_map<std::string, OriginId> ids;
+        std::shared_mutex mtx;
+    };
+
+    static Table& get_table();
+
+};
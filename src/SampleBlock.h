@@ -0,0 +1,170 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "Data.h"
+
+/**
+ * \class SampleBlock
+ *
+ * \brief A block of evenly spaced samples of a signal
+ *
+ * Holds the timestamp of the first sample, the period between samples and
+ * the contiguous values, so a high-rate sensor publishes one Data object
+ * (one timestamp, one origin) per block instead of one per sample.
+ *
+ * T must be one of the types supported by the array methods of
+ * SerializedObject: int16_t, int32_t, uint64_t, float or double.
+ */
+template <typename T>
+class SampleBlock : public Data {
+
+public:
+
+    SampleBlock() : Data(), period(0) {
+
+    }
+
+    /**
+     * Constructor. The first sample is taken now.
+     * @param origin The origin of the data
+     * @param period The time between two samples in nanoseconds
+     */
+    SampleBlock(const std::string& origin, uint64_t period) : Data(origin), period(period) {
+
+    }
+
+    /**
+     * Constructor with an interned origin. The first sample is taken now.
+     * @param origin The id of the origin of the data (see OriginRegistry)
+     * @param period The time between two samples in nanoseconds
+     */
+    SampleBlock(OriginId origin, uint64_t period) : Data(origin), period(period) {
+
+    }
+
+    /**
+     * Constructor
+     * @param time When the first sample was taken
+     * @param origin The origin of the data
+     * @param period The time between two samples in nanoseconds
+     * @param values The samples
+     */
+    SampleBlock(const Timestamp& time, const std::string& origin, uint64_t period, std::vector<T> values) :
+        Data(time, origin), period(period), values(std::move(values)) {
+
+    }
+
+    /**
+     * Serialize the SampleBlock. Do not call directly.
+     * @param object The resulting SerializedObject where the data must be saved.
+     */
+    virtual void serialize(SerializedObject* object) override {
+        Data::serialize(object);
+        object->put("period", period);
+        object->put("samples", values.data(), values.size());
+    }
+
+    /**
+     * Deserialize the SampleBlock. Do not call directly.
+     * @param object The SerializedObject to load the data from.
+     */
+    virtual void deserialize(SerializedObject* object) override {
+        Data::deserialize(object);
+        period = object->get_long_int("period");
+        object->get_array("samples", values);
+    }
+
+    /**
+     * Get the time between two samples
+     * @returns The period in nanoseconds
+     */
+    uint64_t get_period() const {
+        return period;
+    }
+
+    /**
+     * Set the time between two samples
+     * @param period The period in nanoseconds
+     */
+    void set_period(uint64_t period) {
+        this->period = period;
+    }
+
+    /**
+     * Get the timestamp of a sample
+     * @param index The position of the sample
+     * @returns The timestamp of the first sample plus index periods
+     */
+    Timestamp get_sample_time(std::size_t index) const {
+        return Timestamp(time.to_nanos() + index * period);
+    }
+
+    /**
+     * Get the number of samples
+     * @returns The number of samples
+     */
+    std::size_t size() const {
+        return values.size();
+    }
+
+    /**
+     * Get a sample
+     * @param index The position of the sample
+     * @returns The value of the sample
+     */
+    const T& operator[](std::size_t index) const {
+        return values[index];
+    }
+
+    T& operator[](std::size_t index) {
+        return values[index];
+    }
+
+    /**
+     * Append a sample at the end of the block
+     * @param value The value of the sample
+     */
+    void push_back(const T& value) {
+        values.push_back(value);
+    }
+
+    /**
+     * Get the samples
+     * @returns The contiguous samples
+     */
+    std::vector<T>& get_values() {
+        return values;
+    }
+
+    const std::vector<T>& get_values() const {
+        return values;
+    }
+
+private:
+
+    uint64_t period;
+
+    std::vector<T> values;
+
+};
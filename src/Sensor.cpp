@@ -18,20 +18,25 @@
 
 #include "Sensor.h"
 
+#include <algorithm>
+#include <system_error>
+
+const int Sensor::DEADLINE_WARMUP_READS;
+const uint64_t Sensor::DEADLINE_MIN_RUNTIME;
+
 void Sensor::start() {
     if (started) {
         throw std::runtime_error("Sensor already started!");
     }
-    this->sensor_thread = Thread(&Sensor::run, this);
-    try {
-        int priority = Thread::get_max_scheduling_priority(SchedulingPolicy::RT_ROUND_ROBIN) - 1;
-        this->sensor_thread.set_scheduling_policy(SchedulingPolicy::RT_ROUND_ROBIN, priority);
-    }
-    catch (std::runtime_error& ex) {
-        Log::log(WARNING) << "[" << name << "] While setting the sensor's thread scheduling policy an exception was thrown: " << ex.what();
-        Log::log(WARNING) << "[" << name << "] Are you running as sudo?";
-    }
+    bind_metrics();
+    // Set before the thread runs, otherwise run() can see the sensor stopped and return
     this->started = true;
+    if (attached != nullptr) {
+        // The reactor calls the handlers of the sensor
+        return;
+    }
+    this->sensor_thread = Thread(&Sensor::run, this);
+    ThreadPlacement::apply(this->sensor_thread, ROLE_SENSOR, name);
 }
 
 void Sensor::stop() {
@@ -39,7 +44,33 @@ void Sensor::stop() {
         throw std::runtime_error("Sensor not started or already stopped!");
     }
     this->started = false;
-    this->sensor_thread.join();
+    if (attached == nullptr) {
+        this->sensor_thread.join();
+    }
+}
+
+void Sensor::attach(Reactor& reactor) {
+    if (polling) {
+        throw std::logic_error("Only event-driven sensors can be attached to a reactor");
+    }
+    if (started) {
+        throw std::logic_error("Sensors must be attached before starting them");
+    }
+    attached = &reactor;
+}
+
+bool Sensor::is_attached() const {
+    return attached != nullptr;
+}
+
+Reactor& Sensor::get_reactor() {
+    if (attached != nullptr) {
+        return *attached;
+    }
+    if (!own_reactor) {
+        own_reactor = std::make_unique<Reactor>();
+    }
+    return *own_reactor;
 }
 
 bool Sensor::is_started() const {
@@ -51,17 +82,99 @@ bool Sensor::is_stopped() const {
 }
 
 void Sensor::run() {
+    ThreadPlacement::prepare_current(ROLE_SENSOR);
+    Placement placement = ThreadPlacement::get(ROLE_SENSOR);
+    bool deadline = polling && placement.policy == RT_DEADLINE && set_deadline_scheduling(placement);
     while (!is_stopped()) {
-        this->read();
-        std::this_thread::sleep_for(std::chrono::nanoseconds(sampling_rate));
+        if (!polling) {
+            // read() blocks until the next event, so it is not timed
+            this->read();
+            continue;
+        }
+        timed_read();
+        if (deadline) {
+            // Job done: sleep until the next period
+            sched_yield();
+        }
+        else {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(sampling_rate));
+        }
     }
 }
 
+void Sensor::timed_read() {
+    uint64_t start = Trace::now();
+    this->read();
+    uint64_t cost = Trace::now() - start;
+    read_duration->record(cost);
+    worst_read = std::max(worst_read, cost);
+}
+
+bool Sensor::set_deadline_scheduling(const Placement& placement) {
+    uint64_t runtime = placement.runtime;
+    if (runtime == 0) {
+        // Measure the cost of read() under the round-robin fallback
+        worst_read = 0;
+        for (int i = 0; i < DEADLINE_WARMUP_READS && !is_stopped(); ++i) {
+            timed_read();
+            std::this_thread::sleep_for(std::chrono::nanoseconds(sampling_rate));
+        }
+        runtime = std::max(worst_read + worst_read / 2, DEADLINE_MIN_RUNTIME);
+    }
+    if (runtime > sampling_rate) {
+        RTDATA_LOG(WARNING) << "[" << name << "] read() needs " << runtime << " ns per " << sampling_rate
+            << " ns period, too much for SCHED_DEADLINE. Using round-robin.";
+        return false;
+    }
+    try {
+        this_thread::set_deadline_scheduling(runtime, sampling_rate, sampling_rate);
+    }
+    catch (const std::system_error& ex) {
+        RTDATA_LOG(WARNING) << "[" << name << "] Cannot use SCHED_DEADLINE (" << ex.what()
+            << (ex.code().value() == EBUSY ? ", not enough CPU bandwidth" : "") << "). Using round-robin.";
+        return false;
+    }
+    catch (const std::invalid_argument& ex) {
+        RTDATA_LOG(WARNING) << "[" << name << "] Cannot use SCHED_DEADLINE (" << ex.what() << "). Using round-robin.";
+        return false;
+    }
+    RTDATA_LOG(INFO) << "[" << name << "] SCHED_DEADLINE runtime " << runtime << " ns, period " << sampling_rate << " ns";
+    return true;
+}
+
 void Sensor::fetch(Broker* broker) {
     while (!queue.empty()) {
         std::shared_ptr<Data> data = queue.pop();
+        data->get_trace().mark(STAGE_FETCHED);
         broker->dispatch(topic, data);
     }
+    if (queued_samples != nullptr) {
+        queued_samples->set(queue.size());
+    }
+}
+
+void Sensor::enqueue(std::shared_ptr<Data> data) {
+    data->get_trace().mark(STAGE_ENQUEUED);
+    queue.push(data);
+    if (samples_total != nullptr) {
+        samples_total->increment();
+        queued_samples->set(queue.size());
+    }
+}
+
+void Sensor::count_read_error() {
+    if (read_errors_total != nullptr) {
+        read_errors_total->increment();
+    }
+}
+
+void Sensor::bind_metrics() {
+    MetricsRegistry& registry = MetricsRegistry::get_default();
+    std::string labels = MetricsRegistry::label("sensor", name);
+    read_errors_total = &registry.counter("rtdata_sensor_read_errors_total", labels, "Sensor reads that did not produce a sample");
+    queued_samples = &registry.gauge("rtdata_sensor_queued_samples", labels, "Samples waiting to be fetched");
+    read_duration = &registry.histogram("rtdata_sensor_read_duration_ns", labels, "Time spent in read() in nanoseconds");
+    samples_total = &registry.counter("rtdata_sensor_samples_total", labels, "Samples produced by the sensor");
 }
 
 std::string Sensor::get_name() const {
@@ -78,6 +191,7 @@ uint64_t Sensor::get_sampling_rate() const {
 
 void Sensor::set_name(const std::string& name) {
     this->name = name;
+    this->origin = OriginRegistry::intern(name);
 }
 
 void Sensor::set_topic(const std::string& topic) {
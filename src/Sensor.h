@@ -28,6 +28,9 @@
 #include "Data.h"
 #include "Broker.h"
 #include "concurrent/Thread.h"
+#include "concurrent/Reactor.h"
+#include "concurrent/ThreadPlacement.h"
+#include "metrics/MetricsRegistry.h"
 
 /**
  * A class to interface with a sensor. Provides methods
@@ -40,7 +43,7 @@ public:
     /**
      * Default constructor
      */
-    Sensor() : name("unknown"), topic("default"), sampling_rate(10000), started(false) {
+    Sensor() : name("unknown"), origin(OriginRegistry::UNKNOWN), topic("default"), sampling_rate(10000), started(false) {
 
     }
 
@@ -50,7 +53,8 @@ public:
      * @param topic The topic this sensor will publish its data to.
      * @param rate The rate in nanoseconds at which this sensor will be read.
      */
-    Sensor(const std::string& name, const std::string& topic, uint64_t rate) : name(name), topic(topic), sampling_rate(rate), started(false)  {
+    Sensor(const std::string& name, const std::string& topic, uint64_t rate) : name(name), origin(OriginRegistry::intern(name)),
+        topic(topic), sampling_rate(rate), started(false)  {
 
     }
 
@@ -60,6 +64,7 @@ public:
      */
     explicit Sensor(Configuration& config) : 
         name(config["name"].get<std::string>()),
+        origin(OriginRegistry::intern(name)),
         topic(config["topic"].get<std::string>()),
         sampling_rate(config["sampling_rate"].get<uint64_t>()),
         started(false) {
@@ -79,19 +84,34 @@ public:
     }
 
     /**
-     * Starts the sensor and the internal reading thread.
+     * Starts the sensor and the internal reading thread, unless it is attached to a Reactor.
      * Shall be overriden to configure the sensor.
      * @throws std::runtime_error if the sensor has been already started or if it was stopped.
      */
     virtual void start();
 
     /**
-     * Stops the sensor and the internal reading thread.
+     * Stops the sensor and the internal reading thread, unless it is attached to a Reactor.
      * Shall be overriden to release the sensor's resources.
      * @throws std::runtime_error if the sensor has been already stopped or if it was never started.
      */
     virtual void stop();
 
+    /**
+     * Serve an event-driven sensor from a Reactor instead of a thread of its own.
+     * Must be called before start(). The handlers of the sensor then run in the
+     * reactor thread, so they must not block.
+     * @param reactor The reactor, usually Reactor::get_shared(). It must outlive the sensor.
+     * @throws std::logic_error If the sensor is polled or is started
+     */
+    void attach(Reactor& reactor);
+
+    /**
+     * Is the sensor served by a Reactor given to attach()?
+     * @returns Whether or not the sensor is attached
+     */
+    bool is_attached() const;
+
     /**
      * Is the sensor started?
      * @returns Whether or not the sensor has been started
@@ -156,12 +176,39 @@ protected:
      */
     virtual void read() = 0;
 
+    /**
+     * Store a read data in the internal queue, to be fetched later.
+     * Subclasses should use this method instead of pushing to `queue` directly.
+     * @param data The read data
+     */
+    void enqueue(std::shared_ptr<Data> data);
+
+    /**
+     * Count a failed read in the sensor's metrics.
+     * Subclasses call it when read() cannot produce a sample.
+     */
+    void count_read_error();
+
+    /**
+     * Get the Reactor that watches the file descriptors of an event-driven sensor:
+     * the one given to attach(), or else a private one, created on the first call,
+     * that read() runs in the sensor thread.
+     * @returns The reactor
+     */
+    Reactor& get_reactor();
+
     /**
      * The name of the sensor. Used to populate the origin field from Data.
      * If not set, defaults to "unknown".
      */
     std::string name;
 
+    /**
+     * The name of the sensor interned in the OriginRegistry.
+     * Subclasses pass it to the Data they create, to avoid looking up the name on every sample.
+     */
+    OriginId origin;
+
     /**
      * The topic where this sensor will publish its data.
      * If not set, defaults to "default".
@@ -174,6 +221,13 @@ protected:
      */
     uint64_t sampling_rate;
 
+    /**
+     * Whether the sensor is polled: read() is called every `sampling_rate` nanoseconds.
+     * Event-driven sensors set it to false; their read() waits for the next event
+     * (with a bounded timeout so stop() is noticed) and is called again right away.
+     */
+    bool polling = true;
+
     /**
      * Internal thread-safe queue where the read data is stored. 
      */
@@ -186,8 +240,34 @@ private:
      */
     void run();
 
+    bool set_deadline_scheduling(const Placement& placement);
+
+    void timed_read();
+
+    void bind_metrics();
+
     std::atomic<bool> started;
 
+    Reactor* attached = nullptr;
+
+    std::unique_ptr<Reactor> own_reactor;
+
+    Counter* samples_total = nullptr;
+
+    Counter* read_errors_total = nullptr;
+
+    Gauge* queued_samples = nullptr;
+
+    LatencyHistogram* read_duration = nullptr;
+
+    uint64_t worst_read = 0;
+
+    // Reads measured before deriving the SCHED_DEADLINE runtime
+    static const int DEADLINE_WARMUP_READS = 20;
+
+    // Lower bound of the derived SCHED_DEADLINE runtime, in nanoseconds
+    static const uint64_t DEADLINE_MIN_RUNTIME = 20000;
+
     Thread sensor_thread;
 
 };
\ No newline at end of file
@@ -22,6 +22,9 @@ void SensorsManager::add_sensor(std::shared_ptr<Sensor> sensor) {
     //Avoid adding a sensor while fetching data from sensors
     std::unique_lock<std::mutex> lck(sensor_mtx);
     sensors.push_back(sensor);
+    if (sensor_count != nullptr) {
+        sensor_count->set(sensors.size());
+    }
     if (started) {
         sensor->start();
     }
@@ -34,6 +37,9 @@ void SensorsManager::remove_sensor(std::shared_ptr<Sensor> sensor) {
             sensors.erase(sensors.begin() + i);
         }
     }
+    if (sensor_count != nullptr) {
+        sensor_count->set(sensors.size());
+    }
 }
 
 void SensorsManager::start() {
@@ -41,12 +47,14 @@ void SensorsManager::start() {
         throw std::runtime_error("Cannot start already started SensorsManager");
     }
     std::unique_lock<std::mutex> lck(sensor_mtx);
+    bind_metrics();
     for (auto& sensor : sensors) {
         if (!sensor->is_started() && !sensor->is_stopped()) {
             sensor->start();
         }
     }
-    fetch_thread = std::thread(&SensorsManager::run, this);
+    fetch_thread = Thread(&SensorsManager::run, this);
+    ThreadPlacement::apply(fetch_thread, ROLE_MANAGER, "manager");
     started = true;
 }
 
@@ -65,20 +73,32 @@ void SensorsManager::stop() {
 }
 
 void SensorsManager::run() {
+    ThreadPlacement::prepare_current(ROLE_MANAGER);
     //Defer to avoid deadlock
     std::unique_lock<std::mutex> lck(sensor_mtx, std::defer_lock);
     while (started) {
         lck.lock();
         if (broker != NULL) {
+            uint64_t start = Trace::now();
             for (auto& sensor : sensors) {
                 sensor->fetch(broker);
             }
+            fetch_duration->record(Trace::now() - start);
+            fetch_cycles->increment();
         }
         lck.unlock();
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 }
 
+void SensorsManager::bind_metrics() {
+    MetricsRegistry& registry = MetricsRegistry::get_default();
+    sensor_count = &registry.gauge("rtdata_manager_sensors", "", "Sensors managed by the SensorsManager");
+    fetch_cycles = &registry.counter("rtdata_manager_fetch_cycles_total", "", "Fetch cycles run by the SensorsManager");
+    fetch_duration = &registry.histogram("rtdata_manager_fetch_duration_ns", "", "Time spent fetching from all the sensors in nanoseconds");
+    sensor_count->set(sensors.size());
+}
+
 bool SensorsManager::is_started() const {
     return started;
 }
@@ -89,4 +109,4 @@ bool SensorsManager::is_stopped() const {
 
 void SensorsManager::set_broker(Broker* broker) {
     this->broker = broker;
-}
\ No newline at end of file
+}
\ No newline at end of file
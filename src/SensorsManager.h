@@ -27,6 +27,7 @@
 #include <chrono>
 
 #include "Sensor.h"
+#include "metrics/MetricsRegistry.h"
 
 /**
  * A manager for Sensors. Responsible of the correct life-cycle management
@@ -114,8 +115,16 @@ private:
 
     std::mutex sensor_mtx;
 
-    std::thread fetch_thread;
+    Thread fetch_thread;
 
     Broker* broker;
 
-};
\ No newline at end of file
+    Gauge* sensor_count = nullptr;
+
+    Counter* fetch_cycles = nullptr;
+
+    LatencyHistogram* fetch_duration = nullptr;
+
+    void bind_metrics();
+
+};
\ No newline at end of file
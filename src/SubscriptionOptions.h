@@ -0,0 +1,185 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "concurrent/ThreadPool.h"
+#include "concurrent/Mailbox.h"
+
+/**
+ * How the Broker runs a listener for the events of a topic
+ */
+enum DeliveryMode {
+    // Each event is a separate ThreadPool job: a listener may handle
+    // several events of the topic at once, in any order
+    DELIVERY_CONCURRENT = 0,
+    // The events of the topic are handled in dispatch order, one at a time,
+    // by a single worker at once. Other listeners and topics are not blocked.
+    DELIVERY_ORDERED,
+    // The listener is called by the thread that dispatches the event, before
+    // dispatch() returns. For cheap listeners: a listener that exceeds its
+    // time budget is moved to the pool (DELIVERY_CONCURRENT).
+    DELIVERY_INLINE,
+    // Only the latest event of each topic is delivered when the listener is ready:
+    // events dispatched while the previous one waits replace it. Handled one at a
+    // time, like DELIVERY_ORDERED. For low-rate consumers of high-rate topics.
+    DELIVERY_CONFLATED
+};
+
+/**
+ * \struct SubscriptionOptions
+ *
+ * \brief How a listener subscribed with Broker::subscribe() receives the events of a topic
+ */
+struct SubscriptionOptions {
+
+    /**
+     * How the listener is run
+     */
+    DeliveryMode delivery = DELIVERY_CONCURRENT;
+
+    /**
+     * The ThreadPool lane of the deliveries. Listeners of critical topics (alarms,
+     * state changes) use PRIORITY_HIGH to skip the backlog of high-rate topics.
+     */
+    JobPriority priority = PRIORITY_NORMAL;
+
+    /**
+     * With DELIVERY_INLINE, the maximum time in nanoseconds a call to the listener
+     * may take. After MAX_INLINE_OVERRUNS consecutive calls over it, the listener is moved to the pool.
+     */
+    uint64_t inline_budget = DEFAULT_INLINE_BUDGET;
+
+    /**
+     * The maximum number of events waiting for the listener, or 0 for no limit.
+     * Bounds the memory used by a listener that falls behind, e.g. a Writer of
+     * an unreachable server. Not used with DELIVERY_CONFLATED, which holds at
+     * most one event per topic.
+     */
+    std::size_t capacity = 0;
+
+    /**
+     * What to do with an event dispatched while the listener's mailbox is full.
+     * OVERFLOW_BLOCK makes dispatch() wait: do not use it on topics dispatched
+     * by the listeners themselves.
+     */
+    OverflowPolicy overflow = OVERFLOW_BLOCK;
+
+    /**
+     * With OVERFLOW_SAMPLE, one in sample_rate of the events dispatched while
+     * the mailbox is full is delivered
+     */
+    unsigned int sample_rate = Mailbox::DEFAULT_SAMPLE_RATE;
+
+    /**
+     * Whether the listener receives, when it subscribes, the last value of the
+     * topics already dispatched (see Broker::get_last_value())
+     */
+    bool replay_last_value = false;
+
+    /**
+     * Default time budget of an inline listener: 20 microseconds
+     */
+    static constexpr uint64_t DEFAULT_INLINE_BUDGET = 20000;
+
+    /**
+     * Consecutive calls over the time budget tolerated before an inline listener is moved
+     * to the pool. A call within the budget resets the count, so occasional page faults
+     * or preemptions do not demote it.
+     */
+    static constexpr int MAX_INLINE_OVERRUNS = 3;
+
+    /**
+     * Options for a listener that handles the events in order (DELIVERY_ORDERED)
+     * @param priority The ThreadPool lane of the deliveries
+     * @returns The options
+     */
+    static SubscriptionOptions ordered(JobPriority priority = PRIORITY_NORMAL) {
+        SubscriptionOptions options;
+        options.delivery = DELIVERY_ORDERED;
+        options.priority = priority;
+        return options;
+    }
+
+    /**
+     * Options for a listener that handles the events concurrently (DELIVERY_CONCURRENT)
+     * @param priority The ThreadPool lane of the deliveries
+     * @returns The options
+     */
+    static SubscriptionOptions concurrent(JobPriority priority) {
+        SubscriptionOptions options;
+        options.priority = priority;
+        return options;
+    }
+
+    /**
+     * Options for a listener that only needs the latest event of each topic (DELIVERY_CONFLATED)
+     * @param priority The ThreadPool lane of the deliveries
+     * @returns The options
+     */
+    static SubscriptionOptions conflated(JobPriority priority = PRIORITY_NORMAL) {
+        SubscriptionOptions options;
+        options.delivery = DELIVERY_CONFLATED;
+        options.priority = priority;
+        return options;
+    }
+
+    /**
+     * Options for a cheap listener called by the dispatching thread (DELIVERY_INLINE)
+     * @param budget The time budget of a call in nanoseconds
+     * @returns The options
+     */
+    static SubscriptionOptions inline_delivery(uint64_t budget = DEFAULT_INLINE_BUDGET) {
+        SubscriptionOptions options;
+        options.delivery = DELIVERY_INLINE;
+        options.inline_budget = budget;
+        return options;
+    }
+
+    /**
+     * Copy of these options with a bounded mailbox, e.g.
+     * SubscriptionOptions::ordered().bounded(1000, OVERFLOW_DROP_OLDEST)
+     * @param capacity The maximum number of events waiting for the listener
+     * @param overflow What to do with an event dispatched while the mailbox is full
+     * @param sample_rate With OVERFLOW_SAMPLE, deliver one in sample_rate of those events
+     * @returns The options
+     */
+    SubscriptionOptions bounded(std::size_t capacity, OverflowPolicy overflow = OVERFLOW_BLOCK,
+            unsigned int sample_rate = Mailbox::DEFAULT_SAMPLE_RATE) const {
+        SubscriptionOptions options = *this;
+        options.capacity = capacity;
+        options.overflow = overflow;
+        options.sample_rate = sample_rate;
+        return options;
+    }
+
+    /**
+     * Copy of these options where the listener receives the last value of the matching
+     * topics when it subscribes, e.g. SubscriptionOptions::conflated().with_last_value()
+     * @returns The options
+     */
+    SubscriptionOptions with_last_value() const {
+        SubscriptionOptions options = *this;
+        options.replay_last_value = true;
+        return options;
+    }
+
+};
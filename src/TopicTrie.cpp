@@ -0,0 +1,98 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TopicTrie.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+const char TopicTrie::SEPARATOR;
+const char TopicTrie::SINGLE_LEVEL;
+const char TopicTrie::MULTI_LEVEL;
+
+void TopicTrie::insert(const std::string& pattern, std::size_t value) {
+    validate(pattern);
+    std::vector<std::string> levels = split(pattern);
+    Node* node = root.get();
+    for (const std::string& level : levels) {
+        if (level.size() == 1 && level[0] == MULTI_LEVEL) {
+            node->multi_level_values.push_back(value);
+            return;
+        }
+        std::unique_ptr<Node>& child = (level.size() == 1 && level[0] == SINGLE_LEVEL)? node->single_level : node->children[level];
+        if (!child) {
+            child.reset(new Node());
+        }
+        node = child.get();
+    }
+    node->values.push_back(value);
+}
+
+std::vector<std::size_t> TopicTrie::match(const std::string& topic) const {
+    std::vector<std::size_t> values;
+    match(*root, split(topic), 0, values);
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+void TopicTrie::match(const Node& node, const std::vector<std::string>& levels, std::size_t level, std::vector<std::size_t>& values) {
+    values.insert(values.end(), node.multi_level_values.begin(), node.multi_level_values.end());
+    if (level == levels.size()) {
+        values.insert(values.end(), node.values.begin(), node.values.end());
+        return;
+    }
+    auto child = node.children.find(levels[level]);
+    if (child != node.children.end()) {
+        match(*child->second, levels, level + 1, values);
+    }
+    if (node.single_level) {
+        match(*node.single_level, levels, level + 1, values);
+    }
+}
+
+void TopicTrie::validate(const std::string& pattern) {
+    std::vector<std::string> levels = split(pattern);
+    for (std::size_t i = 0; i < levels.size(); ++i) {
+        const std::string& level = levels[i];
+        bool wildcard = level.find(SINGLE_LEVEL) != std::string::npos || level.find(MULTI_LEVEL) != std::string::npos;
+        if (wildcard && level.size() != 1) {
+            throw std::invalid_argument("A wildcard must be a whole level of the topic: " + pattern);
+        }
+        if (wildcard && level[0] == MULTI_LEVEL && i != levels.size() - 1) {
+            throw std::invalid_argument("# must be the last level of the topic: " + pattern);
+        }
+    }
+}
+
+bool TopicTrie::is_pattern(const std::string& topic) {
+    return topic.find(SINGLE_LEVEL) != std::string::npos || topic.find(MULTI_LEVEL) != std::string::npos;
+}
+
+std::vector<std::string> TopicTrie::split(const std::string& topic) {
+    std::vector<std::string> levels;
+    std::size_t start = 0;
+    while (true) {
+        std::size_t end = topic.find(SEPARATOR, start);
+        if (end == std::string::npos) {
+            levels.push_back(topic.substr(start));
+            return levels;
+        }
+        levels.push_back(topic.substr(start, end - start));
+        start = end + 1;
+    }
+}
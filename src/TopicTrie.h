@@ -0,0 +1,123 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+/**
+ * \class TopicTrie
+ *
+ * \brief Matches hierarchical topics against subscription patterns
+ *
+ * Topics are made of levels separated by '/', e.g. `vehicle/imu/accel`.
+ * In a pattern, a level may be a wildcard:
+ *   - `*` matches exactly one level: the levels `vehicle`, `*`, `accel` match `vehicle/imu/accel`
+ *     and `vehicle/wheel/accel`, but not `vehicle/accel`
+ *   - `#`, only as the last level, matches any number of levels, including none:
+ *     `vehicle/#` matches `vehicle`, `vehicle/gps` and `vehicle/imu/accel`
+ * A pattern without wildcards matches only the same topic.
+ *
+ * Each inserted pattern carries a value (the Broker uses the index of the
+ * subscription). Matching walks one branch per level, plus the wildcard
+ * branches, so its cost does not depend on the number of patterns.
+ */
+class TopicTrie {
+
+public:
+
+    /**
+     * Default constructor
+     */
+    TopicTrie() : root(new Node()) {
+
+    }
+
+    // Do not allow copy or assignment.
+
+    TopicTrie(const TopicTrie&) = delete;
+
+    TopicTrie& operator=(const TopicTrie&) = delete;
+
+    /**
+     * Add a pattern
+     * @param pattern The topic or the wildcard pattern
+     * @param value The value returned by match() for the topics that match the pattern
+     * @throws std::invalid_argument If the pattern is not valid (see validate())
+     */
+    void insert(const std::string& pattern, std::size_t value);
+
+    /**
+     * Find the patterns that match a topic
+     * @param topic A topic without wildcards
+     * @returns The values of the matching patterns, in ascending order
+     */
+    std::vector<std::size_t> match(const std::string& topic) const;
+
+    /**
+     * Check a pattern: a wildcard must be a whole level, and `#` must be the last one
+     * @param pattern The pattern
+     * @throws std::invalid_argument If the pattern is not valid
+     */
+    static void validate(const std::string& pattern);
+
+    /**
+     * Does a topic have wildcards?
+     * @param topic The topic
+     * @returns Whether the topic contains `*` or `#`
+     */
+    static bool is_pattern(const std::string& topic);
+
+    /**
+     * Separator of the levels of a topic
+     */
+    static const char SEPARATOR = '/';
+
+    /**
+     * Wildcard matching one level
+     */
+    static const char SINGLE_LEVEL = '*';
+
+    /**
+     * Wildcard matching the remaining levels
+     */
+    static const char MULTI_LEVEL = '#';
+
+private:
+
+    struct Node {
+        std::unordered_map<std::string, std::unique_ptr<Node>> children;
+        // The `*` child
+        std::unique_ptr<Node> single_level;
+        // Patterns that end at this node
+        std::vector<std::size_t> values;
+        // Patterns that end with `#` after this node
+        std::vector<std::size_t> multi_level_values;
+    };
+
+    static std::vector<std::string> split(const std::string& topic);
+
+    static void match(const Node& node, const std::vector<std::string>& levels, std::size_t level, std::vector<std::size_t>& values);
+
+    std::unique_ptr<Node> root;
+
+};
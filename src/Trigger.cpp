@@ -0,0 +1,155 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Trigger.h"
+#include "time/Timestamp.h"
+
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <ctime>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+EventTrigger::EventTrigger() {
+    fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error(std::strerror(errno));
+    }
+}
+
+EventTrigger::~EventTrigger() {
+    close(fd);
+}
+
+void EventTrigger::fire() {
+    uint64_t one = 1;
+    // Only fails if the counter is saturated, and then the trigger is pending anyway
+    ssize_t size = write(fd, &one, sizeof(one));
+    (void)size;
+}
+
+int EventTrigger::get_fd() const {
+    return fd;
+}
+
+uint64_t EventTrigger::consume(uint64_t& timestamp) {
+    uint64_t count = 0;
+    if (read(fd, &count, sizeof(count)) < 0) {
+        if (errno == EAGAIN) {
+            return 0;
+        }
+        throw std::runtime_error(std::strerror(errno));
+    }
+    timestamp = Timestamp::now().to_nanos();
+    return count;
+}
+
+TimerTrigger::TimerTrigger(uint64_t period) {
+    if (period == 0) {
+        throw std::invalid_argument("The period of a timer must be greater than 0");
+    }
+    fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error(std::strerror(errno));
+    }
+    struct itimerspec spec;
+    spec.it_interval.tv_sec = period / 1000000000ULL;
+    spec.it_interval.tv_nsec = period % 1000000000ULL;
+    spec.it_value = spec.it_interval;
+    if (timerfd_settime(fd, 0, &spec, nullptr) < 0) {
+        std::string error = std::strerror(errno);
+        close(fd);
+        throw std::runtime_error(error);
+    }
+}
+
+TimerTrigger::~TimerTrigger() {
+    close(fd);
+}
+
+int TimerTrigger::get_fd() const {
+    return fd;
+}
+
+uint64_t TimerTrigger::consume(uint64_t& timestamp) {
+    uint64_t expirations = 0;
+    if (read(fd, &expirations, sizeof(expirations)) < 0) {
+        if (errno == EAGAIN) {
+            return 0;
+        }
+        throw std::runtime_error(std::strerror(errno));
+    }
+    timestamp = Timestamp::now().to_nanos();
+    return expirations;
+}
+
+int FileTrigger::get_fd() const {
+    return fd;
+}
+
+uint64_t FileTrigger::consume(uint64_t& timestamp) {
+    timestamp = Timestamp::now().to_nanos();
+    if (!drain) {
+        return 1;
+    }
+    char buffer[256];
+    ssize_t size;
+    bool drained = false;
+    while ((size = read(fd, buffer, sizeof(buffer))) > 0) {
+        drained = true;
+    }
+    if (size < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        throw std::runtime_error(std::strerror(errno));
+    }
+    // The last bytes before the end of the file still fire: the next call reports it
+    if (size == 0 && !drained) {
+        throw std::runtime_error("End of file");
+    }
+    return drained ? 1 : 0;
+}
+
+int GPIOTrigger::get_fd() const {
+    return line->get_fd();
+}
+
+uint64_t GPIOTrigger::consume(uint64_t& timestamp) {
+    uint64_t count = 0;
+    GPIOEvent event;
+    while (line->read_event(event)) {
+        ++count;
+    }
+    if (count > 0) {
+        timestamp = to_wall_clock(event.timestamp);
+    }
+    return count;
+}
+
+uint64_t GPIOTrigger::to_wall_clock(uint64_t kernel_timestamp) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t monotonic = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    uint64_t now = Timestamp::now().to_nanos();
+    if (kernel_timestamp > monotonic) {
+        // Older kernels already use CLOCK_REALTIME
+        return kernel_timestamp;
+    }
+    return now - (monotonic - kernel_timestamp);
+}
@@ -0,0 +1,207 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <memory>
+#include <cstdint>
+
+#include "io/GPIOChip.h"
+
+/**
+ * \class Trigger
+ *
+ * \brief A pollable source of events that drives the reads of a TriggeredSensor
+ *
+ * A trigger exposes a file descriptor that becomes readable when it fires
+ * (a data-ready interrupt, a timer, ...). When it is readable, consume()
+ * acknowledges the pending firings so the descriptor is not readable anymore.
+ */
+class Trigger {
+
+public:
+
+    virtual ~Trigger() = default;
+
+    /**
+     * Get the file descriptor watched for this trigger
+     * @returns A file descriptor that is readable while the trigger has fired and was not consumed
+     */
+    virtual int get_fd() const = 0;
+
+    /**
+     * Acknowledge the pending firings
+     * @param timestamp Set to the time of the last firing, in nanoseconds
+     * @returns The number of firings since the last call (more than 1 if reads fell behind), 0 if none
+     * @throws std::runtime_error If the source cannot be read or was closed
+     */
+    virtual uint64_t consume(uint64_t& timestamp) = 0;
+
+};
+
+/**
+ * \class EventTrigger
+ *
+ * \brief A trigger fired by software, through an eventfd
+ *
+ * Another thread (or another process, with get_fd()) calls fire(). Useful to
+ * chain sensors, or as a stand-in for a hardware trigger in tests.
+ */
+class EventTrigger : public Trigger {
+
+public:
+
+    /**
+     * Constructor
+     * @throws std::runtime_error If the eventfd cannot be created
+     */
+    EventTrigger();
+
+    ~EventTrigger();
+
+    // Do not allow copy or assignment.
+
+    EventTrigger(const EventTrigger&) = delete;
+
+    EventTrigger& operator=(const EventTrigger&) = delete;
+
+    /**
+     * Fire the trigger. Can be called from any thread.
+     */
+    void fire();
+
+    virtual int get_fd() const override;
+
+    virtual uint64_t consume(uint64_t& timestamp) override;
+
+private:
+
+    int fd;
+
+};
+
+/**
+ * \class TimerTrigger
+ *
+ * \brief A periodic trigger, through a timerfd on CLOCK_MONOTONIC
+ *
+ * The period is kept by the kernel, so it does not drift with the duration of the reads.
+ */
+class TimerTrigger : public Trigger {
+
+public:
+
+    /**
+     * Constructor. The timer starts right away.
+     * @param period The period in nanoseconds
+     * @throws std::invalid_argument If the period is 0
+     * @throws std::runtime_error If the timer cannot be created
+     */
+    explicit TimerTrigger(uint64_t period);
+
+    ~TimerTrigger();
+
+    // Do not allow copy or assignment.
+
+    TimerTrigger(const TimerTrigger&) = delete;
+
+    TimerTrigger& operator=(const TimerTrigger&) = delete;
+
+    virtual int get_fd() const override;
+
+    virtual uint64_t consume(uint64_t& timestamp) override;
+
+private:
+
+    int fd;
+
+};
+
+/**
+ * \class FileTrigger
+ *
+ * \brief A trigger on any pollable file descriptor, e.g. an IIO buffer or a pipe
+ *
+ * The descriptor is not owned. If `drain` is set, consume() reads and drops the
+ * available bytes (for pipes or sockets used as notifications); otherwise they are
+ * left for the sensor to read (e.g. the scans of an IIO buffer), which must read them
+ * or the trigger keeps firing. When draining, the end of the file (the writer of a
+ * pipe closed it) is reported by consume() as an error.
+ */
+class FileTrigger : public Trigger {
+
+public:
+
+    /**
+     * Constructor
+     * @param fd The file descriptor, which must outlive the trigger
+     * @param drain Whether consume() discards the available bytes
+     */
+    FileTrigger(int fd, bool drain) : fd(fd), drain(drain) {
+
+    }
+
+    virtual int get_fd() const override;
+
+    virtual uint64_t consume(uint64_t& timestamp) override;
+
+private:
+
+    int fd;
+
+    bool drain;
+
+};
+
+/**
+ * \class GPIOTrigger
+ *
+ * \brief A trigger on the edges of a GPIO line, e.g. the data-ready line of a device
+ *
+ * The timestamp is the one taken by the kernel in the interrupt handler,
+ * converted to the clock of Timestamp::now(), so it does not include the
+ * latency of waking up the sensor.
+ */
+class GPIOTrigger : public Trigger {
+
+public:
+
+    /**
+     * Constructor
+     * @param line The line, as requested with GPIOChip::request_edges()
+     */
+    explicit GPIOTrigger(std::unique_ptr<GPIOEdgeLine> line) : line(std::move(line)) {
+
+    }
+
+    virtual int get_fd() const override;
+
+    virtual uint64_t consume(uint64_t& timestamp) override;
+
+    /**
+     * Convert a GPIO event timestamp to the clock of Timestamp::now()
+     * @param kernel_timestamp The timestamp of the event (see GPIOEvent)
+     * @returns The timestamp in nanoseconds since the epoch
+     */
+    static uint64_t to_wall_clock(uint64_t kernel_timestamp);
+
+private:
+
+    std::unique_ptr<GPIOEdgeLine> line;
+
+};
@@ -0,0 +1,119 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TriggeredSensor.h"
+
+#include <stdexcept>
+
+const int TriggeredSensor::READ_TIMEOUT_MILLIS;
+
+TriggeredSensor::~TriggeredSensor() {
+    try {
+        stop();
+    }
+    catch (std::runtime_error&) {
+        //Already stopped
+    }
+}
+
+void TriggeredSensor::add_trigger(std::unique_ptr<Trigger> trigger) {
+    if (is_started()) {
+        throw std::logic_error("Triggers must be added before starting the sensor");
+    }
+    if (!trigger) {
+        throw std::invalid_argument("Null trigger");
+    }
+    triggers.push_back(std::move(trigger));
+}
+
+void TriggeredSensor::start() {
+    if (is_started()) {
+        throw std::runtime_error("Sensor already started!");
+    }
+    if (triggers.empty()) {
+        add_trigger(std::make_unique<TimerTrigger>(sampling_rate));
+    }
+    missed_total = &MetricsRegistry::get_default().counter("rtdata_sensor_missed_triggers_total",
+        MetricsRegistry::label("sensor", name), "Trigger firings coalesced because the sensor was busy");
+    Reactor& reactor = get_reactor();
+    try {
+        for (auto& trigger : triggers) {
+            Trigger* raw = trigger.get();
+            reactor.add(raw->get_fd(), Reactor::READABLE, [this, raw](uint32_t events) {
+                handle(*raw, events);
+            });
+        }
+    }
+    catch (std::runtime_error&) {
+        unwatch();
+        throw;
+    }
+    Sensor::start();
+}
+
+void TriggeredSensor::stop() {
+    Sensor::stop();
+    unwatch();
+}
+
+void TriggeredSensor::unwatch() {
+    // Waits for a handler running in the thread of a shared reactor
+    Reactor& reactor = get_reactor();
+    for (auto& trigger : triggers) {
+        reactor.remove(trigger->get_fd());
+    }
+}
+
+void TriggeredSensor::read() {
+    get_reactor().run_once(READ_TIMEOUT_MILLIS);
+}
+
+void TriggeredSensor::handle(Trigger& trigger, uint32_t events) {
+    uint64_t timestamp = 0;
+    uint64_t count;
+    try {
+        if ((events & (EPOLLHUP | EPOLLERR)) && !(events & Reactor::READABLE)) {
+            throw std::runtime_error("Hung up");
+        }
+        count = trigger.consume(timestamp);
+    }
+    catch (std::runtime_error& e) {
+        // The descriptor is level-triggered: left registered, it would be reported on every wait
+        RTDATA_LOG(WARNING) << "[" << name << "] Trigger failed, not watched anymore: " << e.what();
+        count_read_error();
+        get_reactor().remove(trigger.get_fd());
+        return;
+    }
+    if (count == 0) {
+        return;
+    }
+    if (count > 1) {
+        missed += count - 1;
+        missed_total->increment(count - 1);
+    }
+    ++triggered;
+    on_trigger(trigger, timestamp);
+}
+
+uint64_t TriggeredSensor::get_triggered() const {
+    return triggered;
+}
+
+uint64_t TriggeredSensor::get_missed() const {
+    return missed;
+}
@@ -0,0 +1,136 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <atomic>
+
+#include "Sensor.h"
+#include "Log.h"
+#include "Trigger.h"
+#include "concurrent/Reactor.h"
+
+/**
+ * \class TriggeredSensor
+ *
+ * \brief A sensor read when one of its triggers fires, instead of at a fixed interval
+ *
+ * The triggers (a data-ready GPIO edge, an IIO buffer, a timer, an event fired by
+ * another component, ...) are watched by a Reactor: a private one run by the sensor
+ * thread or, if the sensor is attached (see Sensor::attach()), one shared with other
+ * components, such as Reactor::get_shared(). When one
+ * fires, on_trigger() is called with the time of the firing; it reads the device
+ * and enqueues the samples. Firings that happen while the sensor is still busy are
+ * coalesced into one call, and counted as missed.
+ *
+ * If no trigger is added, the sensor uses a TimerTrigger with the sampling rate.
+ */
+class TriggeredSensor : public Sensor {
+
+public:
+
+    /**
+     * Constructor
+     * @param name The name of the sensor. Used to identify it.
+     * @param topic The topic this sensor will publish its data to.
+     * @param rate The period in nanoseconds of the default timer trigger, used if no trigger is added.
+     */
+    TriggeredSensor(const std::string& name, const std::string& topic, uint64_t rate) : Sensor(name, topic, rate) {
+        polling = false;
+    }
+
+    /**
+     * Constructor with configuration object
+     * @param config The node containing the configuration for this sensor
+     */
+    explicit TriggeredSensor(Configuration& config) : Sensor(config) {
+        polling = false;
+    }
+
+    /**
+     * Destructor
+     */
+    virtual ~TriggeredSensor();
+
+    /**
+     * Add a trigger. The sensor takes its ownership.
+     * @param trigger The trigger
+     * @throws std::logic_error If the sensor is started
+     * @throws std::invalid_argument If the trigger is null
+     */
+    void add_trigger(std::unique_ptr<Trigger> trigger);
+
+    /**
+     * Starts the sensor and starts watching its triggers.
+     * @throws std::runtime_error if the sensor has been already started or if it was stopped.
+     */
+    virtual void start() override;
+
+    /**
+     * Stops the sensor and stops watching its triggers.
+     * @throws std::runtime_error if the sensor has been already stopped or if it was never started.
+     */
+    virtual void stop() override;
+
+    /**
+     * Get the number of times the sensor was triggered
+     * @returns The number of calls to on_trigger()
+     */
+    uint64_t get_triggered() const;
+
+    /**
+     * Get the number of firings coalesced because the sensor was busy
+     * @returns The number of missed firings
+     */
+    uint64_t get_missed() const;
+
+protected:
+
+    /**
+     * Read the sensor after a trigger fired. Must be overriden by a subclass.
+     * The results of the read must be saved with enqueue().
+     * @param trigger The trigger that fired
+     * @param timestamp The time of the firing in nanoseconds (see Timestamp)
+     */
+    virtual void on_trigger(Trigger& trigger, uint64_t timestamp) = 0;
+
+    /**
+     * Waits for the triggers and calls on_trigger()
+     */
+    virtual void read() override;
+
+private:
+
+    void handle(Trigger& trigger, uint32_t events);
+
+    void unwatch();
+
+    // Maximum time read() waits for a trigger, so stop() is noticed
+    static const int READ_TIMEOUT_MILLIS = 100;
+
+    std::vector<std::unique_ptr<Trigger>> triggers;
+
+    std::atomic<uint64_t> triggered{0};
+
+    std::atomic<uint64_t> missed{0};
+
+    Counter* missed_total = nullptr;
+
+};
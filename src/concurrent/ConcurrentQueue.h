@@ -24,6 +24,8 @@
 /**
  * \class ConcurrentQueue
  * \brief A thread-safe (blocking) queue.
+ *
+ * Items are moved in and out, so it can hold move-only types such as Task.
  */
 template <typename T>
 class ConcurrentQueue {
@@ -41,18 +43,34 @@ public:
      */
     T pop() {
         std::unique_lock<std::mutex> lck(mtx);
-        T item = q.front();
+        T item = std::move(q.front());
         q.pop();
         return item;
     }
 
+    /**
+     * Delete the first element from the queue, if any.
+     * Unlike empty() followed by pop(), it cannot race with another consumer.
+     * @param item Where the first element is moved to
+     * @returns Whether an element was popped
+     */
+    bool try_pop(T& item) {
+        std::unique_lock<std::mutex> lck(mtx);
+        if (q.empty()) {
+            return false;
+        }
+        item = std::move(q.front());
+        q.pop();
+        return true;
+    }
+
     /**
      * Add a new item to the back of the queue.
      * @params item An item to be stored in the queue.
      */
     void push(T item) {
         std::unique_lock<std::mutex> lck(mtx);
-        q.push(item);
+        q.push(std::move(item));
     }
 
     /**
@@ -64,6 +82,15 @@ public:
         return q.empty();
     }
 
+    /**
+     * Get the number of items in the queue
+     * @returns The number of queued items.
+     */
+    std::size_t size() {
+        std::unique_lock<std::mutex> lck(mtx);
+        return q.size();
+    }
+
     //Do not allow copy or assignment.
 
     ConcurrentQueue(const ConcurrentQueue&) = delete;
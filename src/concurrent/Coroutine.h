@@ -0,0 +1,490 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#ifdef WITH_COROUTINES
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <mutex>
+#include <condition_variable>
+
+#include "Reactor.h"
+#include "ThreadPool.h"
+#include "../time/Timestamp.h"
+#include "../Log.h"
+
+/**
+ * C++20 coroutine support (build with -DWITH_COROUTINES=ON).
+ *
+ * A device conversation that would block the sensor thread (write a register,
+ * wait for the conversion, read the result) can be written as a coroutine that
+ * suspends instead, so many of them share a few threads:
+ *
+ *     async::Task<uint16_t> convert(I2C& i2c, Reactor& reactor, ThreadPool& pool) {
+ *         co_await i2c.transfer_async(start_conversion, pool);
+ *         co_await async::sleep_for(reactor, 2000000);
+ *         co_await i2c.transfer_async(read_result, pool);
+ *         co_return value;
+ *     }
+ *
+ * A coroutine resumes in the thread that completed what it awaited: the thread
+ * running the Reactor after sleep_for(), sleep_until(), fd_readable() and
+ * fd_writable(), a worker of the ThreadPool after schedule_on().
+ */
+namespace async {
+
+    template <typename T = void>
+    class Task;
+
+    namespace detail {
+
+        struct PromiseBase {
+
+            std::coroutine_handle<> continuation;
+
+            std::exception_ptr error;
+
+            bool detached = false;
+
+            std::suspend_always initial_suspend() noexcept {
+                return {};
+            }
+
+            struct FinalAwaiter {
+
+                bool await_ready() noexcept {
+                    return false;
+                }
+
+                template <typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+                    PromiseBase& promise = handle.promise();
+                    if (promise.continuation) {
+                        return promise.continuation;
+                    }
+                    if (promise.detached) {
+                        if (promise.error) {
+                            try {
+                                std::rethrow_exception(promise.error);
+                            }
+                            catch (std::exception& e) {
+                                RTDATA_LOG(WARNING) << "Detached coroutine failed: " << e.what();
+                            }
+                            catch (...) {
+                                RTDATA_LOG(WARNING) << "Detached coroutine failed";
+                            }
+                        }
+                        handle.destroy();
+                    }
+                    return std::noop_coroutine();
+                }
+
+                void await_resume() noexcept {
+
+                }
+
+            };
+
+            FinalAwaiter final_suspend() noexcept {
+                return {};
+            }
+
+            void unhandled_exception() {
+                error = std::current_exception();
+            }
+
+        };
+
+        template <typename T>
+        struct Promise : PromiseBase {
+
+            std::optional<T> value;
+
+            Task<T> get_return_object();
+
+            template <typename U>
+            void return_value(U&& result) {
+                value.emplace(std::forward<U>(result));
+            }
+
+            T result() {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+                return std::move(*value);
+            }
+
+        };
+
+        template <>
+        struct Promise<void> : PromiseBase {
+
+            Task<void> get_return_object();
+
+            void return_void() {
+
+            }
+
+            void result() {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+            }
+
+        };
+
+    }
+
+    /**
+     * \class Task
+     *
+     * \brief A lazy coroutine returning a T
+     *
+     * The coroutine starts when the Task is awaited (co_await), detached with
+     * spawn() or waited with sync_wait(). An exception thrown by the coroutine is
+     * rethrown to the awaiter.
+     */
+    template <typename T>
+    class Task {
+
+    public:
+
+        typedef detail::Promise<T> promise_type;
+
+        explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {
+
+        }
+
+        Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {
+
+        }
+
+        Task& operator=(Task&& other) noexcept {
+            if (this != &other) {
+                if (handle) {
+                    handle.destroy();
+                }
+                handle = std::exchange(other.handle, nullptr);
+            }
+            return *this;
+        }
+
+        /**
+         * Destructor. Destroys the coroutine if it was not detached.
+         */
+        ~Task() {
+            if (handle) {
+                handle.destroy();
+            }
+        }
+
+        // Do not allow copy or assignment.
+
+        Task(const Task&) = delete;
+
+        Task& operator=(const Task&) = delete;
+
+        bool await_ready() const noexcept {
+            return !handle || handle.done();
+        }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+            handle.promise().continuation = awaiter;
+            return handle;
+        }
+
+        T await_resume() {
+            return handle.promise().result();
+        }
+
+        /**
+         * Start the coroutine without waiting for it. Its frame is destroyed
+         * when it finishes; an exception thrown by it is logged.
+         */
+        void detach() {
+            std::coroutine_handle<promise_type> started = std::exchange(handle, nullptr);
+            started.promise().detached = true;
+            started.resume();
+        }
+
+    private:
+
+        std::coroutine_handle<promise_type> handle;
+
+    };
+
+    namespace detail {
+
+        template <typename T>
+        Task<T> Promise<T>::get_return_object() {
+            return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+        }
+
+        inline Task<void> Promise<void>::get_return_object() {
+            return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+        }
+
+        struct SyncState {
+
+            std::mutex mtx;
+
+            std::condition_variable finished;
+
+            bool done = false;
+
+            std::exception_ptr error;
+
+        };
+
+        template <typename T>
+        Task<void> complete(Task<T>& task, std::optional<T>& result, SyncState& state) {
+            try {
+                result.emplace(co_await task);
+            }
+            catch (...) {
+                state.error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lck(state.mtx);
+            state.done = true;
+            state.finished.notify_all();
+        }
+
+        inline Task<void> complete(Task<void>& task, SyncState& state) {
+            try {
+                co_await task;
+            }
+            catch (...) {
+                state.error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lck(state.mtx);
+            state.done = true;
+            state.finished.notify_all();
+        }
+
+        inline void wait(SyncState& state) {
+            std::unique_lock<std::mutex> lck(state.mtx);
+            state.finished.wait(lck, [&state]() {
+                return state.done;
+            });
+            if (state.error) {
+                std::rethrow_exception(state.error);
+            }
+        }
+
+    }
+
+    /**
+     * Start a coroutine without waiting for it
+     * @param task The coroutine
+     */
+    inline void spawn(Task<void> task) {
+        task.detach();
+    }
+
+    /**
+     * Run a coroutine and block the calling thread until it finishes.
+     * Bridges a coroutine with blocking code, e.g. Sensor::read().
+     * @param task The coroutine
+     * @returns The result of the coroutine
+     * @throws The exception thrown by the coroutine
+     */
+    template <typename T>
+    T sync_wait(Task<T> task) {
+        detail::SyncState state;
+        std::optional<T> result;
+        detail::complete(task, result, state).detach();
+        detail::wait(state);
+        return std::move(*result);
+    }
+
+    inline void sync_wait(Task<void> task) {
+        detail::SyncState state;
+        detail::complete(task, state).detach();
+        detail::wait(state);
+    }
+
+    /**
+     * Awaitable that resumes the coroutine when a Reactor timer expires
+     */
+    class TimerAwaiter {
+
+    public:
+
+        TimerAwaiter(Reactor& reactor, uint64_t delay) : reactor(reactor), delay(delay) {
+
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> awaiter) {
+            // Created disarmed: the handler needs the identifier of the timer
+            timer = reactor.add_timer(0, 0, [this, awaiter](uint64_t) {
+                reactor.remove_timer(timer);
+                awaiter.resume();
+            });
+            // A zero delay would leave the timer disarmed
+            reactor.set_timer(timer, delay > 0 ? delay : 1, 0);
+        }
+
+        void await_resume() const noexcept {
+
+        }
+
+    private:
+
+        Reactor& reactor;
+
+        uint64_t delay;
+
+        int timer = -1;
+
+    };
+
+    /**
+     * Suspend the coroutine for a while
+     * @param reactor The reactor that resumes the coroutine
+     * @param nanos The time to wait in nanoseconds
+     * @returns The awaitable
+     */
+    inline TimerAwaiter sleep_for(Reactor& reactor, uint64_t nanos) {
+        return TimerAwaiter(reactor, nanos);
+    }
+
+    /**
+     * Suspend the coroutine until a point in time
+     * @param reactor The reactor that resumes the coroutine
+     * @param time The time to wake up, in the clock of Timestamp::now()
+     * @returns The awaitable. Resumes right away if the time has passed.
+     */
+    inline TimerAwaiter sleep_until(Reactor& reactor, const Timestamp& time) {
+        uint64_t now = Timestamp::now().to_nanos();
+        return TimerAwaiter(reactor, time.to_nanos() > now ? time.to_nanos() - now : 0);
+    }
+
+    /**
+     * Awaitable that resumes the coroutine when a file descriptor is ready
+     */
+    class FileAwaiter {
+
+    public:
+
+        FileAwaiter(Reactor& reactor, int fd, uint32_t events) : reactor(reactor), fd(fd), events(events) {
+
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> awaiter) {
+            // One shot: the handler is not called again before it unregisters the descriptor
+            reactor.add(fd, events | EPOLLONESHOT, [this, awaiter](uint32_t ready) {
+                reactor.remove(fd);
+                events = ready;
+                awaiter.resume();
+            });
+        }
+
+        /**
+         * @returns The ready epoll events, including EPOLLERR and EPOLLHUP
+         */
+        uint32_t await_resume() const noexcept {
+            return events;
+        }
+
+    private:
+
+        Reactor& reactor;
+
+        int fd;
+
+        uint32_t events;
+
+    };
+
+    /**
+     * Suspend the coroutine until a file descriptor can be read without blocking
+     * @param reactor The reactor that watches the descriptor
+     * @param fd The file descriptor. Must not be registered in the reactor.
+     * @returns The awaitable, which yields the ready events
+     * @throws std::runtime_error If the descriptor cannot be watched
+     */
+    inline FileAwaiter fd_readable(Reactor& reactor, int fd) {
+        return FileAwaiter(reactor, fd, Reactor::READABLE);
+    }
+
+    /**
+     * Suspend the coroutine until a file descriptor can be written without blocking
+     * @param reactor The reactor that watches the descriptor
+     * @param fd The file descriptor. Must not be registered in the reactor.
+     * @returns The awaitable, which yields the ready events
+     * @throws std::runtime_error If the descriptor cannot be watched
+     */
+    inline FileAwaiter fd_writable(Reactor& reactor, int fd) {
+        return FileAwaiter(reactor, fd, Reactor::WRITABLE);
+    }
+
+    /**
+     * Awaitable that resumes the coroutine in a ThreadPool
+     */
+    class PoolAwaiter {
+
+    public:
+
+        explicit PoolAwaiter(ThreadPool& pool) : pool(pool) {
+
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> awaiter) {
+            pool.add_job([awaiter]() {
+                awaiter.resume();
+            });
+        }
+
+        void await_resume() const noexcept {
+
+        }
+
+    private:
+
+        ThreadPool& pool;
+
+    };
+
+    /**
+     * Continue the coroutine in a worker of a ThreadPool, e.g. before a blocking call
+     * @param pool The pool
+     * @returns The awaitable
+     */
+    inline PoolAwaiter schedule_on(ThreadPool& pool) {
+        return PoolAwaiter(pool);
+    }
+
+}
+
+#endif // WITH_COROUTINES
@@ -0,0 +1,100 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Mailbox.h"
+
+#include <stdexcept>
+
+const unsigned int Mailbox::DEFAULT_SAMPLE_RATE;
+
+Mailbox::Mailbox(std::size_t capacity, OverflowPolicy overflow, unsigned int sample_rate) :
+    capacity(capacity), overflow(overflow), sample_rate(sample_rate) {
+    if (sample_rate == 0) {
+        throw std::invalid_argument("The sample rate of a Mailbox must be at least 1");
+    }
+}
+
+PushResult Mailbox::push(Task task) {
+    PushResult result;
+    // Discarded tasks are destroyed after unlocking: they may hold the last reference to a Data
+    std::deque<Task> discarded;
+    {
+        std::unique_lock<std::mutex> lck(mtx);
+        if (full()) {
+            switch (overflow) {
+                case OVERFLOW_BLOCK:
+                    result.waited = true;
+                    space.wait(lck, [this]() -> bool {return !full();});
+                    break;
+                case OVERFLOW_DROP_OLDEST:
+                    discarded.push_back(std::move(tasks.front()));
+                    tasks.pop_front();
+                    break;
+                case OVERFLOW_CONFLATE:
+                    discarded.swap(tasks);
+                    break;
+                case OVERFLOW_SAMPLE:
+                    if (overflows++ % sample_rate != 0) {
+                        result.discarded = 1;
+                        return result;
+                    }
+                    discarded.push_back(std::move(tasks.front()));
+                    tasks.pop_front();
+                    break;
+            }
+        }
+        tasks.push_back(std::move(task));
+    }
+    result.discarded += discarded.size();
+    return result;
+}
+
+bool Mailbox::pop(Task& task) {
+    {
+        std::unique_lock<std::mutex> lck(mtx);
+        if (tasks.empty()) {
+            return false;
+        }
+        task = std::move(tasks.front());
+        tasks.pop_front();
+    }
+    space.notify_one();
+    return true;
+}
+
+std::size_t Mailbox::size() {
+    std::unique_lock<std::mutex> lck(mtx);
+    return tasks.size();
+}
+
+bool Mailbox::empty() {
+    std::unique_lock<std::mutex> lck(mtx);
+    return tasks.empty();
+}
+
+std::size_t Mailbox::get_capacity() const {
+    return capacity;
+}
+
+OverflowPolicy Mailbox::get_overflow() const {
+    return overflow;
+}
+
+bool Mailbox::full() const {
+    return capacity > 0 && tasks.size() >= capacity;
+}
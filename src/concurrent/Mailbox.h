@@ -0,0 +1,156 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+#include "Task.h"
+
+/**
+ * What a bounded Mailbox does with a task pushed while it is full
+ */
+enum OverflowPolicy {
+    // The producer waits until a task is taken out of the mailbox
+    OVERFLOW_BLOCK = 0,
+    // The oldest task is discarded to make room for the new one
+    OVERFLOW_DROP_OLDEST,
+    // Every waiting task is discarded: only the latest one is kept
+    OVERFLOW_CONFLATE,
+    // Only one in sample_rate of the tasks pushed while full is kept, replacing
+    // the oldest one. The others are discarded.
+    OVERFLOW_SAMPLE
+};
+
+/**
+ * \struct PushResult
+ *
+ * \brief What happened to a task pushed to a Mailbox
+ */
+struct PushResult {
+
+    /**
+     * The number of tasks discarded by the push, including the pushed task
+     * if it was not kept
+     */
+    std::size_t discarded = 0;
+
+    /**
+     * Whether the producer had to wait for room (OVERFLOW_BLOCK)
+     */
+    bool waited = false;
+
+};
+
+/**
+ * \class Mailbox
+ *
+ * \brief A thread-safe FIFO of tasks, optionally bounded, that sheds load following an OverflowPolicy
+ *
+ * Used by the Broker to hold the deliveries of a listener until a pool thread
+ * runs them, so a listener that falls behind holds at most `capacity` events
+ * instead of growing without limit.
+ *
+ * With OVERFLOW_BLOCK, push() waits for room: it must not be called by the
+ * thread that consumes the mailbox, or it may wait forever.
+ */
+class Mailbox {
+
+public:
+
+    /**
+     * Constructor
+     * @param capacity The maximum number of tasks waiting, or 0 for an unbounded mailbox
+     * @param overflow What to do with tasks pushed while the mailbox is full
+     * @param sample_rate With OVERFLOW_SAMPLE, keep one in sample_rate of the tasks pushed while full
+     * @throws std::invalid_argument If sample_rate is 0
+     */
+    explicit Mailbox(std::size_t capacity = 0, OverflowPolicy overflow = OVERFLOW_BLOCK, unsigned int sample_rate = DEFAULT_SAMPLE_RATE);
+
+    // Do not allow copy or assignment.
+
+    Mailbox(const Mailbox&) = delete;
+
+    Mailbox& operator=(const Mailbox&) = delete;
+
+    /**
+     * Add a task at the back of the mailbox, applying the overflow policy if it is full
+     * @param task The task
+     * @returns What happened to the task and to the waiting ones
+     */
+    PushResult push(Task task);
+
+    /**
+     * Take the task at the front of the mailbox, if any
+     * @param task Where the task is moved to
+     * @returns Whether a task was taken
+     */
+    bool pop(Task& task);
+
+    /**
+     * Get the number of tasks waiting
+     * @returns The number of tasks in the mailbox
+     */
+    std::size_t size();
+
+    /**
+     * Is the mailbox empty?
+     * @returns Whether there are no tasks waiting
+     */
+    bool empty();
+
+    /**
+     * Get the capacity of the mailbox
+     * @returns The maximum number of tasks waiting, or 0 if unbounded
+     */
+    std::size_t get_capacity() const;
+
+    /**
+     * Get the overflow policy of the mailbox
+     * @returns What is done with tasks pushed while the mailbox is full
+     */
+    OverflowPolicy get_overflow() const;
+
+    /**
+     * Default sample rate of OVERFLOW_SAMPLE: one in ten
+     */
+    static const unsigned int DEFAULT_SAMPLE_RATE = 10;
+
+private:
+
+    bool full() const;
+
+    const std::size_t capacity;
+
+    const OverflowPolicy overflow;
+
+    const unsigned int sample_rate;
+
+    std::mutex mtx;
+
+    std::condition_variable space;
+
+    std::deque<Task> tasks;
+
+    // Tasks pushed while full, to keep one in sample_rate of them
+    unsigned long overflows = 0;
+
+};
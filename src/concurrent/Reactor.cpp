@@ -0,0 +1,294 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Reactor.h"
+#include "Thread.h"
+#include "ThreadPlacement.h"
+#include "../Log.h"
+
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+const uint32_t Reactor::READABLE;
+const uint32_t Reactor::WRITABLE;
+const int Reactor::MAX_EVENTS;
+
+// The wakeup eventfd is registered with this file descriptor number in the event data
+static const int WAKEUP_TAG = -1;
+
+static uint64_t pack(int fd, uint32_t generation) {
+    return ((uint64_t)generation << 32) | (uint32_t)fd;
+}
+
+static struct timespec to_timespec(uint64_t nanos) {
+    struct timespec ts;
+    ts.tv_sec = nanos / 1000000000ULL;
+    ts.tv_nsec = nanos % 1000000000ULL;
+    return ts;
+}
+
+Reactor::Reactor() : stop_requested(false), next_generation(0) {
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        throw std::runtime_error(std::strerror(errno));
+    }
+    wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeup_fd < 0) {
+        int error = errno;
+        ::close(epoll_fd);
+        throw std::runtime_error(std::strerror(error));
+    }
+    struct epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u64 = pack(WAKEUP_TAG, 0);
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fd, &event) < 0) {
+        int error = errno;
+        ::close(wakeup_fd);
+        ::close(epoll_fd);
+        throw std::runtime_error(std::strerror(error));
+    }
+}
+
+Reactor::~Reactor() {
+    ::close(wakeup_fd);
+    ::close(epoll_fd);
+}
+
+void Reactor::add(int fd, uint32_t events, Handler handler) {
+    std::unique_lock<std::mutex> lck(mtx);
+    if (registrations.find(fd) != registrations.end()) {
+        throw std::runtime_error("File descriptor " + std::to_string(fd) + " already registered");
+    }
+    uint32_t generation = next_generation++;
+    struct epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.u64 = pack(fd, generation);
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        throw std::runtime_error(std::strerror(errno));
+    }
+    registrations[fd] = Registration{generation, std::make_shared<Handler>(std::move(handler))};
+}
+
+void Reactor::modify(int fd, uint32_t events) {
+    std::unique_lock<std::mutex> lck(mtx);
+    auto it = registrations.find(fd);
+    if (it == registrations.end()) {
+        throw std::runtime_error("File descriptor " + std::to_string(fd) + " not registered");
+    }
+    struct epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.u64 = pack(fd, it->second.generation);
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event) < 0) {
+        throw std::runtime_error(std::strerror(errno));
+    }
+}
+
+void Reactor::remove(int fd, bool wait) {
+    std::unique_lock<std::mutex> lck(mtx);
+    if (registrations.erase(fd) > 0) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+    // Also when the descriptor was already removed without waiting
+    if (wait) {
+        wait_for_call(lck, fd);
+    }
+}
+
+void Reactor::synchronize() {
+    std::unique_lock<std::mutex> lck(mtx);
+    wait_for_call(lck, calling_fd);
+}
+
+bool Reactor::must_wait(int fd) const {
+    return calling_fd >= 0 && calling_fd == fd && calling_thread != std::this_thread::get_id();
+}
+
+void Reactor::wait_for_call(std::unique_lock<std::mutex>& lck, int fd) {
+    if (!must_wait(fd)) {
+        return;
+    }
+    uint64_t call = calls;
+    call_done.wait(lck, [this, call]() -> bool {return calls != call || calling_fd < 0;});
+}
+
+int Reactor::add_timer(uint64_t delay, uint64_t period, TimerHandler handler) {
+    int timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer < 0) {
+        throw std::runtime_error(std::strerror(errno));
+    }
+    try {
+        set_timer(timer, delay, period);
+        add(timer, READABLE, [timer, handler](uint32_t) {
+            uint64_t expirations = 0;
+            if (::read(timer, &expirations, sizeof(expirations)) == sizeof(expirations) && expirations > 0) {
+                handler(expirations);
+            }
+        });
+    }
+    catch (std::runtime_error&) {
+        ::close(timer);
+        throw;
+    }
+    return timer;
+}
+
+void Reactor::set_timer(int timer, uint64_t delay, uint64_t period) {
+    struct itimerspec spec;
+    spec.it_value = to_timespec(delay);
+    spec.it_interval = to_timespec(period);
+    if (timerfd_settime(timer, 0, &spec, nullptr) < 0) {
+        throw std::runtime_error(std::strerror(errno));
+    }
+}
+
+void Reactor::remove_timer(int timer) {
+    remove(timer);
+    ::close(timer);
+}
+
+std::size_t Reactor::run_once(int timeout_millis) {
+    struct epoll_event events[MAX_EVENTS];
+    int ready = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout_millis);
+    if (ready < 0) {
+        if (errno == EINTR) {
+            return 0;
+        }
+        throw std::runtime_error(std::strerror(errno));
+    }
+    std::size_t called = 0;
+    for (int i = 0; i < ready; ++i) {
+        int fd = (int)(uint32_t)events[i].data.u64;
+        uint32_t generation = (uint32_t)(events[i].data.u64 >> 32);
+        if (fd == WAKEUP_TAG) {
+            drain_wakeup();
+            continue;
+        }
+        std::shared_ptr<Handler> handler;
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            auto it = registrations.find(fd);
+            if (it == registrations.end() || it->second.generation != generation) {
+                // Removed by a previous handler of this batch, or by another thread
+                continue;
+            }
+            handler = it->second.handler;
+            // Marked in the same critical section as the lookup, so a remove()
+            // either prevents the call or sees it in progress
+            calling_fd = fd;
+            calling_thread = std::this_thread::get_id();
+            ++calls;
+        }
+        try {
+            (*handler)(events[i].events);
+        }
+        catch (...) {
+            end_call();
+            throw;
+        }
+        end_call();
+        ++called;
+    }
+    return called;
+}
+
+void Reactor::end_call() {
+    {
+        std::unique_lock<std::mutex> lck(mtx);
+        calling_fd = -1;
+    }
+    call_done.notify_all();
+}
+
+void Reactor::run() {
+    while (!stop_requested.exchange(false)) {
+        run_once(-1);
+    }
+}
+
+void Reactor::stop() {
+    stop_requested = true;
+    wakeup();
+}
+
+void Reactor::wakeup() {
+    uint64_t one = 1;
+    if (::write(wakeup_fd, &one, sizeof(one)) < 0) {
+        // The counter is already non-zero: a wakeup is pending
+    }
+}
+
+void Reactor::drain_wakeup() {
+    uint64_t count;
+    if (::read(wakeup_fd, &count, sizeof(count)) < 0) {
+        // Nothing to drain
+    }
+}
+
+std::size_t Reactor::size() {
+    std::unique_lock<std::mutex> lck(mtx);
+    return registrations.size();
+}
+
+namespace {
+
+    struct SharedReactor {
+
+        SharedReactor() : running(true) {
+            thread = Thread(&SharedReactor::run, this);
+            ThreadPlacement::apply(thread, ROLE_IO, "reactor");
+        }
+
+        ~SharedReactor() {
+            running = false;
+            reactor.wakeup();
+            thread.join();
+        }
+
+        void run() {
+            ThreadPlacement::prepare_current(ROLE_IO);
+            while (running) {
+                try {
+                    reactor.run_once(-1);
+                }
+                catch (std::exception& e) {
+                    RTDATA_LOG(WARNING) << "[reactor] Handler failed: " << e.what();
+                }
+            }
+        }
+
+        Reactor reactor;
+
+        std::atomic<bool> running;
+
+        Thread thread;
+
+    };
+
+}
+
+Reactor& Reactor::get_shared() {
+    static SharedReactor shared;
+    return shared.reactor;
+}
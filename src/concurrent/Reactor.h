@@ -0,0 +1,237 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
+#include <sys/epoll.h>
+
+/**
+ * \class Reactor
+ *
+ * \brief An epoll event loop that calls a handler when a file descriptor is ready
+ *
+ * File descriptors are registered with add() together with the events of
+ * interest (READABLE, WRITABLE) and a handler. run_once() waits for ready
+ * descriptors and calls their handlers in the calling thread; run() does it
+ * until stop() is called. Errors and hang-ups (EPOLLERR, EPOLLHUP) are always
+ * reported to the handler. Descriptors are level-triggered.
+ *
+ * Timers (add_timer()) are timerfds watched like any other descriptor, so a
+ * single thread can serve periodic work and I/O without extra wakeups.
+ *
+ * add(), modify(), remove(), the timer methods, stop() and wakeup() can be
+ * called from any thread, including from a handler. Called from another
+ * thread, remove() and remove_timer() wait for a call in progress to the
+ * removed handler, so its captures can be destroyed once they return.
+ *
+ * get_shared() returns a reactor run by a background thread, for components
+ * that do non-blocking I/O (see Serial::attach(), TCPWriter::attach(),
+ * HTTPWriter::attach() and Sensor::attach()). Its handlers must be short and must not block,
+ * since they delay every other component.
+ */
+class Reactor {
+
+public:
+
+    /**
+     * The handler of a file descriptor. Receives the ready epoll events.
+     */
+    typedef std::function<void(uint32_t)> Handler;
+
+    /**
+     * The handler of a timer. Receives the number of expirations since the last call,
+     * more than 1 if the reactor fell behind.
+     */
+    typedef std::function<void(uint64_t)> TimerHandler;
+
+    /**
+     * The file descriptor can be read without blocking
+     */
+    static const uint32_t READABLE = EPOLLIN;
+
+    /**
+     * The file descriptor can be written without blocking
+     */
+    static const uint32_t WRITABLE = EPOLLOUT;
+
+    /**
+     * Constructor
+     * @throws std::runtime_error If the epoll instance cannot be created
+     */
+    Reactor();
+
+    /**
+     * Destructor. Does not close the registered file descriptors.
+     */
+    ~Reactor();
+
+    // Do not allow copy or assignment.
+
+    Reactor(const Reactor&) = delete;
+
+    Reactor& operator=(const Reactor&) = delete;
+
+    /**
+     * Register a file descriptor
+     * @param fd The file descriptor, preferably non-blocking
+     * @param events The events of interest (READABLE and/or WRITABLE)
+     * @param handler Called with the ready events when the file descriptor is ready
+     * @throws std::runtime_error If the file descriptor cannot be registered
+     */
+    void add(int fd, uint32_t events, Handler handler);
+
+    /**
+     * Change the events of interest of a registered file descriptor
+     * @param fd The file descriptor
+     * @param events The new events of interest
+     * @throws std::runtime_error If the file descriptor is not registered
+     */
+    void modify(int fd, uint32_t events);
+
+    /**
+     * Unregister a file descriptor. Must be called before closing it.
+     * Its handler is not called anymore, even for events already returned by the
+     * current wait. If the handler is running in another thread, waits for it to
+     * return, unless wait is false: a caller holding a lock that the handler takes
+     * must not wait, and must call remove() or synchronize() again without the lock
+     * before destroying what the handler uses.
+     * @param fd The file descriptor
+     * @param wait Whether to wait for a call in progress to the handler
+     */
+    void remove(int fd, bool wait = true);
+
+    /**
+     * Create a timer
+     * @param delay Nanoseconds until the first expiration, 0 to create it disarmed
+     * @param period Nanoseconds between the next expirations, 0 for a one-shot timer
+     * @param handler Called in the reactor thread when the timer expires
+     * @returns The identifier of the timer
+     * @throws std::runtime_error If the timer cannot be created
+     */
+    int add_timer(uint64_t delay, uint64_t period, TimerHandler handler);
+
+    /**
+     * Re-arm or disarm a timer. Pending expirations are discarded.
+     * @param timer The identifier returned by add_timer()
+     * @param delay Nanoseconds until the next expiration, 0 to disarm it
+     * @param period Nanoseconds between the next expirations, 0 for a one-shot timer
+     * @throws std::runtime_error If the timer cannot be set
+     */
+    void set_timer(int timer, uint64_t delay, uint64_t period);
+
+    /**
+     * Destroy a timer. Its handler is not called anymore: if it is running in
+     * another thread, waits for it to return.
+     * @param timer The identifier returned by add_timer()
+     */
+    void remove_timer(int timer);
+
+    /**
+     * Wait for the handler running in another thread, if any, to return. After it,
+     * the handlers removed before the call are not running and will not be called.
+     * Returns immediately when called from a handler.
+     */
+    void synchronize();
+
+    /**
+     * Wait for ready file descriptors and call their handlers
+     * @param timeout_millis The maximum time to wait in milliseconds, -1 to wait forever
+     * @returns The number of handlers called
+     */
+    std::size_t run_once(int timeout_millis);
+
+    /**
+     * Call the handlers of the ready file descriptors until stop() is called
+     */
+    void run();
+
+    /**
+     * Make run() return after the current handlers. If run() is not running,
+     * the next call returns immediately.
+     */
+    void stop();
+
+    /**
+     * Interrupt the current wait of run_once()
+     */
+    void wakeup();
+
+    /**
+     * Get the number of registered file descriptors
+     * @returns The number of registered file descriptors
+     */
+    std::size_t size();
+
+    /**
+     * Get the process-wide reactor. It is created on the first call and run
+     * by a background thread (with the ROLE_IO placement) until the program exits.
+     * @returns The shared reactor
+     */
+    static Reactor& get_shared();
+
+private:
+
+    struct Registration {
+        uint32_t generation;
+        std::shared_ptr<Handler> handler;
+    };
+
+    // Maximum number of events returned by a single wait
+    static const int MAX_EVENTS = 64;
+
+    void drain_wakeup();
+
+    // Whether the caller must wait for the handler in progress. Called with the lock held.
+    bool must_wait(int fd) const;
+
+    void wait_for_call(std::unique_lock<std::mutex>& lck, int fd);
+
+    void end_call();
+
+    int epoll_fd;
+
+    int wakeup_fd;
+
+    std::atomic<bool> stop_requested;
+
+    std::mutex mtx;
+
+    std::unordered_map<int, Registration> registrations;
+
+    // Tells apart a descriptor that was removed and reused during a wait
+    uint32_t next_generation;
+
+    // The handler in progress: its file descriptor (-1 if none), the thread that
+    // calls it and the number of calls started, to tell consecutive calls apart
+    int calling_fd = -1;
+
+    std::thread::id calling_thread;
+
+    uint64_t calls = 0;
+
+    std::condition_variable call_done;
+
+};
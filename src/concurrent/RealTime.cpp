@@ -0,0 +1,162 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RealTime.h"
+#include "ThreadPlacement.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <atomic>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <malloc.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static std::atomic<std::size_t> stack_prefault_size(0);
+
+void RealTime::lock_memory(std::size_t heap_size) {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+        throw std::runtime_error(std::string("Cannot lock the process memory: ") + std::strerror(errno));
+    }
+    // Keep freed memory in the heap (no trimming) and serve big allocations
+    // from the heap instead of fresh mmaps, which would fault again
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+    if (heap_size > 0) {
+        char* heap = (char*)std::malloc(heap_size);
+        if (heap == NULL) {
+            throw std::runtime_error("Cannot prefault the heap: out of memory");
+        }
+        long page_size = sysconf(_SC_PAGESIZE);
+        for (std::size_t i = 0; i < heap_size; i += page_size) {
+            ((volatile char*)heap)[i] = 0;
+        }
+        std::free(heap);
+    }
+}
+
+void RealTime::prefault_stack(std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+    volatile char* stack = (volatile char*)alloca(size);
+    long page_size = sysconf(_SC_PAGESIZE);
+    for (std::size_t i = 0; i < size; i += page_size) {
+        stack[i] = 0;
+    }
+}
+
+std::size_t RealTime::get_stack_prefault_size() {
+    return stack_prefault_size;
+}
+
+void RealTime::set_stack_prefault_size(std::size_t size) {
+    stack_prefault_size = size;
+}
+
+void RealTime::setup(Configuration& config) {
+    Configuration& stack = config["prefault_stack"];
+    if (!stack.is_null()) {
+        set_stack_prefault_size(stack.get<uint64_t>());
+    }
+    Configuration& lock = config["lock_memory"];
+    if (!lock.is_null() && lock.get<bool>()) {
+        Configuration& heap = config["prefault_heap"];
+        lock_memory(heap.is_null() ? 0 : heap.get<uint64_t>());
+    }
+    Configuration& isolate = config["isolate_sensors"];
+    if (!isolate.is_null() && isolate.get<bool>()) {
+        ThreadPlacement::isolate_sensors();
+    }
+    Configuration& placement = config["placement"];
+    if (!placement.is_null()) {
+        ThreadPlacement::configure(placement);
+    }
+}
+
+std::vector<int> RealTime::parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::size_t pos = 0;
+    while (pos < list.size()) {
+        std::size_t end = list.find(',', pos);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        std::string range = list.substr(pos, end - pos);
+        pos = end + 1;
+        // Trailing new lines in sysfs files
+        while (!range.empty() && (range.back() == '\n' || range.back() == ' ')) {
+            range.pop_back();
+        }
+        if (range.empty()) {
+            continue;
+        }
+        try {
+            std::size_t dash = range.find('-');
+            std::size_t parsed = 0;
+            int first = std::stoi(range, &parsed);
+            int last = first;
+            if (dash != std::string::npos) {
+                if (parsed != dash) {
+                    throw std::invalid_argument(range);
+                }
+                last = std::stoi(range.substr(dash + 1), &parsed);
+                if (parsed != range.size() - dash - 1) {
+                    throw std::invalid_argument(range);
+                }
+            }
+            else if (parsed != range.size()) {
+                throw std::invalid_argument(range);
+            }
+            if (first < 0 || last < first) {
+                throw std::invalid_argument(range);
+            }
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+        catch (const std::logic_error&) {
+            throw std::invalid_argument("Invalid CPU list: " + list);
+        }
+    }
+    return cpus;
+}
+
+std::vector<int> RealTime::get_isolated_cpus() {
+    return read_cpu_list("/sys/devices/system/cpu/isolated");
+}
+
+std::vector<int> RealTime::get_online_cpus() {
+    return read_cpu_list("/sys/devices/system/cpu/online");
+}
+
+std::vector<int> RealTime::get_numa_node_cpus(int node) {
+    return read_cpu_list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+}
+
+std::vector<int> RealTime::read_cpu_list(const std::string& file) {
+    std::ifstream in(file);
+    if (in.fail()) {
+        return std::vector<int>();
+    }
+    std::string list;
+    std::getline(in, list);
+    return parse_cpu_list(list);
+}
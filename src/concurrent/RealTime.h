@@ -0,0 +1,113 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "../utils/Configuration.h"
+
+/**
+ * \class RealTime
+ *
+ * \brief Process-level setup for real-time execution
+ *
+ * Page faults are one of the main sources of latency spikes in real-time threads.
+ * lock_memory() locks all the current and future pages of the process in RAM and
+ * prefaults a chunk of heap, so later allocations reuse already mapped pages.
+ * Each real-time thread should also call prefault_stack() when it starts.
+ *
+ * It also offers helpers to query the CPU topology (isolated CPUs, NUMA nodes).
+ */
+class RealTime {
+
+public:
+
+    RealTime() = delete;
+
+    /**
+     * Lock the process memory and prefault the heap
+     * @param heap_size Bytes of heap to allocate, touch and release back to the allocator (optional, default = 0)
+     * @throws std::runtime_error If the memory cannot be locked (e.g. not enough privileges or RLIMIT_MEMLOCK)
+     */
+    static void lock_memory(std::size_t heap_size = 0);
+
+    /**
+     * Touch the stack of the calling thread so its pages are mapped before they are needed
+     * @param size The bytes of stack to touch
+     */
+    static void prefault_stack(std::size_t size);
+
+    /**
+     * Get the stack size to prefault in real-time threads
+     * @returns The bytes of stack prefaulted by ThreadPlacement when a thread is placed
+     */
+    static std::size_t get_stack_prefault_size();
+
+    /**
+     * Set the stack size to prefault in real-time threads
+     * @param size The bytes of stack to prefault. 0 disables the prefault.
+     */
+    static void set_stack_prefault_size(std::size_t size);
+
+    /**
+     * Set up the process from a configuration. Recognized properties (all optional):
+     *  - lock_memory (bool): lock the process memory
+     *  - prefault_heap (unsigned): bytes of heap to prefault when locking the memory
+     *  - prefault_stack (unsigned): bytes of stack to prefault in each real-time thread
+     *  - isolate_sensors (bool): see ThreadPlacement::isolate_sensors()
+     *  - placement (object): per-role thread placements, see ThreadPlacement::configure()
+     * @param config The configuration node
+     * @throws std::runtime_error If the memory cannot be locked
+     */
+    static void setup(Configuration& config);
+
+    /**
+     * Parse a CPU list in the kernel format, e.g. "0-3,6,8-9"
+     * @param list The CPU list
+     * @returns The CPUs in the list
+     * @throws std::invalid_argument If the list is malformed
+     */
+    static std::vector<int> parse_cpu_list(const std::string& list);
+
+    /**
+     * Get the CPUs isolated from the scheduler (isolcpus kernel parameter)
+     * @returns The isolated CPUs, empty if there are none
+     */
+    static std::vector<int> get_isolated_cpus();
+
+    /**
+     * Get the online CPUs
+     * @returns The online CPUs
+     */
+    static std::vector<int> get_online_cpus();
+
+    /**
+     * Get the CPUs of a NUMA node
+     * @param node The NUMA node
+     * @returns The CPUs of the node, empty if the node does not exist
+     */
+    static std::vector<int> get_numa_node_cpus(int node);
+
+private:
+
+    static std::vector<int> read_cpu_list(const std::string& file);
+
+};
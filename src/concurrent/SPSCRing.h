@@ -0,0 +1,104 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * A bounded, lock-free, single-producer single-consumer ring buffer.
+ * One thread may push and one (other) thread may pop concurrently, without locks
+ * nor allocations. The capacity must be a power of two.
+ */
+template <typename T, std::size_t Capacity>
+class SPSCRing {
+
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SPSCRing capacity must be a power of two");
+
+public:
+
+    /**
+     * Default constructor. Builds an empty ring.
+     */
+    SPSCRing() : head(0), tail(0) {
+
+    }
+
+    //Do not allow copy or assignment.
+
+    SPSCRing(const SPSCRing&) = delete;
+
+    SPSCRing& operator=(const SPSCRing&) = delete;
+
+    /**
+     * Copy an item to the back of the ring. Only called by the producer.
+     * @param item The item to add
+     * @returns Whether the item was added. False if the ring is full.
+     */
+    bool try_push(const T& item) {
+        std::size_t current_tail = tail.load(std::memory_order_relaxed);
+        if (current_tail - head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        items[current_tail & (Capacity - 1)] = item;
+        tail.store(current_tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Copy and remove the item at the front of the ring. Only called by the consumer.
+     * @param item Where the item is copied to
+     * @returns Whether an item was removed. False if the ring is empty.
+     */
+    bool try_pop(T& item) {
+        std::size_t current_head = head.load(std::memory_order_relaxed);
+        if (current_head == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[current_head & (Capacity - 1)];
+        head.store(current_head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Is the ring empty?
+     * @returns Whether the ring is empty or not. Only exact when called by the consumer.
+     */
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Get the capacity of the ring
+     * @returns The maximum number of items in the ring
+     */
+    static constexpr std::size_t capacity() {
+        return Capacity;
+    }
+
+private:
+
+    // Each index in its own cache line to avoid false sharing between producer and consumer
+    alignas(64) std::atomic<std::size_t> head;
+
+    alignas(64) std::atomic<std::size_t> tail;
+
+    alignas(64) T items[Capacity];
+
+};
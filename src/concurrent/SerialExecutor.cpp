@@ -0,0 +1,75 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SerialExecutor.h"
+
+const int SerialExecutor::BATCH_SIZE;
+
+PushResult SerialExecutor::submit(Task task) {
+    PushResult result = mailbox.push(std::move(task));
+    {
+        std::unique_lock<std::mutex> lck(mtx);
+        if (scheduled) {
+            return result;
+        }
+        scheduled = true;
+    }
+    schedule();
+    return result;
+}
+
+std::size_t SerialExecutor::pending() {
+    return mailbox.size();
+}
+
+void SerialExecutor::schedule() {
+    std::shared_ptr<SerialExecutor> self = shared_from_this();
+    pool.add_job([self]() {
+        self->drain();
+    }, priority);
+}
+
+bool SerialExecutor::idle() {
+    // A task pushed before the check is seen here; one pushed after
+    // finds scheduled false and schedules the executor again
+    std::unique_lock<std::mutex> lck(mtx);
+    if (!mailbox.empty()) {
+        return false;
+    }
+    scheduled = false;
+    return true;
+}
+
+void SerialExecutor::drain() {
+    Task task;
+    for (int i = 0; i < BATCH_SIZE; ++i) {
+        if (!mailbox.pop(task)) {
+            if (idle()) {
+                return;
+            }
+            continue;
+        }
+        task();
+        task = Task();
+    }
+    if (idle()) {
+        return;
+    }
+    // Still busy: queue again behind the other jobs of the pool
+    schedule();
+}
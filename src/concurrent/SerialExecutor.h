@@ -0,0 +1,106 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+#include "ThreadPool.h"
+#include "Mailbox.h"
+#include "Task.h"
+
+/**
+ * \class SerialExecutor
+ *
+ * \brief Runs tasks in a ThreadPool one at a time, in submission order
+ *
+ * The tasks wait in a mailbox. While it is not empty, a single pool job runs
+ * them in order, so they never run concurrently, and it gives the worker back
+ * after BATCH_SIZE tasks so a busy executor does not starve the others.
+ * Executors sharing a pool run in parallel. A bounded mailbox sheds tasks
+ * following its OverflowPolicy when the executor falls behind.
+ *
+ * Must be owned by a std::shared_ptr: the pool job keeps it alive.
+ */
+class SerialExecutor : public std::enable_shared_from_this<SerialExecutor> {
+
+public:
+
+    /**
+     * Constructor
+     * @param pool The pool that runs the tasks. Must outlive the executor.
+     * @param priority The lane of the pool where the tasks run
+     * @param capacity The maximum number of tasks waiting in the mailbox, or 0 for no limit
+     * @param overflow What to do with tasks submitted while the mailbox is full
+     * @param sample_rate With OVERFLOW_SAMPLE, keep one in sample_rate of the tasks submitted while full
+     * @throws std::invalid_argument If sample_rate is 0
+     */
+    explicit SerialExecutor(ThreadPool& pool, JobPriority priority = PRIORITY_NORMAL, std::size_t capacity = 0,
+        OverflowPolicy overflow = OVERFLOW_BLOCK, unsigned int sample_rate = Mailbox::DEFAULT_SAMPLE_RATE) :
+        pool(pool), priority(priority), mailbox(capacity, overflow, sample_rate) {
+
+    }
+
+    // Do not allow copy or assignment.
+
+    SerialExecutor(const SerialExecutor&) = delete;
+
+    SerialExecutor& operator=(const SerialExecutor&) = delete;
+
+    /**
+     * Queue a task. It runs after the tasks submitted before it.
+     * With OVERFLOW_BLOCK, waits while the mailbox is full: a task run by
+     * this executor must not submit to it.
+     * @param task The task
+     * @returns What happened to the task and to the waiting ones
+     */
+    PushResult submit(Task task);
+
+    /**
+     * Get the number of tasks waiting in the mailbox
+     * @returns The number of tasks not started yet
+     */
+    std::size_t pending();
+
+    /**
+     * Maximum number of tasks run by a pool job before it is queued again
+     */
+    static const int BATCH_SIZE = 16;
+
+private:
+
+    void schedule();
+
+    void drain();
+
+    bool idle();
+
+    ThreadPool& pool;
+
+    JobPriority priority;
+
+    Mailbox mailbox;
+
+    // Guards scheduled
+    std::mutex mtx;
+
+    // Whether a pool job is queued or running for this executor
+    bool scheduled = false;
+
+};
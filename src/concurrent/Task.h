@@ -0,0 +1,189 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * \class Task
+ *
+ * \brief A move-only `void()` callable with inline storage, used for ThreadPool jobs
+ *
+ * Unlike std::function, a Task is never copied and stores callables of up to
+ * INLINE_SIZE bytes (e.g. a lambda capturing a few shared_ptr and a std::string)
+ * in place, so queuing a job does not allocate. Larger callables, or callables
+ * that may throw when moved, are stored on the heap.
+ */
+class Task {
+
+public:
+
+    /**
+     * Bytes of inline storage. sizeof(Task) is 128, two cache lines.
+     */
+    static const std::size_t INLINE_SIZE = 112;
+
+    /**
+     * Build an empty Task
+     */
+    Task() noexcept : ops(nullptr) {
+
+    }
+
+    /**
+     * Build a Task from a callable
+     * @param function The callable, moved or copied into the Task
+     */
+    template <typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, Task>::value>::type>
+    Task(F&& function) {
+        typedef typename std::decay<F>::type Function;
+        if constexpr (fits_inline<Function>()) {
+            new (storage) Function(std::forward<F>(function));
+            ops = &InlineOps<Function>::ops;
+        }
+        else {
+            new (storage) Function*(new Function(std::forward<F>(function)));
+            ops = &HeapOps<Function>::ops;
+        }
+    }
+
+    Task(Task&& other) noexcept : ops(other.ops) {
+        if (ops != nullptr) {
+            ops->move(storage, other.storage);
+            other.ops = nullptr;
+        }
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            ops = other.ops;
+            if (ops != nullptr) {
+                ops->move(storage, other.storage);
+                other.ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    ~Task() {
+        reset();
+    }
+
+    // Do not allow copy or assignment.
+
+    Task(const Task&) = delete;
+
+    Task& operator=(const Task&) = delete;
+
+    /**
+     * Call the callable
+     */
+    void operator()() {
+        ops->invoke(storage);
+    }
+
+    /**
+     * Does the Task hold a callable?
+     * @returns Whether the Task is not empty
+     */
+    explicit operator bool() const noexcept {
+        return ops != nullptr;
+    }
+
+    /**
+     * Would a callable be stored inline?
+     * @returns Whether a callable of type F is stored without allocating
+     */
+    template <typename F>
+    static constexpr bool fits_inline() {
+        return sizeof(F) <= INLINE_SIZE && alignof(F) <= alignof(std::max_align_t) &&
+            std::is_nothrow_move_constructible<F>::value;
+    }
+
+private:
+
+    struct Ops {
+        void (*invoke)(void*);
+        // Move-construct into the destination and destroy the source
+        void (*move)(void*, void*);
+        void (*destroy)(void*);
+    };
+
+    template <typename F>
+    struct InlineOps {
+
+        static void invoke(void* storage) {
+            (*static_cast<F*>(storage))();
+        }
+
+        static void move(void* destination, void* source) {
+            F* function = static_cast<F*>(source);
+            new (destination) F(std::move(*function));
+            function->~F();
+        }
+
+        static void destroy(void* storage) {
+            static_cast<F*>(storage)->~F();
+        }
+
+        static const Ops ops;
+
+    };
+
+    template <typename F>
+    struct HeapOps {
+
+        static void invoke(void* storage) {
+            (**static_cast<F**>(storage))();
+        }
+
+        static void move(void* destination, void* source) {
+            *static_cast<F**>(destination) = *static_cast<F**>(source);
+        }
+
+        static void destroy(void* storage) {
+            delete *static_cast<F**>(storage);
+        }
+
+        static const Ops ops;
+
+    };
+
+    void reset() noexcept {
+        if (ops != nullptr) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+
+    const Ops* ops;
+
+};
+
+template <typename F>
+const Task::Ops Task::InlineOps<F>::ops = { &Task::InlineOps<F>::invoke, &Task::InlineOps<F>::move, &Task::InlineOps<F>::destroy };
+
+template <typename F>
+const Task::Ops Task::HeapOps<F>::ops = { &Task::HeapOps<F>::invoke, &Task::HeapOps<F>::move, &Task::HeapOps<F>::destroy };
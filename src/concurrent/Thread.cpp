@@ -17,8 +17,78 @@
 */
 
 #include "Thread.h"
+#include "RealTime.h"
 
-int Thread::convert_policy(SchedulingPolicy policy) {
+#include <unistd.h>
+#include <sys/syscall.h>
+
+static void set_thread_affinity(pthread_t thread, const std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (cpus.empty()) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    for (int cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) {
+            throw std::runtime_error("Invalid CPU " + std::to_string(cpu));
+        }
+        CPU_SET(cpu, &set);
+    }
+    int ret = pthread_setaffinity_np(thread, sizeof(set), &set);
+    if (ret) {
+        throw std::runtime_error(std::strerror(ret));
+    }
+}
+
+static std::vector<int> get_thread_affinity(pthread_t thread) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    int ret = pthread_getaffinity_np(thread, sizeof(set), &set);
+    if (ret) {
+        throw std::runtime_error(std::strerror(ret));
+    }
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+
+// Layout of the kernel's struct sched_attr (SCHED_ATTR_SIZE_VER0)
+// Not every libc declares it, so it is defined here under another name
+struct deadline_sched_attr {
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+};
+
+static SchedulingPolicy convert_sched_policy(int policy) {
+    switch (policy) {
+        case SCHED_FIFO:
+            return RT_FIFO;
+        case SCHED_RR:
+            return RT_ROUND_ROBIN;
+        case SCHED_DEADLINE:
+            return RT_DEADLINE;
+        default:
+            return DEFAULT;
+    }
+}
+
+static int convert_policy(SchedulingPolicy policy) {
     int sched_policy;
     switch (policy) {
         case DEFAULT:
@@ -30,6 +100,9 @@ int Thread::convert_policy(SchedulingPolicy policy) {
         case RT_ROUND_ROBIN:
             sched_policy = SCHED_RR;
             break;
+        case RT_DEADLINE:
+            sched_policy = SCHED_DEADLINE;
+            break;
         default:
             sched_policy = SCHED_OTHER;
             break;
@@ -38,6 +111,9 @@ int Thread::convert_policy(SchedulingPolicy policy) {
 }
 
 void Thread::set_scheduling_policy(SchedulingPolicy policy, int priority) {
+    if (policy == RT_DEADLINE) {
+        throw std::invalid_argument("RT_DEADLINE must be set with this_thread::set_deadline_scheduling");
+    }
     int sched_policy = convert_policy(policy);
     sched_param params;
     params.sched_priority = priority; // Ignored if policy is not RT Round Robin or FIFO
@@ -54,7 +130,7 @@ SchedulingPolicy Thread::get_current_scheduling_policy() {
     if (ret) {
         throw std::runtime_error(std::strerror(errno));
     }
-    return (SchedulingPolicy)policy;
+    return convert_sched_policy(policy);
 }
 
 int Thread::get_current_priority() {
@@ -67,6 +143,22 @@ int Thread::get_current_priority() {
     return params.sched_priority;
 }
 
+void Thread::set_affinity(const std::vector<int>& cpus) {
+    set_thread_affinity(this->native_handle(), cpus);
+}
+
+std::vector<int> Thread::get_affinity() {
+    return get_thread_affinity(this->native_handle());
+}
+
+void Thread::set_numa_node(int node) {
+    std::vector<int> cpus = RealTime::get_numa_node_cpus(node);
+    if (cpus.empty()) {
+        throw std::runtime_error("NUMA node " + std::to_string(node) + " has no CPUs");
+    }
+    set_affinity(cpus);
+}
+
 int Thread::get_min_scheduling_priority(SchedulingPolicy policy) {
     int sched_policy = convert_policy(policy);
     return sched_get_priority_min(sched_policy);
@@ -85,7 +177,7 @@ SchedulingPolicy this_thread::get_current_scheduling_policy() {
     if (ret) {
         throw std::runtime_error(std::strerror(errno));
     }
-    return (SchedulingPolicy)policy;
+    return convert_sched_policy(policy);
 }
 
 int this_thread::get_current_priority() {
@@ -97,4 +189,41 @@ int this_thread::get_current_priority() {
         throw std::runtime_error(std::strerror(errno));
     }
     return params.sched_priority;
-}
\ No newline at end of file
+}
+
+void this_thread::set_scheduling_policy(SchedulingPolicy policy, int priority) {
+    if (policy == RT_DEADLINE) {
+        throw std::invalid_argument("RT_DEADLINE must be set with this_thread::set_deadline_scheduling");
+    }
+    int sched_policy = convert_policy(policy);
+    sched_param params;
+    params.sched_priority = priority;
+    int ret = pthread_setschedparam(pthread_self(), sched_policy, &params);
+    if (ret) {
+        throw std::runtime_error(std::strerror(ret));
+    }
+}
+
+void this_thread::set_deadline_scheduling(uint64_t runtime, uint64_t deadline, uint64_t period) {
+    if (runtime == 0 || runtime > deadline || deadline > period) {
+        throw std::invalid_argument("SCHED_DEADLINE requires 0 < runtime <= deadline <= period");
+    }
+    deadline_sched_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.sched_policy = SCHED_DEADLINE;
+    attr.sched_runtime = runtime;
+    attr.sched_deadline = deadline;
+    attr.sched_period = period;
+    if (syscall(SYS_sched_setattr, 0, &attr, 0) < 0) {
+        throw std::system_error(errno, std::system_category(), "sched_setattr");
+    }
+}
+
+void this_thread::set_affinity(const std::vector<int>& cpus) {
+    set_thread_affinity(pthread_self(), cpus);
+}
+
+std::vector<int> this_thread::get_affinity() {
+    return get_thread_affinity(pthread_self());
+}
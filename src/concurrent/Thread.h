@@ -23,12 +23,15 @@
 #include <sched.h>
 #include <pthread.h>
 #include <cstring>
+#include <vector>
+#include <cstdint>
+#include <system_error>
 
 /**
  * Scheduling policies
- * RT_FIFO and RT_ROUND_ROBIN are real-time schedulings
+ * RT_FIFO, RT_ROUND_ROBIN and RT_DEADLINE are real-time schedulings
  * Any real-time thread has more priority than non-real-time threads
- * A real-time thread is the one that has a real-time scheduling (RT_FIFO or RT_ROUND_ROBIN)
+ * A real-time thread is the one that has a real-time scheduling (RT_FIFO, RT_ROUND_ROBIN or RT_DEADLINE)
  */
 enum SchedulingPolicy {
     DEFAULT = 0,
@@ -36,7 +39,10 @@ enum SchedulingPolicy {
     // scheduling policy based on a queue
     RT_FIFO,
     // Real-time Round-robin
-    RT_ROUND_ROBIN
+    RT_ROUND_ROBIN,
+    // Real-time earliest deadline first (Linux SCHED_DEADLINE).
+    // Has no priority: see this_thread::set_deadline_scheduling
+    RT_DEADLINE
 };
 
 /**
@@ -54,6 +60,7 @@ public:
      * The priority in non-real-time threads is ignored
      * @param policy The SchedulingPolicy for this thread
      * @param priority The priority for this thread between 0 (min priority) and 99 (max priority)
+     * @throws std::invalid_argument If policy is RT_DEADLINE, which needs this_thread::set_deadline_scheduling
      */
     void set_scheduling_policy(SchedulingPolicy policy, int priority);
 
@@ -69,6 +76,26 @@ public:
      */
     int get_current_priority();
 
+    /**
+     * Pin the thread to a set of CPUs
+     * @param cpus The CPUs where the thread is allowed to run. If empty, any CPU.
+     * @throws std::runtime_error If the affinity cannot be set (e.g. a CPU does not exist)
+     */
+    void set_affinity(const std::vector<int>& cpus);
+
+    /**
+     * Get the CPUs where the thread is allowed to run
+     * @returns The CPUs of the affinity mask of the thread
+     */
+    std::vector<int> get_affinity();
+
+    /**
+     * Pin the thread to the CPUs of a NUMA node
+     * @param node The NUMA node
+     * @throws std::runtime_error If the node does not exist or the affinity cannot be set
+     */
+    void set_numa_node(int node);
+
     /**
      * Get the minimum priority for a given SchedulingPolicy
      * @param policy A SchedulingPolicy
@@ -83,10 +110,6 @@ public:
      */
     static int get_max_scheduling_priority(SchedulingPolicy policy);
 
-private:
-
-    static int convert_policy(SchedulingPolicy policy);
-
 };
 
 /**
@@ -107,4 +130,41 @@ namespace this_thread {
      */
     int get_current_priority();
 
+    /**
+     * Set the scheduling policy and priority for the current thread
+     * @param policy The SchedulingPolicy for this thread
+     * @param priority The priority for this thread
+     * @throws std::invalid_argument If policy is RT_DEADLINE, use set_deadline_scheduling instead
+     * @throws std::runtime_error If the policy cannot be set
+     */
+    void set_scheduling_policy(SchedulingPolicy policy, int priority);
+
+    /**
+     * Run the current thread under SCHED_DEADLINE: every `period` nanoseconds the thread
+     * is guaranteed `runtime` nanoseconds of CPU before `deadline` nanoseconds have elapsed.
+     * The thread should call sched_yield() when its job for the period is done.
+     * It is only available for the calling thread because the kernel addresses threads
+     * by their thread id, which a std::thread does not expose.
+     * @param runtime The CPU time budget per period, in nanoseconds
+     * @param deadline The relative deadline, in nanoseconds
+     * @param period The period, in nanoseconds
+     * @throws std::invalid_argument If the parameters do not satisfy runtime <= deadline <= period
+     * @throws std::system_error If the kernel rejects them. EBUSY means admission control
+     *      rejected the bandwidth; EPERM a lack of privileges or a restricted CPU affinity.
+     */
+    void set_deadline_scheduling(uint64_t runtime, uint64_t deadline, uint64_t period);
+
+    /**
+     * Pin the current thread to a set of CPUs
+     * @param cpus The CPUs where the thread is allowed to run. If empty, any CPU.
+     * @throws std::runtime_error If the affinity cannot be set
+     */
+    void set_affinity(const std::vector<int>& cpus);
+
+    /**
+     * Get the CPUs where the current thread is allowed to run
+     * @returns The CPUs of the affinity mask of the current thread
+     */
+    std::vector<int> get_affinity();
+
 };
\ No newline at end of file
@@ -0,0 +1,222 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ThreadPlacement.h"
+#include "ThreadPool.h"
+#include "RealTime.h"
+#include "../Log.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+Placement ThreadPlacement::placements[ROLE_COUNT] = {
+    {RT_ROUND_ROBIN, -1, {}, -1, 0},
+    {RT_ROUND_ROBIN, -2, {}, -1, 0},
+    {DEFAULT, 0, {}, -1, 0},
+    {DEFAULT, 0, {}, -1, 0}
+};
+
+std::mutex ThreadPlacement::mtx;
+
+Placement ThreadPlacement::get(ThreadRole role) {
+    std::unique_lock<std::mutex> lck(mtx);
+    return placements[role];
+}
+
+void ThreadPlacement::set(ThreadRole role, const Placement& placement) {
+    std::unique_lock<std::mutex> lck(mtx);
+    placements[role] = placement;
+}
+
+void ThreadPlacement::isolate_sensors() {
+    std::vector<int> isolated = RealTime::get_isolated_cpus();
+    if (isolated.empty()) {
+        RTDATA_LOG(WARNING) << "No isolated CPUs (isolcpus), sensor threads are not isolated";
+        return;
+    }
+    std::vector<int> housekeeping;
+    for (int cpu : RealTime::get_online_cpus()) {
+        if (std::find(isolated.begin(), isolated.end(), cpu) == isolated.end()) {
+            housekeeping.push_back(cpu);
+        }
+    }
+    std::unique_lock<std::mutex> lck(mtx);
+    for (int role = 0; role < ROLE_COUNT; ++role) {
+        if (!placements[role].cpus.empty()) {
+            continue;
+        }
+        placements[role].cpus = role == ROLE_SENSOR ? isolated : housekeeping;
+    }
+}
+
+static SchedulingPolicy parse_policy(const std::string& policy) {
+    if (policy == "default") {
+        return DEFAULT;
+    }
+    if (policy == "fifo") {
+        return RT_FIFO;
+    }
+    if (policy == "rr") {
+        return RT_ROUND_ROBIN;
+    }
+    if (policy == "deadline") {
+        return RT_DEADLINE;
+    }
+    throw std::invalid_argument("Unknown scheduling policy " + policy);
+}
+
+static int get_integer(Configuration& config) {
+    if (config.is<int64_t>()) {
+        return (int)config.get<int64_t>();
+    }
+    return (int)config.get<uint64_t>();
+}
+
+void ThreadPlacement::configure(Configuration& config) {
+    for (int role = 0; role < ROLE_COUNT; ++role) {
+        Configuration& node = config[role_name((ThreadRole)role)];
+        if (node.is_null()) {
+            continue;
+        }
+        Placement placement = get((ThreadRole)role);
+        Configuration& policy = node["policy"];
+        if (!policy.is_null()) {
+            placement.policy = parse_policy(policy.get<std::string>());
+        }
+        Configuration& priority = node["priority"];
+        if (!priority.is_null()) {
+            placement.priority = get_integer(priority);
+        }
+        Configuration& cpus = node["cpus"];
+        if (!cpus.is_null()) {
+            placement.cpus = RealTime::parse_cpu_list(cpus.get<std::string>());
+        }
+        Configuration& numa_node = node["numa_node"];
+        if (!numa_node.is_null()) {
+            placement.numa_node = get_integer(numa_node);
+        }
+        Configuration& runtime = node["runtime"];
+        if (!runtime.is_null()) {
+            placement.runtime = runtime.get<uint64_t>();
+        }
+        set((ThreadRole)role, placement);
+    }
+}
+
+int ThreadPlacement::resolve_priority(const Placement& placement) {
+    if (placement.policy == DEFAULT) {
+        return 0;
+    }
+    SchedulingPolicy policy = placement.policy == RT_DEADLINE ? RT_ROUND_ROBIN : placement.policy;
+    if (placement.priority < 0) {
+        return Thread::get_max_scheduling_priority(policy) + placement.priority;
+    }
+    return placement.priority;
+}
+
+std::vector<int> ThreadPlacement::resolve_cpus(const Placement& placement) {
+    if (placement.cpus.empty() && placement.numa_node >= 0) {
+        return RealTime::get_numa_node_cpus(placement.numa_node);
+    }
+    return placement.cpus;
+}
+
+void ThreadPlacement::apply(Thread& thread, ThreadRole role, const std::string& name) {
+    Placement placement = get(role);
+    // A deadline thread sets its own policy from prepare_current(), so setting it
+    // from here could override the SCHED_DEADLINE the thread already switched to
+    if (placement.policy != RT_DEADLINE) {
+        try {
+            thread.set_scheduling_policy(placement.policy, resolve_priority(placement));
+        }
+        catch (std::runtime_error& ex) {
+            RTDATA_LOG(WARNING) << "[" << name << "] While setting the thread scheduling policy an exception was thrown: " << ex.what();
+            RTDATA_LOG(WARNING) << "[" << name << "] Are you running as sudo?";
+        }
+    }
+    std::vector<int> cpus = resolve_cpus(placement);
+    if (cpus.empty()) {
+        return;
+    }
+    if (placement.policy == RT_DEADLINE) {
+        // The kernel only admits SCHED_DEADLINE threads allowed to run on their whole root domain
+        RTDATA_LOG(WARNING) << "[" << name << "] CPU affinity ignored for a deadline thread";
+        return;
+    }
+    try {
+        thread.set_affinity(cpus);
+    }
+    catch (std::runtime_error& ex) {
+        RTDATA_LOG(WARNING) << "[" << name << "] While setting the thread affinity an exception was thrown: " << ex.what();
+    }
+}
+
+void ThreadPlacement::apply(ThreadPool& pool, ThreadRole role, const std::string& name) {
+    Placement placement = get(role);
+    SchedulingPolicy policy = placement.policy;
+    if (policy == RT_DEADLINE) {
+        RTDATA_LOG(WARNING) << "[" << name << "] The deadline policy is not supported by thread pools, using round-robin";
+        policy = RT_ROUND_ROBIN;
+    }
+    pool.set_scheduling_policy(policy, resolve_priority(placement));
+    std::vector<int> cpus = resolve_cpus(placement);
+    if (cpus.empty()) {
+        return;
+    }
+    try {
+        pool.set_affinity(cpus);
+    }
+    catch (std::runtime_error& ex) {
+        RTDATA_LOG(WARNING) << "[" << name << "] While setting the pool affinity an exception was thrown: " << ex.what();
+    }
+}
+
+void ThreadPlacement::prepare_current(ThreadRole role) {
+    Placement placement = get(role);
+    if (placement.policy == DEFAULT) {
+        return;
+    }
+    RealTime::prefault_stack(RealTime::get_stack_prefault_size());
+    if (placement.policy != RT_DEADLINE) {
+        return;
+    }
+    // The round-robin fallback, until the thread switches itself to SCHED_DEADLINE
+    // (see this_thread::set_deadline_scheduling)
+    try {
+        this_thread::set_scheduling_policy(RT_ROUND_ROBIN, resolve_priority(placement));
+    }
+    catch (std::runtime_error& ex) {
+        RTDATA_LOG(WARNING) << "[" << role_name(role) << "] While setting the thread scheduling policy an exception was thrown: " << ex.what();
+        RTDATA_LOG(WARNING) << "[" << role_name(role) << "] Are you running as sudo?";
+    }
+}
+
+const char* ThreadPlacement::role_name(ThreadRole role) {
+    switch (role) {
+        case ROLE_SENSOR:
+            return "sensor";
+        case ROLE_BROKER:
+            return "broker";
+        case ROLE_IO:
+            return "io";
+        case ROLE_MANAGER:
+            return "manager";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,164 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+
+#include "Thread.h"
+#include "../utils/Configuration.h"
+
+class ThreadPool;
+
+/**
+ * The roles of the framework threads. Each role has its own placement.
+ */
+enum ThreadRole {
+    // Sensor polling threads
+    ROLE_SENSOR = 0,
+    // The Broker's thread pool (listeners and writers)
+    ROLE_BROKER,
+    // Auxiliary IO threads (metrics exporter...)
+    ROLE_IO,
+    // The SensorsManager's fetch thread
+    ROLE_MANAGER,
+    ROLE_COUNT
+};
+
+/**
+ * Where and how a thread runs
+ */
+struct Placement {
+    // The scheduling policy
+    SchedulingPolicy policy = DEFAULT;
+    // The priority, relative to the maximum priority of the policy if negative
+    // (e.g. -1 is the maximum priority minus one). With RT_DEADLINE, the RT_ROUND_ROBIN
+    // priority used before the deadline parameters are set and as a fallback.
+    int priority = 0;
+    // The CPUs where the thread is allowed to run. Empty means any CPU.
+    std::vector<int> cpus;
+    // The NUMA node where the thread is allowed to run (if cpus is empty). -1 means any node.
+    int numa_node = -1;
+    // With RT_DEADLINE, the CPU time budget per period in nanoseconds. 0 means measured.
+    uint64_t runtime = 0;
+};
+
+/**
+ * \class ThreadPlacement
+ *
+ * \brief Process-wide placement (scheduling policy, priority, CPUs) of the framework threads
+ *
+ * Every framework thread is placed according to its role when it is started.
+ * The defaults keep the historical behaviour: sensor threads run with SCHED_RR at the
+ * maximum priority minus one, the Broker's pool at the maximum minus two, and the
+ * rest with the default policy on any CPU.
+ *
+ * The placements must be set before starting the components (e.g. with
+ * RealTime::setup()). Threads that are already running are not moved.
+ */
+class ThreadPlacement {
+
+public:
+
+    ThreadPlacement() = delete;
+
+    /**
+     * Get the placement of a role
+     * @param role A ThreadRole
+     * @returns The placement of the role
+     */
+    static Placement get(ThreadRole role);
+
+    /**
+     * Set the placement of a role
+     * @param role A ThreadRole
+     * @param placement The new placement of the role
+     */
+    static void set(ThreadRole role, const Placement& placement);
+
+    /**
+     * Run the sensor threads on the isolated CPUs (isolcpus) and all the other
+     * roles on the remaining CPUs. Does nothing if there are no isolated CPUs.
+     * Placements with explicit CPUs are not changed.
+     */
+    static void isolate_sensors();
+
+    /**
+     * Set the placements from a configuration. Each role (sensor, broker, io, manager)
+     * is an optional object with the optional properties:
+     *  - policy (string): "default", "fifo", "rr" or "deadline"
+     *  - priority (integer): the priority; if negative, relative to the maximum priority
+     *  - cpus (string): a CPU list, e.g. "2-3,6"
+     *  - numa_node (unsigned): a NUMA node, used if cpus is not set
+     *  - runtime (unsigned): the budget in nanoseconds for the deadline policy
+     * @param config The configuration node
+     * @throws std::invalid_argument If a value is not valid
+     */
+    static void configure(Configuration& config);
+
+    /**
+     * Place a thread. Errors are logged, never thrown.
+     * The policy of a RT_DEADLINE role is set by the thread itself (see prepare_current()).
+     * @param thread The thread
+     * @param role The role of the thread
+     * @param name The name of the thread, for the log
+     */
+    static void apply(Thread& thread, ThreadRole role, const std::string& name);
+
+    /**
+     * Place all the threads of a pool. Errors are logged, never thrown.
+     * @param pool The thread pool
+     * @param role The role of the threads
+     * @param name The name of the pool, for the log
+     */
+    static void apply(ThreadPool& pool, ThreadRole role, const std::string& name);
+
+    /**
+     * Prefault the stack of the calling thread if the role is real-time, and
+     * set the RT_ROUND_ROBIN fallback of a RT_DEADLINE role. Errors are logged, never thrown.
+     * Called by the framework threads when they start running.
+     * @param role The role of the calling thread
+     */
+    static void prepare_current(ThreadRole role);
+
+    /**
+     * Get the name of a role
+     * @param role A ThreadRole
+     * @returns The name of the role, as used in the configuration
+     */
+    static const char* role_name(ThreadRole role);
+
+    /**
+     * Resolve the priority of a placement
+     * @param placement A placement
+     * @returns The absolute priority for the placement's policy. For RT_DEADLINE,
+     *      the RT_ROUND_ROBIN fallback priority.
+     */
+    static int resolve_priority(const Placement& placement);
+
+private:
+
+    static std::vector<int> resolve_cpus(const Placement& placement);
+
+    static Placement placements[ROLE_COUNT];
+
+    static std::mutex mtx;
+
+};
@@ -17,6 +17,18 @@
 */
 
 #include "ThreadPool.h"
+#include "../metrics/Trace.h"
+
+void ThreadPool::init_metrics() {
+    static std::atomic<int> next_pool_id(0);
+    MetricsRegistry& registry = MetricsRegistry::get_default();
+    std::string labels = MetricsRegistry::label("pool", std::to_string(next_pool_id++));
+    queue_depth = &registry.gauge("rtdata_pool_queued_jobs", labels, "Jobs waiting in the pool queue");
+    busy_threads = &registry.gauge("rtdata_pool_busy_threads", labels, "Pool threads executing a job");
+    jobs_total = &registry.counter("rtdata_pool_jobs_total", labels, "Jobs executed by the pool");
+    job_duration = &registry.histogram("rtdata_pool_job_duration_ns", labels, "Job execution time in nanoseconds");
+    registry.gauge("rtdata_pool_threads", labels, "Threads in the pool").set(thread_count);
+}
 
 void ThreadPool::init_threads() {
     for (std::size_t i = 0; i < threads.size(); ++i) {
@@ -24,32 +36,75 @@ void ThreadPool::init_threads() {
     }
 }
 
-void ThreadPool::add_job(std::function<void(void)> job) {
-    queue.push(job);
+void ThreadPool::add_job(Task job, JobPriority priority) {
+    // Counted before the push, otherwise a thread can pop the job and decrement the gauge first
+    queue_depth->increment();
+    {
+        // Pushed under the wait mutex, so a thread cannot miss it between its check and its wait
+        std::unique_lock<std::mutex> lck(wait_mutex);
+        queues[priority].push(std::move(job));
+    }
     new_job.notify_one();
 }
 
 void ThreadPool::thread_run() {
-    while (!stopped) {
-        std::unique_lock<std::mutex> lck(wait_mutex);
-        new_job.wait(lck, [this]() -> bool {return !queue.empty() || stopped;});
-        if (!stopped) {
-            while (queue.empty()) {
-                ;
+    Task job;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lck(wait_mutex);
+            new_job.wait(lck, [this]() -> bool {return has_jobs() || stopped;});
+            // Once stopped, the threads leave only when the queues are drained
+            if (!pop_job(job)) {
+                if (stopped) {
+                    return;
+                }
+                continue;
             }
-            std::function<void(void)> job = queue.pop();
-            ++jobs_in_execution;
-            job();
-            --jobs_in_execution;
+        }
+        queue_depth->decrement();
+        ++jobs_in_execution;
+        busy_threads->increment();
+        uint64_t start = Trace::now();
+        job();
+        job_duration->record(Trace::now() - start);
+        jobs_total->increment();
+        busy_threads->decrement();
+        --jobs_in_execution;
+        // Release the captures now, not when the next job is popped
+        job = Task();
+    }
+}
+
+bool ThreadPool::has_jobs() {
+    for (auto& queue : queues) {
+        if (!queue.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::pop_job(Task& job) {
+    for (auto& queue : queues) {
+        if (queue.try_pop(job)) {
+            return true;
         }
     }
+    return false;
+}
+
+std::size_t ThreadPool::queued(JobPriority priority) {
+    return queues[priority].size();
 }
 
 void ThreadPool::join() {
     if (stopped) {
         return;
     }
-    stopped = true;
+    {
+        std::unique_lock<std::mutex> lck(wait_mutex);
+        stopped = true;
+    }
     new_job.notify_all();
     for (auto& thread : threads) {
         if (thread.joinable()) {
@@ -64,8 +119,14 @@ void ThreadPool::set_scheduling_policy(SchedulingPolicy policy, int priority) {
            threads[i].set_scheduling_policy(policy, priority);
         }
         catch (const std::runtime_error& ex) {
-            Log::log(WARNING) << "While setting a ThreadPool's thread scheduling policy an exception was thrown: " << ex.what();
-            Log::log(WARNING) << "Are you running as sudo?";
+            RTDATA_LOG(WARNING) << "While setting a ThreadPool's thread scheduling policy an exception was thrown: " << ex.what();
+            RTDATA_LOG(WARNING) << "Are you running as sudo?";
         }
     }
-}
\ No newline at end of file
+}
+
+void ThreadPool::set_affinity(const std::vector<int>& cpus) {
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i].set_affinity(cpus);
+    }
+}
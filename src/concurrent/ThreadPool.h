@@ -26,13 +26,30 @@
 #include <condition_variable>
 
 #include "ConcurrentQueue.h"
+#include "Task.h"
 #include "Thread.h"
 #include "../Log.h"
+#include "../metrics/MetricsRegistry.h"
+
+/**
+ * The lane of a ThreadPool job. A free thread always takes the oldest job of
+ * the highest non-empty lane.
+ */
+enum JobPriority {
+    // Alarms, state changes: never wait behind lower lanes
+    PRIORITY_HIGH = 0,
+    PRIORITY_NORMAL,
+    // Bulk work (archiving, uploads) that can wait for the rest
+    PRIORITY_LOW,
+    PRIORITY_COUNT
+};
 
 /**
  * A class to create and manage a thread pool
  * The pool manages a queue of jobs (tasks/functions without inputs nor outputs)
  * that are executed asynchronously by the thread pool.
+ * Jobs are queued in priority lanes (see JobPriority), so a backlog of
+ * normal jobs does not delay high-priority ones by more than the jobs already running.
  * This class guarantees that all threads are joined before this class is destructed.
  */
 class ThreadPool {
@@ -47,6 +64,7 @@ public:
         jobs_in_execution(0),
         stopped(false),
         threads(std::vector<Thread>(10)) {
+        init_metrics();
         init_threads();
     }
 
@@ -58,6 +76,7 @@ public:
         jobs_in_execution(0),
         stopped(false),
         threads(std::vector<Thread>(count)) {
+        init_metrics();
         init_threads();
     }
 
@@ -71,12 +90,20 @@ public:
     /**
      * Queue a new job to be executed by the pool
      * @param job A function to be executed. Must have no parameters and return nothing.
+     * @param priority The lane of the job
+     */
+    void add_job(Task job, JobPriority priority = PRIORITY_NORMAL);
+
+    /**
+     * Get the number of queued jobs of a lane
+     * @param priority The lane
+     * @returns The number of jobs waiting in the lane
      */
-    void add_job(std::function<void(void)> job);
+    std::size_t queued(JobPriority priority);
 
     /**
-     * Wait for all the jobs in execution and join the threads
-     * Note: all the queued jobs are discarded
+     * Run the queued jobs, including the ones they add, and join the threads.
+     * Jobs added after join() returns are never run.
      */
     void join();
 
@@ -87,6 +114,13 @@ public:
      */
     void set_scheduling_policy(SchedulingPolicy policy, int priority);
 
+    /**
+     * Pin all the pool's threads to a set of CPUs
+     * @param cpus The CPUs where the threads are allowed to run. If empty, any CPU.
+     * @throws std::runtime_error If the affinity cannot be set
+     */
+    void set_affinity(const std::vector<int>& cpus);
+
     /**
      * Get the number of threads managed by the class
      * @returns the number of threads managed by the class
@@ -111,7 +145,7 @@ private:
 
     std::atomic<bool> stopped;
 
-    ConcurrentQueue<std::function<void(void)>> queue;
+    ConcurrentQueue<Task> queues[PRIORITY_COUNT];
 
     std::vector<Thread> threads;
 
@@ -119,8 +153,22 @@ private:
 
     std::mutex wait_mutex;
 
+    Gauge* queue_depth;
+
+    Gauge* busy_threads;
+
+    Counter* jobs_total;
+
+    LatencyHistogram* job_duration;
+
+    bool has_jobs();
+
+    bool pop_job(Task& job);
+
     void thread_run();
 
     void init_threads();
 
+    void init_metrics();
+
 };
\ No newline at end of file
@@ -40,6 +40,11 @@
  * State.
  * 
  * You can also force a state change by calling set_current_state().
+ *
+ * The events must be handled one at a time: subscribe the state machine
+ * with SubscriptionOptions::ordered(). If its conditions only depend on the
+ * latest value of high-rate topics, SubscriptionOptions::conflated() skips
+ * the samples it would not use.
  * 
  */
 class StateMachine : public Listener {
@@ -0,0 +1,134 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ByteRing.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <sys/uio.h>
+
+ByteRing::ByteRing(std::size_t capacity) : head(0), tail(0) {
+    if (capacity == 0) {
+        throw std::invalid_argument("The capacity of a ByteRing must be greater than 0");
+    }
+    std::size_t rounded = 1;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+    buffer.resize(rounded);
+    mask = rounded - 1;
+}
+
+ssize_t ByteRing::read_from(int fd) {
+    std::size_t free_space = capacity() - size();
+    if (free_space == 0) {
+        return 0;
+    }
+    std::size_t position = tail & mask;
+    std::size_t first = std::min(free_space, capacity() - position);
+    struct iovec segments[2];
+    segments[0].iov_base = buffer.data() + position;
+    segments[0].iov_len = first;
+    segments[1].iov_base = buffer.data();
+    segments[1].iov_len = free_space - first;
+    ssize_t result = readv(fd, segments, segments[1].iov_len > 0 ? 2 : 1);
+    if (result > 0) {
+        tail += result;
+    }
+    return result;
+}
+
+std::size_t ByteRing::write(const uint8_t* data, std::size_t size) {
+    size = std::min(size, capacity() - this->size());
+    std::size_t position = tail & mask;
+    std::size_t first = std::min(size, capacity() - position);
+    std::memcpy(buffer.data() + position, data, first);
+    std::memcpy(buffer.data(), data + first, size - first);
+    tail += size;
+    return size;
+}
+
+void ByteRing::copy(std::size_t offset, uint8_t* out, std::size_t size) const {
+    std::size_t position = (head + offset) & mask;
+    std::size_t first = std::min(size, capacity() - position);
+    std::memcpy(out, buffer.data() + position, first);
+    std::memcpy(out + first, buffer.data(), size - first);
+}
+
+std::size_t ByteRing::read(uint8_t* out, std::size_t size) {
+    size = std::min(size, this->size());
+    copy(0, out, size);
+    head += size;
+    return size;
+}
+
+bool ByteRing::read_until(std::vector<uint8_t>& out, uint8_t delimiter) {
+    std::size_t position = find(delimiter);
+    if (position == size()) {
+        return false;
+    }
+    out.resize(position);
+    copy(0, out.data(), position);
+    head += position + 1;
+    return true;
+}
+
+bool ByteRing::read_exact(std::vector<uint8_t>& out, std::size_t length) {
+    if (size() < length) {
+        return false;
+    }
+    out.resize(length);
+    read(out.data(), length);
+    return true;
+}
+
+std::size_t ByteRing::find(uint8_t value) const {
+    std::size_t count = size();
+    std::size_t position = head & mask;
+    std::size_t first = std::min(count, capacity() - position);
+    const void* found = std::memchr(buffer.data() + position, value, first);
+    if (found != nullptr) {
+        return static_cast<const uint8_t*>(found) - (buffer.data() + position);
+    }
+    found = std::memchr(buffer.data(), value, count - first);
+    if (found != nullptr) {
+        return first + (static_cast<const uint8_t*>(found) - buffer.data());
+    }
+    return count;
+}
+
+void ByteRing::discard(std::size_t size) {
+    head += std::min(size, this->size());
+}
+
+void ByteRing::clear() {
+    head = tail;
+}
+
+std::size_t ByteRing::size() const {
+    return tail - head;
+}
+
+bool ByteRing::empty() const {
+    return head == tail;
+}
+
+std::size_t ByteRing::capacity() const {
+    return buffer.size();
+}
@@ -0,0 +1,137 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+
+/**
+ * \class ByteRing
+ *
+ * \brief A bounded ring of bytes, filled in bulk from a file descriptor
+ *
+ * read_from() moves everything the kernel has buffered (up to the free space)
+ * into the ring with a single readv(), and the bytes are then extracted as
+ * framed messages, by delimiter or by length, without further system calls.
+ * It is not thread-safe; see SPSCRing to pass items between threads.
+ */
+class ByteRing {
+
+public:
+
+    /**
+     * Constructor
+     * @param capacity The minimum capacity in bytes. Rounded up to a power of two.
+     * @throws std::invalid_argument If the capacity is 0
+     */
+    explicit ByteRing(std::size_t capacity);
+
+    /**
+     * Read from a file descriptor into the free space of the ring, with a single readv()
+     * @param fd The file descriptor to read from
+     * @returns The result of readv(): the bytes read, 0 at end of file or -1 on error (see errno).
+     * 0 if the ring is full.
+     */
+    ssize_t read_from(int fd);
+
+    /**
+     * Copy bytes to the back of the ring
+     * @param data The bytes to copy
+     * @param size The number of bytes
+     * @returns The number of bytes copied, less than `size` if the ring is full
+     */
+    std::size_t write(const uint8_t* data, std::size_t size);
+
+    /**
+     * Remove bytes from the front of the ring
+     * @param out Where the bytes are copied to
+     * @param size The maximum number of bytes to remove
+     * @returns The number of bytes removed
+     */
+    std::size_t read(uint8_t* out, std::size_t size);
+
+    /**
+     * Remove the bytes up to the first occurrence of a delimiter
+     * @param out Replaced with the message, delimiter excluded
+     * @param delimiter The byte that ends the message
+     * @returns Whether a complete message was removed. If not, the ring is left untouched.
+     */
+    bool read_until(std::vector<uint8_t>& out, uint8_t delimiter);
+
+    /**
+     * Remove a message of a fixed length
+     * @param out Replaced with the message
+     * @param length The length of the message
+     * @returns Whether the ring held `length` bytes. If not, the ring is left untouched.
+     */
+    bool read_exact(std::vector<uint8_t>& out, std::size_t length);
+
+    /**
+     * Find the first occurrence of a byte
+     * @param value The byte to look for
+     * @returns Its position from the front of the ring, or `size()` if it is not in the ring
+     */
+    std::size_t find(uint8_t value) const;
+
+    /**
+     * Drop bytes from the front of the ring
+     * @param size The number of bytes to drop
+     */
+    void discard(std::size_t size);
+
+    /**
+     * Drop all the bytes in the ring
+     */
+    void clear();
+
+    /**
+     * Get the number of bytes in the ring
+     * @returns The number of bytes in the ring
+     */
+    std::size_t size() const;
+
+    /**
+     * Is the ring empty?
+     * @returns Whether the ring is empty
+     */
+    bool empty() const;
+
+    /**
+     * Get the capacity of the ring
+     * @returns The maximum number of bytes in the ring
+     */
+    std::size_t capacity() const;
+
+private:
+
+    // Copy `size` bytes starting at `offset` from the front, without removing them
+    void copy(std::size_t offset, uint8_t* out, std::size_t size) const;
+
+    std::vector<uint8_t> buffer;
+
+    std::size_t mask;
+
+    // Free-running counters, the positions are `counter & mask`
+    std::size_t head;
+
+    std::size_t tail;
+
+};
@@ -58,6 +58,7 @@ public:
             throw std::runtime_error("Already open");
         }
         file.open(filename, std::ofstream::out | std::ofstream::binary | std::ofstream::ate);
+        bind_metrics("file", filename);
     }
 
     /**
@@ -95,6 +96,13 @@ public:
         data->serialize(&serialized);
         std::vector<uint8_t> bytes = serialized.get_bytes();
         file.write((char *)bytes.data(), bytes.size());
+        if (file.fail()) {
+            count_error();
+        }
+        else {
+            count_write(bytes.size());
+        }
+        trace_written(topic, data);
     }
 
     /**
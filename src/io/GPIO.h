@@ -16,6 +16,8 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#pragma once
+
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <fcntl.h>
@@ -46,6 +48,9 @@ enum PinStatus {
  * 
  * A GPIO pin is identified by a number. The number of the pin depends on the board you are using,
  * check the documentation for your board.
+ * 
+ * This class uses the sysfs interface and opens a file on every operation. See GPIOChip
+ * for lines held open, bulk reads and writes, and edge events.
  */
 class GPIO {
 
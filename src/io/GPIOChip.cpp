@@ -0,0 +1,179 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GPIOChip.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+static void copy_label(char* destination, const std::string& label) {
+    std::strncpy(destination, label.c_str(), GPIO_MAX_NAME_SIZE - 1);
+    destination[GPIO_MAX_NAME_SIZE - 1] = '\0';
+}
+
+GPIOLines::~GPIOLines() {
+    ::close(fd);
+}
+
+void GPIOLines::get_values(uint8_t* values) {
+    gpiohandle_data data;
+    if (ioctl(fd, GPIOHANDLE_GET_LINE_VALUES_IOCTL, &data) < 0) {
+        throw std::runtime_error(strerror(errno));
+    }
+    std::memcpy(values, data.values, count);
+}
+
+PinStatus GPIOLines::get_value(std::size_t index) {
+    if (index >= count) {
+        throw std::out_of_range("No such GPIO line");
+    }
+    uint8_t values[GPIOHANDLES_MAX];
+    get_values(values);
+    return values[index] ? HIGH : LOW;
+}
+
+void GPIOLines::set_values(const uint8_t* values) {
+    gpiohandle_data data;
+    std::memset(&data, 0, sizeof(data));
+    std::memcpy(data.values, values, count);
+    if (ioctl(fd, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data) < 0) {
+        throw std::runtime_error(strerror(errno));
+    }
+}
+
+std::size_t GPIOLines::size() const {
+    return count;
+}
+
+GPIOEdgeLine::GPIOEdgeLine(int fd) : fd(fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+GPIOEdgeLine::~GPIOEdgeLine() {
+    ::close(fd);
+}
+
+bool GPIOEdgeLine::read_event(GPIOEvent& event) {
+    gpioevent_data data;
+    ssize_t size;
+    do {
+        size = ::read(fd, &data, sizeof(data));
+    } while (size < 0 && errno == EINTR);
+    if (size < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return false;
+        }
+        throw std::runtime_error(strerror(errno));
+    }
+    if (size != sizeof(data)) {
+        throw std::runtime_error("Truncated GPIO event");
+    }
+    event.timestamp = data.timestamp;
+    event.edge = data.id == GPIOEVENT_EVENT_RISING_EDGE ? EDGE_RISING : EDGE_FALLING;
+    return true;
+}
+
+bool GPIOEdgeLine::wait_event(GPIOEvent& event, int timeout_millis) {
+    if (read_event(event)) {
+        return true;
+    }
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    int ret = poll(&pfd, 1, timeout_millis);
+    if (ret < 0 && errno != EINTR) {
+        throw std::runtime_error(strerror(errno));
+    }
+    return ret > 0 && read_event(event);
+}
+
+PinStatus GPIOEdgeLine::get_value() {
+    gpiohandle_data data;
+    if (ioctl(fd, GPIOHANDLE_GET_LINE_VALUES_IOCTL, &data) < 0) {
+        throw std::runtime_error(strerror(errno));
+    }
+    return data.values[0] ? HIGH : LOW;
+}
+
+int GPIOEdgeLine::get_fd() const {
+    return fd;
+}
+
+GPIOChip::GPIOChip(const std::string& device) : device(device) {
+    fd = ::open(device.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open " + device + ": " + strerror(errno));
+    }
+    if (ioctl(fd, GPIO_GET_CHIPINFO_IOCTL, &info) < 0) {
+        std::string error = strerror(errno);
+        ::close(fd);
+        throw std::runtime_error(device + " is not a GPIO chip: " + error);
+    }
+}
+
+GPIOChip::~GPIOChip() {
+    ::close(fd);
+}
+
+std::unique_ptr<GPIOLines> GPIOChip::request_lines(const std::vector<uint32_t>& offsets, Mode mode,
+    const std::string& consumer, const std::vector<uint8_t>& values) {
+    if (offsets.empty() || offsets.size() > GPIOHANDLES_MAX) {
+        throw std::invalid_argument("Between 1 and 64 GPIO lines can be requested at once");
+    }
+    gpiohandle_request request;
+    std::memset(&request, 0, sizeof(request));
+    std::copy(offsets.begin(), offsets.end(), request.lineoffsets);
+    request.lines = offsets.size();
+    request.flags = mode == Mode::OUTPUT ? GPIOHANDLE_REQUEST_OUTPUT : GPIOHANDLE_REQUEST_INPUT;
+    for (std::size_t i = 0; i < values.size() && i < offsets.size(); ++i) {
+        request.default_values[i] = values[i] ? 1 : 0;
+    }
+    copy_label(request.consumer_label, consumer);
+    if (ioctl(fd, GPIO_GET_LINEHANDLE_IOCTL, &request) < 0) {
+        throw std::runtime_error("Could not request the GPIO lines of " + device + ": " + strerror(errno));
+    }
+    return std::make_unique<GPIOLines>(request.fd, offsets.size());
+}
+
+std::unique_ptr<GPIOEdgeLine> GPIOChip::request_edges(uint32_t offset, GPIOEdge edge, const std::string& consumer) {
+    gpioevent_request request;
+    std::memset(&request, 0, sizeof(request));
+    request.lineoffset = offset;
+    request.handleflags = GPIOHANDLE_REQUEST_INPUT;
+    request.eventflags = edge;
+    copy_label(request.consumer_label, consumer);
+    if (ioctl(fd, GPIO_GET_LINEEVENT_IOCTL, &request) < 0) {
+        throw std::runtime_error("Could not request the GPIO events of " + device + ": " + strerror(errno));
+    }
+    return std::make_unique<GPIOEdgeLine>(request.fd);
+}
+
+std::string GPIOChip::get_name() const {
+    return std::string(info.name, strnlen(info.name, GPIO_MAX_NAME_SIZE));
+}
+
+std::string GPIOChip::get_label() const {
+    return std::string(info.label, strnlen(info.label, GPIO_MAX_NAME_SIZE));
+}
+
+uint32_t GPIOChip::get_line_count() const {
+    return info.lines;
+}
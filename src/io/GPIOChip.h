@@ -0,0 +1,260 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <stdexcept>
+
+#include <linux/gpio.h>
+
+#include "GPIO.h"
+
+/**
+ * The edges of a GPIO line that generate events
+ */
+enum GPIOEdge {
+    EDGE_RISING = GPIOEVENT_REQUEST_RISING_EDGE,
+    EDGE_FALLING = GPIOEVENT_REQUEST_FALLING_EDGE,
+    EDGE_BOTH = GPIOEVENT_REQUEST_BOTH_EDGES
+};
+
+/**
+ * An edge detected by the kernel on a GPIO line
+ */
+struct GPIOEvent {
+    uint64_t timestamp; // nanoseconds, CLOCK_MONOTONIC since Linux 5.7 and CLOCK_REALTIME before
+    GPIOEdge edge; // EDGE_RISING or EDGE_FALLING
+};
+
+/**
+ * \class GPIOLines
+ *
+ * \brief A set of GPIO lines of a chip, requested as inputs or outputs
+ *
+ * The request is held open until the object is destroyed, so reading or writing the
+ * lines is a single ioctl for all of them, without opening any file.
+ * Built by GPIOChip::request_lines().
+ */
+class GPIOLines {
+
+public:
+
+    /**
+     * Constructor. Takes the ownership of a line handle.
+     * @param fd The file descriptor of the line handle
+     * @param count The number of lines of the handle
+     */
+    GPIOLines(int fd, std::size_t count) : fd(fd), count(count) {
+
+    }
+
+    ~GPIOLines();
+
+    // Do not allow copy or assignment.
+
+    GPIOLines(const GPIOLines&) = delete;
+
+    GPIOLines& operator=(const GPIOLines&) = delete;
+
+    /**
+     * Read all the lines at once
+     * @param values Where the values are stored (0 or 1), one per line in the order of the request
+     * @throws std::runtime_error If the operation fails
+     */
+    void get_values(uint8_t* values);
+
+    /**
+     * Read a single line
+     * @param index The position of the line in the request
+     * @returns The status of the line
+     * @throws std::runtime_error If the operation fails
+     * @throws std::out_of_range If there is no such line
+     */
+    PinStatus get_value(std::size_t index);
+
+    /**
+     * Write all the lines at once. The lines must have been requested as outputs.
+     * @param values The values (0 or 1), one per line in the order of the request
+     * @throws std::runtime_error If the operation fails
+     */
+    void set_values(const uint8_t* values);
+
+    /**
+     * Get the number of lines
+     * @returns The number of lines of the request
+     */
+    std::size_t size() const;
+
+private:
+
+    int fd;
+
+    std::size_t count;
+
+};
+
+/**
+ * \class GPIOEdgeLine
+ *
+ * \brief A GPIO input line that reports its edges
+ *
+ * The kernel timestamps each edge when the interrupt is handled and queues it
+ * until it is read. The file descriptor is non-blocking, and becomes readable when
+ * an event is queued, so it can be watched with a Reactor (see get_fd()) to react
+ * to data-ready interrupts instead of polling. Built by GPIOChip::request_edges().
+ */
+class GPIOEdgeLine {
+
+public:
+
+    /**
+     * Constructor. Takes the ownership of a line event request.
+     * @param fd The file descriptor of the event request
+     */
+    explicit GPIOEdgeLine(int fd);
+
+    ~GPIOEdgeLine();
+
+    // Do not allow copy or assignment.
+
+    GPIOEdgeLine(const GPIOEdgeLine&) = delete;
+
+    GPIOEdgeLine& operator=(const GPIOEdgeLine&) = delete;
+
+    /**
+     * Take the next queued event, without waiting
+     * @param event Where the event is stored
+     * @returns Whether an event was queued
+     * @throws std::runtime_error If the operation fails
+     */
+    bool read_event(GPIOEvent& event);
+
+    /**
+     * Wait for the next event
+     * @param event Where the event is stored
+     * @param timeout_millis The maximum time to wait, -1 to wait forever
+     * @returns Whether an event was received before the timeout
+     * @throws std::runtime_error If the operation fails
+     */
+    bool wait_event(GPIOEvent& event, int timeout_millis);
+
+    /**
+     * Read the current value of the line
+     * @returns The status of the line
+     * @throws std::runtime_error If the operation fails
+     */
+    PinStatus get_value();
+
+    /**
+     * Get the file descriptor that becomes readable when an event is queued
+     * @returns The file descriptor of the event request
+     */
+    int get_fd() const;
+
+private:
+
+    int fd;
+
+};
+
+/**
+ * \class GPIOChip
+ *
+ * \brief A GPIO controller, through its character device (/dev/gpiochipN)
+ *
+ * Unlike GPIO, which uses the deprecated sysfs interface and opens a file on every
+ * operation, lines are requested once and the requests are kept open: several lines
+ * can be read or written with a single ioctl (see GPIOLines), and edges are reported
+ * with kernel timestamps (see GPIOEdgeLine).
+ *
+ * Lines are identified by their offset within the chip. Check the documentation
+ * of your board, or `gpioinfo`.
+ */
+class GPIOChip {
+
+public:
+
+    /**
+     * Constructor. Opens the chip.
+     * @param device The character device of the chip (e.g. "/dev/gpiochip0")
+     * @throws std::runtime_error If the chip cannot be opened
+     */
+    explicit GPIOChip(const std::string& device);
+
+    ~GPIOChip();
+
+    // Do not allow copy or assignment.
+
+    GPIOChip(const GPIOChip&) = delete;
+
+    GPIOChip& operator=(const GPIOChip&) = delete;
+
+    /**
+     * Request lines as inputs or outputs
+     * @param offsets The offsets of the lines in the chip, at most GPIOHANDLES_MAX
+     * @param mode INPUT or OUTPUT
+     * @param consumer A label shown by the kernel as the user of the lines
+     * @param values The initial values of outputs, one per line (optional, default = all LOW)
+     * @returns The requested lines
+     * @throws std::invalid_argument If there are no lines or too many
+     * @throws std::runtime_error If the lines cannot be requested (e.g. they are in use)
+     */
+    std::unique_ptr<GPIOLines> request_lines(const std::vector<uint32_t>& offsets, Mode mode,
+        const std::string& consumer, const std::vector<uint8_t>& values = std::vector<uint8_t>());
+
+    /**
+     * Request the edge events of an input line
+     * @param offset The offset of the line in the chip
+     * @param edge The edges that generate events
+     * @param consumer A label shown by the kernel as the user of the line
+     * @returns The line
+     * @throws std::runtime_error If the line cannot be requested (e.g. it is in use)
+     */
+    std::unique_ptr<GPIOEdgeLine> request_edges(uint32_t offset, GPIOEdge edge, const std::string& consumer);
+
+    /**
+     * Get the name of the chip, as named by the kernel (e.g. "gpiochip0")
+     * @returns The name of the chip
+     */
+    std::string get_name() const;
+
+    /**
+     * Get the label of the chip, as named by its driver
+     * @returns The label of the chip
+     */
+    std::string get_label() const;
+
+    /**
+     * Get the number of lines of the chip
+     * @returns The number of lines
+     */
+    uint32_t get_line_count() const;
+
+private:
+
+    std::string device;
+
+    int fd;
+
+    gpiochip_info info;
+
+};
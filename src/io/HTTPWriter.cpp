@@ -17,9 +17,11 @@
 */
 
 #include "HTTPWriter.h"
+#include "../Log.h"
 
 std::atomic<bool> HTTPWriter::curl_init(false);
 std::atomic<unsigned int> HTTPWriter::curl_count(0);
+const std::size_t HTTPWriter::DEFAULT_MAX_IN_FLIGHT;
 
 void HTTPWriter::open() {
     if (!curl_init) {
@@ -27,6 +29,7 @@ void HTTPWriter::open() {
         curl_init = true;
     }
     curl_count++;
+    bind_metrics("http", url);
     isopen = true;
 }
 
@@ -36,27 +39,196 @@ void HTTPWriter::write(std::shared_ptr<Data> data) {
 
 void HTTPWriter::write(std::string topic, std::shared_ptr<Data> data) {
     std::unique_lock<std::mutex> lck(mtx);
-    CURL* curl = curl_easy_init();
-    curl_slist *hs=NULL;
-    hs = curl_slist_append(hs, "Content-Type: application/json");
-    if (curl == NULL) {
-        throw std::runtime_error("Error initializing cURL");
-    }
     JSONObject json(topic);
     data->serialize(&json);
     nlohmann::json post_body = json.get_JSON();
     std::string post_body_str = post_body.dump();
+    if (reactor != nullptr) {
+        start_request(topic, data, post_body_str);
+        return;
+    }
+    CURL* curl = curl_easy_init();
+    if (curl == NULL) {
+        throw std::runtime_error("Error initializing cURL");
+    }
+    curl_slist *hs=NULL;
+    hs = curl_slist_append(hs, "Content-Type: application/json");
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
     curl_easy_setopt(curl, CURLOPT_HTTPHEADER, hs);
     curl_easy_setopt(curl, CURLOPT_POSTFIELDS, post_body_str.c_str());
     CURLcode res = curl_easy_perform(curl);
+    curl_easy_cleanup(curl);
+    curl_slist_free_all(hs);
     if (res != CURLE_OK) {
+        count_error();
         throw std::runtime_error(curl_easy_strerror(res));
     }
-    curl_easy_cleanup(curl);
+    count_write(post_body_str.size());
+    trace_written(topic, data);
+}
+
+void HTTPWriter::attach(Reactor& reactor, std::size_t max_in_flight) {
+    if (!is_open()) {
+        throw std::runtime_error("HTTPWriter must be open before attaching it");
+    }
+    std::unique_lock<std::mutex> lck(mtx);
+    if (this->reactor != nullptr) {
+        throw std::runtime_error("HTTPWriter already attached");
+    }
+    multi = curl_multi_init();
+    if (multi == nullptr) {
+        throw std::runtime_error("Error initializing cURL");
+    }
+    this->reactor = &reactor;
+    this->max_in_flight = max_in_flight;
+    headers = curl_slist_append(nullptr, "Content-Type: application/json");
+    curl_multi_setopt(multi, CURLMOPT_SOCKETFUNCTION, &HTTPWriter::on_socket);
+    curl_multi_setopt(multi, CURLMOPT_SOCKETDATA, this);
+    curl_multi_setopt(multi, CURLMOPT_TIMERFUNCTION, &HTTPWriter::on_timer);
+    curl_multi_setopt(multi, CURLMOPT_TIMERDATA, this);
+    timer = reactor.add_timer(0, 0, [this](uint64_t) {
+        perform(CURL_SOCKET_TIMEOUT, 0);
+    });
+}
+
+void HTTPWriter::detach() {
+    flush();
+    std::unique_lock<std::mutex> lck(mtx);
+    if (reactor == nullptr) {
+        return;
+    }
+    // Closes the cached connections, which unregisters their sockets.
+    // Their handlers and the timer handler return right away from now on.
+    curl_multi_cleanup(multi);
+    multi = nullptr;
+    Reactor* attached = reactor;
+    int attached_timer = timer;
+    reactor = nullptr;
+    timer = -1;
+    curl_slist_free_all(headers);
+    headers = nullptr;
+    lck.unlock();
+    // Without the lock, which the handlers may be waiting for
+    attached->remove_timer(attached_timer);
+    attached->synchronize();
+}
+
+std::size_t HTTPWriter::get_in_flight() {
+    std::unique_lock<std::mutex> lck(mtx);
+    return in_flight;
+}
+
+void HTTPWriter::start_request(const std::string& topic, std::shared_ptr<Data> data, const std::string& body) {
+    // Called with the lock held
+    if (in_flight >= max_in_flight) {
+        count_error();
+        throw std::runtime_error("Too many HTTP requests in flight");
+    }
+    CURL* curl = curl_easy_init();
+    if (curl == NULL) {
+        throw std::runtime_error("Error initializing cURL");
+    }
+    Request* request = new Request{topic, data, body.size()};
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_COPYPOSTFIELDS, body.c_str());
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, request);
+    CURLMcode res = curl_multi_add_handle(multi, curl);
+    if (res != CURLM_OK) {
+        curl_easy_cleanup(curl);
+        delete request;
+        count_error();
+        throw std::runtime_error(curl_multi_strerror(res));
+    }
+    ++in_flight;
+}
+
+int HTTPWriter::on_socket(CURL*, curl_socket_t socket, int what, void* writer, void* assigned) {
+    // Called by cURL with the lock held
+    HTTPWriter* self = static_cast<HTTPWriter*>(writer);
+    if (what == CURL_POLL_REMOVE) {
+        // Not waiting for the handler, which takes the lock: detach() waits for it
+        self->reactor->remove(socket, false);
+        return 0;
+    }
+    uint32_t events = ((what & CURL_POLL_IN) ? Reactor::READABLE : 0) | ((what & CURL_POLL_OUT) ? Reactor::WRITABLE : 0);
+    try {
+        if (assigned == nullptr) {
+            self->reactor->add(socket, events, [self, socket](uint32_t events) {
+                int flags = ((events & EPOLLIN) ? CURL_CSELECT_IN : 0) | ((events & EPOLLOUT) ? CURL_CSELECT_OUT : 0) |
+                    ((events & (EPOLLERR | EPOLLHUP)) ? CURL_CSELECT_ERR : 0);
+                self->perform(socket, flags);
+            });
+            curl_multi_assign(self->multi, socket, self);
+        }
+        else {
+            self->reactor->modify(socket, events);
+        }
+    }
+    catch (std::runtime_error& e) {
+        RTDATA_LOG(WARNING) << "[HTTPWriter] Cannot watch a socket: " << e.what();
+        return -1;
+    }
+    return 0;
+}
+
+int HTTPWriter::on_timer(CURLM*, long timeout_millis, void* writer) {
+    // Called by cURL with the lock held
+    HTTPWriter* self = static_cast<HTTPWriter*>(writer);
+    // A zero delay would disarm the timer: expire as soon as possible instead
+    uint64_t delay = timeout_millis < 0 ? 0 : timeout_millis == 0 ? 1 : (uint64_t)timeout_millis * 1000000ULL;
+    try {
+        self->reactor->set_timer(self->timer, delay, 0);
+    }
+    catch (std::runtime_error& e) {
+        RTDATA_LOG(WARNING) << "[HTTPWriter] Cannot set the cURL timer: " << e.what();
+        return -1;
+    }
+    return 0;
+}
+
+void HTTPWriter::perform(curl_socket_t socket, int flags) {
+    std::unique_lock<std::mutex> lck(mtx);
+    if (multi == nullptr) {
+        return;
+    }
+    int running;
+    curl_multi_socket_action(multi, socket, flags, &running);
+    complete_requests();
+}
+
+void HTTPWriter::complete_requests() {
+    // Called with the lock held
+    CURLMsg* message;
+    int queued;
+    while ((message = curl_multi_info_read(multi, &queued)) != nullptr) {
+        if (message->msg != CURLMSG_DONE) {
+            continue;
+        }
+        CURL* curl = message->easy_handle;
+        CURLcode result = message->data.result;
+        Request* request = nullptr;
+        curl_easy_getinfo(curl, CURLINFO_PRIVATE, &request);
+        if (result == CURLE_OK) {
+            count_write(request->size);
+            trace_written(request->topic, request->data);
+        }
+        else {
+            count_error();
+            RTDATA_LOG(WARNING) << "[HTTPWriter] POST to " << url << " failed: " << curl_easy_strerror(result);
+        }
+        curl_multi_remove_handle(multi, curl);
+        curl_easy_cleanup(curl);
+        delete request;
+        --in_flight;
+    }
+    completed.notify_all();
 }
 
 void HTTPWriter::close() {
+    if (reactor != nullptr) {
+        detach();
+    }
     curl_count--;
     if (curl_init && curl_count == 0) {
         curl_global_cleanup();
@@ -74,5 +246,8 @@ bool HTTPWriter::is_closed() {
 }
 
 void HTTPWriter::flush() {
-
+    std::unique_lock<std::mutex> lck(mtx);
+    completed.wait(lck, [this]() {
+        return in_flight == 0;
+    });
 }
\ No newline at end of file
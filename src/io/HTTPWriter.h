@@ -21,15 +21,22 @@
 #include "Writer.h"
 #include "../serialization/Serializer.h"
 #include "../serialization/JSONObject.h"
+#include "../concurrent/Reactor.h"
 
 #include <nlohmann/json.hpp>
 #include <curl/curl.h>
 
 #include <mutex>
 #include <atomic>
+#include <condition_variable>
 
 /**
  * Class to send Data objects to HTTP endpoints using POST requests formatted in JSON
+ *
+ * By default write() blocks until the request completes. Once attached to a
+ * Reactor, the requests go through a cURL multi handle driven by the reactor:
+ * write() starts the request and returns, and many requests can be in flight
+ * on a single thread. Failed requests are then counted and logged, not thrown.
  */
 class HTTPWriter : public Writer {
 
@@ -90,12 +97,52 @@ public:
     virtual bool is_closed();
 
     /**
-     * Does nothing
+     * Wait until the requests in flight complete. Does nothing if not attached to a Reactor.
      */
     virtual void flush();
 
+    /**
+     * Send the requests through a Reactor instead of blocking in write()
+     * @param reactor The reactor, usually Reactor::get_shared()
+     * @param max_in_flight The maximum number of requests in flight. write() throws when it is reached.
+     * @throws std::runtime_error If the HTTPWriter is not open, is already attached or cURL fails
+     */
+    void attach(Reactor& reactor, std::size_t max_in_flight = DEFAULT_MAX_IN_FLIGHT);
+
+    /**
+     * Wait until the requests in flight complete and go back to blocking writes
+     */
+    void detach();
+
+    /**
+     * Get the number of requests in flight
+     * @returns The number of requests not completed yet
+     */
+    std::size_t get_in_flight();
+
+    /**
+     * Default maximum number of requests in flight of an attached HTTPWriter
+     */
+    static const std::size_t DEFAULT_MAX_IN_FLIGHT = 64;
+
 private:
 
+    struct Request {
+        std::string topic;
+        std::shared_ptr<Data> data;
+        std::size_t size;
+    };
+
+    static int on_socket(CURL* easy, curl_socket_t socket, int what, void* writer, void* assigned);
+
+    static int on_timer(CURLM* multi, long timeout_millis, void* writer);
+
+    void start_request(const std::string& topic, std::shared_ptr<Data> data, const std::string& body);
+
+    void perform(curl_socket_t socket, int flags);
+
+    void complete_requests();
+
     static std::atomic<bool> curl_init;
 
     static std::atomic<unsigned int> curl_count;
@@ -108,4 +155,18 @@ private:
 
     bool isopen;
 
+    Reactor* reactor = nullptr;
+
+    CURLM* multi = nullptr;
+
+    curl_slist* headers = nullptr;
+
+    int timer = -1;
+
+    std::size_t in_flight = 0;
+
+    std::size_t max_in_flight = DEFAULT_MAX_IN_FLIGHT;
+
+    std::condition_variable completed;
+
 };
\ No newline at end of file
@@ -92,6 +92,88 @@ void I2C::write(uint8_t address, const std::vector<uint8_t>& buffer) {
     }
 }
 
+void I2C::transfer(I2CTransaction& transaction) {
+    if (!started) {
+        throw std::runtime_error("I2C port is not open");
+    }
+    if (transaction.size() == 0) {
+        return;
+    }
+    i2c_rdwr_ioctl_data data;
+    data.msgs = transaction.get_messages();
+    data.nmsgs = transaction.size();
+    int ret = ioctl(fd, I2C_RDWR, &data);
+    if (ret < 0) {
+        throw std::runtime_error(strerror(errno));
+    }
+}
+
+#ifdef WITH_COROUTINES
+async::Task<void> I2C::transfer_async(I2CTransaction& transaction, ThreadPool& pool) {
+    co_await async::schedule_on(pool);
+    transfer(transaction);
+}
+#endif
+
+void I2C::read_registers(uint8_t address, uint8_t reg, uint8_t* out, size_t size) {
+    if (!started) {
+        throw std::runtime_error("I2C port is not open");
+    }
+    if (size > UINT16_MAX) {
+        throw std::invalid_argument("I2C message too long");
+    }
+    i2c_msg messages[2];
+    messages[0].addr = address;
+    messages[0].flags = 0;
+    messages[0].len = 1;
+    messages[0].buf = &reg;
+    messages[1].addr = address;
+    messages[1].flags = I2C_M_RD;
+    messages[1].len = (uint16_t)size;
+    messages[1].buf = out;
+    i2c_rdwr_ioctl_data data;
+    data.msgs = messages;
+    data.nmsgs = 2;
+    int ret = ioctl(fd, I2C_RDWR, &data);
+    if (ret < 0) {
+        throw std::runtime_error(strerror(errno));
+    }
+}
+
+size_t I2C::read_block(uint8_t address, uint8_t command, std::vector<uint8_t>& out) {
+    i2c_smbus_data data;
+    smbus_read(address, command, I2C_SMBUS_BLOCK_DATA, data);
+    size_t size = data.block[0] <= I2C_SMBUS_BLOCK_MAX ? data.block[0] : I2C_SMBUS_BLOCK_MAX;
+    out.assign(data.block + 1, data.block + 1 + size);
+    return size;
+}
+
+void I2C::read_i2c_block(uint8_t address, uint8_t command, uint8_t* out, size_t size) {
+    if (size > I2C_SMBUS_BLOCK_MAX) {
+        throw std::invalid_argument("I2C block too long");
+    }
+    i2c_smbus_data data;
+    data.block[0] = size;
+    smbus_read(address, command, I2C_SMBUS_I2C_BLOCK_DATA, data);
+    std::memcpy(out, data.block + 1, size);
+}
+
+void I2C::smbus_read(uint8_t address, uint8_t command, uint32_t size, i2c_smbus_data& data) {
+    if (!started) {
+        throw std::runtime_error("I2C port is not open");
+    }
+    this->set_address(address);
+    i2c_smbus_ioctl_data request;
+    request.read_write = I2C_SMBUS_READ;
+    request.command = command;
+    request.size = size;
+    request.data = &data;
+    int ret = ioctl(fd, I2C_SMBUS, &request);
+    if (ret < 0) {
+        throw std::runtime_error(strerror(errno));
+    }
+}
+
 void I2C::set_address(uint8_t address) {
     if (this->address != address || !address_set) {
         int ret = ioctl(fd, I2C_SLAVE, address);
@@ -25,11 +25,18 @@
 #include <cstring>
 
 #include <fcntl.h>
+#include <linux/i2c.h>
 #include <linux/i2c-dev.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
 #include <errno.h>
 
+#include "I2CTransaction.h"
+
+#ifdef WITH_COROUTINES
+#include "../concurrent/Coroutine.h"
+#endif
+
 /**
  * \class I2C
  * 
@@ -51,6 +58,11 @@
  * end of the word) is completely implementation-dependant. Check the manual of
  * your board and/or sensor.
  * 
+ * read() and write() select the device with I2C_SLAVE and then use plain
+ * read/write calls. transfer() submits many messages, to one or several
+ * devices, in a single atomic I2C_RDWR ioctl (see I2CTransaction), and
+ * read_registers() is a register read in one ioctl.
+ * 
  */
 class I2C {
 
@@ -125,6 +137,63 @@ public:
      */
     void write(uint8_t address, const std::vector<uint8_t>& buffer);
 
+    /**
+     * Submit all the messages of a transaction in a single I2C_RDWR ioctl.
+     * The bytes read are stored in the buffers given when the transaction was built.
+     * @param transaction The messages to transfer
+     * @throws std::runtime_error If the port is not open
+     * @throws std::runtime_error If an error occurred during the transfer
+     */
+    void transfer(I2CTransaction& transaction);
+
+#ifdef WITH_COROUTINES
+    /**
+     * Submit all the messages of a transaction from a coroutine. The ioctl blocks
+     * until the bus is done, so it runs in a worker of the pool, where the
+     * coroutine continues.
+     * @param transaction The messages to transfer. Must live until the task completes.
+     * @param pool The pool where the transfer runs
+     * @returns The task of the transfer
+     * @throws std::runtime_error If the port is not open or an error occurred during the transfer
+     */
+    async::Task<void> transfer_async(I2CTransaction& transaction, ThreadPool& pool);
+#endif
+
+    /**
+     * Read consecutive registers: write the address of the first register and read
+     * `size` bytes, with a repeated start, in a single ioctl
+     * @param address A 7-bit address of the device
+     * @param reg The address of the first register
+     * @param out The output buffer, at least `size` bytes long
+     * @param size The number of bytes to read
+     * @throws std::runtime_error If the port is not open
+     * @throws std::runtime_error If an error occurred while reading the port
+     */
+    void read_registers(uint8_t address, uint8_t reg, uint8_t* out, size_t size);
+
+    /**
+     * SMBus block read: the device sends the length of the block (at most 32 bytes) before the data
+     * @param address A 7-bit address of the device
+     * @param command The command (register) to read
+     * @param out Replaced with the block
+     * @returns The length of the block
+     * @throws std::runtime_error If the port is not open
+     * @throws std::runtime_error If an error occurred while reading the port
+     */
+    size_t read_block(uint8_t address, uint8_t command, std::vector<uint8_t>& out);
+
+    /**
+     * I2C block read through the SMBus interface, for devices that do not send the length of the block
+     * @param address A 7-bit address of the device
+     * @param command The command (register) to read
+     * @param out The output buffer, at least `size` bytes long
+     * @param size The number of bytes to read, at most 32
+     * @throws std::invalid_argument If the size is greater than 32
+     * @throws std::runtime_error If the port is not open
+     * @throws std::runtime_error If an error occurred while reading the port
+     */
+    void read_i2c_block(uint8_t address, uint8_t command, uint8_t* out, size_t size);
+
     /**
      * Is the bus open (available for reading and writing)?
      * @returns Whether or not the bus is open
@@ -155,4 +224,6 @@ private:
 
     void set_address(uint8_t address);
 
+    void smbus_read(uint8_t address, uint8_t command, uint32_t size, i2c_smbus_data& data);
+
 };
\ No newline at end of file
@@ -0,0 +1,84 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "I2CTransaction.h"
+
+#include <stdexcept>
+
+const std::size_t I2CTransaction::MAX_MESSAGES;
+const std::size_t I2CTransaction::NO_DATA;
+
+void I2CTransaction::add(uint8_t address, uint16_t flags, uint8_t* out, std::size_t size) {
+    if (messages.size() >= MAX_MESSAGES) {
+        throw std::invalid_argument("Too many messages in the I2C transaction");
+    }
+    if (size > UINT16_MAX) {
+        throw std::invalid_argument("I2C message too long");
+    }
+    i2c_msg message;
+    message.addr = address;
+    message.flags = flags;
+    message.len = (uint16_t)size;
+    message.buf = out;
+    messages.push_back(message);
+}
+
+I2CTransaction& I2CTransaction::write(uint8_t address, const uint8_t* bytes, std::size_t size) {
+    add(address, 0, nullptr, size);
+    offsets.push_back(data.size());
+    data.insert(data.end(), bytes, bytes + size);
+    return *this;
+}
+
+I2CTransaction& I2CTransaction::write(uint8_t address, std::initializer_list<uint8_t> bytes) {
+    return write(address, bytes.begin(), bytes.size());
+}
+
+I2CTransaction& I2CTransaction::read(uint8_t address, uint8_t* out, std::size_t size) {
+    add(address, I2C_M_RD, out, size);
+    offsets.push_back(NO_DATA);
+    return *this;
+}
+
+I2CTransaction& I2CTransaction::read_register(uint8_t address, uint8_t reg, uint8_t* out, std::size_t size) {
+    if (messages.size() + 2 > MAX_MESSAGES) {
+        throw std::invalid_argument("Too many messages in the I2C transaction");
+    }
+    write(address, &reg, 1);
+    return read(address, out, size);
+}
+
+void I2CTransaction::clear() {
+    messages.clear();
+    data.clear();
+    offsets.clear();
+}
+
+std::size_t I2CTransaction::size() const {
+    return messages.size();
+}
+
+i2c_msg* I2CTransaction::get_messages() {
+    // `data` may have been reallocated while the transaction was built
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+        if (offsets[i] != NO_DATA) {
+            messages[i].buf = data.data() + offsets[i];
+        }
+    }
+    return messages.data();
+}
@@ -0,0 +1,128 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#include <linux/i2c.h>
+
+/**
+ * \class I2CTransaction
+ *
+ * \brief A list of I2C messages submitted to the bus at once (see I2C::transfer())
+ *
+ * All the messages are sent in a single I2C_RDWR ioctl, with a repeated start
+ * between them and one stop at the end, so no other master can interleave its
+ * own messages. A register read is a write of the register address followed by
+ * a read, and several registers or devices can be polled in the same transaction.
+ *
+ * The bytes to write are copied into the transaction, and the bytes read are
+ * stored directly in the buffers given by the caller, which must stay valid
+ * until the transaction is transferred. A transaction can be built once and
+ * transferred any number of times, e.g. once per sample.
+ */
+class I2CTransaction {
+
+public:
+
+    /**
+     * Default constructor. Builds an empty transaction.
+     */
+    I2CTransaction() = default;
+
+    /**
+     * Add a write message
+     * @param address The 7-bit address of the device
+     * @param data The bytes to write. They are copied.
+     * @param size The number of bytes to write
+     * @returns This transaction
+     * @throws std::invalid_argument If the transaction is full or the message too long
+     */
+    I2CTransaction& write(uint8_t address, const uint8_t* data, std::size_t size);
+
+    /**
+     * Add a write message
+     * @param address The 7-bit address of the device
+     * @param bytes The bytes to write
+     * @returns This transaction
+     * @throws std::invalid_argument If the transaction is full or the message too long
+     */
+    I2CTransaction& write(uint8_t address, std::initializer_list<uint8_t> bytes);
+
+    /**
+     * Add a read message
+     * @param address The 7-bit address of the device
+     * @param out Where the bytes are stored when the transaction is transferred
+     * @param size The number of bytes to read
+     * @returns This transaction
+     * @throws std::invalid_argument If the transaction is full or the message too long
+     */
+    I2CTransaction& read(uint8_t address, uint8_t* out, std::size_t size);
+
+    /**
+     * Add a register read: the register address is written, then `size` bytes are read
+     * @param address The 7-bit address of the device
+     * @param reg The address of the first register
+     * @param out Where the bytes are stored when the transaction is transferred
+     * @param size The number of bytes to read
+     * @returns This transaction
+     * @throws std::invalid_argument If the transaction is full or the message too long
+     */
+    I2CTransaction& read_register(uint8_t address, uint8_t reg, uint8_t* out, std::size_t size);
+
+    /**
+     * Remove all the messages. The memory is kept to build the next transaction.
+     */
+    void clear();
+
+    /**
+     * Get the number of messages
+     * @returns The number of messages of the transaction
+     */
+    std::size_t size() const;
+
+    /**
+     * Get the messages, ready to be submitted with I2C_RDWR
+     * @returns The first message of the transaction
+     */
+    i2c_msg* get_messages();
+
+    /**
+     * Maximum number of messages of a transaction, as accepted by the kernel
+     */
+    static const std::size_t MAX_MESSAGES = 42;
+
+private:
+
+    void add(uint8_t address, uint16_t flags, uint8_t* out, std::size_t size);
+
+    std::vector<i2c_msg> messages;
+
+    // Bytes to write, referenced by offset in `offsets` until get_messages()
+    std::vector<uint8_t> data;
+
+    // Offset of the bytes to write of each message in `data`, NO_DATA for reads
+    std::vector<std::size_t> offsets;
+
+    static const std::size_t NO_DATA = (std::size_t)-1;
+
+};
@@ -0,0 +1,241 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "IIOBuffer.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+IIOBuffer::IIOBuffer(const std::string& device, const std::string& sysfs_root, const std::string& dev_root) :
+    device(device),
+    sysfs_path(sysfs_root + "/" + device),
+    dev_path(dev_root + "/" + device),
+    scan_size(0),
+    fd(-1) {
+
+}
+
+IIOBuffer::~IIOBuffer() {
+    try {
+        close();
+    }
+    catch (...) {
+        // Nothing we can do here...
+    }
+}
+
+std::string IIOBuffer::read_attribute(const std::string& path) {
+    std::ifstream in(path);
+    if (in.fail()) {
+        throw std::runtime_error("Cannot read " + path);
+    }
+    std::string value;
+    std::getline(in, value);
+    return value;
+}
+
+void IIOBuffer::write_attribute(const std::string& path, const std::string& value) {
+    std::ofstream out(path);
+    if (out.fail()) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    out << value;
+    out.flush();
+    if (out.fail()) {
+        throw std::runtime_error("Cannot write " + path);
+    }
+}
+
+void IIOBuffer::enable_channel(const std::string& channel) {
+    if (is_open()) {
+        throw std::runtime_error("Cannot enable a channel of an open IIOBuffer");
+    }
+    if (get_channel_position(channel) >= 0) {
+        return;
+    }
+    std::string base = sysfs_path + "/scan_elements/" + channel;
+    Channel enabled;
+    enabled.name = channel;
+    enabled.index = std::stoi(read_attribute(base + "_index"));
+    try {
+        enabled.type = parse_type(read_attribute(base + "_type"));
+    }
+    catch (const std::invalid_argument& ex) {
+        throw std::runtime_error("Unsupported format for channel " + channel + ": " + ex.what());
+    }
+    enabled.offset = 0;
+    write_attribute(base + "_en", "1");
+    channels.push_back(enabled);
+    layout();
+}
+
+void IIOBuffer::set_trigger(const std::string& trigger) {
+    write_attribute(sysfs_path + "/trigger/current_trigger", trigger);
+}
+
+void IIOBuffer::set_length(std::size_t length) {
+    write_attribute(sysfs_path + "/buffer/length", std::to_string(length));
+}
+
+void IIOBuffer::layout() {
+    std::sort(channels.begin(), channels.end(), [](const Channel& a, const Channel& b) {
+        return a.index < b.index;
+    });
+    // Each sample is aligned to its own size, the scan to the largest sample
+    std::size_t offset = 0;
+    std::size_t largest = 1;
+    for (auto& channel : channels) {
+        std::size_t bytes = channel.type.storage_bits / 8;
+        offset = (offset + bytes - 1) / bytes * bytes;
+        channel.offset = offset;
+        offset += bytes;
+        largest = std::max(largest, bytes);
+    }
+    scan_size = (offset + largest - 1) / largest * largest;
+}
+
+void IIOBuffer::open() {
+    if (is_open()) {
+        throw std::runtime_error("IIOBuffer already open");
+    }
+    if (channels.empty()) {
+        throw std::runtime_error("No channels enabled in " + device);
+    }
+    write_attribute(sysfs_path + "/buffer/enable", "1");
+    fd = ::open(dev_path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        int error = errno;
+        write_attribute(sysfs_path + "/buffer/enable", "0");
+        throw std::runtime_error("Cannot open " + dev_path + ": " + std::strerror(error));
+    }
+}
+
+void IIOBuffer::close() {
+    if (!is_open()) {
+        return;
+    }
+    ::close(fd);
+    fd = -1;
+    write_attribute(sysfs_path + "/buffer/enable", "0");
+}
+
+bool IIOBuffer::is_open() const {
+    return fd >= 0;
+}
+
+std::size_t IIOBuffer::read(int64_t* values, std::size_t max_scans) {
+    if (!is_open()) {
+        throw std::runtime_error("IIOBuffer must be open before reading");
+    }
+    if (scans.size() < max_scans * scan_size) {
+        scans.resize(max_scans * scan_size);
+    }
+    ssize_t ret = ::read(fd, scans.data(), max_scans * scan_size);
+    if (ret < 0) {
+        if (errno == EAGAIN || errno == EINTR) {
+            return 0;
+        }
+        throw std::runtime_error(std::strerror(errno));
+    }
+    // The kernel only returns whole scans
+    std::size_t count = ret / scan_size;
+    for (std::size_t scan = 0; scan < count; ++scan) {
+        const uint8_t* data = scans.data() + scan * scan_size;
+        for (std::size_t i = 0; i < channels.size(); ++i) {
+            values[scan * channels.size() + i] = decode(data + channels[i].offset, channels[i].type);
+        }
+    }
+    return count;
+}
+
+std::size_t IIOBuffer::get_channel_count() const {
+    return channels.size();
+}
+
+int IIOBuffer::get_channel_position(const std::string& channel) const {
+    for (std::size_t i = 0; i < channels.size(); ++i) {
+        if (channels[i].name == channel) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+std::size_t IIOBuffer::get_scan_size() const {
+    return scan_size;
+}
+
+int IIOBuffer::get_fd() const {
+    return fd;
+}
+
+IIOChannelType IIOBuffer::parse_type(const std::string& type) {
+    IIOChannelType result;
+    char endianness[3] = {0};
+    char sign = 0;
+    unsigned int shift = 0;
+    int fields = std::sscanf(type.c_str(), "%2s:%c%u/%u>>%u", endianness, &sign, &result.real_bits, &result.storage_bits, &shift);
+    if (fields < 4) {
+        throw std::invalid_argument(type);
+    }
+    if (std::strcmp(endianness, "be") == 0) {
+        result.big_endian = true;
+    }
+    else if (std::strcmp(endianness, "le") != 0) {
+        throw std::invalid_argument(type);
+    }
+    if (sign == 's' || sign == 'S') {
+        result.is_signed = true;
+    }
+    else if (sign != 'u' && sign != 'U') {
+        throw std::invalid_argument(type);
+    }
+    if (result.storage_bits != 8 && result.storage_bits != 16 && result.storage_bits != 32 && result.storage_bits != 64) {
+        throw std::invalid_argument(type);
+    }
+    if (result.real_bits == 0 || result.real_bits > result.storage_bits) {
+        throw std::invalid_argument(type);
+    }
+    result.shift = fields == 5 ? shift : 0;
+    return result;
+}
+
+int64_t IIOBuffer::decode(const uint8_t* data, const IIOChannelType& type) {
+    std::size_t bytes = type.storage_bits / 8;
+    uint64_t raw = 0;
+    for (std::size_t i = 0; i < bytes; ++i) {
+        std::size_t byte = type.big_endian ? i : bytes - 1 - i;
+        raw = (raw << 8) | data[byte];
+    }
+    raw >>= type.shift;
+    if (type.real_bits < 64) {
+        raw &= (1ULL << type.real_bits) - 1;
+        if (type.is_signed && (raw & (1ULL << (type.real_bits - 1)))) {
+            // Sign extension
+            raw |= ~((1ULL << type.real_bits) - 1);
+        }
+    }
+    return (int64_t)raw;
+}
@@ -0,0 +1,198 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Format of a channel in the IIO buffer, as described by its scan_elements/<channel>_type file
+ * (e.g. "le:s12/16>>4")
+ */
+struct IIOChannelType {
+    // Whether the samples are big endian
+    bool big_endian = false;
+    // Whether the samples are signed
+    bool is_signed = false;
+    // Bits with data
+    unsigned int real_bits = 0;
+    // Bits used to store a sample (8, 16, 32 or 64)
+    unsigned int storage_bits = 0;
+    // Right shift to apply to the stored value
+    unsigned int shift = 0;
+};
+
+/**
+ * \class IIOBuffer
+ *
+ * \brief Reads samples in bulk from the buffered interface of a Linux IIO device
+ *
+ * The sysfs interface of IIO (in_voltageX_raw) returns one sample per read() syscall.
+ * The buffered interface (/dev/iio:deviceN) returns as many scans (one sample of every
+ * enabled channel) as available, captured by the kernel at the rate of a trigger.
+ *
+ * Usage: enable the channels, optionally set the trigger and the length, then open().
+ * Every read() returns the available scans without blocking; the file descriptor can be
+ * polled for new data.
+ */
+class IIOBuffer {
+
+public:
+
+    /**
+     * Build a buffer for a device
+     * @param device The name of the device (e.g. "iio:device0")
+     * @param sysfs_root Where the IIO devices are in sysfs (optional)
+     * @param dev_root Where the device files are (optional)
+     */
+    explicit IIOBuffer(const std::string& device,
+        const std::string& sysfs_root = "/sys/bus/iio/devices",
+        const std::string& dev_root = "/dev");
+
+    /**
+     * Destructor. Closes the buffer if it is open.
+     */
+    ~IIOBuffer();
+
+    // Do not allow copy or assignment.
+
+    IIOBuffer(const IIOBuffer&) = delete;
+
+    IIOBuffer& operator=(const IIOBuffer&) = delete;
+
+    /**
+     * Enable a channel. The channels are returned in the order of their scan index.
+     * @param channel The name of the channel (e.g. "in_voltage0", "in_timestamp")
+     * @throws std::runtime_error If the channel cannot be enabled or its format is not supported
+     */
+    void enable_channel(const std::string& channel);
+
+    /**
+     * Set the trigger of the device
+     * @param trigger The name of the trigger (e.g. "trigger0" or a hrtimer name)
+     * @throws std::runtime_error If the trigger cannot be set
+     */
+    void set_trigger(const std::string& trigger);
+
+    /**
+     * Set the length of the kernel buffer, in scans
+     * @param length The number of scans the kernel can hold
+     */
+    void set_length(std::size_t length);
+
+    /**
+     * Enable the buffer and open the device
+     * @throws std::runtime_error If the buffer cannot be enabled or the device opened
+     */
+    void open();
+
+    /**
+     * Close the device and disable the buffer
+     */
+    void close();
+
+    /**
+     * Is the buffer open?
+     * @returns Whether the buffer is open or not
+     */
+    bool is_open() const;
+
+    /**
+     * Read the available scans. Never blocks.
+     * @param values Where the samples are stored: scan by scan, one value per enabled channel.
+     *      The values are sign-extended and shifted.
+     * @param max_scans The maximum number of scans to read. values must hold max_scans * get_channel_count() values.
+     * @returns The number of scans read (0 if there was no data)
+     * @throws std::runtime_error If the buffer is not open or the read fails
+     */
+    std::size_t read(int64_t* values, std::size_t max_scans);
+
+    /**
+     * Get the number of enabled channels
+     * @returns The number of values per scan
+     */
+    std::size_t get_channel_count() const;
+
+    /**
+     * Get the position of a channel in the scans
+     * @param channel The name of the channel
+     * @returns The position of the channel, -1 if it is not enabled
+     */
+    int get_channel_position(const std::string& channel) const;
+
+    /**
+     * Get the size of a scan
+     * @returns The bytes per scan
+     */
+    std::size_t get_scan_size() const;
+
+    /**
+     * Get the file descriptor of the device, to poll it
+     * @returns The file descriptor, -1 if the buffer is not open
+     */
+    int get_fd() const;
+
+    /**
+     * Parse the format of a channel
+     * @param type The content of a _type file (e.g. "le:s12/16>>4")
+     * @returns The format
+     * @throws std::invalid_argument If the format cannot be parsed
+     */
+    static IIOChannelType parse_type(const std::string& type);
+
+    /**
+     * Decode a sample
+     * @param data The stored sample
+     * @param type The format of the sample
+     * @returns The value of the sample
+     */
+    static int64_t decode(const uint8_t* data, const IIOChannelType& type);
+
+private:
+
+    struct Channel {
+        std::string name;
+        int index;
+        IIOChannelType type;
+        std::size_t offset;
+    };
+
+    void layout();
+
+    std::string read_attribute(const std::string& path);
+
+    void write_attribute(const std::string& path, const std::string& value);
+
+    std::string device;
+
+    std::string sysfs_path;
+
+    std::string dev_path;
+
+    std::vector<Channel> channels;
+
+    std::vector<uint8_t> scans;
+
+    std::size_t scan_size;
+
+    int fd;
+
+};
@@ -171,6 +171,38 @@ void SPI::transfer(const std::vector<uint8_t>& to_send, std::vector<uint8_t>& to
     }
 }
 
+void SPI::transfer(const uint8_t* to_send, uint8_t* to_receive, size_t size) {
+    if (!started) {
+        throw std::runtime_error("SPI port is not open");
+    }
+
+    spi_ioc_transfer spi_transfer;
+    memset(&spi_transfer, 0, sizeof(spi_transfer));
+
+    spi_transfer.tx_buf = (unsigned long)to_send;
+    spi_transfer.rx_buf = (unsigned long)to_receive;
+    spi_transfer.len = size;
+
+    int ret = ioctl(fd, SPI_IOC_MESSAGE(1), &spi_transfer);
+    if (ret < 0) {
+        throw std::runtime_error(strerror(errno));
+    }
+}
+
+void SPI::transfer(SPITransaction& transaction) {
+    if (!started) {
+        throw std::runtime_error("SPI port is not open");
+    }
+    if (transaction.size() == 0) {
+        return;
+    }
+
+    int ret = ioctl(fd, SPI_IOC_MESSAGE(transaction.size()), transaction.get_segments());
+    if (ret < 0) {
+        throw std::runtime_error(strerror(errno));
+    }
+}
+
 bool SPI::is_open() {
     return started;
 }
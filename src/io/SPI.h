@@ -27,6 +27,8 @@
 #include <sys/ioctl.h>
 #include <linux/spi/spidev.h>
 
+#include "SPITransaction.h"
+
 /*
  * The mode of operation of the SPI port 
  * c.f. https://en.wikipedia.org/wiki/Serial_Peripheral_Interface#Mode_numbers
@@ -58,7 +60,8 @@ enum SPIMode {
  * you are also receiving a byte from the slave.
  * 
  * You can perform regular half-duplex reads and writes, and also a full-duplex
- * transaction using the transfer() method.
+ * transaction using the transfer() method. A SPITransaction chains many segments
+ * (e.g. one conversion per ADC channel) into a single ioctl.
  * 
  * SPI has 4 modes of operation (from 0 to 3), each mode regulates how the chip-select,
  * clock, ... work. By default it's mode 0. Unless you need to change it, don't change it.
@@ -175,6 +178,24 @@ public:
      */
     void transfer(const std::vector<uint8_t>& to_send, std::vector<uint8_t>& to_receive, size_t size);
 
+    /**
+     * Make a full-duplex communication with the slave device over caller buffers
+     * @param to_send The bytes to be sent to the slave, at least `size` bytes
+     * @param to_receive The buffer that will hold the received bytes, at least `size` bytes
+     * @param size The number of bytes to transfer
+     * @throws std::runtime_error If the transfer fails
+     * @throws std::runtime_error If the port is not open
+     */
+    void transfer(const uint8_t* to_send, uint8_t* to_receive, size_t size);
+
+    /**
+     * Submit all the segments of a transaction in a single ioctl
+     * @param transaction The segments to transfer
+     * @throws std::runtime_error If the transfer fails
+     * @throws std::runtime_error If the port is not open
+     */
+    void transfer(SPITransaction& transaction);
+
     /**
      * Is the SPI port open?
      * @returns Whether or not the SPI port is open
@@ -0,0 +1,79 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SPITransaction.h"
+
+#include <stdexcept>
+#include <cstring>
+
+const std::size_t SPITransaction::MAX_SEGMENTS;
+
+SPITransaction& SPITransaction::transfer(const uint8_t* to_send, uint8_t* to_receive, std::size_t size) {
+    if (segments.size() >= MAX_SEGMENTS) {
+        throw std::invalid_argument("Too many segments in the SPI transaction");
+    }
+    spi_ioc_transfer segment;
+    std::memset(&segment, 0, sizeof(segment));
+    segment.tx_buf = (unsigned long)to_send;
+    segment.rx_buf = (unsigned long)to_receive;
+    segment.len = size;
+    segments.push_back(segment);
+    return *this;
+}
+
+SPITransaction& SPITransaction::write(const uint8_t* to_send, std::size_t size) {
+    return transfer(to_send, nullptr, size);
+}
+
+SPITransaction& SPITransaction::read(uint8_t* to_receive, std::size_t size) {
+    return transfer(nullptr, to_receive, size);
+}
+
+spi_ioc_transfer& SPITransaction::last() {
+    if (segments.empty()) {
+        throw std::logic_error("The SPI transaction has no segments");
+    }
+    return segments.back();
+}
+
+SPITransaction& SPITransaction::cs_change() {
+    last().cs_change = 1;
+    return *this;
+}
+
+SPITransaction& SPITransaction::delay(uint16_t usecs) {
+    last().delay_usecs = usecs;
+    return *this;
+}
+
+SPITransaction& SPITransaction::speed(uint32_t hz) {
+    last().speed_hz = hz;
+    return *this;
+}
+
+void SPITransaction::clear() {
+    segments.clear();
+}
+
+std::size_t SPITransaction::size() const {
+    return segments.size();
+}
+
+spi_ioc_transfer* SPITransaction::get_segments() {
+    return segments.data();
+}
@@ -0,0 +1,132 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <linux/spi/spidev.h>
+
+/**
+ * \class SPITransaction
+ *
+ * \brief A chain of SPI segments submitted at once (see SPI::transfer())
+ *
+ * Every segment is a full-duplex transfer of `len` bytes between caller-provided
+ * buffers; either of them can be null for half-duplex segments. All the segments
+ * are submitted in a single SPI_IOC_MESSAGE ioctl. By default the chip select stays
+ * active for the whole transaction; cs_change() releases it after a segment, e.g.
+ * between the conversions of an ADC.
+ *
+ * No data is copied: the buffers must stay valid until the transaction is transferred.
+ * A transaction can be built once over pre-allocated buffers and transferred any
+ * number of times, e.g. once per scan sequence.
+ */
+class SPITransaction {
+
+public:
+
+    /**
+     * Default constructor. Builds an empty transaction.
+     */
+    SPITransaction() = default;
+
+    /**
+     * Add a full-duplex segment
+     * @param to_send The bytes to send, or nullptr to send zeros
+     * @param to_receive Where the received bytes are stored, or nullptr to drop them
+     * @param size The number of bytes of the segment
+     * @returns This transaction
+     * @throws std::invalid_argument If the transaction is full
+     */
+    SPITransaction& transfer(const uint8_t* to_send, uint8_t* to_receive, std::size_t size);
+
+    /**
+     * Add a write segment
+     * @param to_send The bytes to send
+     * @param size The number of bytes to send
+     * @returns This transaction
+     * @throws std::invalid_argument If the transaction is full
+     */
+    SPITransaction& write(const uint8_t* to_send, std::size_t size);
+
+    /**
+     * Add a read segment
+     * @param to_receive Where the received bytes are stored
+     * @param size The number of bytes to read
+     * @returns This transaction
+     * @throws std::invalid_argument If the transaction is full
+     */
+    SPITransaction& read(uint8_t* to_receive, std::size_t size);
+
+    /**
+     * Release the chip select after the last segment added, before the next one.
+     * On the last segment of the transaction it has the opposite effect: the chip
+     * select is kept active after the transaction.
+     * @returns This transaction
+     * @throws std::logic_error If the transaction is empty
+     */
+    SPITransaction& cs_change();
+
+    /**
+     * Wait after the last segment added, before the next one or before releasing the chip select
+     * @param usecs The delay in microseconds
+     * @returns This transaction
+     * @throws std::logic_error If the transaction is empty
+     */
+    SPITransaction& delay(uint16_t usecs);
+
+    /**
+     * Set the clock of the last segment added, instead of the speed of the port
+     * @param hz The clock frequency in Hz
+     * @returns This transaction
+     * @throws std::logic_error If the transaction is empty
+     */
+    SPITransaction& speed(uint32_t hz);
+
+    /**
+     * Remove all the segments. The memory is kept to build the next transaction.
+     */
+    void clear();
+
+    /**
+     * Get the number of segments
+     * @returns The number of segments of the transaction
+     */
+    std::size_t size() const;
+
+    /**
+     * Get the segments, ready to be submitted with SPI_IOC_MESSAGE
+     * @returns The first segment of the transaction
+     */
+    spi_ioc_transfer* get_segments();
+
+    /**
+     * Maximum number of segments of a transaction. The size of the ioctl argument is 14 bits wide.
+     */
+    static const std::size_t MAX_SEGMENTS = ((1 << _IOC_SIZEBITS) - 1) / sizeof(spi_ioc_transfer);
+
+private:
+
+    spi_ioc_transfer& last();
+
+    std::vector<spi_ioc_transfer> segments;
+
+};
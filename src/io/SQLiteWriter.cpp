@@ -30,6 +30,12 @@ void SQLiteWriter::open() {
         //We are saving disk space and some writes to disk
         db.exec("PRAGMA journal_mode = MEMORY");
     }
+    bind_metrics("sqlite", file);
+    MetricsRegistry& registry = MetricsRegistry::get_default();
+    std::string labels = MetricsRegistry::label("target", file);
+    buffered = &registry.gauge("rtdata_sqlite_buffered_rows", labels, "Rows waiting for the next flush");
+    flushes_total = &registry.counter("rtdata_sqlite_flushes_total", labels, "Transactions committed");
+    flush_duration = &registry.histogram("rtdata_sqlite_flush_duration_ns", labels, "Flush (transaction) time in nanoseconds");
     isopen = true;
 }
 
@@ -53,18 +59,26 @@ void SQLiteWriter::write(std::string topic, std::shared_ptr<Data> data) {
     std::unique_lock<std::mutex> lck(mtx);
     //The table name is a combination of the topic and the origin of the data
     //An origin is not expected to send different types of data to the same topic
-    std::ostringstream table_stream;
-    table_stream << topic << "_" << data->get_origin();
-    std::string table = table_stream.str();
-    SQLiteObject object(table);
+    std::unordered_map<OriginId, std::string>& topic_tables = tables[topic];
+    auto cached = topic_tables.find(data->get_origin_id());
+    bool known = cached != topic_tables.end();
+    SQLiteObject object(known ? cached->second : topic + "_" + data->get_origin());
     data->serialize(&object);
-    buffer.push_back(object);
-    if (!db.tableExists(table)) {
-        db.exec(object.get_create_table());
-    }
-    if (prepared_statements.find(table) == prepared_statements.end()) {
-        prepared_statements.emplace(table, SQLite::Statement(db, object.get_insert()));
+    if (!known) {
+        //First write of this origin to this topic: the table and its statement are set up once
+        std::string table = object.get_table();
+        if (!db.tableExists(table)) {
+            db.exec(object.get_create_table());
+        }
+        if (prepared_statements.find(table) == prepared_statements.end()) {
+            prepared_statements.emplace(table, SQLite::Statement(db, object.get_insert()));
+        }
+        topic_tables.emplace(data->get_origin_id(), table);
     }
+    buffer.push_back(std::move(object));
+    buffered->set(buffer.size());
+    count_write(0);
+    trace_written(topic, data);
     if (buffer.size() > buffer_size) {
         lck.unlock(); //Avoid deadlock
         flush();
@@ -74,15 +88,25 @@ void SQLiteWriter::write(std::string topic, std::shared_ptr<Data> data) {
 void SQLiteWriter::flush() {
     std::unique_lock<std::mutex> lck(mtx);
     std::string table;
-    SQLite::Transaction transaction(db);
-    for (auto& object : buffer) {
-        table = object.get_table();
-        object.bind_values(prepared_statements.at(table));
-        prepared_statements.at(table).exec();
-        prepared_statements.at(table).reset();
+    uint64_t start = Trace::now();
+    try {
+        SQLite::Transaction transaction(db);
+        for (auto& object : buffer) {
+            table = object.get_table();
+            object.bind_values(prepared_statements.at(table));
+            prepared_statements.at(table).exec();
+            prepared_statements.at(table).reset();
+        }
+        transaction.commit();
+    }
+    catch (const std::exception&) {
+        count_error();
+        throw;
     }
-    transaction.commit();
     buffer.clear();
+    buffered->set(0);
+    flushes_total->increment();
+    flush_duration->record(Trace::now() - start);
 }
 
 bool SQLiteWriter::is_open() {
@@ -150,4 +150,13 @@ private:
 
     std::unordered_map<std::string, SQLite::Statement> prepared_statements;
 
+    // Table name of each topic and origin
+    std::unordered_map<std::string, std::unordered_map<OriginId, std::string>> tables;
+
+    Gauge* buffered = nullptr;
+
+    Counter* flushes_total = nullptr;
+
+    LatencyHistogram* flush_duration = nullptr;
+
 };
\ No newline at end of file
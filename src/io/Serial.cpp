@@ -17,6 +17,12 @@
 */
 
 #include "Serial.h"
+#include "SerialBaud.h"
+#include "../Log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <linux/serial.h>
 
 void Serial::start() {
     tty_fd = open(file.c_str(), O_RDWR | O_NONBLOCK | O_NOCTTY | O_NDELAY );
@@ -29,8 +35,9 @@ void Serial::start() {
 
     cfmakeraw(&tty); // Set to raw-like mode (input is done char by char, no echoing, processing disabled). This initializes some of the flags.
     
-    cfsetospeed(&tty, baud_rate); // Set output baud rate
-    cfsetispeed(&tty, baud_rate); // Set input baud rate
+    speed_t speed = custom_baud_rate != 0 ? B38400 : baud_rate; // Custom rates are set below
+    cfsetospeed(&tty, speed); // Set output baud rate
+    cfsetispeed(&tty, speed); // Set input baud rate
 
     // Initialize flags
 
@@ -43,10 +50,18 @@ void Serial::start() {
     tty.c_oflag &= ~OPOST; // Disable output processing
 
     tty.c_cc[VMIN] = 0; // Minimum number of characters for reads -> 0
-    tty.c_cc[VTIME] = 100;	// Timeout for reads -> 10 seconds (100 deciseconds)
+    tty.c_cc[VTIME] = timeout;	// Timeout for reads, in deciseconds. By default 10 seconds.
 
     tcsetattr(tty_fd, TCSANOW, &tty); // Set the options
 
+    if (custom_baud_rate != 0 && !set_custom_baud_rate(tty_fd, custom_baud_rate)) {
+        close(tty_fd);
+        throw std::runtime_error("Could not set the baud rate of the serial port");
+    }
+    if (non_blocking) {
+        fcntl(tty_fd, F_SETFL, fcntl(tty_fd, F_GETFL) | O_NONBLOCK);
+    }
+
     int status;
     ioctl(tty_fd, TIOCMGET, &status);
     status |= TIOCM_DTR; // Data terminal ready
@@ -60,7 +75,9 @@ void Serial::stop() {
     if (!isopen) {
         throw std::runtime_error("Serial port is not open");
     }
+    detach();
     close(tty_fd);
+    ring.clear();
     isopen = false;
 }
 
@@ -69,6 +86,7 @@ void Serial::flush() {
         throw std::runtime_error("Serial port is not open");
     }
     tcflush(tty_fd, TCIOFLUSH);
+    ring.clear();
 }
 
 void Serial::send(const std::vector<uint8_t>& buffer) {
@@ -86,22 +104,177 @@ uint8_t Serial::receive() {
         throw std::runtime_error("Serial port is not open");
     }
     uint8_t res;
-    int read_count = read(tty_fd, &res, sizeof(uint8_t));
-    if (read_count < 0) {
-        throw std::runtime_error("Error while reading from serial port");
+    if (ring.read(&res, 1) == 1) {
+        return res;
+    }
+    if (read_some(&res, 1) == 0) {
+        throw std::runtime_error("Timeout while reading from serial port");
     }
     return res;
 }
 
-void Serial::receive(std::vector<uint8_t>& out, size_t size) {
+size_t Serial::receive(std::vector<uint8_t>& out, size_t size) {
     if (!isopen) {
         throw std::runtime_error("Serial port is not open");
     }
-    out.reserve(out.size() + size);
-    int read_count = read(tty_fd, out.data(), size * sizeof(uint8_t));
+    size_t start = out.size();
+    out.resize(start + size);
+    size_t received = ring.read(out.data() + start, size);
+    while (received < size) {
+        size_t read_count = read_some(out.data() + start + received, size - received);
+        if (read_count == 0) {
+            break;
+        }
+        received += read_count;
+    }
+    out.resize(start + received);
+    return received;
+}
+
+size_t Serial::read_some(uint8_t* buffer, size_t size) {
+    if (!isopen) {
+        throw std::runtime_error("Serial port is not open");
+    }
+    if (!ring.empty()) {
+        return ring.read(buffer, size);
+    }
+    ssize_t read_count = read(tty_fd, buffer, size);
     if (read_count < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return 0;
+        }
         throw std::runtime_error("Error while reading from serial port");
     }
+    return read_count;
+}
+
+int Serial::get_fd() {
+    return tty_fd;
+}
+
+void Serial::set_timeout(uint64_t millis) {
+    uint64_t deciseconds = (millis + 99) / 100;
+    if (deciseconds > 255) {
+        throw std::invalid_argument("Serial timeout too long");
+    }
+    timeout = (uint8_t)deciseconds;
+    if (isopen) {
+        tty.c_cc[VTIME] = timeout;
+        tcsetattr(tty_fd, TCSANOW, &tty);
+    }
+}
+
+void Serial::set_non_blocking(bool enabled) {
+    non_blocking = enabled;
+    if (isopen) {
+        int flags = fcntl(tty_fd, F_GETFL);
+        fcntl(tty_fd, F_SETFL, enabled ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+    }
+}
+
+bool Serial::set_low_latency(bool enabled) {
+    if (!isopen) {
+        throw std::runtime_error("Serial port is not open");
+    }
+    struct serial_struct serial;
+    if (ioctl(tty_fd, TIOCGSERIAL, &serial) < 0) {
+        return false;
+    }
+    if (enabled) {
+        serial.flags |= ASYNC_LOW_LATENCY;
+    }
+    else {
+        serial.flags &= ~ASYNC_LOW_LATENCY;
+    }
+    return ioctl(tty_fd, TIOCSSERIAL, &serial) == 0;
+}
+
+void Serial::set_receive_buffer_size(size_t size) {
+    ring = ByteRing(size);
+}
+
+size_t Serial::fill() {
+    if (!isopen) {
+        throw std::runtime_error("Serial port is not open");
+    }
+    size_t total = 0;
+    while (ring.size() < ring.capacity()) {
+        size_t free_space = ring.capacity() - ring.size();
+        ssize_t read_count = ring.read_from(tty_fd);
+        if (read_count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            throw std::runtime_error("Error while reading from serial port");
+        }
+        if (read_count == 0 && non_blocking) {
+            // Without data, a non-blocking read fails with EAGAIN: the port hung up
+            throw std::runtime_error("Serial port hung up");
+        }
+        total += read_count;
+        if ((size_t)read_count < free_space || !non_blocking) {
+            // The kernel buffer is drained, or a blocking read would wait
+            break;
+        }
+    }
+    return total;
+}
+
+bool Serial::extract_until(std::vector<uint8_t>& out, uint8_t delimiter) {
+    return ring.read_until(out, delimiter);
+}
+
+bool Serial::extract(std::vector<uint8_t>& out, size_t length) {
+    return ring.read_exact(out, length);
+}
+
+size_t Serial::available() const {
+    return ring.size();
+}
+
+bool Serial::is_receive_buffer_full() const {
+    return ring.size() == ring.capacity();
+}
+
+void Serial::discard(size_t size) {
+    ring.discard(std::min(size, ring.size()));
+}
+
+void Serial::attach(Reactor& reactor, ReceiveHandler handler) {
+    if (!isopen) {
+        throw std::runtime_error("Serial port is not open");
+    }
+    detach();
+    set_non_blocking(true);
+    reactor.add(tty_fd, Reactor::READABLE, [this, handler](uint32_t) {
+        try {
+            fill();
+        }
+        catch (std::runtime_error&) {
+            // Level-triggered: left registered, the port would be reported on every wait
+            detach();
+            throw;
+        }
+        if (ring.empty()) {
+            return;
+        }
+        handler(*this);
+        if (is_receive_buffer_full()) {
+            RTDATA_LOG(WARNING) << "[Serial] Receive ring of " << file << " full, " << ring.size() << " bytes dropped";
+            ring.clear();
+        }
+    });
+    this->reactor = &reactor;
+}
+
+void Serial::detach() {
+    if (reactor != nullptr) {
+        reactor->remove(tty_fd);
+        reactor = nullptr;
+    }
 }
 
 speed_t Serial::convert_baud_rate(const int baudRate) {
@@ -161,8 +334,11 @@ speed_t Serial::convert_baud_rate(const int baudRate) {
         case 4000000:
             res = B4000000;
             break;
-        default: 
-            throw std::invalid_argument("Unsuportted baud rate");
+        default:
+            if (baudRate <= 0) {
+                throw std::invalid_argument("Unsuportted baud rate");
+            }
+            res = B0; // Set with termios2 when the port is opened
             break;
     }
     return res;
@@ -22,11 +22,15 @@
 #include <vector>
 #include <string>
 #include <cstring>
+#include <functional>
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdexcept>
 #include <sys/ioctl.h>
 
+#include "ByteRing.h"
+#include "../concurrent/Reactor.h"
+
 enum Parity {
     NONE,
     EVEN,
@@ -35,18 +39,41 @@ enum Parity {
     SPACE // Parity bit present but not used, always set to 0
 };
 
+/**
+ * \class Serial
+ *
+ * \brief A serial port
+ *
+ * By default the port is blocking: reads wait up to the timeout (see set_timeout())
+ * for the first byte. In asynchronous mode (see attach()) the port is non-blocking
+ * and watched by a Reactor: when it becomes readable, everything the kernel has
+ * buffered is moved with a single read into a receive ring, from which framed
+ * messages are extracted without further system calls (see extract_until() and
+ * extract()). The blocking receive methods consume the ring first.
+ */
 class Serial {
 
 public:
 
+    /**
+     * Called when new bytes have been moved to the receive ring
+     */
+    typedef std::function<void(Serial&)> ReceiveHandler;
+
+    /**
+     * Default size of the receive ring, in bytes
+     */
+    static const std::size_t DEFAULT_RECEIVE_BUFFER_SIZE = 4096;
+
     /**
      * Full constructor
      * @param file The file that represents the serial stream to open
-     * @param baudRate The baud rate of the communication
+     * @param baudRate The baud rate of the communication. Rates without a termios
+     * constant are set with termios2 (BOTHER), if the driver supports them.
      * @param bits The lenght of a Character. 5, 6, 7 or 8 bits
      * @param parity The type of parity of the characters
      */
-    Serial(const std::string& file, int baudRate, int bits, Parity parity) : file(file), baud_rate(convert_baud_rate(baudRate)), bits(convert_bits(bits)), parity(convert_parity(parity)), isopen(false) {
+    Serial(const std::string& file, int baudRate, int bits, Parity parity) : file(file), baud_rate(convert_baud_rate(baudRate)), custom_baud_rate(baud_rate == B0 ? baudRate : 0), bits(convert_bits(bits)), parity(convert_parity(parity)), isopen(false), ring(DEFAULT_RECEIVE_BUFFER_SIZE) {
         start();
     }
 
@@ -100,15 +127,123 @@ public:
     /**
      * Receive a single byte from the serial port
      * @returns The received byte
+     * @throws std::runtime_error If nothing was received before the timeout
      */
     uint8_t receive();
 
     /**
-     * Receive `size` bytes from the serial port
+     * Receive `size` bytes from the serial port and append them to `out`
      * @param out An output vector where the bytes will be stored
      * @param size The ammount of bytes to be received
+     * @returns The number of bytes received. Less than `size` if the timeout expired
+     * or, in non-blocking mode, if no more bytes were available.
+     */
+    size_t receive(std::vector<uint8_t>& out, size_t size);
+
+    /**
+     * Receive the bytes already available, up to `size`, with a single read.
+     * Meant to be called when the port is readable (see get_fd()).
+     * @param buffer Where the received bytes are stored
+     * @param size The size of the buffer
+     * @returns The number of bytes received, 0 if there were none
+     * @throws std::runtime_error If the port is not open or cannot be read
+     */
+    size_t read_some(uint8_t* buffer, size_t size);
+
+    /**
+     * Get the file descriptor of the serial port, to watch it with a Reactor
+     * @returns The file descriptor of the serial port
+     */
+    int get_fd();
+
+    /**
+     * Set how long reads wait for the first byte in blocking mode (VTIME)
+     * @param millis The timeout in milliseconds, rounded up to tenths of a second. At most 25500.
+     * 0 makes reads return immediately.
+     * @throws std::invalid_argument If the timeout is too long
+     */
+    void set_timeout(uint64_t millis);
+
+    /**
+     * Enable or disable the non-blocking mode (O_NONBLOCK)
+     * @param enabled Whether reads and writes return immediately
+     */
+    void set_non_blocking(bool enabled);
+
+    /**
+     * Ask the driver to pass received bytes to the kernel without delay (ASYNC_LOW_LATENCY).
+     * Not all the drivers support it.
+     * @param enabled Whether the low latency mode is enabled
+     * @returns Whether the driver accepted the setting
+     */
+    bool set_low_latency(bool enabled);
+
+    /**
+     * Replace the receive ring. The bytes it held are dropped.
+     * @param size The minimum size of the ring in bytes
      */
-    void receive(std::vector<uint8_t>& out, size_t size);
+    void set_receive_buffer_size(size_t size);
+
+    /**
+     * Move the bytes buffered by the kernel to the receive ring. In non-blocking mode
+     * a single read is done, unless it fills the free space of the ring.
+     * @returns The number of bytes moved, 0 if there were none or the ring is full
+     * @throws std::runtime_error If the port is not open or cannot be read, or if it
+     *      hung up (in non-blocking mode)
+     */
+    size_t fill();
+
+    /**
+     * Extract a message ended by a delimiter from the receive ring
+     * @param out Replaced with the message, delimiter excluded
+     * @param delimiter The byte that ends messages
+     * @returns Whether a complete message was in the ring
+     */
+    bool extract_until(std::vector<uint8_t>& out, uint8_t delimiter);
+
+    /**
+     * Extract a message of a fixed length from the receive ring
+     * @param out Replaced with the message
+     * @param length The length of the message
+     * @returns Whether a complete message was in the ring
+     */
+    bool extract(std::vector<uint8_t>& out, size_t length);
+
+    /**
+     * Get the number of bytes in the receive ring
+     * @returns The number of bytes received and not extracted yet
+     */
+    size_t available() const;
+
+    /**
+     * Is the receive ring full? Then no byte is received until some are extracted or
+     * discarded, e.g. because a message is longer than the ring or lost its delimiter.
+     * @returns Whether the receive ring is full
+     */
+    bool is_receive_buffer_full() const;
+
+    /**
+     * Drop the oldest bytes of the receive ring
+     * @param size The number of bytes to drop. At most available() are dropped.
+     */
+    void discard(size_t size);
+
+    /**
+     * Switch to asynchronous mode: make the port non-blocking and watch it with a Reactor.
+     * When it is readable, the received bytes are moved to the ring (see fill()) and, if
+     * the ring is not empty, the handler is called from the thread running the reactor.
+     * If the handler leaves the ring full, the port would stall: its bytes are dropped.
+     * When the port cannot be read or hangs up, it is detached and the error is thrown
+     * by Reactor::run_once().
+     * @param reactor The reactor that watches the port. It must outlive the attachment.
+     * @param handler Called after new bytes have been moved to the receive ring
+     */
+    void attach(Reactor& reactor, ReceiveHandler handler);
+
+    /**
+     * Stop watching the port with the reactor it was attached to. The port stays non-blocking.
+     */
+    void detach();
 
     /**
      * Is the Serial port open?
@@ -138,6 +273,9 @@ private:
 
     speed_t baud_rate;
 
+    // Baud rate without a termios constant, 0 if baud_rate is standard
+    int custom_baud_rate;
+
     uint32_t bits, parity;
 
     termios tty;
@@ -146,4 +284,13 @@ private:
 
     bool isopen;
 
+    // Read timeout in tenths of a second
+    uint8_t timeout = 100;
+
+    bool non_blocking = false;
+
+    ByteRing ring;
+
+    Reactor* reactor = nullptr;
+
 };
\ No newline at end of file
@@ -0,0 +1,45 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SerialBaud.h"
+
+#include <asm/termbits.h>
+#include <asm/ioctls.h>
+#include <sys/ioctl.h>
+
+bool set_custom_baud_rate(int fd, int baud_rate) {
+    struct termios2 tty;
+    if (ioctl(fd, TCGETS2, &tty) < 0) {
+        return false;
+    }
+    tty.c_cflag &= ~CBAUD;
+    tty.c_cflag |= BOTHER;
+    tty.c_cflag &= ~(CBAUD << IBSHIFT);
+    tty.c_cflag |= BOTHER << IBSHIFT;
+    tty.c_ispeed = baud_rate;
+    tty.c_ospeed = baud_rate;
+    if (ioctl(fd, TCSETS2, &tty) < 0) {
+        return false;
+    }
+    // The driver may round the rate: check it is within 2%
+    if (ioctl(fd, TCGETS2, &tty) < 0) {
+        return false;
+    }
+    long error = (long)tty.c_ospeed - baud_rate;
+    return error * 50 <= baud_rate && -error * 50 <= baud_rate;
+}
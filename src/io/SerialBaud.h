@@ -0,0 +1,28 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/**
+ * Set a baud rate that has no termios constant (Bxxx) with termios2 and BOTHER.
+ * Kept apart from Serial because <asm/termbits.h> cannot be included with <termios.h>.
+ * @param fd The file descriptor of the serial port
+ * @param baud_rate The baud rate, in bits per second
+ * @returns Whether the driver accepted the baud rate
+ */
+bool set_custom_baud_rate(int fd, int baud_rate);
@@ -19,6 +19,10 @@
 #include "TCPWriter.h"
 #include "../Log.h"
 
+#include <fcntl.h>
+
+const std::size_t TCPWriter::DEFAULT_MAX_PENDING;
+
 void TCPWriter::open() {
     if (isopen) {
         throw std::runtime_error("TCPWriter already open");
@@ -39,6 +43,7 @@ void TCPWriter::open() {
     if (status < 0) {
         throw std::runtime_error(strerror(errno));
     }
+    bind_metrics("tcp", host + ":" + std::to_string(port));
     isopen = true;
 }
 
@@ -46,6 +51,14 @@ void TCPWriter::close() {
     if (!isopen) {
         throw std::runtime_error("TCPWriter already closed");
     }
+    if (reactor != nullptr) {
+        try {
+            detach();
+        }
+        catch (std::runtime_error& e) {
+            RTDATA_LOG(WARNING) << "[TCPWriter] " << e.what();
+        }
+    }
     std::unique_lock<std::mutex> lck(mtx);
     int status = ::close(socket_fd);
     if (status < 0) {
@@ -66,15 +79,24 @@ void TCPWriter::write(std::string topic, std::shared_ptr<Data> data) {
     ByteObject serialized(topic);
     data->serialize(&serialized);
     std::vector<uint8_t> bytes = serialized.get_bytes();
+    if (reactor != nullptr) {
+        queue(bytes);
+        count_write(bytes.size());
+        trace_written(topic, data);
+        return;
+    }
     ssize_t data_written = 0;
     ssize_t message_size = bytes.size();
     while (data_written < message_size) {
         ssize_t put = ::write(socket_fd, bytes.data() + data_written, message_size - data_written);
         if (put < 0) {
+            count_error();
             throw std::runtime_error(strerror(errno));
         }
         data_written += put;
     }
+    count_write(bytes.size());
+    trace_written(topic, data);
 }
 
 bool TCPWriter::is_open() {
@@ -86,5 +108,128 @@ bool TCPWriter::is_closed() {
 }
 
 void TCPWriter::flush() {
+    std::unique_lock<std::mutex> lck(mtx);
+    drained.wait(lck, [this]() {
+        return pending.empty() || !failure.empty();
+    });
+    if (!failure.empty()) {
+        throw std::runtime_error(failure);
+    }
+}
+
+void TCPWriter::attach(Reactor& reactor, std::size_t max_pending) {
+    if (!isopen) {
+        throw std::runtime_error("TCPWriter must be open before attaching it");
+    }
+    std::unique_lock<std::mutex> lck(mtx);
+    if (this->reactor != nullptr) {
+        throw std::runtime_error("TCPWriter already attached");
+    }
+    fcntl(socket_fd, F_SETFL, fcntl(socket_fd, F_GETFL) | O_NONBLOCK);
+    this->max_pending = max_pending;
+    failure.clear();
+    // Errors and hang-ups are always reported; writability only while bytes are queued
+    reactor.add(socket_fd, 0, [this](uint32_t events) {
+        std::unique_lock<std::mutex> lck(mtx);
+        if (this->reactor == nullptr || !failure.empty()) {
+            return;
+        }
+        if (pending.empty() && (events & (EPOLLERR | EPOLLHUP))) {
+            fail("Connection closed by the peer");
+            return;
+        }
+        send_pending();
+    });
+    this->reactor = &reactor;
+}
+
+void TCPWriter::detach() {
+    if (reactor == nullptr) {
+        return;
+    }
+    std::string error;
+    try {
+        flush();
+    }
+    catch (std::runtime_error& e) {
+        error = e.what();
+    }
+    std::unique_lock<std::mutex> lck(mtx);
+    Reactor* attached = reactor;
+    // The handler returns right away from now on
+    reactor = nullptr;
+    lck.unlock();
+    // Without the lock, which the handler may be waiting for
+    attached->remove(socket_fd);
+    lck.lock();
+    fcntl(socket_fd, F_SETFL, fcntl(socket_fd, F_GETFL) & ~O_NONBLOCK);
+    pending.clear();
+    pending_offset = 0;
+    failure.clear();
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+}
+
+std::size_t TCPWriter::get_pending() {
+    std::unique_lock<std::mutex> lck(mtx);
+    return pending.size() - pending_offset;
+}
+
+void TCPWriter::queue(const std::vector<uint8_t>& bytes) {
+    // Called with the lock held
+    if (!failure.empty()) {
+        count_error();
+        throw std::runtime_error(failure);
+    }
+    if (pending.size() - pending_offset + bytes.size() > max_pending) {
+        count_error();
+        throw std::runtime_error("TCPWriter send queue full");
+    }
+    if (pending_offset > pending.size() / 2) {
+        // Drop the sent prefix: under sustained load the queue never drains completely
+        pending.erase(pending.begin(), pending.begin() + pending_offset);
+        pending_offset = 0;
+    }
+    bool was_empty = pending.empty();
+    pending.insert(pending.end(), bytes.begin(), bytes.end());
+    if (was_empty) {
+        // Nothing queued: try to send right away, without a round trip through the reactor
+        send_pending();
+    }
+}
+
+void TCPWriter::send_pending() {
+    // Called with the lock held
+    while (pending_offset < pending.size()) {
+        ssize_t put = send(socket_fd, pending.data() + pending_offset, pending.size() - pending_offset, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (put < 0 && errno == EINTR) {
+            continue;
+        }
+        if (put < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            reactor->modify(socket_fd, Reactor::WRITABLE);
+            return;
+        }
+        if (put < 0) {
+            fail(strerror(errno));
+            return;
+        }
+        pending_offset += put;
+    }
+    pending.clear();
+    pending_offset = 0;
+    reactor->modify(socket_fd, 0);
+    drained.notify_all();
+}
 
+void TCPWriter::fail(const std::string& error) {
+    // Called with the lock held. Stop watching the socket, or its hang-up would be reported forever.
+    failure = error;
+    RTDATA_LOG(WARNING) << "[TCPWriter] Cannot send to " << host << ":" << port << ": " << failure;
+    count_error();
+    pending.clear();
+    pending_offset = 0;
+    // Not waiting for the handler, which takes the lock: detach() waits for it
+    reactor->remove(socket_fd, false);
+    drained.notify_all();
 }
\ No newline at end of file
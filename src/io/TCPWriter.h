@@ -16,13 +16,18 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#pragma once
+
 #include "Writer.h"
 #include "../Log.h"
 #include "../serialization/Serializer.h"
 #include "../serialization/ByteObject.h"
+#include "../concurrent/Reactor.h"
 
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <vector>
 
 #include <cstring>
 #include <sys/socket.h>
@@ -32,6 +37,10 @@
 
 /**
  * Class to send Data objects through a TCP socket
+ *
+ * By default write() blocks until the object is sent. Once attached to a
+ * Reactor, the socket is non-blocking: write() sends what the socket accepts
+ * and queues the rest, which the reactor sends when the socket is writable.
  */
 class TCPWriter : public Writer {
 
@@ -86,10 +95,36 @@ public:
     virtual void write(std::string topic, std::shared_ptr<Data> data);
 
     /**
-     * Does nothing
+     * Wait until the queued bytes are sent. Does nothing if not attached to a Reactor.
+     * @throws std::runtime_error If the connection failed while sending them
      */
     virtual void flush();
 
+    /**
+     * Send through a Reactor instead of blocking in write()
+     * @param reactor The reactor, usually Reactor::get_shared()
+     * @param max_pending The maximum number of queued bytes. write() throws when they do not fit.
+     * @throws std::runtime_error If the TCPWriter is not open or is already attached
+     */
+    void attach(Reactor& reactor, std::size_t max_pending = DEFAULT_MAX_PENDING);
+
+    /**
+     * Wait until the queued bytes are sent and go back to blocking writes
+     * @throws std::runtime_error If the connection failed while sending them
+     */
+    void detach();
+
+    /**
+     * Get the number of bytes waiting to be sent
+     * @returns The number of queued bytes
+     */
+    std::size_t get_pending();
+
+    /**
+     * Default maximum number of queued bytes of an attached TCPWriter
+     */
+    static const std::size_t DEFAULT_MAX_PENDING = 1 << 20;
+
     /**
      * Is the TCPWriter open?
      * @returns Whether or not the TCPWriter is open
@@ -104,6 +139,12 @@ public:
 
 private:
 
+    void queue(const std::vector<uint8_t>& bytes);
+
+    void send_pending();
+
+    void fail(const std::string& error);
+
     std::string host;
 
     int port;
@@ -116,4 +157,19 @@ private:
 
     Serializer serializer;
 
+    Reactor* reactor = nullptr;
+
+    std::size_t max_pending = DEFAULT_MAX_PENDING;
+
+    // Bytes not sent yet, from pending_offset. The sent prefix is dropped when it is
+    // more than half of the vector, so it holds at most about 2 * max_pending bytes.
+    std::vector<uint8_t> pending;
+
+    std::size_t pending_offset = 0;
+
+    std::condition_variable drained;
+
+    // The error that closed the connection while sending from the reactor
+    std::string failure;
+
 };
\ No newline at end of file
@@ -19,6 +19,12 @@
 #pragma once
 
 #include "../Data.h"
+#include "../metrics/TraceAggregator.h"
+#include "../metrics/MetricsRegistry.h"
+
+#ifdef WITH_COROUTINES
+#include "../concurrent/Coroutine.h"
+#endif
 
 /**
  * Interface to implement writters of Data objects.
@@ -68,4 +74,76 @@ public:
      */
     virtual bool is_closed() = 0;
 
+#ifdef WITH_COROUTINES
+    /**
+     * Write an object from a coroutine, without blocking the thread of the caller.
+     * The write runs in a worker of the pool, where the coroutine continues.
+     * @param pool The pool where the write runs
+     * @param topic The topic of the associated data
+     * @param data The Data object to write
+     * @returns The task of the write, which throws what write() throws
+     */
+    async::Task<void> write_async(ThreadPool& pool, std::string topic, std::shared_ptr<Data> data) {
+        co_await async::schedule_on(pool);
+        write(topic, data);
+    }
+#endif
+
+protected:
+
+    /**
+     * Stamp the written stage of a data trace and record its latency.
+     * Does nothing if tracing is disabled.
+     * @param topic The topic of the written data
+     * @param data The written data
+     */
+    void trace_written(const std::string& topic, const std::shared_ptr<Data>& data) {
+        if (Trace::is_enabled()) {
+            data->get_trace().mark(STAGE_WRITTEN);
+            TraceAggregator::get_default().record(topic, STAGE_WRITTEN, data->get_trace());
+        }
+    }
+
+    /**
+     * Look up the metrics of the writer in the default MetricsRegistry.
+     * Must be called before count_write() or count_error(), typically in open().
+     * @param kind The kind of writer (file, sqlite, tcp, http...)
+     * @param target Where the writer writes to (a path, an address...)
+     */
+    void bind_metrics(const std::string& kind, const std::string& target) {
+        MetricsRegistry& registry = MetricsRegistry::get_default();
+        std::string labels = MetricsRegistry::label("writer", kind) + "," + MetricsRegistry::label("target", target);
+        writes_total = &registry.counter("rtdata_writer_writes_total", labels, "Data objects written");
+        bytes_total = &registry.counter("rtdata_writer_bytes_total", labels, "Serialized bytes written");
+        errors_total = &registry.counter("rtdata_writer_errors_total", labels, "Failed writes");
+    }
+
+    /**
+     * Count a written object
+     * @param bytes The size of the serialized object, 0 if unknown
+     */
+    void count_write(std::size_t bytes) {
+        if (writes_total != nullptr) {
+            writes_total->increment();
+            bytes_total->increment(bytes);
+        }
+    }
+
+    /**
+     * Count a failed write
+     */
+    void count_error() {
+        if (errors_total != nullptr) {
+            errors_total->increment();
+        }
+    }
+
+private:
+
+    Counter* writes_total = nullptr;
+
+    Counter* bytes_total = nullptr;
+
+    Counter* errors_total = nullptr;
+
 };
\ No newline at end of file
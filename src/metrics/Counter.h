@@ -0,0 +1,99 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * \class Counter
+ *
+ * \brief A monotonically increasing counter sharded per thread
+ *
+ * Each thread increments its own cache-line aligned shard, so concurrent
+ * increments from different threads do not contend on the same cache line.
+ * Reading the value sums all the shards.
+ */
+class Counter {
+
+public:
+
+    /**
+     * Default constructor. The counter starts at 0.
+     */
+    Counter() = default;
+
+    // Do not allow copy or assignment.
+
+    Counter(const Counter&) = delete;
+
+    Counter& operator=(const Counter&) = delete;
+
+    /**
+     * Increment the counter
+     * @param n The amount to add (optional, default = 1)
+     */
+    void increment(uint64_t n = 1) {
+        shards[shard_index()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the value of the counter
+     * @returns The sum of all the increments
+     */
+    uint64_t get() const {
+        uint64_t total = 0;
+        for (std::size_t i = 0; i < SHARD_COUNT; ++i) {
+            total += shards[i].value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    /**
+     * Set the counter back to 0
+     */
+    void reset() {
+        for (std::size_t i = 0; i < SHARD_COUNT; ++i) {
+            shards[i].value.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    static const std::size_t SHARD_COUNT = 16;
+
+    /**
+     * Get the shard of the calling thread. Each thread is assigned one the first time
+     * it updates a sharded metric (a Counter or a LatencyHistogram).
+     * @returns An index lower than SHARD_COUNT
+     */
+    static std::size_t shard_index() {
+        static std::atomic<std::size_t> next_shard(0);
+        thread_local std::size_t index = next_shard.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+        return index;
+    }
+
+private:
+
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+
+    Shard shards[SHARD_COUNT];
+
+};
@@ -0,0 +1,82 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * \class Gauge
+ *
+ * \brief A value that can go up and down (queue depths, occupancy, ...)
+ */
+class Gauge {
+
+public:
+
+    /**
+     * Default constructor. The gauge starts at 0.
+     */
+    Gauge() : value(0) {
+
+    }
+
+    // Do not allow copy or assignment.
+
+    Gauge(const Gauge&) = delete;
+
+    Gauge& operator=(const Gauge&) = delete;
+
+    /**
+     * Set the value of the gauge
+     * @param value The new value
+     */
+    void set(int64_t value) {
+        this->value.store(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * Add to the value of the gauge
+     * @param n The amount to add (optional, default = 1)
+     */
+    void increment(int64_t n = 1) {
+        value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /**
+     * Substract from the value of the gauge
+     * @param n The amount to substract (optional, default = 1)
+     */
+    void decrement(int64_t n = 1) {
+        value.fetch_sub(n, std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the value of the gauge
+     * @returns The current value
+     */
+    int64_t get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+
+private:
+
+    std::atomic<int64_t> value;
+
+};
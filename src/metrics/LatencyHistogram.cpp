@@ -0,0 +1,134 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LatencyHistogram.h"
+
+#include <limits>
+
+const int LatencyHistogram::SUB_BUCKET_BITS;
+const std::size_t LatencyHistogram::SUB_BUCKET_COUNT;
+const int LatencyHistogram::MAX_SHIFT;
+const std::size_t LatencyHistogram::BUCKET_COUNT;
+
+std::size_t LatencyHistogram::bucket_index(uint64_t value) {
+    if (value < SUB_BUCKET_COUNT) {
+        return value;
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - SUB_BUCKET_BITS;
+    if (shift >= MAX_SHIFT) {
+        return BUCKET_COUNT - 1;
+    }
+    // (value >> shift) is in [SUB_BUCKET_COUNT, 2 * SUB_BUCKET_COUNT)
+    return (shift + 1) * SUB_BUCKET_COUNT + ((value >> shift) - SUB_BUCKET_COUNT);
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(std::size_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+    int shift = (int)(index / SUB_BUCKET_COUNT) - 1;
+    uint64_t sub_bucket = (index % SUB_BUCKET_COUNT) + SUB_BUCKET_COUNT;
+    return (sub_bucket << shift) + ((1ULL << shift) - 1);
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    Shard& shard = shards[Counter::shard_index()];
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+    uint64_t current = min.load(std::memory_order_relaxed);
+    while (value < current && !min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        ;
+    }
+    current = max.load(std::memory_order_relaxed);
+    while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        ;
+    }
+}
+
+uint64_t LatencyHistogram::get_count() const {
+    uint64_t total = 0;
+    for (const Shard& shard : shards) {
+        total += shard.count.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t LatencyHistogram::get_min() const {
+    if (get_count() == 0) {
+        return 0;
+    }
+    return min.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::get_max() const {
+    return max.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::get_mean() const {
+    uint64_t n = get_count();
+    if (n == 0) {
+        return 0.0;
+    }
+    return (double)get_sum() / (double)n;
+}
+
+uint64_t LatencyHistogram::get_sum() const {
+    uint64_t total = 0;
+    for (const Shard& shard : shards) {
+        total += shard.sum.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t LatencyHistogram::get_percentile(double percentile) const {
+    uint64_t total = get_count();
+    if (total == 0) {
+        return 0;
+    }
+    if (percentile > 100.0) {
+        percentile = 100.0;
+    }
+    uint64_t target = (uint64_t)((percentile / 100.0) * (double)total + 0.5);
+    if (target == 0) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            uint64_t value = bucket_upper_bound(i);
+            uint64_t largest = get_max();
+            return value < largest ? value : largest;
+        }
+    }
+    return get_max();
+}
+
+void LatencyHistogram::reset() {
+    for (std::size_t i = 0; i < BUCKET_COUNT; ++i) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+    for (Shard& shard : shards) {
+        shard.count.store(0, std::memory_order_relaxed);
+        shard.sum.store(0, std::memory_order_relaxed);
+    }
+    min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
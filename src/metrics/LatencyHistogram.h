@@ -0,0 +1,141 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#include "Counter.h"
+
+/**
+ * \class LatencyHistogram
+ *
+ * \brief A lock-free HDR-style histogram of nanosecond values
+ *
+ * Values are stored in log-linear buckets: every power of two is split in
+ * 32 linear sub-buckets, so any recorded value is reported with a relative
+ * error below ~3%. Values under 32 are exact. Values above 2^48 ns (~78 hours)
+ * are clamped into the last bucket.
+ *
+ * record() is wait-free (a few relaxed atomic increments) and can be called
+ * concurrently from any number of threads. The count and the sum, updated by
+ * every record(), are sharded per thread like a Counter; the buckets are shared,
+ * since sharding them would take 16 times the memory and threads recording
+ * different values already touch different cache lines.
+ */
+class LatencyHistogram {
+
+public:
+
+    /**
+     * Default constructor. Builds an empty histogram.
+     */
+    LatencyHistogram() {
+        reset();
+    }
+
+    // Do not allow copy or assignment.
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * Record a value
+     * @param value The value to record, typically nanoseconds
+     */
+    void record(uint64_t value);
+
+    /**
+     * Get the number of recorded values
+     * @returns The number of recorded values
+     */
+    uint64_t get_count() const;
+
+    /**
+     * Get the smallest recorded value
+     * @returns The smallest recorded value, 0 if the histogram is empty
+     */
+    uint64_t get_min() const;
+
+    /**
+     * Get the largest recorded value
+     * @returns The largest recorded value, 0 if the histogram is empty
+     */
+    uint64_t get_max() const;
+
+    /**
+     * Get the mean of the recorded values
+     * @returns The mean of the recorded values, 0 if the histogram is empty
+     */
+    double get_mean() const;
+
+    /**
+     * Get the sum of the recorded values
+     * @returns The sum of all the recorded values
+     */
+    uint64_t get_sum() const;
+
+    /**
+     * Get the value at a given percentile
+     * @param percentile A percentile between 0 and 100
+     * @returns The highest value equivalent to the bucket holding the percentile
+     */
+    uint64_t get_percentile(double percentile) const;
+
+    /**
+     * Clear all the recorded values
+     */
+    void reset();
+
+    /**
+     * Number of linear sub-buckets per power of two (in bits)
+     */
+    static const int SUB_BUCKET_BITS = 5;
+
+    static const std::size_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+
+    /**
+     * Largest power of two that has its own buckets
+     */
+    static const int MAX_SHIFT = 43;
+
+    static const std::size_t BUCKET_COUNT = (MAX_SHIFT + 1) * SUB_BUCKET_COUNT;
+
+private:
+
+    static std::size_t bucket_index(uint64_t value);
+
+    static uint64_t bucket_upper_bound(std::size_t index);
+
+    std::atomic<uint64_t> buckets[BUCKET_COUNT];
+
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sum;
+    };
+
+    Shard shards[Counter::SHARD_COUNT];
+
+    std::atomic<uint64_t> min;
+
+    std::atomic<uint64_t> max;
+
+};
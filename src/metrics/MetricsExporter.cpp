@@ -0,0 +1,280 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "MetricsExporter.h"
+#include "TraceAggregator.h"
+#include "../Log.h"
+#include "../concurrent/ThreadPlacement.h"
+
+#include <stdexcept>
+#include <sstream>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+MetricsExporter::MetricsExporter(MetricsRegistry& registry) : registry(registry),
+    period_millis(0),
+    http_port(-1),
+    unix_fd(-1),
+    http_fd(-1),
+    wakeup_fd(-1),
+    running(false) {
+
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+void MetricsExporter::export_to_file(const std::string& file, Duration period) {
+    if (running) {
+        throw std::runtime_error("Cannot configure a running MetricsExporter");
+    }
+    this->file = file;
+    this->period_millis = period.to_millis() > 0 ? period.to_millis() : 1;
+}
+
+void MetricsExporter::listen_unix(const std::string& path) {
+    if (running) {
+        throw std::runtime_error("Cannot configure a running MetricsExporter");
+    }
+    struct sockaddr_un addr;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::invalid_argument("Unix socket path too long: " + path);
+    }
+    this->unix_path = path;
+}
+
+void MetricsExporter::listen_http(uint16_t port) {
+    if (running) {
+        throw std::runtime_error("Cannot configure a running MetricsExporter");
+    }
+    this->http_port = port;
+}
+
+void MetricsExporter::start() {
+    if (running) {
+        throw std::runtime_error("Cannot start already running MetricsExporter");
+    }
+    try {
+        wakeup_fd = eventfd(0, EFD_CLOEXEC);
+        if (wakeup_fd < 0) {
+            throw std::runtime_error(std::strerror(errno));
+        }
+        if (!unix_path.empty()) {
+            unix_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (unix_fd < 0) {
+                throw std::runtime_error(std::strerror(errno));
+            }
+            struct sockaddr_un addr;
+            std::memset(&addr, 0, sizeof(addr));
+            addr.sun_family = AF_UNIX;
+            std::strncpy(addr.sun_path, unix_path.c_str(), sizeof(addr.sun_path) - 1);
+            unlink(unix_path.c_str());
+            if (bind(unix_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(unix_fd, 4) < 0) {
+                throw std::runtime_error("Cannot listen on " + unix_path + ": " + std::strerror(errno));
+            }
+        }
+        if (http_port >= 0) {
+            http_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (http_fd < 0) {
+                throw std::runtime_error(std::strerror(errno));
+            }
+            int reuse = 1;
+            setsockopt(http_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            struct sockaddr_in addr;
+            std::memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons((uint16_t)http_port);
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (bind(http_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(http_fd, 4) < 0) {
+                throw std::runtime_error("Cannot listen on port " + std::to_string(http_port) + ": " + std::strerror(errno));
+            }
+        }
+    }
+    catch (const std::runtime_error&) {
+        close_all();
+        throw;
+    }
+    running = true;
+    thread = Thread(&MetricsExporter::run, this);
+    ThreadPlacement::apply(thread, ROLE_IO, "metrics");
+}
+
+void MetricsExporter::stop() {
+    if (!running) {
+        return;
+    }
+    running = false;
+    uint64_t one = 1;
+    if (write(wakeup_fd, &one, sizeof(one)) < 0) {
+        RTDATA_LOG(WARNING) << "Cannot wake up the MetricsExporter: " << std::strerror(errno);
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+    close_all();
+}
+
+bool MetricsExporter::is_running() const {
+    return running;
+}
+
+void MetricsExporter::close_all() {
+    for (int* fd : {&unix_fd, &http_fd, &wakeup_fd}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+    if (!unix_path.empty()) {
+        unlink(unix_path.c_str());
+    }
+}
+
+void MetricsExporter::run() {
+    ThreadPlacement::prepare_current(ROLE_IO);
+    auto next_write = std::chrono::steady_clock::now();
+    while (running) {
+        int timeout = -1;
+        if (!file.empty()) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= next_write) {
+                write_file();
+                next_write = now + std::chrono::milliseconds(period_millis);
+            }
+            timeout = (int)std::chrono::duration_cast<std::chrono::milliseconds>(next_write - now).count();
+            if (timeout < 0) {
+                timeout = 0;
+            }
+        }
+        struct pollfd fds[3] = {
+            {wakeup_fd, POLLIN, 0},
+            {unix_fd, POLLIN, 0},
+            {http_fd, POLLIN, 0}
+        };
+        int ret = poll(fds, 3, timeout);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            RTDATA_LOG(WARNING) << "MetricsExporter poll failed: " << std::strerror(errno);
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            serve_unix();
+        }
+        if (fds[2].revents & POLLIN) {
+            serve_http();
+        }
+    }
+    if (!file.empty()) {
+        write_file();
+    }
+}
+
+void MetricsExporter::write_file() {
+    std::string tmp = file + ".tmp";
+    {
+        std::ofstream out(tmp, std::ofstream::out | std::ofstream::trunc);
+        if (out.fail()) {
+            RTDATA_LOG(WARNING) << "Cannot open metrics file " << tmp;
+            return;
+        }
+        registry.write_prometheus(out);
+    }
+    if (std::rename(tmp.c_str(), file.c_str()) < 0) {
+        RTDATA_LOG(WARNING) << "Cannot write metrics file " << file << ": " << std::strerror(errno);
+    }
+}
+
+static void send_all(int fd, const std::string& text) {
+    std::size_t sent = 0;
+    while (sent < text.size()) {
+        ssize_t ret = send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return;
+        }
+        sent += ret;
+    }
+}
+
+void MetricsExporter::serve_unix() {
+    int client = accept4(unix_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (client < 0) {
+        return;
+    }
+    send_all(client, registry.to_prometheus());
+    close(client);
+}
+
+void MetricsExporter::serve_http() {
+    int client = accept4(http_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (client < 0) {
+        return;
+    }
+    // Requests are tiny GETs, so waiting briefly for the first line is enough
+    struct pollfd pfd = {client, POLLIN, 0};
+    char buffer[1024];
+    ssize_t received = 0;
+    if (poll(&pfd, 1, 1000) > 0) {
+        received = recv(client, buffer, sizeof(buffer) - 1, 0);
+    }
+    if (received <= 0) {
+        close(client);
+        return;
+    }
+    buffer[received] = '\0';
+    std::string request(buffer);
+    std::string body;
+    std::string status = "200 OK";
+    if (request.compare(0, 4, "GET ") != 0) {
+        status = "405 Method Not Allowed";
+    }
+    else if (request.compare(4, 7, "/trace ") == 0) {
+        std::ostringstream out;
+        TraceAggregator::get_default().dump(out);
+        body = out.str();
+    }
+    else {
+        body = registry.to_prometheus();
+    }
+    std::ostringstream response;
+    response << "HTTP/1.0 " << status << "\r\n"
+             << "Content-Type: text/plain; version=0.0.4\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    send_all(client, response.str());
+    close(client);
+}
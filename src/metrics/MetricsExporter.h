@@ -0,0 +1,135 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+#include "MetricsRegistry.h"
+#include "../concurrent/Thread.h"
+#include "../time/Duration.h"
+
+/**
+ * \class MetricsExporter
+ *
+ * \brief Exports the metrics of a MetricsRegistry in the Prometheus text format
+ *
+ * Three outputs can be enabled, in any combination, before calling start():
+ *  - A file rewritten periodically (atomically, through a rename)
+ *  - A Unix socket: every client that connects receives the metrics and is disconnected
+ *  - An HTTP endpoint listening on 127.0.0.1. GET /metrics (or any other path) returns the
+ *    metrics, GET /trace returns the dump of the default TraceAggregator.
+ *
+ * All the outputs are served by a single low-priority thread.
+ */
+class MetricsExporter {
+
+public:
+
+    /**
+     * Build an exporter for a registry
+     * @param registry The registry to export. By default, the process-wide registry.
+     */
+    explicit MetricsExporter(MetricsRegistry& registry = MetricsRegistry::get_default());
+
+    /**
+     * Destructor. Stops the exporter if it is running.
+     */
+    ~MetricsExporter();
+
+    // Do not allow copy or assignment.
+
+    MetricsExporter(const MetricsExporter&) = delete;
+
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    /**
+     * Periodically write the metrics to a file
+     * @param file The path of the file
+     * @param period The time between writes
+     * @throws std::runtime_error If the exporter is running
+     */
+    void export_to_file(const std::string& file, Duration period);
+
+    /**
+     * Serve the metrics on a Unix socket
+     * @param path The path of the socket. An existing file in this path is replaced.
+     * @throws std::runtime_error If the exporter is running
+     */
+    void listen_unix(const std::string& path);
+
+    /**
+     * Serve the metrics over HTTP on the loopback interface
+     * @param port The TCP port
+     * @throws std::runtime_error If the exporter is running
+     */
+    void listen_http(uint16_t port);
+
+    /**
+     * Open the configured outputs and start exporting
+     * @throws std::runtime_error If the exporter is already running or an output cannot be opened
+     */
+    void start();
+
+    /**
+     * Stop exporting and close all the outputs
+     */
+    void stop();
+
+    /**
+     * Is the exporter running?
+     * @returns Whether the exporter is running or not
+     */
+    bool is_running() const;
+
+private:
+
+    void run();
+
+    void write_file();
+
+    void serve_unix();
+
+    void serve_http();
+
+    void close_all();
+
+    MetricsRegistry& registry;
+
+    std::string file;
+
+    uint64_t period_millis;
+
+    std::string unix_path;
+
+    int http_port;
+
+    int unix_fd;
+
+    int http_fd;
+
+    int wakeup_fd;
+
+    std::atomic<bool> running;
+
+    Thread thread;
+
+};
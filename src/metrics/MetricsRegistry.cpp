@@ -0,0 +1,146 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "MetricsRegistry.h"
+
+#include <sstream>
+#include <stdexcept>
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& labels, const std::string& help) {
+    std::unique_lock<std::mutex> lck(mtx);
+    auto& metric = get_family(name, COUNTER, help).counters[labels];
+    if (!metric) {
+        metric = std::make_unique<Counter>();
+    }
+    return *metric;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& labels, const std::string& help) {
+    std::unique_lock<std::mutex> lck(mtx);
+    auto& metric = get_family(name, GAUGE, help).gauges[labels];
+    if (!metric) {
+        metric = std::make_unique<Gauge>();
+    }
+    return *metric;
+}
+
+LatencyHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& labels, const std::string& help) {
+    std::unique_lock<std::mutex> lck(mtx);
+    auto& metric = get_family(name, HISTOGRAM, help).histograms[labels];
+    if (!metric) {
+        metric = std::make_unique<LatencyHistogram>();
+    }
+    return *metric;
+}
+
+MetricsRegistry::Family& MetricsRegistry::get_family(const std::string& name, MetricType type, const std::string& help) {
+    auto it = families.find(name);
+    if (it == families.end()) {
+        Family& family = families[name];
+        family.type = type;
+        family.help = help;
+        return family;
+    }
+    if (it->second.type != type) {
+        throw std::invalid_argument("Metric " + name + " already registered with another type");
+    }
+    if (it->second.help.empty()) {
+        it->second.help = help;
+    }
+    return it->second;
+}
+
+std::string MetricsRegistry::sample_name(const std::string& name, const std::string& labels, const std::string& extra_label) {
+    if (labels.empty() && extra_label.empty()) {
+        return name;
+    }
+    std::string result = name + "{" + labels;
+    if (!labels.empty() && !extra_label.empty()) {
+        result += ",";
+    }
+    return result + extra_label + "}";
+}
+
+void MetricsRegistry::write_prometheus(std::ostream& out) {
+    static const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+    std::unique_lock<std::mutex> lck(mtx);
+    for (auto& entry : families) {
+        const std::string& name = entry.first;
+        Family& family = entry.second;
+        if (!family.help.empty()) {
+            out << "# HELP " << name << " " << family.help << "\n";
+        }
+        switch (family.type) {
+            case COUNTER:
+                out << "# TYPE " << name << " counter\n";
+                for (auto& metric : family.counters) {
+                    out << sample_name(name, metric.first) << " " << metric.second->get() << "\n";
+                }
+                break;
+            case GAUGE:
+                out << "# TYPE " << name << " gauge\n";
+                for (auto& metric : family.gauges) {
+                    out << sample_name(name, metric.first) << " " << metric.second->get() << "\n";
+                }
+                break;
+            case HISTOGRAM:
+                out << "# TYPE " << name << " summary\n";
+                for (auto& metric : family.histograms) {
+                    for (double quantile : quantiles) {
+                        std::ostringstream quantile_label;
+                        quantile_label << "quantile=\"" << quantile << "\"";
+                        out << sample_name(name, metric.first, quantile_label.str()) << " "
+                            << metric.second->get_percentile(quantile * 100.0) << "\n";
+                    }
+                    out << sample_name(name + "_sum", metric.first) << " " << metric.second->get_sum() << "\n";
+                    out << sample_name(name + "_count", metric.first) << " " << metric.second->get_count() << "\n";
+                }
+                break;
+        }
+    }
+    out.flush();
+}
+
+std::string MetricsRegistry::to_prometheus() {
+    std::ostringstream out;
+    write_prometheus(out);
+    return out.str();
+}
+
+std::string MetricsRegistry::label(const std::string& key, const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            escaped.push_back('\\');
+            escaped.push_back(c);
+        }
+        else if (c == '\n') {
+            escaped += "\\n";
+        }
+        else {
+            escaped.push_back(c);
+        }
+    }
+    return key + "=\"" + escaped + "\"";
+}
+
+MetricsRegistry& MetricsRegistry::get_default() {
+    static MetricsRegistry registry;
+    return registry;
+}
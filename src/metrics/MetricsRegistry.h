@@ -0,0 +1,139 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+#include "Counter.h"
+#include "Gauge.h"
+#include "LatencyHistogram.h"
+
+/**
+ * \class MetricsRegistry
+ *
+ * \brief A registry of named runtime metrics
+ *
+ * Metrics are identified by a name and an optional set of labels in
+ * Prometheus syntax (e.g. `sensor="imu",topic="accel"`, see label()).
+ * Looking a metric up takes a lock, so components look their metrics up
+ * once and keep a pointer to them: updating a metric is lock-free.
+ *
+ * Metrics are never removed, so the returned references are valid
+ * as long as the registry.
+ */
+class MetricsRegistry {
+
+public:
+
+    /**
+     * Default constructor
+     */
+    MetricsRegistry() = default;
+
+    // Do not allow copy or assignment.
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    /**
+     * Get or create a counter
+     * @param name The name of the metric
+     * @param labels The labels of the metric (optional)
+     * @param help A description of the metric, used when it is created (optional)
+     * @returns The counter
+     * @throws std::invalid_argument If the name is already used by a metric of another type
+     */
+    Counter& counter(const std::string& name, const std::string& labels = "", const std::string& help = "");
+
+    /**
+     * Get or create a gauge
+     * @param name The name of the metric
+     * @param labels The labels of the metric (optional)
+     * @param help A description of the metric, used when it is created (optional)
+     * @returns The gauge
+     * @throws std::invalid_argument If the name is already used by a metric of another type
+     */
+    Gauge& gauge(const std::string& name, const std::string& labels = "", const std::string& help = "");
+
+    /**
+     * Get or create a histogram. Exported as a Prometheus summary.
+     * @param name The name of the metric
+     * @param labels The labels of the metric (optional)
+     * @param help A description of the metric, used when it is created (optional)
+     * @returns The histogram
+     * @throws std::invalid_argument If the name is already used by a metric of another type
+     */
+    LatencyHistogram& histogram(const std::string& name, const std::string& labels = "", const std::string& help = "");
+
+    /**
+     * Write all the metrics in the Prometheus text exposition format
+     * @param out The stream where the metrics are written
+     */
+    void write_prometheus(std::ostream& out);
+
+    /**
+     * Get all the metrics in the Prometheus text exposition format
+     * @returns The metrics as text
+     */
+    std::string to_prometheus();
+
+    /**
+     * Build a label
+     * @param key The name of the label
+     * @param value The value of the label. Quotes and backslashes are escaped.
+     * @returns A label in Prometheus syntax: key="value"
+     */
+    static std::string label(const std::string& key, const std::string& value);
+
+    /**
+     * Get the registry used by the framework components
+     * @returns The process-wide registry
+     */
+    static MetricsRegistry& get_default();
+
+private:
+
+    enum MetricType {
+        COUNTER,
+        GAUGE,
+        HISTOGRAM
+    };
+
+    struct Family {
+        MetricType type;
+        std::string help;
+        std::map<std::string, std::unique_ptr<Counter>> counters;
+        std::map<std::string, std::unique_ptr<Gauge>> gauges;
+        std::map<std::string, std::unique_ptr<LatencyHistogram>> histograms;
+    };
+
+    Family& get_family(const std::string& name, MetricType type, const std::string& help);
+
+    static std::string sample_name(const std::string& name, const std::string& labels, const std::string& extra_label = "");
+
+    std::map<std::string, Family> families;
+
+    std::mutex mtx;
+
+};
@@ -0,0 +1,67 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Trace.h"
+
+std::atomic<bool> Trace::enabled(false);
+
+uint64_t Trace::since_read(TraceStage stage) const {
+    uint64_t read = get(STAGE_READ);
+    uint64_t at = get(stage);
+    if (read == 0 || at == 0 || at < read) {
+        return 0;
+    }
+    return at - read;
+}
+
+void Trace::reset() {
+    for (int i = 0; i < STAGE_COUNT; ++i) {
+        stamps[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void Trace::copy(const Trace& other) {
+    for (int i = 0; i < STAGE_COUNT; ++i) {
+        stamps[i].store(other.stamps[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+void Trace::set_enabled(bool enable) {
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+const char* Trace::stage_name(TraceStage stage) {
+    switch (stage) {
+        case STAGE_READ:
+            return "read";
+        case STAGE_ENQUEUED:
+            return "enqueued";
+        case STAGE_FETCHED:
+            return "fetched";
+        case STAGE_DISPATCHED:
+            return "dispatched";
+        case STAGE_HANDLER_START:
+            return "handler_start";
+        case STAGE_HANDLER_END:
+            return "handler_end";
+        case STAGE_WRITTEN:
+            return "written";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,176 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <time.h>
+
+/**
+ * The stages a Data object goes through, from the moment it is read
+ * by a Sensor until a Writer persists it.
+ */
+enum TraceStage {
+    // The Data object was created by the sensor
+    STAGE_READ = 0,
+    // The sensor stored the Data in its internal queue
+    STAGE_ENQUEUED,
+    // The SensorsManager fetched the Data from the sensor
+    STAGE_FETCHED,
+    // The Broker dispatched the Data to the listeners of its topic
+    STAGE_DISPATCHED,
+    // A listener started handling the Data
+    STAGE_HANDLER_START,
+    // A listener finished handling the Data
+    STAGE_HANDLER_END,
+    // A Writer accepted the Data
+    STAGE_WRITTEN,
+    // Number of stages, not a stage
+    STAGE_COUNT
+};
+
+/**
+ * \class Trace
+ *
+ * \brief Per-stage timestamps attached to a Data object
+ *
+ * Each stage is stamped with a monotonic clock (CLOCK_MONOTONIC_RAW), so the
+ * values are only meaningful relative to each other. Tracing is disabled by
+ * default: when disabled, mark() is a single relaxed atomic load.
+ *
+ * A Data object can be handled by several listeners at the same time,
+ * so stamps are atomic and the last writer wins.
+ */
+class Trace {
+
+public:
+
+    /**
+     * Default constructor. No stage is stamped.
+     */
+    Trace() {
+        reset();
+    }
+
+    /**
+     * Copy constructor
+     */
+    Trace(const Trace& other) {
+        copy(other);
+    }
+
+    /**
+     * Assignment operator
+     */
+    Trace& operator=(const Trace& other) {
+        if (this != &other) {
+            copy(other);
+        }
+        return *this;
+    }
+
+    /**
+     * Stamp a stage with the current monotonic time, if tracing is enabled
+     * @param stage The stage to stamp
+     */
+    void mark(TraceStage stage) {
+        if (is_enabled()) {
+            stamps[stage].store(now(), std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Stamp a stage with a given time
+     * @param stage The stage to stamp
+     * @param nanos A monotonic time in nanoseconds, as returned by now()
+     */
+    void set(TraceStage stage, uint64_t nanos) {
+        stamps[stage].store(nanos, std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the stamp of a stage
+     * @param stage The stage
+     * @returns The monotonic time in nanoseconds of the stage, 0 if it was not stamped
+     */
+    uint64_t get(TraceStage stage) const {
+        return stamps[stage].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Has a stage been stamped?
+     * @param stage The stage
+     * @returns Whether or not the stage has been stamped
+     */
+    bool has(TraceStage stage) const {
+        return get(stage) != 0;
+    }
+
+    /**
+     * Time elapsed between the read of the data and a stage
+     * @param stage The stage
+     * @returns The elapsed nanoseconds, 0 if either stage was not stamped
+     */
+    uint64_t since_read(TraceStage stage) const;
+
+    /**
+     * Clear all the stamps
+     */
+    void reset();
+
+    /**
+     * Get the current monotonic time. Not affected by NTP adjustments.
+     * @returns The current monotonic time in nanoseconds
+     */
+    static uint64_t now() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    }
+
+    /**
+     * Enable or disable tracing for the whole process
+     * @param enable Whether or not Data objects should be stamped
+     */
+    static void set_enabled(bool enable);
+
+    /**
+     * Is tracing enabled?
+     * @returns Whether or not Data objects are being stamped
+     */
+    static bool is_enabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Get a printable name for a stage
+     * @param stage The stage
+     * @returns The name of the stage
+     */
+    static const char* stage_name(TraceStage stage);
+
+private:
+
+    void copy(const Trace& other);
+
+    std::atomic<uint64_t> stamps[STAGE_COUNT];
+
+    static std::atomic<bool> enabled;
+
+};
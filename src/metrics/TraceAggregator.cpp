@@ -0,0 +1,111 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TraceAggregator.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <mutex>
+
+void TraceAggregator::record(const std::string& topic, TraceStage stage, uint64_t nanos) {
+    get_topic(topic).stages[stage].record(nanos);
+}
+
+void TraceAggregator::record(const std::string& topic, TraceStage stage, const Trace& trace) {
+    if (!trace.has(STAGE_READ) || !trace.has(stage)) {
+        return;
+    }
+    record(topic, stage, trace.since_read(stage));
+}
+
+const LatencyHistogram& TraceAggregator::get_histogram(const std::string& topic, TraceStage stage) {
+    return get_topic(topic).stages[stage];
+}
+
+TraceAggregator::TopicHistograms& TraceAggregator::get_topic(const std::string& topic) {
+    {
+        std::shared_lock<std::shared_mutex> lck(mtx);
+        auto it = topics.find(topic);
+        if (it != topics.end()) {
+            return *it->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lck(mtx);
+    auto& histograms = topics[topic];
+    if (!histograms) {
+        histograms = std::make_unique<TopicHistograms>();
+    }
+    return *histograms;
+}
+
+void TraceAggregator::dump(std::ostream& out) {
+    std::shared_lock<std::shared_mutex> lck(mtx);
+    out << "# topic stage count min mean p50 p90 p99 p99.9 max (nanoseconds since read)\n";
+    for (auto& topic : topics) {
+        for (int i = 0; i < STAGE_COUNT; ++i) {
+            const LatencyHistogram& histogram = topic.second->stages[i];
+            if (histogram.get_count() == 0) {
+                continue;
+            }
+            out << topic.first << ' ' << Trace::stage_name((TraceStage)i)
+                << ' ' << histogram.get_count()
+                << ' ' << histogram.get_min()
+                << ' ' << (uint64_t)histogram.get_mean()
+                << ' ' << histogram.get_percentile(50.0)
+                << ' ' << histogram.get_percentile(90.0)
+                << ' ' << histogram.get_percentile(99.0)
+                << ' ' << histogram.get_percentile(99.9)
+                << ' ' << histogram.get_max() << '\n';
+        }
+    }
+    out.flush();
+}
+
+void TraceAggregator::dump(const std::string& file) {
+    std::string tmp = file + ".tmp";
+    {
+        std::ofstream out(tmp, std::ofstream::out | std::ofstream::trunc);
+        if (out.fail()) {
+            throw std::runtime_error("Cannot open trace dump file " + tmp);
+        }
+        dump(out);
+        if (out.fail()) {
+            throw std::runtime_error("Cannot write trace dump file " + tmp);
+        }
+    }
+    if (std::rename(tmp.c_str(), file.c_str()) < 0) {
+        throw std::runtime_error(std::strerror(errno));
+    }
+}
+
+void TraceAggregator::reset() {
+    std::shared_lock<std::shared_mutex> lck(mtx);
+    for (auto& topic : topics) {
+        for (int i = 0; i < STAGE_COUNT; ++i) {
+            topic.second->stages[i].reset();
+        }
+    }
+}
+
+TraceAggregator& TraceAggregator::get_default() {
+    static TraceAggregator aggregator;
+    return aggregator;
+}
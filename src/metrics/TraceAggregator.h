@@ -0,0 +1,120 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <shared_mutex>
+#include <ostream>
+
+#include "Trace.h"
+#include "LatencyHistogram.h"
+
+/**
+ * \class TraceAggregator
+ *
+ * \brief Keeps per-topic latency histograms for each trace stage
+ *
+ * Each histogram holds the time elapsed between the read of a Data
+ * object (STAGE_READ) and the moment it reached a stage. Comparing the
+ * percentiles of consecutive stages shows where the time goes.
+ *
+ * The Broker and the Writers record into the default aggregator
+ * (get_default()) when tracing is enabled (see Trace::set_enabled()).
+ * The histograms can be dumped as text to a stream or to a file.
+ */
+class TraceAggregator {
+
+public:
+
+    /**
+     * Default constructor
+     */
+    TraceAggregator() = default;
+
+    // Do not allow copy or assignment.
+
+    TraceAggregator(const TraceAggregator&) = delete;
+
+    TraceAggregator& operator=(const TraceAggregator&) = delete;
+
+    /**
+     * Record the latency of a stage for a topic
+     * @param topic The topic of the traced data
+     * @param stage The stage that was reached
+     * @param nanos The nanoseconds elapsed since the data was read
+     */
+    void record(const std::string& topic, TraceStage stage, uint64_t nanos);
+
+    /**
+     * Record the latency of a stage for a topic from a Trace.
+     * Nothing is recorded if the read or the stage were not stamped.
+     * @param topic The topic of the traced data
+     * @param stage The stage that was reached
+     * @param trace The trace of the data
+     */
+    void record(const std::string& topic, TraceStage stage, const Trace& trace);
+
+    /**
+     * Get the histogram of a stage for a topic
+     * @param topic The topic
+     * @param stage The stage
+     * @returns The histogram. It is created empty if it did not exist.
+     */
+    const LatencyHistogram& get_histogram(const std::string& topic, TraceStage stage);
+
+    /**
+     * Write a text summary (count, min, mean, p50, p90, p99, p99.9, max) of every
+     * non-empty histogram, one line per topic and stage
+     * @param out The stream where the summary is written
+     */
+    void dump(std::ostream& out);
+
+    /**
+     * Write the text summary to a file. The file is replaced atomically.
+     * @param file The path of the dump file
+     * @throws std::runtime_error If the file cannot be written
+     */
+    void dump(const std::string& file);
+
+    /**
+     * Clear all the histograms
+     */
+    void reset();
+
+    /**
+     * Get the aggregator used by the Broker and the Writers
+     * @returns The process-wide aggregator
+     */
+    static TraceAggregator& get_default();
+
+private:
+
+    struct TopicHistograms {
+        LatencyHistogram stages[STAGE_COUNT];
+    };
+
+    TopicHistograms& get_topic(const std::string& topic);
+
+    std::unordered_map<std::string, std::unique_ptr<TopicHistograms>> topics;
+
+    std::shared_mutex mtx;
+
+};
@@ -18,36 +18,163 @@
 
 #include "AnalogSensor.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+const std::size_t AnalogSensor::IIO_MAX_SCANS;
+
+// Parse a decimal integer with an optional sign. Returns whether a number was found.
+static bool parse_integer(const char* buffer, std::size_t size, long& value) {
+    std::size_t i = 0;
+    while (i < size && (buffer[i] == ' ' || buffer[i] == '\t')) {
+        ++i;
+    }
+    bool negative = false;
+    if (i < size && (buffer[i] == '-' || buffer[i] == '+')) {
+        negative = buffer[i] == '-';
+        ++i;
+    }
+    std::size_t first_digit = i;
+    long result = 0;
+    while (i < size && buffer[i] >= '0' && buffer[i] <= '9') {
+        result = result * 10 + (buffer[i] - '0');
+        ++i;
+    }
+    if (i == first_digit) {
+        return false;
+    }
+    value = negative ? -result : result;
+    return true;
+}
+
+void AnalogSensor::use_iio_buffer(const std::string& device, const std::string& channel,
+    const std::string& trigger, std::size_t length) {
+    if (is_started()) {
+        throw std::runtime_error("Cannot change the input of a started sensor");
+    }
+    iio_device = device;
+    iio_channel = channel;
+    iio_trigger = trigger;
+    iio_length = length;
+}
+
 void AnalogSensor::start() {
+    // Before touching the buffer or the file, which the sensor thread may be reading
+    if (is_started()) {
+        throw std::runtime_error("Sensor already started!");
+    }
+    if (!iio_device.empty()) {
+        iio_buffer = std::make_unique<IIOBuffer>(iio_device);
+        iio_buffer->enable_channel(iio_channel);
+        try {
+            iio_buffer->enable_channel("in_timestamp");
+        }
+        catch (const std::runtime_error&) {
+            // No timestamp channel, samples are stamped when read
+        }
+        if (!iio_trigger.empty()) {
+            iio_buffer->set_trigger(iio_trigger);
+        }
+        if (iio_length > 0) {
+            iio_buffer->set_length(iio_length);
+        }
+        iio_buffer->open();
+        iio_values.resize(IIO_MAX_SCANS * iio_buffer->get_channel_count());
+    }
+    else {
+        open_file();
+    }
     Sensor::start();
 }
 
 void AnalogSensor::stop() {
     Sensor::stop();
+    close_file();
+    iio_buffer.reset();
 }
 
-void AnalogSensor::read() {
-    std::string buff;
-    double value;
+void AnalogSensor::open_file() {
+    fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        RTDATA_LOG(WARNING) << "[" << name << "] Failed to open the file " << file;
+    }
+}
 
-    std::ifstream fp(file);
-    if (fp.fail()) {
-        Log::log(WARNING) << "[" << name << "] Failed to open the file " << file;
-        return;
+void AnalogSensor::close_file() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void AnalogSensor::read() {
+    if (iio_buffer) {
+        read_buffer();
     }
+    else {
+        read_file();
+    }
+}
 
-    fp >> buff;
-    if (fp.fail()) {
-        Log::log(WARNING) << "[" << name << "] Failed to read from file " << file;
+void AnalogSensor::read_file() {
+    if (fd < 0) {
+        open_file();
+        if (fd < 0) {
+            count_read_error();
+            return;
+        }
+    }
+    // sysfs attributes are regenerated on every read from offset 0
+    char buffer[32];
+    ssize_t size = pread(fd, buffer, sizeof(buffer), 0);
+    long raw;
+    if (size <= 0 || !parse_integer(buffer, size, raw)) {
+        RTDATA_LOG(WARNING) << "[" << name << "] Failed to read from file " << file;
+        count_read_error();
+        if (size < 0 && errno != EAGAIN && errno != EINTR) {
+            // Reopen on the next read (e.g. the device was removed)
+            close_file();
+        }
         return;
     }
 
-    value = (std::stoi(buff) - zero) * (scale / span);
+    double value = (raw - zero) * (scale / span);
+
+    RTDATA_LOG(DEBUG) << "[" << name << "] Read value " << value;
 
-    Log::log(INFO) << "[" << name << "] Read value " << value;
+    std::shared_ptr<Data> data = std::make_shared<AnalogData>(origin, value);
+    enqueue(data);
+}
 
-    std::shared_ptr<Data> data = std::make_shared<AnalogData>(name, value);
-    queue.push(data);
+void AnalogSensor::read_buffer() {
+    std::size_t count;
+    try {
+        count = iio_buffer->read(iio_values.data(), IIO_MAX_SCANS);
+    }
+    catch (const std::runtime_error& ex) {
+        RTDATA_LOG(WARNING) << "[" << name << "] Failed to read from " << iio_device << ": " << ex.what();
+        count_read_error();
+        return;
+    }
+    std::size_t channels = iio_buffer->get_channel_count();
+    int value_position = iio_buffer->get_channel_position(iio_channel);
+    int timestamp_position = iio_buffer->get_channel_position("in_timestamp");
+    double factor = scale / span;
+    for (std::size_t i = 0; i < count; ++i) {
+        const int64_t* scan = iio_values.data() + i * channels;
+        double value = (scan[value_position] - zero) * factor;
+        std::shared_ptr<Data> data;
+        if (timestamp_position >= 0) {
+            Timestamp time((uint64_t)scan[timestamp_position]);
+            data = std::make_shared<AnalogData>(time, origin, value);
+        }
+        else {
+            data = std::make_shared<AnalogData>(origin, value);
+        }
+        enqueue(data);
+    }
 }
 
 void AnalogData::serialize(SerializedObject* object) {
@@ -20,8 +20,10 @@
 
 #include "../Sensor.h"
 #include "../Log.h"
+#include "../io/IIOBuffer.h"
 
-#include <fstream>
+#include <memory>
+#include <vector>
 
 class AnalogSensor : public Sensor {
 
@@ -62,6 +64,7 @@ public:
      */
     explicit AnalogSensor(Configuration& config) : 
         Sensor(config),
+        file(config["file"].is_null() ? "" : config["file"].get<std::string>()),
         zero_value(config["zero"].get<double>()),
         span_value(config["span"].get<double>()),
         scale(config["span"].get<double>()),
@@ -70,11 +73,35 @@ public:
         span_voltage(config["span_voltage"].get<int64_t>()) {
             zero = (double)(1 << quantization_bits) * (zero_value - zero_voltage) / span_voltage;
             span = (double)(1 << quantization_bits) * (span_value) / span_voltage;
+            Configuration& device = config["iio_device"];
+            if (!device.is_null()) {
+                Configuration& trigger = config["iio_trigger"];
+                Configuration& length = config["iio_buffer_length"];
+                use_iio_buffer(device.get<std::string>(), config["iio_channel"].get<std::string>(),
+                    trigger.is_null() ? "" : trigger.get<std::string>(),
+                    length.is_null() ? 0 : length.get<uint64_t>());
+            }
     }
 
+    /**
+     * Read the samples from the buffered interface of an IIO device instead of the sysfs file.
+     * Each read drains all the samples captured by the kernel since the previous one, so the
+     * sampling rate becomes the period at which the buffer is drained; the actual sample
+     * rate is the rate of the trigger. If the device has a timestamp channel, it is used
+     * as the timestamp of the samples.
+     * Must be called before starting the sensor.
+     * @param device The IIO device (e.g. "iio:device0")
+     * @param channel The channel (e.g. "in_voltage0")
+     * @param trigger The trigger to use (optional, default = keep the current trigger)
+     * @param length The length of the kernel buffer in samples (optional, default = keep the current length)
+     */
+    void use_iio_buffer(const std::string& device, const std::string& channel,
+        const std::string& trigger = "", std::size_t length = 0);
+
     /**
      * Starts the sensor.
-     * @throws std::runtime_error if the sensor has been already started or if it was stopped.
+     * @throws std::runtime_error if the sensor has been already started or if it was stopped,
+     *      or if the IIO buffer cannot be set up.
      */
     virtual void start() override;
 
@@ -93,7 +120,31 @@ protected:
 
 private:
 
+    void read_file();
+
+    void read_buffer();
+
+    void open_file();
+
+    void close_file();
+
+    /**
+     * Maximum number of samples read from the IIO buffer at once
+     */
+    static const std::size_t IIO_MAX_SCANS = 256;
+
     std::string file;
+
+    // Kept open between reads, -1 if closed
+    int fd = -1;
+
+    std::string iio_device;
+    std::string iio_channel;
+    std::string iio_trigger;
+    std::size_t iio_length = 0;
+    std::unique_ptr<IIOBuffer> iio_buffer;
+    std::vector<int64_t> iio_values;
+
     double zero_value;
     double span_value;
     double scale;
@@ -126,6 +177,14 @@ public:
 
     }
 
+    AnalogData(OriginId origin, double value) : Data(origin), value(value) {
+
+    }
+
+    AnalogData(const Timestamp& time, OriginId origin, double value) : Data(time, origin), value(value) {
+
+    }
+
     /**
      * Serialize the AnalogData. Do not call directly.
      * @param object The resulting SerializedObject where the data must be saved.
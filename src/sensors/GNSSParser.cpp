@@ -0,0 +1,546 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GNSSParser.h"
+#include "../time/Timestamp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <limits>
+
+const std::size_t GNSSParser::MAX_SENTENCE_SIZE;
+const std::size_t GNSSParser::MAX_UBX_PAYLOAD;
+const std::size_t GNSSParser::MAX_TALKERS;
+const std::size_t GNSSParser::MAX_FIELDS;
+
+static const uint8_t UBX_SYNC_1 = 0xB5;
+static const uint8_t UBX_SYNC_2 = 0x62;
+static const uint8_t UBX_NAV = 0x01;
+static const uint8_t UBX_NAV_PVT = 0x07;
+static const std::size_t UBX_NAV_PVT_SIZE = 92;
+
+static const double KNOTS_TO_METERS_PER_SECOND = 0.514444;
+
+static const int64_t MILLIS_PER_DAY = 86400000;
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+static double to_double(std::string_view value) {
+    char number[32];
+    if (value.empty() || value.size() >= sizeof(number)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    std::memcpy(number, value.data(), value.size());
+    number[value.size()] = '\0';
+    char* end;
+    double result = std::strtod(number, &end);
+    return end == number ? std::numeric_limits<double>::quiet_NaN() : result;
+}
+
+static bool read_digits(std::string_view text, std::size_t position, std::size_t count, int& value) {
+    if (position + count > text.size()) {
+        return false;
+    }
+    value = 0;
+    for (std::size_t i = position; i < position + count; ++i) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (text[i] - '0');
+    }
+    return true;
+}
+
+// hhmmss[.sss] to milliseconds since midnight, -1 if malformed
+static int64_t parse_time_of_day(std::string_view time) {
+    int hour, minute, second;
+    if (!read_digits(time, 0, 2, hour) || !read_digits(time, 2, 2, minute) || !read_digits(time, 4, 2, second) ||
+        hour > 23 || minute > 59 || second > 60) {
+        return -1;
+    }
+    int64_t millis = 0;
+    if (time.size() > 6 && time[6] == '.') {
+        int64_t scale = 100;
+        for (std::size_t i = 7; i < time.size() && time[i] >= '0' && time[i] <= '9'; ++i) {
+            millis += (time[i] - '0') * scale;
+            scale /= 10;
+        }
+    }
+    return ((hour * 60 + minute) * 60 + second) * 1000LL + millis;
+}
+
+// ddmmyy to days since the epoch, -1 if malformed
+static int64_t parse_date(std::string_view date) {
+    int day, month, year;
+    if (!read_digits(date, 0, 2, day) || !read_digits(date, 2, 2, month) || !read_digits(date, 4, 2, year) ||
+        day < 1 || day > 31 || month < 1 || month > 12) {
+        return -1;
+    }
+    return Timestamp::days_from_civil(2000 + year, month, day);
+}
+
+// (d)ddmm.mmmm and hemisphere to signed degrees
+static double parse_coordinate(std::string_view value, std::string_view hemisphere) {
+    double raw = to_double(value);
+    if (std::isnan(raw) || hemisphere.empty()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    double degrees = std::floor(raw / 100.0);
+    degrees += (raw - degrees * 100.0) / 60.0;
+    return hemisphere[0] == 'S' || hemisphere[0] == 'W' ? -degrees : degrees;
+}
+
+template <typename T>
+static T read_le(const uint8_t* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+static void ubx_checksum(const uint8_t* header, const uint8_t* payload, std::size_t size, uint8_t& a, uint8_t& b) {
+    a = 0;
+    b = 0;
+    for (std::size_t i = 0; i < 4; ++i) {
+        a += header[i];
+        b += a;
+    }
+    for (std::size_t i = 0; i < size; ++i) {
+        a += payload[i];
+        b += a;
+    }
+}
+
+GNSSParser::GNSSParser(FixHandler handler) : handler(handler), errors(0), ubx_fixes(false) {
+    reset();
+}
+
+void GNSSParser::reset() {
+    state = STATE_SYNC;
+    length = 0;
+    ubx_length = 0;
+    fix = GPSFix();
+    epoch_time = -1;
+    has_gga = false;
+    has_rmc = false;
+    emitted = false;
+    quality = 0;
+    date = -1;
+    mode = NOT_SEEN;
+    for (std::size_t i = 0; i < MAX_TALKERS; ++i) {
+        satellites[i].talker[0] = '\0';
+        satellites[i].talker[1] = '\0';
+        satellites[i].visible = 0;
+    }
+}
+
+uint64_t GNSSParser::get_errors() const {
+    return errors;
+}
+
+void GNSSParser::feed(const uint8_t* data, std::size_t size) {
+    const uint8_t* end = data + size;
+    while (data < end) {
+        std::size_t available = end - data;
+        switch (state) {
+            case STATE_SYNC: {
+                while (data < end && *data != '$' && *data != UBX_SYNC_1) {
+                    ++data;
+                }
+                if (data == end) {
+                    return;
+                }
+                if (*data == UBX_SYNC_1) {
+                    state = STATE_UBX_SYNC;
+                    ++data;
+                    break;
+                }
+                // Parse the sentence in place if it is complete in this chunk
+                available = end - data;
+                const uint8_t* newline = static_cast<const uint8_t*>(
+                    std::memchr(data, '\n', std::min(available, MAX_SENTENCE_SIZE + 1)));
+                if (newline != nullptr) {
+                    parse_sentence(std::string_view(reinterpret_cast<const char*>(data), newline - data));
+                    data = newline + 1;
+                }
+                else if (available > MAX_SENTENCE_SIZE) {
+                    ++errors;
+                    ++data;
+                }
+                else {
+                    std::memcpy(buffer, data, available);
+                    length = available;
+                    state = STATE_NMEA;
+                    return;
+                }
+                break;
+            }
+            case STATE_NMEA: {
+                const uint8_t* newline = static_cast<const uint8_t*>(std::memchr(data, '\n', available));
+                std::size_t chunk = newline != nullptr ? (std::size_t)(newline - data) : available;
+                if (length + chunk > MAX_SENTENCE_SIZE) {
+                    // Too long: look for the next frame from here
+                    ++errors;
+                    length = 0;
+                    state = STATE_SYNC;
+                    break;
+                }
+                std::memcpy(buffer + length, data, chunk);
+                length += chunk;
+                if (newline == nullptr) {
+                    return;
+                }
+                parse_sentence(std::string_view(reinterpret_cast<const char*>(buffer), length));
+                length = 0;
+                state = STATE_SYNC;
+                data = newline + 1;
+                break;
+            }
+            case STATE_UBX_SYNC:
+                if (*data == UBX_SYNC_2) {
+                    length = 0;
+                    state = STATE_UBX_HEADER;
+                    ++data;
+                }
+                else {
+                    // Not a UBX frame, the byte may start another frame
+                    state = STATE_SYNC;
+                }
+                break;
+            case STATE_UBX_HEADER: {
+                if (length == 0 && available >= 4) {
+                    std::size_t payload = data[2] | (data[3] << 8);
+                    if (payload <= MAX_UBX_PAYLOAD && available >= 4 + payload + 2) {
+                        // The whole frame is in this chunk
+                        parse_ubx(data, data + 4);
+                        data += 4 + payload + 2;
+                        state = STATE_SYNC;
+                        break;
+                    }
+                }
+                std::size_t chunk = std::min(4 - length, available);
+                std::memcpy(ubx_header + length, data, chunk);
+                length += chunk;
+                data += chunk;
+                if (length < 4) {
+                    return;
+                }
+                ubx_length = ubx_header[2] | (ubx_header[3] << 8);
+                length = 0;
+                if (ubx_length > MAX_UBX_PAYLOAD) {
+                    ++errors;
+                    state = STATE_SYNC;
+                }
+                else {
+                    state = STATE_UBX_BODY;
+                }
+                break;
+            }
+            case STATE_UBX_BODY: {
+                std::size_t chunk = std::min(ubx_length + 2 - length, available);
+                std::memcpy(buffer + length, data, chunk);
+                length += chunk;
+                data += chunk;
+                if (length < ubx_length + 2) {
+                    return;
+                }
+                parse_ubx(ubx_header, buffer);
+                length = 0;
+                state = STATE_SYNC;
+                break;
+            }
+        }
+    }
+}
+
+std::vector<uint8_t> GNSSParser::make_ubx(uint8_t message_class, uint8_t message_id, const std::vector<uint8_t>& payload) {
+    uint8_t header[4] = { message_class, message_id, (uint8_t)(payload.size() & 0xFF), (uint8_t)(payload.size() >> 8) };
+    uint8_t a, b;
+    ubx_checksum(header, payload.data(), payload.size(), a, b);
+    std::vector<uint8_t> frame;
+    frame.reserve(payload.size() + 8);
+    frame.push_back(UBX_SYNC_1);
+    frame.push_back(UBX_SYNC_2);
+    frame.insert(frame.end(), header, header + 4);
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    frame.push_back(a);
+    frame.push_back(b);
+    return frame;
+}
+
+void GNSSParser::parse_sentence(std::string_view sentence) {
+    // $<address>,<fields>*<checksum>[\r]
+    if (!sentence.empty() && sentence.back() == '\r') {
+        sentence.remove_suffix(1);
+    }
+    std::size_t star = sentence.rfind('*');
+    if (star == std::string_view::npos || star + 3 != sentence.size()) {
+        ++errors;
+        return;
+    }
+    int high = hex_digit(sentence[star + 1]);
+    int low = hex_digit(sentence[star + 2]);
+    uint8_t checksum = 0;
+    for (std::size_t i = 1; i < star; ++i) {
+        checksum ^= (uint8_t)sentence[i];
+    }
+    if (high < 0 || low < 0 || checksum != ((high << 4) | low)) {
+        ++errors;
+        return;
+    }
+    std::string_view body = sentence.substr(1, star - 1);
+    std::string_view fields[MAX_FIELDS];
+    std::size_t count = 0;
+    while (count < MAX_FIELDS) {
+        std::size_t comma = body.find(',');
+        fields[count++] = body.substr(0, comma);
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        body.remove_prefix(comma + 1);
+    }
+    std::string_view address = fields[0];
+    if (address.size() != 5 || address[0] == 'P') {
+        // Proprietary or unknown sentence
+        return;
+    }
+    std::string_view type = address.substr(2);
+    if (type == "GGA") {
+        parse_gga(fields, count);
+    }
+    else if (type == "RMC") {
+        parse_rmc(fields, count);
+    }
+    else if (type == "GSA") {
+        parse_gsa(fields, count);
+    }
+    else if (type == "GSV") {
+        parse_gsv(address.substr(0, 2), fields, count);
+    }
+}
+
+void GNSSParser::parse_gga(const std::string_view* fields, std::size_t count) {
+    // GGA,time,lat,N/S,lon,E/W,quality,satellites,hdop,altitude,M,...
+    if (ubx_fixes || count < 10) {
+        return;
+    }
+    int64_t time_of_day = parse_time_of_day(fields[1]);
+    if (time_of_day < 0) {
+        return;
+    }
+    start_epoch(time_of_day);
+    if (emitted) {
+        return;
+    }
+    fix.latitude = parse_coordinate(fields[2], fields[3]);
+    fix.longitude = parse_coordinate(fields[4], fields[5]);
+    quality = fields[6].empty() ? 0 : (int)to_double(fields[6]);
+    double used = to_double(fields[7]);
+    fix.satellites_used = std::isnan(used) ? 0 : (int)used;
+    fix.altitude = to_double(fields[9]);
+    has_gga = true;
+    if (has_rmc) {
+        finish_epoch();
+    }
+}
+
+void GNSSParser::parse_rmc(const std::string_view* fields, std::size_t count) {
+    // RMC,time,A/V,lat,N/S,lon,E/W,speed (knots),track,date,...
+    if (ubx_fixes || count < 10) {
+        return;
+    }
+    int64_t time_of_day = parse_time_of_day(fields[1]);
+    if (time_of_day < 0) {
+        return;
+    }
+    int64_t days = parse_date(fields[9]);
+    if (days >= 0) {
+        date = days;
+    }
+    start_epoch(time_of_day);
+    if (emitted) {
+        return;
+    }
+    bool valid = fields[2] == "A";
+    if (!has_gga) {
+        fix.latitude = parse_coordinate(fields[3], fields[4]);
+        fix.longitude = parse_coordinate(fields[5], fields[6]);
+        quality = valid ? 1 : 0;
+    }
+    fix.ground_speed = to_double(fields[7]) * KNOTS_TO_METERS_PER_SECOND;
+    fix.track = to_double(fields[8]);
+    has_rmc = true;
+    if (has_gga) {
+        finish_epoch();
+    }
+}
+
+void GNSSParser::parse_gsa(const std::string_view* fields, std::size_t count) {
+    // GSA,A/M,mode (1 = no fix, 2 = 2D, 3 = 3D),...
+    if (count < 3 || fields[2].size() != 1) {
+        return;
+    }
+    switch (fields[2][0]) {
+        case '1':
+            mode = NO_FIX;
+            break;
+        case '2':
+            mode = FIX_2D;
+            break;
+        case '3':
+            mode = FIX_3D;
+            break;
+        default:
+            break;
+    }
+}
+
+void GNSSParser::parse_gsv(std::string_view talker, const std::string_view* fields, std::size_t count) {
+    // GSV,number of sentences,sentence number,satellites in view,...
+    if (count < 4) {
+        return;
+    }
+    double visible = to_double(fields[3]);
+    if (std::isnan(visible)) {
+        return;
+    }
+    for (std::size_t i = 0; i < MAX_TALKERS; ++i) {
+        TalkerSatellites& entry = satellites[i];
+        if (entry.talker[0] == '\0') {
+            entry.talker[0] = talker[0];
+            entry.talker[1] = talker[1];
+        }
+        if (entry.talker[0] == talker[0] && entry.talker[1] == talker[1]) {
+            entry.visible = (int)visible;
+            return;
+        }
+    }
+}
+
+int GNSSParser::get_satellites_visible() const {
+    int visible = 0;
+    for (std::size_t i = 0; i < MAX_TALKERS && satellites[i].talker[0] != '\0'; ++i) {
+        visible += satellites[i].visible;
+    }
+    return visible;
+}
+
+void GNSSParser::start_epoch(int64_t time_of_day) {
+    if (time_of_day == epoch_time) {
+        return;
+    }
+    if (epoch_time >= 0 && !emitted && (has_gga || has_rmc)) {
+        // The receiver did not send both sentences
+        finish_epoch();
+    }
+    fix = GPSFix();
+    epoch_time = time_of_day;
+    has_gga = false;
+    has_rmc = false;
+    emitted = false;
+    quality = 0;
+}
+
+void GNSSParser::finish_epoch() {
+    if (quality == 0) {
+        fix.status = NOFIX;
+        fix.mode = NO_FIX;
+    }
+    else {
+        // 2 = DGPS, 4 = RTK fixed, 5 = RTK float
+        fix.status = quality == 2 || quality == 4 || quality == 5 ? DGPS_FIX : FIX;
+        if (mode != NOT_SEEN && mode != NO_FIX) {
+            fix.mode = mode;
+        }
+        else {
+            fix.mode = std::isnan(fix.altitude) ? FIX_2D : FIX_3D;
+        }
+    }
+    if (date >= 0) {
+        fix.time = (uint64_t)(date * MILLIS_PER_DAY + epoch_time) * 1000000ULL;
+    }
+    fix.satellites_visible = get_satellites_visible();
+    emitted = true;
+    handler(fix);
+}
+
+void GNSSParser::parse_ubx(const uint8_t* header, const uint8_t* body) {
+    std::size_t size = header[2] | (header[3] << 8);
+    uint8_t a, b;
+    ubx_checksum(header, body, size, a, b);
+    if (a != body[size] || b != body[size + 1]) {
+        ++errors;
+        return;
+    }
+    if (header[0] == UBX_NAV && header[1] == UBX_NAV_PVT && size == UBX_NAV_PVT_SIZE) {
+        parse_nav_pvt(body);
+    }
+}
+
+void GNSSParser::parse_nav_pvt(const uint8_t* payload) {
+    ubx_fixes = true;
+    GPSFix pvt;
+    uint8_t valid = payload[11];
+    if ((valid & 0x03) == 0x03) {
+        // Valid date and time
+        int64_t nanos = (int64_t)Timestamp::from_utc(read_le<uint16_t>(payload + 4), payload[6], payload[7],
+            payload[8], payload[9], payload[10]).to_nanos();
+        pvt.time = (uint64_t)(nanos + read_le<int32_t>(payload + 16));
+    }
+    uint8_t fix_type = payload[20];
+    uint8_t flags = payload[21];
+    if (fix_type == 2) {
+        pvt.mode = FIX_2D;
+    }
+    else if (fix_type == 3 || fix_type == 4) {
+        pvt.mode = FIX_3D;
+    }
+    else {
+        pvt.mode = NO_FIX;
+    }
+    if (pvt.mode != NO_FIX && (flags & 0x01) != 0) {
+        pvt.status = (flags & 0x02) != 0 ? DGPS_FIX : FIX;
+    }
+    pvt.satellites_used = payload[23];
+    pvt.satellites_visible = get_satellites_visible();
+    pvt.longitude = read_le<int32_t>(payload + 24) * 1e-7;
+    pvt.latitude = read_le<int32_t>(payload + 28) * 1e-7;
+    pvt.altitude = read_le<int32_t>(payload + 36) * 1e-3;
+    pvt.vertical_speed = -read_le<int32_t>(payload + 56) * 1e-3;
+    pvt.ground_speed = read_le<int32_t>(payload + 60) * 1e-3;
+    pvt.track = read_le<int32_t>(payload + 64) * 1e-5;
+    pvt.latitude_uncertainty = read_le<uint32_t>(payload + 40) * 1e-3;
+    pvt.longitude_uncertainty = pvt.latitude_uncertainty;
+    pvt.altitude_uncertainty = read_le<uint32_t>(payload + 44) * 1e-3;
+    pvt.ground_speed_uncertainty = read_le<uint32_t>(payload + 68) * 1e-3;
+    pvt.vertical_speed_uncertainty = pvt.ground_speed_uncertainty;
+    pvt.track_uncertainty = read_le<uint32_t>(payload + 72) * 1e-5;
+    handler(pvt);
+}
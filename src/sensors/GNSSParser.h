@@ -0,0 +1,171 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <functional>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "GPSFix.h"
+
+/**
+ * \class GNSSParser
+ *
+ * \brief Streaming parser of NMEA 0183 sentences and u-blox UBX frames
+ *
+ * The bytes read from a GNSS receiver are passed to feed() as they arrive, in
+ * chunks of any size; NMEA and UBX can be interleaved in the same stream. Frames
+ * that are complete within a chunk are parsed in place, only frames split across
+ * chunks are copied to an internal buffer. Frames with a wrong checksum are dropped.
+ *
+ * Fixes are built from:
+ * - UBX NAV-PVT: each valid frame is a complete fix, passed to the handler right away.
+ *   Once a NAV-PVT frame has been seen, NMEA is only used for the satellites in view.
+ * - NMEA: GGA and RMC sentences with the same time of day are merged, and the fix is
+ *   passed to the handler as soon as both have been received (or when the next epoch
+ *   starts, for receivers that only send one of them). GSA gives the fix mode and GSV
+ *   the satellites in view.
+ */
+class GNSSParser {
+
+public:
+
+    /**
+     * Called with every fix
+     */
+    typedef std::function<void(const GPSFix&)> FixHandler;
+
+    /**
+     * Constructor
+     * @param handler Called with every fix
+     */
+    explicit GNSSParser(FixHandler handler);
+
+    /**
+     * Parse received bytes. The handler is called for each fix completed by these bytes.
+     * @param data The received bytes
+     * @param size The number of received bytes
+     */
+    void feed(const uint8_t* data, std::size_t size);
+
+    /**
+     * Discard the partial frames and the current epoch
+     */
+    void reset();
+
+    /**
+     * Get the number of frames dropped because of a wrong checksum or an excessive length
+     * @returns The number of dropped frames
+     */
+    uint64_t get_errors() const;
+
+    /**
+     * Build a UBX frame (sync characters, header, payload and checksum)
+     * @param message_class The class of the message
+     * @param message_id The id of the message
+     * @param payload The payload
+     * @returns The frame
+     */
+    static std::vector<uint8_t> make_ubx(uint8_t message_class, uint8_t message_id, const std::vector<uint8_t>& payload);
+
+    /**
+     * Maximum length of a NMEA sentence. The standard limit is 82 characters.
+     */
+    static const std::size_t MAX_SENTENCE_SIZE = 128;
+
+    /**
+     * Maximum length of a UBX payload. Longer frames are skipped.
+     */
+    static const std::size_t MAX_UBX_PAYLOAD = 512;
+
+private:
+
+    enum State {
+        STATE_SYNC,
+        STATE_NMEA,
+        STATE_UBX_SYNC,
+        STATE_UBX_HEADER,
+        STATE_UBX_BODY
+    };
+
+    // Satellites in view reported by the GSV sentences of one talker (GP, GL, GA, ...)
+    struct TalkerSatellites {
+        char talker[2];
+        int visible;
+    };
+
+    static const std::size_t MAX_TALKERS = 8;
+
+    static const std::size_t MAX_FIELDS = 24;
+
+    void parse_sentence(std::string_view sentence);
+
+    void parse_gga(const std::string_view* fields, std::size_t count);
+
+    void parse_rmc(const std::string_view* fields, std::size_t count);
+
+    void parse_gsa(const std::string_view* fields, std::size_t count);
+
+    void parse_gsv(std::string_view talker, const std::string_view* fields, std::size_t count);
+
+    void parse_ubx(const uint8_t* header, const uint8_t* body);
+
+    void parse_nav_pvt(const uint8_t* payload);
+
+    void start_epoch(int64_t time_of_day);
+
+    void finish_epoch();
+
+    int get_satellites_visible() const;
+
+    FixHandler handler;
+
+    State state;
+
+    uint8_t buffer[MAX_UBX_PAYLOAD + 2];
+
+    std::size_t length;
+
+    uint8_t ubx_header[4];
+
+    std::size_t ubx_length;
+
+    uint64_t errors;
+
+    // Seen a UBX NAV-PVT frame: NMEA fixes are ignored
+    bool ubx_fixes;
+
+    // Current NMEA epoch
+    GPSFix fix;
+    int64_t epoch_time; // milliseconds since midnight, -1 if none
+    bool has_gga;
+    bool has_rmc;
+    bool emitted;
+    int quality;
+
+    // Last date received (days since the epoch), -1 if none
+    int64_t date;
+
+    FixMode mode;
+
+    TalkerSatellites satellites[MAX_TALKERS];
+
+};
@@ -0,0 +1,354 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GPSDParser.h"
+#include "../time/Timestamp.h"
+
+#include <cstring>
+#include <cstdlib>
+
+const std::size_t GPSDParser::MAX_REPORT_SIZE;
+
+// Minimal JSON scanning over string_views: enough to walk the flat objects sent by gpsd
+
+static std::size_t skip_spaces(std::string_view json, std::size_t i) {
+    while (i < json.size() && (json[i] == ' ' || json[i] == '\t' || json[i] == '\r' || json[i] == '\n')) {
+        ++i;
+    }
+    return i;
+}
+
+// i is at the opening quote. Returns the position after the closing quote, or npos.
+static std::size_t skip_string(std::string_view json, std::size_t i) {
+    for (++i; i < json.size(); ++i) {
+        if (json[i] == '\\') {
+            ++i;
+        }
+        else if (json[i] == '"') {
+            return i + 1;
+        }
+    }
+    return std::string_view::npos;
+}
+
+// Returns the position after the value starting at i, or npos.
+static std::size_t skip_value(std::string_view json, std::size_t i) {
+    if (i >= json.size()) {
+        return std::string_view::npos;
+    }
+    if (json[i] == '"') {
+        return skip_string(json, i);
+    }
+    if (json[i] == '{' || json[i] == '[') {
+        int depth = 0;
+        while (i < json.size()) {
+            char c = json[i];
+            if (c == '"') {
+                i = skip_string(json, i);
+                if (i == std::string_view::npos) {
+                    return i;
+                }
+                continue;
+            }
+            if (c == '{' || c == '[') {
+                ++depth;
+            }
+            else if (c == '}' || c == ']') {
+                if (--depth == 0) {
+                    return i + 1;
+                }
+            }
+            ++i;
+        }
+        return std::string_view::npos;
+    }
+    while (i < json.size() && json[i] != ',' && json[i] != '}' && json[i] != ']') {
+        ++i;
+    }
+    return i;
+}
+
+// Calls f(key, value) for each member of the object in json. Returns false if it is malformed.
+template <typename F>
+static bool for_each_member(std::string_view json, F f) {
+    std::size_t i = skip_spaces(json, 0);
+    if (i >= json.size() || json[i] != '{') {
+        return false;
+    }
+    i = skip_spaces(json, i + 1);
+    while (i < json.size() && json[i] != '}') {
+        if (json[i] != '"') {
+            return false;
+        }
+        std::size_t key_end = skip_string(json, i);
+        if (key_end == std::string_view::npos) {
+            return false;
+        }
+        std::string_view key = json.substr(i + 1, key_end - i - 2);
+        i = skip_spaces(json, key_end);
+        if (i >= json.size() || json[i] != ':') {
+            return false;
+        }
+        i = skip_spaces(json, i + 1);
+        std::size_t value_end = skip_value(json, i);
+        if (value_end == std::string_view::npos) {
+            return false;
+        }
+        std::string_view value = json.substr(i, value_end - i);
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+            value.remove_suffix(1);
+        }
+        f(key, value);
+        i = skip_spaces(json, value_end);
+        if (i < json.size() && json[i] == ',') {
+            i = skip_spaces(json, i + 1);
+        }
+    }
+    return i < json.size();
+}
+
+// Calls f(element) for each element of the array in json
+template <typename F>
+static void for_each_element(std::string_view json, F f) {
+    std::size_t i = skip_spaces(json, 0);
+    if (i >= json.size() || json[i] != '[') {
+        return;
+    }
+    i = skip_spaces(json, i + 1);
+    while (i < json.size() && json[i] != ']') {
+        std::size_t end = skip_value(json, i);
+        if (end == std::string_view::npos) {
+            return;
+        }
+        f(json.substr(i, end - i));
+        i = skip_spaces(json, end);
+        if (i < json.size() && json[i] == ',') {
+            i = skip_spaces(json, i + 1);
+        }
+    }
+}
+
+static double to_double(std::string_view value) {
+    char number[64];
+    if (value.empty() || value.size() >= sizeof(number)) {
+        return 0.0;
+    }
+    std::memcpy(number, value.data(), value.size());
+    number[value.size()] = '\0';
+    return std::strtod(number, nullptr);
+}
+
+static std::string_view unquote(std::string_view value) {
+    if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+        return value.substr(1, value.size() - 2);
+    }
+    return value;
+}
+
+static bool read_digits(std::string_view text, std::size_t position, std::size_t count, int& value) {
+    if (position + count > text.size()) {
+        return false;
+    }
+    value = 0;
+    for (std::size_t i = position; i < position + count; ++i) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (text[i] - '0');
+    }
+    return true;
+}
+
+bool GPSDParser::parse_time(std::string_view time, uint64_t& nanos) {
+    // YYYY-MM-DDTHH:MM:SS[.fraction]Z
+    int year, month, day, hour, minute, second;
+    if (!read_digits(time, 0, 4, year) || !read_digits(time, 5, 2, month) || !read_digits(time, 8, 2, day) ||
+        !read_digits(time, 11, 2, hour) || !read_digits(time, 14, 2, minute) || !read_digits(time, 17, 2, second) ||
+        time[4] != '-' || time[7] != '-' || time[10] != 'T' || time[13] != ':' || time[16] != ':') {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60 || year < 1970) {
+        return false;
+    }
+    uint64_t fraction = 0;
+    std::size_t i = 19;
+    if (i < time.size() && time[i] == '.') {
+        uint64_t scale = 100000000;
+        for (++i; i < time.size() && time[i] >= '0' && time[i] <= '9'; ++i) {
+            fraction += (time[i] - '0') * scale;
+            scale /= 10;
+        }
+    }
+    nanos = Timestamp::from_utc(year, month, day, hour, minute, second, fraction).to_nanos();
+    return true;
+}
+
+void GPSDParser::feed(const char* data, std::size_t size) {
+    while (size > 0) {
+        const char* newline = static_cast<const char*>(std::memchr(data, '\n', size));
+        std::size_t chunk = newline != nullptr ? (std::size_t)(newline - data) : size;
+        if (!overflow) {
+            if (length + chunk > MAX_REPORT_SIZE) {
+                overflow = true;
+            }
+            else {
+                std::memcpy(line + length, data, chunk);
+                length += chunk;
+            }
+        }
+        if (newline == nullptr) {
+            return;
+        }
+        if (!overflow) {
+            std::size_t report_length = length;
+            if (report_length > 0 && line[report_length - 1] == '\r') {
+                --report_length;
+            }
+            parse_report(std::string_view(line, report_length));
+        }
+        length = 0;
+        overflow = false;
+        data = newline + 1;
+        size -= chunk + 1;
+    }
+}
+
+void GPSDParser::reset() {
+    length = 0;
+    overflow = false;
+    satellites_used = 0;
+    satellites_visible = 0;
+}
+
+bool GPSDParser::parse_report(std::string_view report) {
+    std::string_view report_class;
+    bool valid = for_each_member(report, [&report_class](std::string_view key, std::string_view value) {
+        if (key == "class") {
+            report_class = unquote(value);
+        }
+    });
+    if (!valid) {
+        return false;
+    }
+    if (report_class == "TPV") {
+        parse_fix(report);
+        return true;
+    }
+    if (report_class == "SKY") {
+        parse_sky(report);
+    }
+    return false;
+}
+
+void GPSDParser::parse_fix(std::string_view report) {
+    GPSFix fix;
+    fix.satellites_used = satellites_used;
+    fix.satellites_visible = satellites_visible;
+    int status = -1;
+    bool has_hae = false;
+    for_each_member(report, [&fix, &status, &has_hae](std::string_view key, std::string_view value) {
+        if (key == "mode") {
+            fix.mode = (FixMode)(int)to_double(value);
+        }
+        else if (key == "status") {
+            status = (int)to_double(value);
+        }
+        else if (key == "time") {
+            uint64_t nanos;
+            if (parse_time(unquote(value), nanos)) {
+                fix.time = nanos;
+            }
+        }
+        else if (key == "lat") {
+            fix.latitude = to_double(value);
+        }
+        else if (key == "lon") {
+            fix.longitude = to_double(value);
+        }
+        else if (key == "altHAE") {
+            fix.altitude = to_double(value);
+            has_hae = true;
+        }
+        else if (key == "alt" && !has_hae) {
+            // Deprecated by gpsd 3.20 in favour of altHAE
+            fix.altitude = to_double(value);
+        }
+        else if (key == "track") {
+            fix.track = to_double(value);
+        }
+        else if (key == "speed") {
+            fix.ground_speed = to_double(value);
+        }
+        else if (key == "climb") {
+            fix.vertical_speed = to_double(value);
+        }
+        else if (key == "epy") {
+            fix.latitude_uncertainty = to_double(value);
+        }
+        else if (key == "epx") {
+            fix.longitude_uncertainty = to_double(value);
+        }
+        else if (key == "epv") {
+            fix.altitude_uncertainty = to_double(value);
+        }
+        else if (key == "epd") {
+            fix.track_uncertainty = to_double(value);
+        }
+        else if (key == "eps") {
+            fix.ground_speed_uncertainty = to_double(value);
+        }
+        else if (key == "epc") {
+            fix.vertical_speed_uncertainty = to_double(value);
+        }
+    });
+    if (status == 2 || status == 3 || status == 4) {
+        // DGPS, RTK fixed and RTK floating
+        fix.status = DGPS_FIX;
+    }
+    else {
+        fix.status = fix.mode >= FIX_2D ? FIX : NOFIX;
+    }
+    handler(fix);
+}
+
+void GPSDParser::parse_sky(std::string_view report) {
+    int used = -1;
+    int visible = -1;
+    int listed = 0;
+    int listed_used = 0;
+    for_each_member(report, [&](std::string_view key, std::string_view value) {
+        if (key == "uSat") {
+            used = (int)to_double(value);
+        }
+        else if (key == "nSat") {
+            visible = (int)to_double(value);
+        }
+        else if (key == "satellites") {
+            for_each_element(value, [&](std::string_view satellite) {
+                ++listed;
+                for_each_member(satellite, [&](std::string_view satellite_key, std::string_view satellite_value) {
+                    if (satellite_key == "used" && satellite_value == "true") {
+                        ++listed_used;
+                    }
+                });
+            });
+        }
+    });
+    satellites_used = used >= 0 ? used : listed_used;
+    satellites_visible = visible >= 0 ? visible : listed;
+}
@@ -0,0 +1,108 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <functional>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+#include "GPSFix.h"
+
+/**
+ * \class GPSDParser
+ *
+ * \brief Incremental parser of the JSON reports sent by gpsd
+ *
+ * Bytes received from the gpsd socket are passed to feed() as they arrive, in
+ * chunks of any size. Every complete line is parsed in place, without
+ * allocating memory: TPV reports produce a GPSFix that is passed to the handler,
+ * and SKY reports update the number of satellites used and visible reported
+ * with the next fixes. Other reports are ignored.
+ */
+class GPSDParser {
+
+public:
+
+    /**
+     * Called with every TPV report
+     */
+    typedef std::function<void(const GPSFix&)> FixHandler;
+
+    /**
+     * Constructor
+     * @param handler Called with every TPV report
+     */
+    explicit GPSDParser(FixHandler handler) : handler(std::move(handler)), length(0), overflow(false),
+        satellites_used(0), satellites_visible(0) {
+
+    }
+
+    /**
+     * Parse received bytes. The handler is called for each TPV report completed by these bytes.
+     * @param data The received bytes
+     * @param size The number of received bytes
+     */
+    void feed(const char* data, std::size_t size);
+
+    /**
+     * Discard the partial line and the satellite counts (e.g. after a reconnection)
+     */
+    void reset();
+
+    /**
+     * Parse one report
+     * @param report A JSON report without the line terminator
+     * @returns Whether the report was a TPV report (and the handler was called)
+     */
+    bool parse_report(std::string_view report);
+
+    /**
+     * Parse an ISO 8601 UTC time as sent by gpsd (e.g. "2019-03-25T12:54:12.480Z")
+     * @param time The time
+     * @param nanos Where the nanoseconds since the epoch are stored
+     * @returns Whether the time was valid
+     */
+    static bool parse_time(std::string_view time, uint64_t& nanos);
+
+    /**
+     * Maximum length of a report. Longer lines are discarded.
+     */
+    static const std::size_t MAX_REPORT_SIZE = 8192;
+
+private:
+
+    void parse_fix(std::string_view report);
+
+    void parse_sky(std::string_view report);
+
+    FixHandler handler;
+
+    char line[MAX_REPORT_SIZE];
+
+    std::size_t length;
+
+    // The current line is longer than MAX_REPORT_SIZE and is being discarded
+    bool overflow;
+
+    int satellites_used;
+
+    int satellites_visible;
+
+};
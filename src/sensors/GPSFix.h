@@ -0,0 +1,62 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+enum GPSStatus {
+    NOFIX = 0, // no fix
+    FIX, // fix without DGPS
+    DGPS_FIX // fix with DGPS
+};
+
+enum FixMode {
+    NOT_SEEN = 0, 
+    NO_FIX,
+    FIX_2D,
+    FIX_3D
+};
+
+/**
+ * A position fix as reported by a GNSS receiver or by gpsd.
+ * Values that were not reported are NaN.
+ */
+struct GPSFix {
+    uint64_t time = 0; // UTC nanoseconds since the epoch
+    GPSStatus status = NOFIX;
+    FixMode mode = NOT_SEEN;
+    int satellites_used = 0;
+    int satellites_visible = 0;
+
+    double latitude = std::numeric_limits<double>::quiet_NaN(); // degrees
+    double longitude = std::numeric_limits<double>::quiet_NaN(); // degrees
+    double altitude = std::numeric_limits<double>::quiet_NaN(); // meters
+    double track = std::numeric_limits<double>::quiet_NaN(); // degrees from true north
+    double ground_speed = std::numeric_limits<double>::quiet_NaN(); // m/s
+    double vertical_speed = std::numeric_limits<double>::quiet_NaN(); // m/s
+
+    // Uncertainties with 95% confidence
+    double latitude_uncertainty = std::numeric_limits<double>::quiet_NaN(); // meters
+    double longitude_uncertainty = std::numeric_limits<double>::quiet_NaN(); // meters
+    double altitude_uncertainty = std::numeric_limits<double>::quiet_NaN(); // meters
+    double track_uncertainty = std::numeric_limits<double>::quiet_NaN(); // degrees
+    double ground_speed_uncertainty = std::numeric_limits<double>::quiet_NaN(); // m/s
+    double vertical_speed_uncertainty = std::numeric_limits<double>::quiet_NaN(); // m/s
+};
@@ -18,28 +18,232 @@
 
 #include "GPSSensor.h"
 
+#include <cstring>
+#include <cerrno>
+#include <thread>
+#include <unistd.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+const int GPSSensor::READ_TIMEOUT_MILLIS;
+
+// Ask gpsd to stream JSON reports
+static const char WATCH_COMMAND[] = "?WATCH={\"enable\":true,\"json\":true};\n";
+
+GPSDParser::FixHandler GPSSensor::make_handler() {
+    return [this](const GPSFix& fix) {
+        std::shared_ptr<GPSData> gps_data = std::make_shared<GPSData>(fix);
+        gps_data->set_origin(origin);
+        enqueue(gps_data);
+    };
+}
+
 void GPSSensor::start() {
-    if (gps.stream(WATCH_ENABLE | WATCH_JSON) == NULL) {
+    if (is_started()) {
+        throw std::runtime_error("Sensor already started!");
+    }
+    // Not in the reactor thread, where a slow name resolution would stall other components
+    resolve();
+    std::unique_lock<std::mutex> lck(mtx);
+    if (is_attached()) {
+        retry_timer = get_reactor().add_timer(0, 0, [this](uint64_t) {
+            retry();
+        });
+    }
+    connect();
+    bool connected = fd >= 0;
+    lck.unlock();
+    if (!connected) {
+        release();
         throw std::runtime_error("No GPSD running");
     }
     Sensor::start();
-    Log::log(INFO) << "[" << name << "] GPS sensor started";
+    RTDATA_LOG(INFO) << "[" << name << "] GPS sensor started";
 }
 
 void GPSSensor::stop() {
     Sensor::stop();
+    release();
+}
+
+void GPSSensor::release() {
+    std::unique_lock<std::mutex> lck(mtx);
+    disconnect();
+    lck.unlock();
+    // Without the lock, which the handlers take
+    if (retry_timer >= 0) {
+        get_reactor().remove_timer(retry_timer);
+        retry_timer = -1;
+    }
+    get_reactor().synchronize();
+}
+
+void GPSSensor::resolve() {
+    addresses.clear();
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* results = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &results) != 0) {
+        return;
+    }
+    for (struct addrinfo* result = results; result != nullptr; result = result->ai_next) {
+        Address address;
+        address.family = result->ai_family;
+        address.socktype = result->ai_socktype;
+        address.protocol = result->ai_protocol;
+        std::memcpy(&address.address, result->ai_addr, result->ai_addrlen);
+        address.length = result->ai_addrlen;
+        addresses.push_back(address);
+    }
+    freeaddrinfo(results);
+}
+
+void GPSSensor::connect() {
+    // Called with the lock held. Blocks until connected, so not from a shared reactor.
+    for (const Address& address : addresses) {
+        fd = socket(address.family, address.socktype | SOCK_CLOEXEC, address.protocol);
+        if (fd < 0) {
+            continue;
+        }
+        if (::connect(fd, (const struct sockaddr*)&address.address, address.length) == 0 &&
+            send(fd, WATCH_COMMAND, sizeof(WATCH_COMMAND) - 1, MSG_NOSIGNAL) >= 0) {
+            break;
+        }
+        ::close(fd);
+        fd = -1;
+    }
+    if (fd < 0) {
+        return;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    parser.reset();
+    get_reactor().add(fd, Reactor::READABLE, [this](uint32_t) {
+        on_socket();
+    });
+}
+
+void GPSSensor::connect_async(std::size_t index) {
+    // Called with the lock held. Completes in finish_connect() when the socket is writable.
+    for (; index < addresses.size(); ++index) {
+        const Address& address = addresses[index];
+        fd = socket(address.family, address.socktype | SOCK_CLOEXEC | SOCK_NONBLOCK, address.protocol);
+        if (fd < 0) {
+            continue;
+        }
+        if (::connect(fd, (const struct sockaddr*)&address.address, address.length) == 0 || errno == EINPROGRESS) {
+            connecting = true;
+            next_address = index + 1;
+            get_reactor().add(fd, Reactor::WRITABLE, [this](uint32_t) {
+                on_socket();
+            });
+            return;
+        }
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void GPSSensor::finish_connect() {
+    // Called with the lock held
+    int error = 0;
+    socklen_t length = sizeof(error);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) < 0) {
+        error = errno;
+    }
+    if (error == 0 && send(fd, WATCH_COMMAND, sizeof(WATCH_COMMAND) - 1, MSG_NOSIGNAL | MSG_DONTWAIT) < 0) {
+        error = errno;
+    }
+    if (error != 0) {
+        // Try the next address, or wait for the retry timer
+        disconnect();
+        connect_async(next_address);
+        return;
+    }
+    connecting = false;
+    parser.reset();
+    get_reactor().modify(fd, Reactor::READABLE);
+    get_reactor().set_timer(retry_timer, 0, 0);
+    RTDATA_LOG(INFO) << "[" << name << "] Reconnected to gpsd";
+}
+
+void GPSSensor::disconnect() {
+    if (fd >= 0) {
+        // Called with the lock held: a handler waiting for it finds the socket closed
+        get_reactor().remove(fd, false);
+        ::close(fd);
+        fd = -1;
+        connecting = false;
+    }
 }
 
 void GPSSensor::read() {
-    if (gps.waiting(10)) { // wait for input, timeout = 10 seconds
-        gps_data_t* gpsd_data = gps.read();
-        if (gpsd_data == NULL) {
-            Log::log(WARNING) << "[" << name << "] Received invalid (null) GPS data";
-            return; // invalid gps data
+    std::unique_lock<std::mutex> lck(mtx);
+    if (fd < 0) {
+        connect();
+        if (fd < 0) {
+            lck.unlock();
+            std::this_thread::sleep_for(std::chrono::nanoseconds(sampling_rate));
+            return;
+        }
+        RTDATA_LOG(INFO) << "[" << name << "] Reconnected to gpsd";
+    }
+    lck.unlock();
+    get_reactor().run_once(READ_TIMEOUT_MILLIS);
+}
+
+void GPSSensor::retry() {
+    std::lock_guard<std::mutex> lck(mtx);
+    if (is_stopped() || (fd >= 0 && !connecting)) {
+        return;
+    }
+    if (connecting) {
+        // Not connected within a retry period: the host is unreachable, try the next address
+        disconnect();
+        connect_async(next_address < addresses.size() ? next_address : 0);
+        return;
+    }
+    connect_async(0);
+}
+
+void GPSSensor::on_socket() {
+    std::lock_guard<std::mutex> lck(mtx);
+    if (fd < 0) {
+        return;
+    }
+    if (connecting) {
+        finish_connect();
+    }
+    else {
+        receive();
+    }
+}
+
+void GPSSensor::receive() {
+    // Called with the lock held
+    char buffer[4096];
+    while (true) {
+        ssize_t size = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (size > 0) {
+            parser.feed(buffer, size);
+            continue;
+        }
+        if (size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        if (size < 0 && errno == EINTR) {
+            continue;
+        }
+        RTDATA_LOG(WARNING) << "[" << name << "] Lost the connection to gpsd"
+            << (size < 0 ? std::string(": ") + std::strerror(errno) : std::string());
+        count_read_error();
+        disconnect();
+        if (retry_timer >= 0) {
+            get_reactor().set_timer(retry_timer, sampling_rate, sampling_rate);
         }
-        std::shared_ptr<GPSData> gps_data = std::make_shared<GPSData>(gpsd_data);
-        gps_data->set_origin(name);
-        queue.push(gps_data);
+        return;
     }
 }
 
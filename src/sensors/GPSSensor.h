@@ -18,10 +18,19 @@
 
 #pragma once
 
+#include <mutex>
+#include <vector>
+#include <sys/socket.h>
+
 #include "../Sensor.h"
 #include "../Log.h"
+#include "../concurrent/Reactor.h"
+#include "GPSFix.h"
+#include "GPSDParser.h"
 
-#include <libgpsmm.h> 
+#ifndef DEFAULT_GPSD_PORT
+#define DEFAULT_GPSD_PORT "2947"
+#endif
 
 // Forward declaration
 class GPSData;
@@ -30,6 +39,17 @@ class GPSData;
  * GPS sensor
  * Can read from a GPS sensor connected to a TTY port
  * and managed by a gpsd daemon.
+ *
+ * The sensor connects to the gpsd socket and asks for JSON reports. The
+ * socket is watched by a Reactor, so every fix is parsed and published as
+ * soon as gpsd sends it; the sampling rate is only used as the retry period
+ * when gpsd is not reachable.
+ *
+ * The address of gpsd is resolved once, on start(). Attached to a shared Reactor
+ * (see Sensor::attach()), the sensor needs no thread: after the connection is lost,
+ * a timer of the reactor retries it with a non-blocking connect, so an unreachable
+ * host does not stall the reactor. A connection still in progress when the timer
+ * fires again is abandoned for the next address.
  */
 class GPSSensor : public Sensor {
 
@@ -38,21 +58,22 @@ public:
     /**
      * Default constructor
      */
-    GPSSensor() : Sensor(), host("localhost"), port(DEFAULT_GPSD_PORT), gps(host.c_str(), port.c_str()) {
-
+    GPSSensor() : Sensor(), host("localhost"), port(DEFAULT_GPSD_PORT), parser(make_handler()) {
+        polling = false;
     }
 
     /**
      * Constructor with all configurable parameters
      * @param name Name of the sensor. Used to identify it.
      * @param topic The topic where this sensor will publish its data to
-     * @param rate The rate in nanoseconds at which the sensor will be read
+     * @param rate The rate in nanoseconds at which the connection to gpsd is retried
      * @param host The hostname of the host where the gpsd daemon is running. By default "localhost"
      * @param port The port that gpsd is listening to. By default DEFAULT_GPSD_PORT
      */
     GPSSensor(const std::string& name, const std::string& topic, 
-        uint64_t rate, const std::string& host="localhost", const std::string& port=DEFAULT_GPSD_PORT) : Sensor(name, topic, rate), host(host), port(port), gps(host.c_str(), port.c_str()) {
-
+        uint64_t rate, const std::string& host="localhost", const std::string& port=DEFAULT_GPSD_PORT) : Sensor(name, topic, rate),
+        host(host), port(port), parser(make_handler()) {
+            polling = false;
     }
     
     /**
@@ -60,8 +81,8 @@ public:
      * @param config The node containing the configuration for this sensor
      */
     explicit GPSSensor(Configuration& config) : Sensor(config), 
-        host(config["host"].get<std::string>()), port(config["port"].get<std::string>()), gps(host.c_str(), port.c_str()) {
-
+        host(config["host"].get<std::string>()), port(config["port"].get<std::string>()), parser(make_handler()) {
+            polling = false;
     }
 
     /**
@@ -104,31 +125,67 @@ public:
 protected:
 
     /**
-     * Internal read method
+     * Internal read method. Waits for the next reports from gpsd.
      */
     virtual void read();
 
 private:
 
+    GPSDParser::FixHandler make_handler();
+
+    void resolve();
+
+    void connect();
+
+    void connect_async(std::size_t index);
+
+    void finish_connect();
+
+    void disconnect();
+
+    void on_socket();
+
+    void receive();
+
+    void retry();
+
+    void release();
+
+    /**
+     * Maximum time read() waits for gpsd, so stop() is noticed
+     */
+    static const int READ_TIMEOUT_MILLIS = 100;
+
     std::string host;
 
     std::string port;
 
-    gpsmm gps;
+    // Guards the connection, used by the handlers of an attached sensor
+    std::mutex mtx;
 
-};
+    struct Address {
+        int family;
+        int socktype;
+        int protocol;
+        struct sockaddr_storage address;
+        socklen_t length;
+    };
 
-enum GPSStatus {
-    NOFIX = 0, // no fix
-    FIX, // fix without DGPS
-    DGPS_FIX // fix with DGPS
-};
+    // The addresses of gpsd, resolved on start()
+    std::vector<Address> addresses;
+
+    int fd = -1;
+
+    // Whether fd is a non-blocking connection in progress, to addresses[next_address - 1]
+    bool connecting = false;
+
+    std::size_t next_address = 0;
+
+    // Reconnects an attached sensor, armed while the connection is lost
+    int retry_timer = -1;
+
+    GPSDParser parser;
 
-enum FixMode {
-    NOT_SEEN = 0, 
-    NO_FIX,
-    FIX_2D,
-    FIX_3D
 };
 
 class GPSData : public Data {
@@ -138,28 +195,32 @@ public:
     /**
      * Default constructor
      */
-    GPSData() : Data() {
+    GPSData() : GPSData(GPSFix()) {
 
     }
 
-    explicit GPSData(gps_data_t* gps_data) :
-        gps_time(Timestamp((uint64_t)(gps_data->fix.time * 1000000000.0))),
-        status((GPSStatus)gps_data->status),
-        number_of_satellites_used(gps_data->satellites_used),
-        number_of_satellites_visible(gps_data->satellites_visible),
-        fix_mode((FixMode)gps_data->fix.mode),
-        longitude(gps_data->fix.longitude),
-        latitude(gps_data->fix.latitude),
-        altitude(gps_data->fix.altitude),
-        track(gps_data->fix.track),
-        ground_speed(gps_data->fix.speed),
-        vertical_speed(gps_data->fix.climb),
-        latitude_uncertainty(gps_data->fix.epy),
-        longitude_uncertainty(gps_data->fix.epx),
-        altitude_uncertainty(gps_data->fix.epv),
-        track_uncertainty(gps_data->fix.epd),
-        ground_speed_uncertainty(gps_data->fix.eps),
-        vertical_speed_uncertainty(gps_data->fix.epc) {
+    /**
+     * Constructor from a fix
+     * @param fix The fix reported by the receiver
+     */
+    explicit GPSData(const GPSFix& fix) :
+        gps_time(Timestamp(fix.time)),
+        status(fix.status),
+        number_of_satellites_used(fix.satellites_used),
+        number_of_satellites_visible(fix.satellites_visible),
+        fix_mode(fix.mode),
+        longitude(fix.longitude),
+        latitude(fix.latitude),
+        altitude(fix.altitude),
+        track(fix.track),
+        ground_speed(fix.ground_speed),
+        vertical_speed(fix.vertical_speed),
+        latitude_uncertainty(fix.latitude_uncertainty),
+        longitude_uncertainty(fix.longitude_uncertainty),
+        altitude_uncertainty(fix.altitude_uncertainty),
+        track_uncertainty(fix.track_uncertainty),
+        ground_speed_uncertainty(fix.ground_speed_uncertainty),
+        vertical_speed_uncertainty(fix.vertical_speed_uncertainty) {
     
     }
 
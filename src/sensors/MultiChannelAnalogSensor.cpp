@@ -0,0 +1,327 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "MultiChannelAnalogSensor.h"
+
+#include <algorithm>
+#include <cstring>
+
+const std::size_t MultiChannelAnalogSensor::IIO_MAX_SCANS;
+
+// Four doubles: one AVX register, or two SSE2/NEON registers
+typedef double double4 __attribute__((vector_size(4 * sizeof(double))));
+
+static double get_number(Configuration& config) {
+    if (config.is<double>()) {
+        return config.get<double>();
+    }
+    if (config.is<int64_t>()) {
+        return (double)config.get<int64_t>();
+    }
+    return (double)config.get<uint64_t>();
+}
+
+MultiChannelAnalogSensor::MultiChannelAnalogSensor(Configuration& config) :
+    Sensor(config),
+    quantization_bits((int)get_number(config["quantization_bits"])),
+    zero_voltage(get_number(config["zero_voltage"])),
+    span_voltage(get_number(config["span_voltage"])) {
+        Configuration& list = config["channels"];
+        for (std::size_t i = 0; i < list.size(); ++i) {
+            Configuration& node = list[i];
+            AnalogChannel channel;
+            channel.name = node["name"].get<std::string>();
+            channel.input = node["input"].is_null() ? -1 : (int)get_number(node["input"]);
+            channel.zero_value = get_number(node["zero"]);
+            channel.span_value = get_number(node["span"]);
+            channel.scale = get_number(node["scale"]);
+            channels.push_back(channel);
+        }
+        compute_calibration();
+        if (!config["iio_device"].is_null()) {
+            Configuration& trigger = config["iio_trigger"];
+            Configuration& length = config["iio_buffer_length"];
+            use_iio_buffer(config["iio_device"].get<std::string>(),
+                trigger.is_null() ? "" : trigger.get<std::string>(),
+                length.is_null() ? 0 : length.get<uint64_t>());
+        }
+        else if (!config["spi_device"].is_null()) {
+            Configuration& speed = config["spi_speed"];
+            Configuration& scans = config["spi_scans"];
+            use_spi(config["spi_device"].get<std::string>(),
+                speed.is_null() ? 1000000 : (uint32_t)speed.get<uint64_t>(),
+                scans.is_null() ? 1 : scans.get<uint64_t>());
+        }
+}
+
+void MultiChannelAnalogSensor::compute_calibration() {
+    if (channels.empty()) {
+        throw std::invalid_argument("A MultiChannelAnalogSensor needs at least one channel");
+    }
+    zeros.clear();
+    factors.clear();
+    double levels = (double)(1 << quantization_bits);
+    for (const AnalogChannel& channel : channels) {
+        double zero = levels * (channel.zero_value - zero_voltage) / span_voltage;
+        double span = levels * channel.span_value / span_voltage;
+        zeros.push_back(zero);
+        factors.push_back(channel.scale / span);
+    }
+}
+
+void MultiChannelAnalogSensor::use_iio_buffer(const std::string& device, const std::string& trigger, std::size_t length) {
+    if (is_started()) {
+        throw std::runtime_error("Cannot change the input of a started sensor");
+    }
+    iio_device = device;
+    iio_trigger = trigger;
+    iio_length = length;
+    spi_device.clear();
+}
+
+void MultiChannelAnalogSensor::use_spi(const std::string& device, uint32_t speed, std::size_t scans) {
+    if (is_started()) {
+        throw std::runtime_error("Cannot change the input of a started sensor");
+    }
+    if (scans == 0) {
+        throw std::invalid_argument("At least one scan per read is needed");
+    }
+    spi_device = device;
+    spi_speed = speed;
+    spi_scans = scans;
+    iio_device.clear();
+}
+
+void MultiChannelAnalogSensor::start() {
+    // Before touching the buffer or the SPI device, which the sensor thread may be reading
+    if (is_started()) {
+        throw std::runtime_error("Sensor already started!");
+    }
+    if (!iio_device.empty()) {
+        iio_buffer = std::make_unique<IIOBuffer>(iio_device);
+        for (const AnalogChannel& channel : channels) {
+            iio_buffer->enable_channel(channel.name);
+        }
+        try {
+            iio_buffer->enable_channel("in_timestamp");
+        }
+        catch (const std::runtime_error&) {
+            // No timestamp channel, samples are stamped when read
+        }
+        if (!iio_trigger.empty()) {
+            iio_buffer->set_trigger(iio_trigger);
+        }
+        if (iio_length > 0) {
+            iio_buffer->set_length(iio_length);
+        }
+        iio_buffer->open();
+        iio_positions.clear();
+        for (const AnalogChannel& channel : channels) {
+            iio_positions.push_back(iio_buffer->get_channel_position(channel.name));
+        }
+        iio_values.resize(IIO_MAX_SCANS * iio_buffer->get_channel_count());
+    }
+    else if (!spi_device.empty()) {
+        spi = std::make_unique<SPI>(spi_device, spi_speed);
+        prepare_spi();
+    }
+    else {
+        throw std::runtime_error("No input set for sensor " + name);
+    }
+    Sensor::start();
+}
+
+void MultiChannelAnalogSensor::stop() {
+    Sensor::stop();
+    iio_buffer.reset();
+    spi.reset();
+}
+
+std::size_t MultiChannelAnalogSensor::get_channel_count() const {
+    return channels.size();
+}
+
+void MultiChannelAnalogSensor::calibrate(double* values, std::size_t count, double zero, double factor) {
+    double4 zero4 = {zero, zero, zero, zero};
+    double4 factor4 = {factor, factor, factor, factor};
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        double4 block;
+        std::memcpy(&block, values + i, sizeof(block));
+        block = (block - zero4) * factor4;
+        std::memcpy(values + i, &block, sizeof(block));
+    }
+    for (; i < count; ++i) {
+        values[i] = (values[i] - zero) * factor;
+    }
+}
+
+void MultiChannelAnalogSensor::read() {
+    if (iio_buffer) {
+        read_buffer();
+    }
+    else if (spi) {
+        read_spi();
+    }
+}
+
+void MultiChannelAnalogSensor::read_buffer() {
+    std::size_t count;
+    try {
+        count = iio_buffer->read(iio_values.data(), IIO_MAX_SCANS);
+    }
+    catch (const std::runtime_error& ex) {
+        RTDATA_LOG(WARNING) << "[" << name << "] Failed to read from " << iio_device << ": " << ex.what();
+        count_read_error();
+        return;
+    }
+    if (count == 0) {
+        return;
+    }
+    std::size_t stride = iio_buffer->get_channel_count();
+    std::shared_ptr<AnalogBlockData> block = std::make_shared<AnalogBlockData>(origin, channels.size(), count);
+    // Transpose the interleaved scans into contiguous channels
+    for (std::size_t c = 0; c < channels.size(); ++c) {
+        double* values = block->get_channel(c);
+        const int64_t* raw = iio_values.data() + iio_positions[c];
+        for (std::size_t s = 0; s < count; ++s) {
+            values[s] = (double)raw[s * stride];
+        }
+    }
+    int timestamp_position = iio_buffer->get_channel_position("in_timestamp");
+    if (timestamp_position >= 0) {
+        for (std::size_t s = 0; s < count; ++s) {
+            block->set_sample_time(s, (uint64_t)iio_values[s * stride + timestamp_position]);
+        }
+    }
+    publish(block);
+}
+
+void MultiChannelAnalogSensor::prepare_spi() {
+    std::size_t count = channels.size();
+    spi_batch = std::max<std::size_t>(1, std::min(spi_scans, SPITransaction::MAX_SEGMENTS / count));
+    spi_commands.assign(spi_batch * count * 3, 0);
+    spi_responses.assign(spi_batch * count * 3, 0);
+    for (std::size_t s = 0; s < spi_batch; ++s) {
+        for (std::size_t c = 0; c < count; ++c) {
+            int input = channels[c].input < 0 ? (int)c : channels[c].input;
+            uint8_t* command = spi_commands.data() + (s * count + c) * 3;
+            // Start bit, single-ended, 3-bit input; the 12-bit result ends the frame
+            command[0] = 0x06 | ((input >> 2) & 0x01);
+            command[1] = (input & 0x03) << 6;
+        }
+    }
+    build_spi_transaction(spi_transaction, spi_batch);
+    build_spi_transaction(spi_remainder, spi_scans % spi_batch);
+}
+
+void MultiChannelAnalogSensor::build_spi_transaction(SPITransaction& transaction, std::size_t scans) {
+    transaction.clear();
+    std::size_t conversions = scans * channels.size();
+    for (std::size_t i = 0; i < conversions; ++i) {
+        transaction.transfer(spi_commands.data() + i * 3, spi_responses.data() + i * 3, 3);
+        if (i + 1 < conversions) {
+            // The ADC starts a conversion on each falling edge of the chip select
+            transaction.cs_change();
+        }
+    }
+}
+
+void MultiChannelAnalogSensor::read_spi() {
+    std::shared_ptr<AnalogBlockData> block = std::make_shared<AnalogBlockData>(origin, channels.size(), spi_scans);
+    std::size_t count = channels.size();
+    for (std::size_t first = 0; first < spi_scans; first += spi_batch) {
+        std::size_t scans = std::min(spi_batch, spi_scans - first);
+        uint64_t begin = Timestamp::now().to_nanos();
+        try {
+            spi->transfer(scans == spi_batch ? spi_transaction : spi_remainder);
+        }
+        catch (const std::runtime_error& ex) {
+            RTDATA_LOG(WARNING) << "[" << name << "] Failed to read from " << spi_device << ": " << ex.what();
+            count_read_error();
+            return;
+        }
+        uint64_t end = Timestamp::now().to_nanos();
+        for (std::size_t s = 0; s < scans; ++s) {
+            // The scans are evenly spread over the transfer
+            block->set_sample_time(first + s, begin + (end - begin) * s / scans);
+            for (std::size_t c = 0; c < count; ++c) {
+                const uint8_t* response = spi_responses.data() + (s * count + c) * 3;
+                block->get_channel(c)[first + s] = (double)(((response[1] & 0x0F) << 8) | response[2]);
+            }
+        }
+    }
+    publish(block);
+}
+
+void MultiChannelAnalogSensor::publish(std::shared_ptr<AnalogBlockData> block) {
+    for (std::size_t c = 0; c < channels.size(); ++c) {
+        calibrate(block->get_channel(c), block->get_sample_count(), zeros[c], factors[c]);
+    }
+    enqueue(block);
+}
+
+void AnalogBlockData::serialize(SerializedObject* object) {
+    Data::serialize(object);
+    object->put("channels", (unsigned int)channels);
+    object->put("samples", (unsigned int)samples);
+    object->put("sample_times", sample_times.data(), sample_times.size());
+    object->put("values", values.data(), values.size());
+}
+
+void AnalogBlockData::deserialize(SerializedObject* object) {
+    Data::deserialize(object);
+    channels = object->get_uint("channels");
+    samples = object->get_uint("samples");
+    object->get_array("sample_times", sample_times);
+    object->get_array("values", values);
+    if (sample_times.size() != samples || values.size() != channels * samples) {
+        throw std::length_error("The number of values does not match the size of the block");
+    }
+}
+
+std::size_t AnalogBlockData::get_channel_count() const {
+    return channels;
+}
+
+std::size_t AnalogBlockData::get_sample_count() const {
+    return samples;
+}
+
+double* AnalogBlockData::get_channel(std::size_t channel) {
+    return values.data() + channel * samples;
+}
+
+const double* AnalogBlockData::get_channel(std::size_t channel) const {
+    return values.data() + channel * samples;
+}
+
+double AnalogBlockData::get_value(std::size_t channel, std::size_t sample) const {
+    return values[channel * samples + sample];
+}
+
+uint64_t AnalogBlockData::get_sample_time(std::size_t sample) const {
+    return sample_times[sample];
+}
+
+void AnalogBlockData::set_sample_time(std::size_t sample, uint64_t nanos) {
+    sample_times[sample] = nanos;
+    if (sample == 0) {
+        time = Timestamp(nanos);
+    }
+}
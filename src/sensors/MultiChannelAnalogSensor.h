@@ -0,0 +1,310 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "../Sensor.h"
+#include "../Log.h"
+#include "../io/IIOBuffer.h"
+#include "../io/SPI.h"
+
+#include <memory>
+#include <vector>
+#include <string>
+
+/**
+ * Calibration of one channel of a MultiChannelAnalogSensor.
+ * Same meaning as the parameters of AnalogSensor.
+ */
+struct AnalogChannel {
+    /**
+     * The IIO channel (e.g. "in_voltage0"), or a short identifier when reading from SPI
+     */
+    std::string name;
+    /**
+     * The input of the SPI ADC. -1 to use the position of the channel.
+     */
+    int input;
+    /**
+     * The voltage at which the ADC reads the lowest value
+     */
+    double zero_value;
+    /**
+     * The voltage at which the ADC reads the highest value
+     */
+    double span_value;
+    /**
+     * The maximum value that can be read by the sensor
+     */
+    double scale;
+};
+
+/**
+ * \class AnalogBlockData
+ *
+ * \brief A block of samples of several analog channels
+ *
+ * The values are stored as a structure of arrays: the samples of each channel
+ * are contiguous (see get_channel()). Every sample (scan) has its own timestamp;
+ * the timestamp of the Data is the timestamp of the first sample.
+ */
+class AnalogBlockData : public Data {
+
+public:
+
+    AnalogBlockData() : Data(), channels(0), samples(0) {
+
+    }
+
+    AnalogBlockData(const std::string& origin, std::size_t channels, std::size_t samples) :
+        Data(origin), channels(channels), samples(samples), values(channels * samples, 0.0),
+        sample_times(samples, time.to_nanos()) {
+
+    }
+
+    AnalogBlockData(const Timestamp& time, const std::string& origin, std::size_t channels, std::size_t samples) :
+        Data(time, origin), channels(channels), samples(samples), values(channels * samples, 0.0),
+        sample_times(samples, time.to_nanos()) {
+
+    }
+
+    AnalogBlockData(OriginId origin, std::size_t channels, std::size_t samples) :
+        Data(origin), channels(channels), samples(samples), values(channels * samples, 0.0),
+        sample_times(samples, time.to_nanos()) {
+
+    }
+
+    /**
+     * Serialize the AnalogBlockData. Do not call directly.
+     * @param object The resulting SerializedObject where the data must be saved.
+     */
+    virtual void serialize(SerializedObject* object) override;
+
+    /**
+     * Deserialize the AnalogBlockData. Do not call directly.
+     * @param object The SerializedObject to load the data from.
+     */
+    virtual void deserialize(SerializedObject* object) override;
+
+    /**
+     * Get the number of channels
+     * @returns The number of channels
+     */
+    std::size_t get_channel_count() const;
+
+    /**
+     * Get the number of samples per channel
+     * @returns The number of samples
+     */
+    std::size_t get_sample_count() const;
+
+    /**
+     * Get the samples of a channel
+     * @param channel The position of the channel
+     * @returns The get_sample_count() contiguous samples of the channel
+     */
+    double* get_channel(std::size_t channel);
+
+    const double* get_channel(std::size_t channel) const;
+
+    /**
+     * Get a sample
+     * @param channel The position of the channel
+     * @param sample The position of the sample
+     * @returns The value of the sample
+     */
+    double get_value(std::size_t channel, std::size_t sample) const;
+
+    /**
+     * Get the timestamp of a sample in nanoseconds
+     * @param sample The position of the sample
+     * @returns When the sample was taken
+     */
+    uint64_t get_sample_time(std::size_t sample) const;
+
+    /**
+     * Set the timestamp of a sample in nanoseconds. Setting the first
+     * sample also sets the timestamp of the Data.
+     * @param sample The position of the sample
+     * @param nanos When the sample was taken
+     */
+    void set_sample_time(std::size_t sample, uint64_t nanos);
+
+private:
+
+    std::size_t channels;
+
+    std::size_t samples;
+
+    std::vector<double> values;
+
+    std::vector<uint64_t> sample_times;
+
+};
+
+/**
+ * \class MultiChannelAnalogSensor
+ *
+ * \brief Samples several channels of an ADC at once
+ *
+ * Each read takes a block of scans of all the channels, either from the buffered
+ * interface of an IIO device or from a MCP3204/MCP3208 SPI ADC, and publishes it
+ * as a single AnalogBlockData. The raw values are converted with the same formula
+ * as AnalogSensor, vectorized across the samples of each channel.
+ */
+class MultiChannelAnalogSensor : public Sensor {
+
+public:
+
+    /**
+     * Constructor for MultiChannelAnalogSensor
+     * @param topic The topic this sensor will publish to
+     * @param sensorName A short identifier for the sensor
+     * @param samplingRate The rate that will be used to sample the sensor in nanos
+     * @param channels The calibration of each channel
+     * @param quantizationBits The resolution of the ADC in bits
+     * @param zeroVoltage The lowest possible voltage at which the ADC reads a value (tipically 0)
+     * @param spanVoltage The maximum possible voltage at which the ADC reads a value (tipically 5 or 3.3)
+     */
+    MultiChannelAnalogSensor(const std::string& topic,
+        const std::string& sensorName,
+        uint64_t samplingRate,
+        const std::vector<AnalogChannel>& channels,
+        int quantizationBits,
+        double zeroVoltage,
+        double spanVoltage) : Sensor(sensorName, topic, samplingRate), channels(channels),
+        quantization_bits(quantizationBits), zero_voltage(zeroVoltage), span_voltage(spanVoltage) {
+            compute_calibration();
+    }
+
+    /**
+     * Constructor with Configuration object.
+     * The channels are an array of {"name", "input", "zero", "span", "scale"} objects
+     * ("input" is optional). The source is either "iio_device" (with the optional
+     * "iio_trigger" and "iio_buffer_length") or "spi_device" (with the optional
+     * "spi_speed" and "spi_scans").
+     * @param config The configuration node for this sensor
+     */
+    explicit MultiChannelAnalogSensor(Configuration& config);
+
+    /**
+     * Read the channels from the buffered interface of an IIO device.
+     * The names of the channels are the IIO channels. Each read drains all the scans
+     * captured since the previous one. If the device has a timestamp channel, it is used
+     * as the timestamp of the samples.
+     * Must be called before starting the sensor.
+     * @param device The IIO device (e.g. "iio:device0")
+     * @param trigger The trigger to use (optional, default = keep the current trigger)
+     * @param length The length of the kernel buffer in scans (optional, default = keep the current length)
+     */
+    void use_iio_buffer(const std::string& device, const std::string& trigger = "", std::size_t length = 0);
+
+    /**
+     * Read the channels from a MCP3204/MCP3208 SPI ADC (single-ended inputs).
+     * The conversions of all the scans are chained in a single SPI transaction,
+     * split only when it exceeds SPITransaction::MAX_SEGMENTS.
+     * Must be called before starting the sensor.
+     * @param device The spidev device file (e.g. "/dev/spidev0.0")
+     * @param speed The clock of the bus in Hz
+     * @param scans The number of scans taken on each read (optional, default = 1)
+     */
+    void use_spi(const std::string& device, uint32_t speed, std::size_t scans = 1);
+
+    /**
+     * Starts the sensor.
+     * @throws std::runtime_error if the sensor has been already started or if it was stopped,
+     *      if no source was set, or if the source cannot be opened.
+     */
+    virtual void start() override;
+
+    /**
+     * Stops the sensor.
+     * @throws std::runtime_error if the sensor has been already stopped or if it was never started.
+     */
+    virtual void stop() override;
+
+    /**
+     * Get the number of channels
+     * @returns The number of channels
+     */
+    std::size_t get_channel_count() const;
+
+    /**
+     * Convert raw values in place: value = (value - zero) * factor
+     * @param values The values to convert
+     * @param count The number of values
+     * @param zero The raw value of the zero
+     * @param factor The scale divided by the raw span
+     */
+    static void calibrate(double* values, std::size_t count, double zero, double factor);
+
+protected:
+
+    /**
+     * Internal read method
+     */
+    virtual void read() override;
+
+private:
+
+    void compute_calibration();
+
+    void read_buffer();
+
+    void read_spi();
+
+    void prepare_spi();
+
+    void build_spi_transaction(SPITransaction& transaction, std::size_t scans);
+
+    void publish(std::shared_ptr<AnalogBlockData> block);
+
+    /**
+     * Maximum number of scans read from the IIO buffer at once
+     */
+    static const std::size_t IIO_MAX_SCANS = 256;
+
+    std::vector<AnalogChannel> channels;
+
+    int quantization_bits;
+    double zero_voltage;
+    double span_voltage;
+
+    // Raw zero and scale / span of each channel
+    std::vector<double> zeros;
+    std::vector<double> factors;
+
+    std::string iio_device;
+    std::string iio_trigger;
+    std::size_t iio_length = 0;
+    std::unique_ptr<IIOBuffer> iio_buffer;
+    std::vector<int64_t> iio_values;
+    std::vector<int> iio_positions;
+
+    std::string spi_device;
+    uint32_t spi_speed = 0;
+    std::size_t spi_scans = 1;
+    std::unique_ptr<SPI> spi;
+    // Commands and responses of spi_batch scans, 3 bytes per conversion
+    std::vector<uint8_t> spi_commands;
+    std::vector<uint8_t> spi_responses;
+    std::size_t spi_batch = 0;
+    SPITransaction spi_transaction; // spi_batch scans
+    SPITransaction spi_remainder; // spi_scans % spi_batch scans
+
+};
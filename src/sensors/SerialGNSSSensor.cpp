@@ -0,0 +1,186 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SerialGNSSSensor.h"
+
+#include <thread>
+
+const int SerialGNSSSensor::READ_TIMEOUT_MILLIS;
+
+GNSSParser::FixHandler SerialGNSSSensor::make_handler() {
+    return [this](const GPSFix& fix) {
+        std::shared_ptr<GPSData> gps_data = std::make_shared<GPSData>(fix);
+        gps_data->set_origin(origin);
+        enqueue(gps_data);
+    };
+}
+
+void SerialGNSSSensor::start() {
+    if (is_started()) {
+        throw std::runtime_error("Sensor already started!");
+    }
+    std::unique_lock<std::mutex> lck(mtx);
+    try {
+        if (is_attached()) {
+            retry_timer = get_reactor().add_timer(0, 0, [this](uint64_t) {
+                retry();
+            });
+        }
+        open();
+        configure();
+    }
+    catch (std::exception&) {
+        lck.unlock();
+        release();
+        throw;
+    }
+    lck.unlock();
+    Sensor::start();
+    RTDATA_LOG(INFO) << "[" << name << "] GNSS sensor started on " << device;
+}
+
+void SerialGNSSSensor::stop() {
+    Sensor::stop();
+    release();
+}
+
+void SerialGNSSSensor::release() {
+    std::unique_lock<std::mutex> lck(mtx);
+    close();
+    lck.unlock();
+    // Without the lock, which the handlers take
+    if (retry_timer >= 0) {
+        get_reactor().remove_timer(retry_timer);
+        retry_timer = -1;
+    }
+    get_reactor().synchronize();
+}
+
+void SerialGNSSSensor::open() {
+    serial = std::make_unique<Serial>(device, baud_rate);
+    parser.reset();
+    serial->set_non_blocking(true);
+    serial->set_low_latency(true);
+    get_reactor().add(serial->get_fd(), Reactor::READABLE, [this](uint32_t events) {
+        receive(events);
+    });
+}
+
+void SerialGNSSSensor::close() {
+    if (serial) {
+        // Called with the lock held: a handler waiting for it finds the port closed
+        get_reactor().remove(serial->get_fd(), false);
+        serial.reset();
+    }
+}
+
+void SerialGNSSSensor::configure() {
+    if (update_rate > 0) {
+        serial->send(make_rate_command(update_rate));
+    }
+    if (ubx) {
+        serial->send(make_nav_pvt_command());
+    }
+}
+
+void SerialGNSSSensor::read() {
+    std::unique_lock<std::mutex> lck(mtx);
+    if (!serial) {
+        try {
+            open();
+        }
+        catch (std::runtime_error&) {
+            lck.unlock();
+            std::this_thread::sleep_for(std::chrono::nanoseconds(sampling_rate));
+            return;
+        }
+        RTDATA_LOG(INFO) << "[" << name << "] Reopened " << device;
+    }
+    lck.unlock();
+    get_reactor().run_once(READ_TIMEOUT_MILLIS);
+}
+
+void SerialGNSSSensor::retry() {
+    std::lock_guard<std::mutex> lck(mtx);
+    if (serial || is_stopped()) {
+        return;
+    }
+    try {
+        open();
+    }
+    catch (std::runtime_error&) {
+        return;
+    }
+    get_reactor().set_timer(retry_timer, 0, 0);
+    RTDATA_LOG(INFO) << "[" << name << "] Reopened " << device;
+}
+
+void SerialGNSSSensor::receive(uint32_t events) {
+    std::lock_guard<std::mutex> lck(mtx);
+    if (!serial) {
+        return;
+    }
+    uint8_t buffer[1024];
+    try {
+        // A single read: the port is readable, so it does not block
+        std::size_t size = serial->read_some(buffer, sizeof(buffer));
+        if (size > 0) {
+            parser.feed(buffer, size);
+            return;
+        }
+        // Readable or hung up without data: the receiver is gone (e.g. unplugged), and the
+        // level-triggered descriptor would be reported again on every wait
+        if (events & (Reactor::READABLE | EPOLLHUP | EPOLLERR)) {
+            throw std::runtime_error("The serial port hung up");
+        }
+    }
+    catch (std::runtime_error& e) {
+        RTDATA_LOG(WARNING) << "[" << name << "] " << e.what();
+        count_read_error();
+        close();
+        if (retry_timer >= 0) {
+            get_reactor().set_timer(retry_timer, sampling_rate, sampling_rate);
+        }
+    }
+}
+
+std::vector<uint8_t> SerialGNSSSensor::make_rate_command(int update_rate) {
+    if (update_rate < 1 || update_rate > 1000) {
+        throw std::invalid_argument("Unsupported update rate");
+    }
+    uint16_t period = 1000 / update_rate; // measurement period in ms
+    // measRate, navRate (1 measurement per solution), timeRef (1 = GPS time)
+    return GNSSParser::make_ubx(0x06, 0x08, { (uint8_t)(period & 0xFF), (uint8_t)(period >> 8), 1, 0, 1, 0 });
+}
+
+std::vector<uint8_t> SerialGNSSSensor::make_nav_pvt_command() {
+    // msgClass NAV, msgID PVT, rate 1 on the current port
+    return GNSSParser::make_ubx(0x06, 0x01, { 0x01, 0x07, 1 });
+}
+
+std::string SerialGNSSSensor::get_device() const {
+    return device;
+}
+
+int SerialGNSSSensor::get_update_rate() const {
+    return update_rate;
+}
+
+uint64_t SerialGNSSSensor::get_parse_errors() const {
+    return parser.get_errors();
+}
@@ -0,0 +1,177 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+#include "../Sensor.h"
+#include "../Log.h"
+#include "../io/Serial.h"
+#include "../concurrent/Reactor.h"
+#include "GNSSParser.h"
+#include "GPSSensor.h"
+
+/**
+ * GNSS sensor
+ * Reads a GNSS receiver connected to a serial port directly, without gpsd.
+ *
+ * The port is watched by a Reactor and the received bytes are parsed as they
+ * arrive by a GNSSParser, which understands NMEA 0183 sentences and u-blox
+ * UBX frames. Every fix is published as a GPSData.
+ *
+ * On start, the sensor can configure a u-blox receiver (UBX-CFG-RATE) to compute
+ * fixes at a higher rate than the usual 1 Hz, and enable the UBX NAV-PVT message,
+ * which carries a whole fix in a single binary frame. At 10 Hz or more, NMEA needs a
+ * baud rate of at least 115200; the receiver must already be set to the baud rate of
+ * the sensor. The sampling rate is only used as the retry period when the port cannot
+ * be opened.
+ *
+ * Attached to a shared Reactor (see Sensor::attach()), the sensor needs no thread:
+ * a timer of the reactor retries opening the port after it is lost.
+ */
+class SerialGNSSSensor : public Sensor {
+
+public:
+
+    /**
+     * Constructor with all configurable parameters
+     * @param name Name of the sensor. Used to identify it.
+     * @param topic The topic where this sensor will publish its data to
+     * @param rate The rate in nanoseconds at which opening the port is retried
+     * @param device The serial port where the receiver is connected, e.g. /dev/ttyACM0
+     * @param baud_rate The baud rate of the serial port
+     * @param update_rate The navigation rate in Hz to configure on the receiver. 0 to keep its setting.
+     * @param ubx Whether to enable the UBX NAV-PVT message on the receiver
+     */
+    SerialGNSSSensor(const std::string& name, const std::string& topic, uint64_t rate,
+        const std::string& device, int baud_rate = 9600, int update_rate = 0, bool ubx = false) :
+        Sensor(name, topic, rate), device(device), baud_rate(baud_rate), update_rate(update_rate), ubx(ubx),
+        parser(make_handler()) {
+            polling = false;
+    }
+
+    /**
+     * Constructor with a Configuration object
+     * Keys: device, baud_rate (default 9600), update_rate (Hz, default 0) and ubx (default false)
+     * @param config The node containing the configuration for this sensor
+     */
+    explicit SerialGNSSSensor(Configuration& config) : Sensor(config),
+        device(config["device"].get<std::string>()),
+        baud_rate(config["baud_rate"].is_null() ? 9600 : (int)config["baud_rate"].get<uint64_t>()),
+        update_rate(config["update_rate"].is_null() ? 0 : (int)config["update_rate"].get<uint64_t>()),
+        ubx(config["ubx"].is_null() ? false : config["ubx"].get<bool>()),
+        parser(make_handler()) {
+            polling = false;
+    }
+
+    /**
+     * Starts the sensor. Configures the receiver if an update rate or UBX were requested.
+     * @throws std::runtime_error if the sensor has been already started or if it was stopped.
+     * @throws std::runtime_error if the serial port cannot be opened
+     * @throws std::invalid_argument if the baud rate is not supported
+     */
+    virtual void start() override;
+
+    /**
+     * Stops the sensor.
+     * @throws std::runtime_error if the sensor has been already stopped or if it was never started.
+     */
+    virtual void stop() override;
+
+    /**
+     * Get the serial port of the receiver
+     * @returns The serial port of the receiver
+     */
+    std::string get_device() const;
+
+    /**
+     * Get the navigation rate configured on the receiver
+     * @returns The navigation rate in Hz, 0 if the receiver setting is kept
+     */
+    int get_update_rate() const;
+
+    /**
+     * Get the number of received frames that were dropped because they were malformed
+     * @returns The number of dropped frames
+     */
+    uint64_t get_parse_errors() const;
+
+    /**
+     * Build the UBX-CFG-RATE frame that sets the navigation rate of a u-blox receiver
+     * @param update_rate The navigation rate in Hz, from 1 to 1000
+     * @returns The frame
+     * @throws std::invalid_argument if the rate is out of range
+     */
+    static std::vector<uint8_t> make_rate_command(int update_rate);
+
+    /**
+     * Build the UBX-CFG-MSG frame that enables the NAV-PVT message, once per navigation solution,
+     * on the port where it is sent
+     * @returns The frame
+     */
+    static std::vector<uint8_t> make_nav_pvt_command();
+
+protected:
+
+    /**
+     * Internal read method. Waits for the next bytes from the receiver.
+     */
+    virtual void read();
+
+private:
+
+    GNSSParser::FixHandler make_handler();
+
+    void open();
+
+    void close();
+
+    void configure();
+
+    void receive(uint32_t events);
+
+    void retry();
+
+    void release();
+
+    /**
+     * Maximum time read() waits for the receiver, so stop() is noticed
+     */
+    static const int READ_TIMEOUT_MILLIS = 100;
+
+    std::string device;
+
+    int baud_rate;
+
+    int update_rate;
+
+    bool ubx;
+
+    // Guards the port, used by the handlers of an attached sensor
+    std::mutex mtx;
+
+    std::unique_ptr<Serial> serial;
+
+    // Reopens the port of an attached sensor, armed while the port is lost
+    int retry_timer = -1;
+
+    GNSSParser parser;
+
+};
@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <stdexcept>
 #include <algorithm>
+#include <cstring>
 
 class ByteObject : public SerializedObject {
 
@@ -113,12 +114,67 @@ public:
         return _get<uint64_t>(key);
     }
 
+    /**
+     * 'Put' methods to serialize arrays of values
+     * @param key The preferred key for the array to be serialized. This parameter is ignored.
+     * @param values The first value of the array
+     * @param count The number of values
+     */
+
+    virtual void put(const std::string& key, const int16_t* values, std::size_t count) {
+        _put_array(key, values, count);
+    }
+
+    virtual void put(const std::string& key, const int32_t* values, std::size_t count) {
+        _put_array(key, values, count);
+    }
+
+    virtual void put(const std::string& key, const uint64_t* values, std::size_t count) {
+        _put_array(key, values, count);
+    }
+
+    virtual void put(const std::string& key, const float* values, std::size_t count) {
+        _put_array(key, values, count);
+    }
+
+    virtual void put(const std::string& key, const double* values, std::size_t count) {
+        _put_array(key, values, count);
+    }
+
+    /**
+     * 'Get' methods to deserialize arrays of values
+     * @param key The key of the array to be deserialized. This parameter is ignored.
+     * @param values Where the deserialized values are stored
+     */
+
+    virtual void get_array(const std::string& key, std::vector<int16_t>& values) {
+        _get_array(key, values);
+    }
+
+    virtual void get_array(const std::string& key, std::vector<int32_t>& values) {
+        _get_array(key, values);
+    }
+
+    virtual void get_array(const std::string& key, std::vector<uint64_t>& values) {
+        _get_array(key, values);
+    }
+
+    virtual void get_array(const std::string& key, std::vector<float>& values) {
+        _get_array(key, values);
+    }
+
+    virtual void get_array(const std::string& key, std::vector<double>& values) {
+        _get_array(key, values);
+    }
+
     /**
      * Get the resulting bytes.
      * @returns A vector of bytes that representing the serialization
      *      of all passed values.
      * Every value has prepended its size (or length)
      * |size of object1|object1 bytes|size of object2|object2 bytes|
+     * Arrays are stored as the number of values followed by the size of one value and the raw values
+     * |4|uint32 count|size of value|count * size of value bytes|
      */
     std::vector<uint8_t> get_bytes() {
         std::vector<uint8_t> result(sizeof(uint32_t) + bytes.size());
@@ -166,6 +222,28 @@ private:
         return result;
     }
 
+    template <typename T>
+    void _put_array(const std::string& key, const T* values, std::size_t count) {
+        _put<uint32_t>(key, (uint32_t)count);
+        const uint8_t* serialized = reinterpret_cast<const uint8_t*>(values);
+        bytes.push_back((uint8_t) sizeof(T));
+        bytes.insert(bytes.end(), serialized, serialized + count * sizeof(T));
+    }
+
+    template <typename T>
+    void _get_array(const std::string& key, std::vector<T>& values) {
+        uint32_t count = _get<uint32_t>(key);
+        if (bytes.empty() || (1 + count * sizeof(T)) > bytes.size()) {
+            throw std::out_of_range("Not enough remaining bytes to be deserialized");
+        }
+        if (bytes[0] != sizeof(T)) {
+            throw std::length_error("The asked type size does not match the stored value size");
+        }
+        values.resize(count);
+        std::memcpy(values.data(), bytes.data() + 1, count * sizeof(T));
+        bytes.erase(bytes.begin(), bytes.begin() + count * sizeof(T) + 1);
+    }
+
     std::string _get_string(const std::string& key) {
         if (bytes.size() <= 1) {
             throw std::out_of_range("Not enough remaining bytes to be deserialized");
@@ -110,6 +110,59 @@ public:
         return _get<uint64_t>(key);
     }
 
+    /**
+     * 'Put' methods to serialize arrays of values
+     * @param key The preferred key for the array to be serialized.
+     * @param values The first value of the array
+     * @param count The number of values
+     */
+
+    virtual void put(const std::string& key, const int16_t* values, std::size_t count) {
+        _put_array(key, values, count);
+    }
+
+    virtual void put(const std::string& key, const int32_t* values, std::size_t count) {
+        _put_array(key, values, count);
+    }
+
+    virtual void put(const std::string& key, const uint64_t* values, std::size_t count) {
+        _put_array(key, values, count);
+    }
+
+    virtual void put(const std::string& key, const float* values, std::size_t count) {
+        _put_array(key, values, count);
+    }
+
+    virtual void put(const std::string& key, const double* values, std::size_t count) {
+        _put_array(key, values, count);
+    }
+
+    /**
+     * 'Get' methods to deserialize arrays of values
+     * @param key The key of the array to be deserialized.
+     * @param values Where the deserialized values are stored
+     */
+
+    virtual void get_array(const std::string& key, std::vector<int16_t>& values) {
+        _get_array(key, values);
+    }
+
+    virtual void get_array(const std::string& key, std::vector<int32_t>& values) {
+        _get_array(key, values);
+    }
+
+    virtual void get_array(const std::string& key, std::vector<uint64_t>& values) {
+        _get_array(key, values);
+    }
+
+    virtual void get_array(const std::string& key, std::vector<float>& values) {
+        _get_array(key, values);
+    }
+
+    virtual void get_array(const std::string& key, std::vector<double>& values) {
+        _get_array(key, values);
+    }
+
     /**
      * Get the resulting JSON
      * @returns The serialized JSON
@@ -148,6 +201,16 @@ private:
         return serialized[key].get<T>();
     }
 
+    template <typename T>
+    void _put_array(std::string key, const T* values, std::size_t count) {
+        serialized[key.c_str()] = std::vector<T>(values, values + count);
+    }
+
+    template <typename T>
+    void _get_array(std::string key, std::vector<T>& values) {
+        values = serialized[key].get<std::vector<T>>();
+    }
+
     nlohmann::json serialized;
 
 };
\ No newline at end of file
@@ -27,6 +27,7 @@
 #include <stdint.h>
 #include <stdexcept>
 #include <sstream>
+#include <cstring>
 #include <map>
 #include <unordered_map>
 
@@ -116,6 +117,60 @@ public:
         return contents[key]->get<uint64_t>();
     }
 
+    /**
+     * 'Put' methods to serialize arrays of values
+     * Arrays are stored as a BLOB with the raw values.
+     * @param key The preferred key for the array to be serialized.
+     * @param values The first value of the array
+     * @param count The number of values
+     */
+
+    virtual void put(const std::string& key, const int16_t* values, std::size_t count) {
+        _put_array(key, values, count);
+    }
+
+    virtual void put(const std::string& key, const int32_t* values, std::size_t count) {
+        _put_array(key, values, count);
+    }
+
+    virtual void put(const std::string& key, const uint64_t* values, std::size_t count) {
+        _put_array(key, values, count);
+    }
+
+    virtual void put(const std::string& key, const float* values, std::size_t count) {
+        _put_array(key, values, count);
+    }
+
+    virtual void put(const std::string& key, const double* values, std::size_t count) {
+        _put_array(key, values, count);
+    }
+
+    /**
+     * 'Get' methods to deserialize arrays of values
+     * @param key The key of the array to be deserialized.
+     * @param values Where the deserialized values are stored
+     */
+
+    virtual void get_array(const std::string& key, std::vector<int16_t>& values) {
+        _get_array(key, values);
+    }
+
+    virtual void get_array(const std::string& key, std::vector<int32_t>& values) {
+        _get_array(key, values);
+    }
+
+    virtual void get_array(const std::string& key, std::vector<uint64_t>& values) {
+        _get_array(key, values);
+    }
+
+    virtual void get_array(const std::string& key, std::vector<float>& values) {
+        _get_array(key, values);
+    }
+
+    virtual void get_array(const std::string& key, std::vector<double>& values) {
+        _get_array(key, values);
+    }
+
     /**
      * Get the prepared statement for inserting data
      * @returns A SQL prepared statement that can be used to insert data from the serialized class 
@@ -199,7 +254,7 @@ public:
 private:
 
     enum Type {
-        INT, UINT, FLOAT, DOUBLE, BOOL, STRING, LONGINT
+        INT, UINT, FLOAT, DOUBLE, BOOL, STRING, LONGINT, BLOB
     };
 
     template <typename T>
@@ -208,6 +263,22 @@ private:
         types[key] = type;
     }
 
+    template <typename T>
+    void _put_array(std::string key, const T* values, std::size_t count) {
+        const uint8_t* serialized = reinterpret_cast<const uint8_t*>(values);
+        _put(key, std::vector<uint8_t>(serialized, serialized + count * sizeof(T)), Type::BLOB);
+    }
+
+    template <typename T>
+    void _get_array(std::string key, std::vector<T>& values) {
+        const std::vector<uint8_t>& blob = contents[key]->get<std::vector<uint8_t>>();
+        if (blob.size() % sizeof(T) != 0) {
+            throw std::length_error("The asked type size does not match the stored BLOB size");
+        }
+        values.resize(blob.size() / sizeof(T));
+        std::memcpy(values.data(), blob.data(), blob.size());
+    }
+
     void bind_column(SQLite::Statement& insert, std::string column) {
         std::string bind_column_name = ":" + column;
         switch (types[column]) {
@@ -232,6 +303,11 @@ private:
             case LONGINT:
                 insert.bind(bind_column_name, (long long int)contents[column]->get<uint64_t>());
                 break;
+            case BLOB: {
+                const std::vector<uint8_t>& blob = contents[column]->get<std::vector<uint8_t>>();
+                insert.bind(bind_column_name, blob.data(), (int)blob.size());
+                break;
+            }
         }
     }
 
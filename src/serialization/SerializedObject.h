@@ -72,6 +72,39 @@ public:
 
     virtual uint64_t get_long_int(const std::string& key) = 0;
 
+    /**
+     * 'Put' methods to serialize arrays of values
+     * @param key The preferred key for the array to be serialized. Could be ignored by the implementation.
+     * @param values The first value of the array
+     * @param count The number of values
+     */
+
+    virtual void put(const std::string& key, const int16_t* values, std::size_t count) = 0;
+
+    virtual void put(const std::string& key, const int32_t* values, std::size_t count) = 0;
+
+    virtual void put(const std::string& key, const uint64_t* values, std::size_t count) = 0;
+
+    virtual void put(const std::string& key, const float* values, std::size_t count) = 0;
+
+    virtual void put(const std::string& key, const double* values, std::size_t count) = 0;
+
+    /**
+     * 'Get' methods to deserialize arrays of values
+     * @param key The key of the array to be deserialized. Could be ignored by the implementation.
+     * @param values Where the deserialized values are stored. It is resized to the number of values.
+     */
+
+    virtual void get_array(const std::string& key, std::vector<int16_t>& values) = 0;
+
+    virtual void get_array(const std::string& key, std::vector<int32_t>& values) = 0;
+
+    virtual void get_array(const std::string& key, std::vector<uint64_t>& values) = 0;
+
+    virtual void get_array(const std::string& key, std::vector<float>& values) = 0;
+
+    virtual void get_array(const std::string& key, std::vector<double>& values) = 0;
+
     /**
      * Obtain the bytes of the serialized object
      * @returns A vector of bytes representing the serialized object
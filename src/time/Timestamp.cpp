@@ -29,6 +29,22 @@ Timestamp Timestamp::now() {
     return Timestamp(value.count());
 }
 
+int64_t Timestamp::days_from_civil(int64_t year, unsigned month, unsigned day) {
+    // http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    unsigned year_of_era = (unsigned)(year - era * 400);
+    unsigned day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    unsigned day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + (int64_t)day_of_era - 719468;
+}
+
+Timestamp Timestamp::from_utc(int year, int month, int day, int hour, int minute, int second, uint64_t nanos) {
+    int64_t days = days_from_civil(year, month, day);
+    uint64_t seconds = (uint64_t)days * 86400 + hour * 3600 + minute * 60 + second;
+    return Timestamp(seconds * 1000000000ULL + nanos);
+}
+
 uint64_t Timestamp::to_seconds() const {
     return TimeUnit::convert(nanos, TimeUnit::nanoseconds, TimeUnit::seconds);
 }
@@ -75,6 +75,28 @@ public:
         return Timestamp(nanos);
     }
 
+    /**
+     * Get a Timestamp from a UTC calendar date and time (proleptic Gregorian calendar).
+     * @param year The year, 1970 or later
+     * @param month The month, from 1 to 12
+     * @param day The day of the month, from 1 to 31
+     * @param hour The hour, from 0 to 23
+     * @param minute The minute, from 0 to 59
+     * @param second The second, from 0 to 60 (leap second)
+     * @param nanos The nanoseconds within the second
+     * @returns a Timestamp representing the UTC date and time
+     */
+    static Timestamp from_utc(int year, int month, int day, int hour, int minute, int second, uint64_t nanos = 0);
+
+    /**
+     * Get the number of days between the epoch and a UTC date (proleptic Gregorian calendar).
+     * @param year The year
+     * @param month The month, from 1 to 12
+     * @param day The day of the month, from 1 to 31
+     * @returns The number of days since 1970-01-01, negative before it
+     */
+    static int64_t days_from_civil(int64_t year, unsigned month, unsigned day);
+
     /**
      * Return an integer representing the number of seconds
      * since epoch (implementation specific)
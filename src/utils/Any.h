@@ -53,6 +53,15 @@ public:
         return dynamic_cast<AnyImpl<T>&>(*this).set(content);
     }
 
+    /**
+     * Does this object hold a value of type T?
+     * @returns Whether the held value is a T
+     */
+    template<typename T>
+    bool is() const {
+        return dynamic_cast<const AnyImpl<T>*>(this) != nullptr;
+    }
+
     /**
      * Set the value that this class will hold
      * @param content The content that this class will hold
@@ -41,6 +41,14 @@ Configuration& ConfigurationArrayNode::at(const int index) {
     return *childs[index];
 }
 
+std::size_t ConfigurationArrayNode::size() {
+    if (!loaded) {
+        load_from_implementation();
+        loaded = true;
+    }
+    return childs.size();
+}
+
 Configuration& Configuration::operator[](const std::string &property) {
     return this->at(property);
 }
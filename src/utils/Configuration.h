@@ -103,6 +103,32 @@ public:
         return content->get<T>();
     }
 
+    /**
+     * Does the node hold a value of a given type?
+     * @returns Whether the content of the node is of type T
+     */
+    template <typename T>
+    bool is() const {
+        return content && content->is<T>();
+    }
+
+    /**
+     * Is the node empty? A property that does not exist is an empty node.
+     * @returns Whether the node has no content nor childs
+     */
+    virtual bool is_null() const {
+        // A JSON null has no content
+        return !content || content->is<std::nullptr_t>();
+    }
+
+    /**
+     * Get the number of childs of an array node
+     * @returns The number of elements of the array, 0 if the node is not an array
+     */
+    virtual std::size_t size() {
+        return 0;
+    }
+
 protected:
 
     /**
@@ -138,6 +164,14 @@ public:
      */
     virtual Configuration& at(const int index);
 
+    /**
+     * A tree node is never empty
+     * @returns false
+     */
+    virtual bool is_null() const {
+        return false;
+    }
+
 protected:
 
     /**
@@ -175,6 +209,20 @@ public:
      */
     virtual Configuration& at(const int index);
 
+    /**
+     * An array node is never empty
+     * @returns false
+     */
+    virtual bool is_null() const {
+        return false;
+    }
+
+    /**
+     * Get the number of childs of the array
+     * @returns The number of elements of the array
+     */
+    virtual std::size_t size();
+
 protected:
 
     /**
@@ -0,0 +1,80 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "AsyncLoggerTest.h"
+
+#include <sstream>
+#include <string>
+
+void AsyncLoggerTest::ringTest() {
+    SPSCRing<int, 4> ring;
+    int value = 0;
+    CPPUNIT_ASSERT(ring.empty());
+    CPPUNIT_ASSERT(!ring.try_pop(value));
+    for (int i = 0; i < 4; ++i) {
+        CPPUNIT_ASSERT(ring.try_push(i));
+    }
+    CPPUNIT_ASSERT(!ring.try_push(4));
+    for (int i = 0; i < 4; ++i) {
+        CPPUNIT_ASSERT(ring.try_pop(value));
+        CPPUNIT_ASSERT(i == value);
+    }
+    CPPUNIT_ASSERT(ring.empty());
+}
+
+#ifndef WITH_G3LOG
+void AsyncLoggerTest::recordFormatTest() {
+    LogRecord record;
+    record.size = 0;
+    record.truncated = 0;
+    record.put("value ", 6);
+    record.put((int64_t)-3);
+    record.put(' ');
+    record.put((uint64_t)7);
+    record.put(' ');
+    record.put(2.5);
+    record.put(' ');
+    record.put(true);
+    std::ostringstream out;
+    record.format(out);
+    CPPUNIT_ASSERT(out.str() == "value -3 7 2.5 1");
+}
+
+void AsyncLoggerTest::recordTruncationTest() {
+    LogRecord record;
+    record.size = 0;
+    record.truncated = 0;
+    std::string text(LogRecord::PAYLOAD_SIZE, 'a');
+    record.put(text.data(), text.size());
+    record.put((int64_t)1);
+    CPPUNIT_ASSERT(record.truncated);
+    CPPUNIT_ASSERT(record.size <= LogRecord::PAYLOAD_SIZE);
+    std::ostringstream out;
+    record.format(out);
+    // The string tag and length take two bytes of the payload
+    CPPUNIT_ASSERT(out.str().size() == LogRecord::PAYLOAD_SIZE - 2 + 3);
+    CPPUNIT_ASSERT(out.str().compare(out.str().size() - 3, 3, "...") == 0);
+}
+
+void AsyncLoggerTest::disabledLevelTest() {
+    int evaluated = 0;
+    RTDATA_LOG(DEBUG) << "discarded " << ++evaluated;
+    // Below RTDATA_LOG_LEVEL, the streamed values are not even evaluated
+    CPPUNIT_ASSERT(evaluated == (DEBUG >= RTDATA_LOG_LEVEL ? 1 : 0));
+}
+#endif
@@ -0,0 +1,60 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "Log.h"
+#include "concurrent/SPSCRing.h"
+
+class AsyncLoggerTest : public CppUnit::TestFixture {
+
+    CPPUNIT_TEST_SUITE(AsyncLoggerTest);
+    CPPUNIT_TEST(ringTest);
+    #ifndef WITH_G3LOG
+    CPPUNIT_TEST(recordFormatTest);
+    CPPUNIT_TEST(recordTruncationTest);
+    CPPUNIT_TEST(disabledLevelTest);
+    #endif
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+
+    void setUp() {
+
+    }
+
+    void tearDown() {
+
+    }
+
+    void ringTest();
+
+    #ifndef WITH_G3LOG
+    void recordFormatTest();
+
+    void recordTruncationTest();
+
+    void disabledLevelTest();
+    #endif
+
+private:
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( AsyncLoggerTest );
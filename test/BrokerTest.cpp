@@ -20,8 +20,12 @@
 #include "SensorStub.h"
 #include "utils/LambdaListener.h"
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 void BrokerTest::dispatchTest() {
     std::mutex mutex;
@@ -38,4 +42,288 @@ void BrokerTest::dispatchTest() {
     broker->dispatch("test", data);
     cond_var.wait_for(lck, std::chrono::seconds(1));
     CPPUNIT_ASSERT(dispatched);
-}
\ No newline at end of file
+}
+
+void BrokerTest::orderedTest() {
+    const int EVENTS = 2000;
+    std::atomic<int> expected(0);
+    std::atomic<int> running(0);
+    std::atomic<bool> in_order(true);
+    std::atomic<int> other(0);
+    broker->subscribe("test", std::make_shared<LambdaListener>([&](std::string topic, std::shared_ptr<Data> data) {
+        if (++running > 1) {
+            in_order = false;
+        }
+        int value = std::static_pointer_cast<IntData>(data)->getValue();
+        if (value != expected) {
+            in_order = false;
+        }
+        expected = value + 1;
+        --running;
+    }), SubscriptionOptions::ordered());
+    // A concurrent listener of the same topic is not held back
+    broker->subscribe("test", std::make_shared<LambdaListener>([&](std::string topic, std::shared_ptr<Data> data) {
+        ++other;
+    }));
+    for (int i = 0; i < EVENTS; ++i) {
+        broker->dispatch("test", std::make_shared<IntData>(i));
+    }
+    for (int i = 0; i < 2000 && (expected < EVENTS || other < EVENTS); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CPPUNIT_ASSERT(in_order);
+    CPPUNIT_ASSERT(expected == EVENTS);
+    CPPUNIT_ASSERT(other == EVENTS);
+}
+
+void BrokerTest::inlineTest() {
+    std::thread::id dispatcher = std::this_thread::get_id();
+    std::atomic<int> handled(0);
+    std::atomic<int> handled_inline(0);
+    std::atomic<bool> slow(false);
+    broker->subscribe("test", std::make_shared<LambdaListener>([&](std::string topic, std::shared_ptr<Data> data) {
+        if (std::this_thread::get_id() == dispatcher) {
+            ++handled_inline;
+        }
+        if (slow) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ++handled;
+    }), SubscriptionOptions::inline_delivery(500000));
+    for (int i = 0; i < 10; ++i) {
+        broker->dispatch("test", std::make_shared<IntData>(i));
+        // Handled before dispatch() returns
+        CPPUNIT_ASSERT(handled == i + 1);
+    }
+    CPPUNIT_ASSERT(handled_inline == 10);
+    // Over budget a few times: moved to the pool
+    slow = true;
+    for (int i = 0; i < SubscriptionOptions::MAX_INLINE_OVERRUNS; ++i) {
+        broker->dispatch("test", std::make_shared<IntData>(i));
+    }
+    CPPUNIT_ASSERT(handled_inline == 10 + SubscriptionOptions::MAX_INLINE_OVERRUNS);
+    broker->dispatch("test", std::make_shared<IntData>(0));
+    for (int i = 0; i < 1000 && handled < 11 + SubscriptionOptions::MAX_INLINE_OVERRUNS; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CPPUNIT_ASSERT(handled == 11 + SubscriptionOptions::MAX_INLINE_OVERRUNS);
+    CPPUNIT_ASSERT(handled_inline == 10 + SubscriptionOptions::MAX_INLINE_OVERRUNS);
+}
+
+void BrokerTest::boundedTest() {
+    Counter& shed = MetricsRegistry::get_default().counter("rtdata_broker_shed_total", MetricsRegistry::label("policy", "drop_oldest"));
+    uint64_t shed_before = shed.get();
+    std::atomic<bool> running(false);
+    std::atomic<bool> release(false);
+    std::mutex mutex;
+    std::vector<int> values;
+    broker->subscribe("test", std::make_shared<LambdaListener>([&](std::string topic, std::shared_ptr<Data> data) {
+        running = true;
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::unique_lock<std::mutex> lck(mutex);
+        values.push_back(std::static_pointer_cast<IntData>(data)->getValue());
+    }), SubscriptionOptions::ordered().bounded(10, OVERFLOW_DROP_OLDEST));
+    broker->dispatch("test", std::make_shared<IntData>(0));
+    for (int i = 0; i < 1000 && !running; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CPPUNIT_ASSERT(running);
+    // The listener is stuck: only the 10 latest events wait for it
+    for (int i = 1; i < 100; ++i) {
+        broker->dispatch("test", std::make_shared<IntData>(i));
+    }
+    CPPUNIT_ASSERT(shed.get() - shed_before == 89);
+    release = true;
+    broker->stop();
+    std::vector<int> expected{0};
+    for (int i = 90; i < 100; ++i) {
+        expected.push_back(i);
+    }
+    CPPUNIT_ASSERT(values == expected);
+}
+
+void BrokerTest::blockTest() {
+    Counter& blocked = MetricsRegistry::get_default().counter("rtdata_broker_blocked_dispatches_total");
+    uint64_t blocked_before = blocked.get();
+    std::atomic<bool> running(false);
+    std::atomic<bool> release(false);
+    std::atomic<bool> dispatched(false);
+    std::atomic<int> handled(0);
+    broker->subscribe("test", std::make_shared<LambdaListener>([&](std::string topic, std::shared_ptr<Data> data) {
+        running = true;
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ++handled;
+    }), SubscriptionOptions::ordered().bounded(1, OVERFLOW_BLOCK));
+    broker->dispatch("test", std::make_shared<IntData>(0));
+    for (int i = 0; i < 1000 && !running; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    broker->dispatch("test", std::make_shared<IntData>(1));
+    // The mailbox is full: the producer waits for the listener
+    std::thread producer([&]() {
+        broker->dispatch("test", std::make_shared<IntData>(2));
+        dispatched = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CPPUNIT_ASSERT(!dispatched);
+    // Other topics are not blocked
+    broker->dispatch("other", std::make_shared<IntData>(0));
+    release = true;
+    producer.join();
+    CPPUNIT_ASSERT(dispatched);
+    CPPUNIT_ASSERT(blocked.get() - blocked_before == 1);
+    broker->stop();
+    CPPUNIT_ASSERT(handled == 3);
+}
+
+void BrokerTest::stopTest() {
+    std::atomic<int> bounded(0);
+    std::atomic<int> unbounded(0);
+    broker->subscribe("test", std::make_shared<LambdaListener>([&](std::string topic, std::shared_ptr<Data> data) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++bounded;
+    }), SubscriptionOptions().bounded(5, OVERFLOW_BLOCK));
+    broker->subscribe("test", std::make_shared<LambdaListener>([&](std::string topic, std::shared_ptr<Data> data) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++unbounded;
+    }));
+    for (int i = 0; i < 20; ++i) {
+        broker->dispatch("test", std::make_shared<IntData>(i));
+    }
+    // Nothing dispatched is lost
+    broker->stop();
+    CPPUNIT_ASSERT(bounded == 20);
+    CPPUNIT_ASSERT(unbounded == 20);
+}
+
+void BrokerTest::wildcardTest() {
+    std::mutex mutex;
+    std::vector<std::string> all;
+    std::atomic<int> accel(0);
+    broker->subscribe("vehicle/#", std::make_shared<LambdaListener>([&](std::string topic, std::shared_ptr<Data> data) {
+        std::unique_lock<std::mutex> lck(mutex);
+        all.push_back(topic);
+    }), SubscriptionOptions::inline_delivery(1000000000));
+    broker->dispatch("vehicle/gps", std::make_shared<IntData>(0));
+    broker->dispatch("vehicle/imu/accel", std::make_shared<IntData>(1));
+    broker->dispatch("temperature", std::make_shared<IntData>(2));
+    // A later subscription is seen by the topics already dispatched
+    broker->subscribe("vehicle/*/accel", std::make_shared<LambdaListener>([&](std::string topic, std::shared_ptr<Data> data) {
+        ++accel;
+    }), SubscriptionOptions::inline_delivery(1000000000));
+    broker->dispatch("vehicle/imu/accel", std::make_shared<IntData>(3));
+    broker->dispatch("vehicle/wheel/accel", std::make_shared<IntData>(4));
+    CPPUNIT_ASSERT((all == std::vector<std::string>{"vehicle/gps", "vehicle/imu/accel", "vehicle/imu/accel", "vehicle/wheel/accel"}));
+    CPPUNIT_ASSERT(accel == 2);
+    bool received_exception = false;
+    try {
+        broker->dispatch("vehicle/*", std::make_shared<IntData>(5));
+    }
+    catch (const std::invalid_argument&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+}
+
+void BrokerTest::lastValueTest() {
+    std::shared_ptr<const LastValue> last = broker->get_last_value("temperature");
+    CPPUNIT_ASSERT(last->get() == nullptr);
+    // Kept even without listeners
+    broker->dispatch("temperature", std::make_shared<IntData>(1));
+    broker->dispatch("temperature", std::make_shared<IntData>(2));
+    CPPUNIT_ASSERT(std::static_pointer_cast<IntData>(last->get())->getValue() == 2);
+    // And across subscriptions
+    broker->subscribe("humidity", std::make_shared<LambdaListener>([](std::string topic, std::shared_ptr<Data> data) {}));
+    broker->dispatch("temperature", std::make_shared<IntData>(3));
+    CPPUNIT_ASSERT(std::static_pointer_cast<IntData>(last->get())->getValue() == 3);
+    CPPUNIT_ASSERT(broker->get_last_value("temperature") == last);
+    bool received_exception = false;
+    try {
+        broker->get_last_value("#");
+    }
+    catch (const std::invalid_argument&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+}
+
+void BrokerTest::conflatedTest() {
+    Counter& conflated = MetricsRegistry::get_default().counter("rtdata_broker_conflated_total");
+    uint64_t conflated_before = conflated.get();
+    std::atomic<bool> running(false);
+    std::atomic<bool> release(false);
+    std::mutex mutex;
+    std::vector<std::string> received;
+    broker->subscribe("sensors/#", std::make_shared<LambdaListener>([&](std::string topic, std::shared_ptr<Data> data) {
+        running = true;
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::unique_lock<std::mutex> lck(mutex);
+        received.push_back(topic + "=" + std::to_string(std::static_pointer_cast<IntData>(data)->getValue()));
+    }), SubscriptionOptions::conflated());
+    broker->dispatch("sensors/a", std::make_shared<IntData>(0));
+    for (int i = 0; i < 1000 && !running; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CPPUNIT_ASSERT(running);
+    // While the listener is busy, only the latest value of each topic is kept
+    for (int i = 1; i <= 100; ++i) {
+        broker->dispatch("sensors/a", std::make_shared<IntData>(i));
+        broker->dispatch("sensors/b", std::make_shared<IntData>(-i));
+    }
+    CPPUNIT_ASSERT(conflated.get() - conflated_before == 198);
+    release = true;
+    broker->stop();
+    CPPUNIT_ASSERT((received == std::vector<std::string>{"sensors/a=0", "sensors/a=100", "sensors/b=-100"}));
+}
+
+void BrokerTest::replayTest() {
+    broker->dispatch("vehicle/gps", std::make_shared<IntData>(1));
+    broker->dispatch("vehicle/gps", std::make_shared<IntData>(2));
+    broker->dispatch("vehicle/imu", std::make_shared<IntData>(3));
+    broker->dispatch("temperature", std::make_shared<IntData>(4));
+    std::mutex mutex;
+    std::vector<int> late;
+    std::atomic<int> plain(0);
+    broker->subscribe("vehicle/#", std::make_shared<LambdaListener>([&](std::string topic, std::shared_ptr<Data> data) {
+        std::unique_lock<std::mutex> lck(mutex);
+        late.push_back(std::static_pointer_cast<IntData>(data)->getValue());
+    }), SubscriptionOptions::ordered().with_last_value());
+    // Without with_last_value() nothing is replayed
+    broker->subscribe("vehicle/#", std::make_shared<LambdaListener>([&](std::string topic, std::shared_ptr<Data> data) {
+        ++plain;
+    }));
+    broker->stop();
+    std::sort(late.begin(), late.end());
+    CPPUNIT_ASSERT((late == std::vector<int>{2, 3}));
+    CPPUNIT_ASSERT(plain == 0);
+}
+
+void BrokerTest::inlineOverrunsTest() {
+    std::thread::id dispatcher = std::this_thread::get_id();
+    std::atomic<int> handled_inline(0);
+    std::atomic<bool> slow(false);
+    broker->subscribe("test", std::make_shared<LambdaListener>([&](std::string topic, std::shared_ptr<Data> data) {
+        if (std::this_thread::get_id() == dispatcher) {
+            ++handled_inline;
+        }
+        if (slow) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }), SubscriptionOptions::inline_delivery(500000));
+    // Overruns separated by calls within the budget are forgiven
+    for (int i = 0; i < 4 * SubscriptionOptions::MAX_INLINE_OVERRUNS; ++i) {
+        slow = i % 2 == 0;
+        broker->dispatch("test", std::make_shared<IntData>(i));
+    }
+    CPPUNIT_ASSERT(handled_inline == 4 * SubscriptionOptions::MAX_INLINE_OVERRUNS);
+}
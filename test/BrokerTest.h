@@ -25,6 +25,16 @@ class BrokerTest : public CppUnit::TestFixture {
 
     CPPUNIT_TEST_SUITE(BrokerTest);
     CPPUNIT_TEST(dispatchTest);
+    CPPUNIT_TEST(orderedTest);
+    CPPUNIT_TEST(inlineTest);
+    CPPUNIT_TEST(inlineOverrunsTest);
+    CPPUNIT_TEST(boundedTest);
+    CPPUNIT_TEST(blockTest);
+    CPPUNIT_TEST(stopTest);
+    CPPUNIT_TEST(wildcardTest);
+    CPPUNIT_TEST(lastValueTest);
+    CPPUNIT_TEST(conflatedTest);
+    CPPUNIT_TEST(replayTest);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -45,6 +55,26 @@ public:
 
     void dispatchTest();
 
+    void orderedTest();
+
+    void inlineTest();
+
+    void inlineOverrunsTest();
+
+    void boundedTest();
+
+    void blockTest();
+
+    void stopTest();
+
+    void wildcardTest();
+
+    void lastValueTest();
+
+    void conflatedTest();
+
+    void replayTest();
+
 
 private:
 
@@ -0,0 +1,109 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ByteRingTest.h"
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <unistd.h>
+
+static std::size_t write_string(ByteRing& ring, const std::string& text) {
+    return ring.write(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+}
+
+static std::string to_string(const std::vector<uint8_t>& bytes) {
+    return std::string(bytes.begin(), bytes.end());
+}
+
+void ByteRingTest::capacityTest() {
+    ByteRing ring(10);
+    CPPUNIT_ASSERT(ring.capacity() == 16);
+    CPPUNIT_ASSERT(ring.empty());
+    CPPUNIT_ASSERT(write_string(ring, std::string(20, 'x')) == 16);
+    CPPUNIT_ASSERT(ring.size() == 16);
+    bool received_exception = false;
+    try {
+        ByteRing empty(0);
+    }
+    catch (std::invalid_argument&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+}
+
+void ByteRingTest::wrapTest() {
+    ByteRing ring(8);
+    uint8_t out[8];
+    write_string(ring, "abcdef");
+    CPPUNIT_ASSERT(ring.read(out, 4) == 4);
+    // Wraps around the end of the buffer
+    CPPUNIT_ASSERT(write_string(ring, "ghijkl") == 6);
+    CPPUNIT_ASSERT(ring.size() == 8);
+    CPPUNIT_ASSERT(ring.read(out, 8) == 8);
+    CPPUNIT_ASSERT(std::string(out, out + 8) == "efghijkl");
+    CPPUNIT_ASSERT(ring.empty());
+}
+
+void ByteRingTest::delimiterTest() {
+    ByteRing ring(8);
+    std::vector<uint8_t> message;
+    write_string(ring, "abcde");
+    ring.discard(4);
+    write_string(ring, "fg\nh");
+    // The message wraps around the end of the buffer
+    CPPUNIT_ASSERT(ring.find('\n') == 3);
+    CPPUNIT_ASSERT(ring.read_until(message, '\n'));
+    CPPUNIT_ASSERT(to_string(message) == "efg");
+    CPPUNIT_ASSERT(!ring.read_until(message, '\n'));
+    CPPUNIT_ASSERT(ring.size() == 1);
+    CPPUNIT_ASSERT(ring.find('\n') == ring.size());
+}
+
+void ByteRingTest::lengthTest() {
+    ByteRing ring(16);
+    std::vector<uint8_t> message;
+    write_string(ring, "12345");
+    CPPUNIT_ASSERT(!ring.read_exact(message, 6));
+    CPPUNIT_ASSERT(ring.size() == 5);
+    CPPUNIT_ASSERT(ring.read_exact(message, 3));
+    CPPUNIT_ASSERT(to_string(message) == "123");
+    ring.clear();
+    CPPUNIT_ASSERT(ring.empty());
+}
+
+void ByteRingTest::readFromTest() {
+    int fds[2];
+    CPPUNIT_ASSERT(pipe(fds) == 0);
+    ByteRing ring(8);
+    write_string(ring, "abcdef");
+    ring.discard(6);
+    std::string data = "0123456789";
+    CPPUNIT_ASSERT(::write(fds[1], data.data(), data.size()) == (ssize_t)data.size());
+    // A single readv fills both segments of the free space
+    CPPUNIT_ASSERT(ring.read_from(fds[0]) == 8);
+    CPPUNIT_ASSERT(ring.read_from(fds[0]) == 0);
+    std::vector<uint8_t> message;
+    CPPUNIT_ASSERT(ring.read_exact(message, 8));
+    CPPUNIT_ASSERT(to_string(message) == "01234567");
+    CPPUNIT_ASSERT(ring.read_from(fds[0]) == 2);
+    close(fds[0]);
+    close(fds[1]);
+}
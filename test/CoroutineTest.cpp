@@ -0,0 +1,130 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CoroutineTest.h"
+
+#ifdef WITH_COROUTINES
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <fcntl.h>
+
+static async::Task<int> add(int a, int b) {
+    co_return a + b;
+}
+
+static async::Task<int> sum(int count) {
+    int total = 0;
+    for (int i = 0; i < count; ++i) {
+        total = co_await add(total, i);
+    }
+    co_return total;
+}
+
+static async::Task<void> fail() {
+    throw std::runtime_error("failed");
+    co_return;
+}
+
+void CoroutineTest::taskTest() {
+    CPPUNIT_ASSERT(async::sync_wait(sum(10)) == 45);
+    // Lazy: nothing runs until the task is awaited
+    async::Task<int> task = add(1, 2);
+    CPPUNIT_ASSERT(async::sync_wait(std::move(task)) == 3);
+}
+
+void CoroutineTest::exceptionTest() {
+    bool received_exception = false;
+    try {
+        async::sync_wait(fail());
+    }
+    catch (std::runtime_error&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+}
+
+void CoroutineTest::sleepTest() {
+    Reactor& reactor = Reactor::get_shared();
+    auto sleeper = [&reactor](uint64_t nanos) -> async::Task<uint64_t> {
+        uint64_t start = Timestamp::now().to_nanos();
+        co_await async::sleep_for(reactor, nanos);
+        co_return Timestamp::now().to_nanos() - start;
+    };
+    CPPUNIT_ASSERT(async::sync_wait(sleeper(5000000)) >= 5000000);
+    // Many sleeping coroutines share the reactor thread
+    std::vector<async::Task<uint64_t>> tasks;
+    for (int i = 0; i < 100; ++i) {
+        tasks.push_back(sleeper(1000000));
+    }
+    for (auto& task : tasks) {
+        CPPUNIT_ASSERT(async::sync_wait(std::move(task)) >= 1000000);
+    }
+    auto until = [&reactor]() -> async::Task<void> {
+        co_await async::sleep_until(reactor, Timestamp::now().plus(2, TimeUnit::milliseconds));
+        // In the past: resumes right away
+        co_await async::sleep_until(reactor, Timestamp(0));
+    };
+    async::sync_wait(until());
+    CPPUNIT_ASSERT(reactor.size() == 0);
+}
+
+void CoroutineTest::readableTest() {
+    int fds[2];
+    CPPUNIT_ASSERT(pipe2(fds, O_NONBLOCK | O_CLOEXEC) == 0);
+    Reactor& reactor = Reactor::get_shared();
+    auto reader = [&reactor](int fd) -> async::Task<char> {
+        uint32_t events = co_await async::fd_readable(reactor, fd);
+        CPPUNIT_ASSERT(events & Reactor::READABLE);
+        char c = 0;
+        CPPUNIT_ASSERT(::read(fd, &c, 1) == 1);
+        co_return c;
+    };
+    std::thread producer([&fds]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        CPPUNIT_ASSERT(::write(fds[1], "x", 1) == 1);
+    });
+    CPPUNIT_ASSERT(async::sync_wait(reader(fds[0])) == 'x');
+    producer.join();
+    close(fds[0]);
+    close(fds[1]);
+}
+
+void CoroutineTest::poolTest() {
+    ThreadPool pool(2);
+    std::atomic<int> done(0);
+    std::thread::id caller = std::this_thread::get_id();
+    auto job = [&]() -> async::Task<void> {
+        co_await async::schedule_on(pool);
+        CPPUNIT_ASSERT(std::this_thread::get_id() != caller);
+        ++done;
+    };
+    for (int i = 0; i < 10; ++i) {
+        async::spawn(job());
+    }
+    for (int i = 0; i < 1000 && done < 10; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CPPUNIT_ASSERT(done == 10);
+}
+
+#endif // WITH_COROUTINES
@@ -0,0 +1,192 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GNSSParserTest.h"
+#include "time/Timestamp.h"
+
+#include <string>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+
+// Recorded from a receiver, as test/acceptance2/testdata.log
+static const std::string LOG =
+    "$PMGNST,05.40,2,T,961,08.3,+04583,00*4C\r\n"
+    "$GPGLL,5036.9881,N,00707.9142,E,125412.480,A*3F\r\n"
+    "$GPGGA,125412.48,5036.9881,N,00707.9142,E,2,04,20.5,00269,M,,,,*17\r\n"
+    "$GPRMC,125412.48,A,5036.9881,N,00707.9142,E,00.0,000.0,230506,00,E*4F\r\n"
+    "$GPGSA,A,2,27,04,08,24,,,,,,,,,20.5,20.5,*12\r\n"
+    "$GPGSV,3,1,10,13,81,052,,04,58,240,39,23,44,064,,24,43,188,36*75\r\n"
+    "$GPGSV,3,2,10,02,42,295,,27,34,177,40,20,21,113,,16,12,058,*7F\r\n"
+    "$GPGSV,3,3,10,08,07,189,38,10,05,293,,131,11,117,,120,28,209,*76\r\n";
+
+static const uint64_t LOG_TIME = Timestamp::from_utc(2006, 5, 23, 12, 54, 12, 480000000).to_nanos();
+
+// Adds the delimiter and the checksum to the body of a sentence
+static std::string sentence(const std::string& body) {
+    uint8_t checksum = 0;
+    for (char c : body) {
+        checksum ^= (uint8_t)c;
+    }
+    char suffix[8];
+    std::snprintf(suffix, sizeof(suffix), "*%02X\r\n", checksum);
+    return "$" + body + suffix;
+}
+
+template <typename T>
+static void write_le(std::vector<uint8_t>& payload, std::size_t offset, T value) {
+    std::memcpy(payload.data() + offset, &value, sizeof(T));
+}
+
+static std::vector<uint8_t> nav_pvt() {
+    std::vector<uint8_t> payload(92, 0);
+    write_le<uint16_t>(payload, 4, 2019);
+    payload[6] = 3;
+    payload[7] = 25;
+    payload[8] = 12;
+    payload[9] = 54;
+    payload[10] = 12;
+    payload[11] = 0x07; // valid date, time and fully resolved
+    write_le<int32_t>(payload, 16, -20000000); // -20 ms
+    payload[20] = 3; // 3D
+    payload[21] = 0x03; // gnssFixOK, diffSoln
+    payload[23] = 11;
+    write_le<int32_t>(payload, 24, 71319033);
+    write_le<int32_t>(payload, 28, 506164683);
+    write_le<int32_t>(payload, 36, 269500);
+    write_le<uint32_t>(payload, 40, 1500);
+    write_le<int32_t>(payload, 56, 250);
+    write_le<int32_t>(payload, 60, 1200);
+    write_le<int32_t>(payload, 64, 9000000);
+    return GNSSParser::make_ubx(0x01, 0x07, payload);
+}
+
+void GNSSParserTest::setUp() {
+    fixes.clear();
+    parser = new GNSSParser([this](const GPSFix& fix) {
+        fixes.push_back(fix);
+    });
+}
+
+void GNSSParserTest::tearDown() {
+    delete parser;
+}
+
+void GNSSParserTest::feed(const std::string& data) {
+    parser->feed(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+}
+
+void GNSSParserTest::recordedLogTest() {
+    feed(LOG);
+    // GGA and RMC of the same epoch are merged in a single fix
+    CPPUNIT_ASSERT(fixes.size() == 1);
+    const GPSFix& fix = fixes[0];
+    CPPUNIT_ASSERT(fix.time == LOG_TIME);
+    CPPUNIT_ASSERT(fix.status == DGPS_FIX);
+    CPPUNIT_ASSERT(fix.mode == FIX_3D);
+    CPPUNIT_ASSERT(fix.satellites_used == 4);
+    CPPUNIT_ASSERT(std::fabs(fix.latitude - (50 + 36.9881 / 60)) < 1e-9);
+    CPPUNIT_ASSERT(std::fabs(fix.longitude - (7 + 7.9142 / 60)) < 1e-9);
+    CPPUNIT_ASSERT(fix.altitude == 269.0);
+    CPPUNIT_ASSERT(fix.ground_speed == 0.0);
+    CPPUNIT_ASSERT(fix.track == 0.0);
+    CPPUNIT_ASSERT(parser->get_errors() == 0);
+}
+
+void GNSSParserTest::epochTest() {
+    feed(LOG);
+    // Next epoch, only GGA: emitted when the following epoch starts
+    feed(sentence("GPGGA,125412.58,5037.0000,S,00707.9142,W,1,05,20.5,00270,M,,,,"));
+    CPPUNIT_ASSERT(fixes.size() == 1);
+    feed(sentence("GPRMC,125412.68,A,5037.0000,S,00707.9142,W,01.0,090.0,230506,00,E"));
+    CPPUNIT_ASSERT(fixes.size() == 2);
+    const GPSFix& fix = fixes[1];
+    CPPUNIT_ASSERT(fix.time == LOG_TIME + 100000000ULL);
+    CPPUNIT_ASSERT(fix.status == FIX);
+    // Mode from the GSA and satellites in view from the GSV sentences of the previous epoch
+    CPPUNIT_ASSERT(fix.mode == FIX_2D);
+    CPPUNIT_ASSERT(fix.satellites_visible == 10);
+    CPPUNIT_ASSERT(fix.satellites_used == 5);
+    CPPUNIT_ASSERT(std::fabs(fix.latitude + (50 + 37.0 / 60)) < 1e-9);
+    CPPUNIT_ASSERT(fix.longitude < 0);
+    CPPUNIT_ASSERT(std::isnan(fix.ground_speed));
+}
+
+void GNSSParserTest::partialFeedTest() {
+    for (char c : LOG) {
+        uint8_t byte = (uint8_t)c;
+        parser->feed(&byte, 1);
+    }
+    CPPUNIT_ASSERT(fixes.size() == 1);
+    CPPUNIT_ASSERT(fixes[0].time == LOG_TIME);
+    CPPUNIT_ASSERT(fixes[0].satellites_used == 4);
+}
+
+void GNSSParserTest::checksumTest() {
+    std::string log = LOG;
+    log[log.find("5036.9881,N,00707.9142,E,2")] = '6';
+    feed(log);
+    // The GGA is dropped, the RMC is still reported when the next epoch starts
+    CPPUNIT_ASSERT(parser->get_errors() == 1);
+    CPPUNIT_ASSERT(fixes.empty());
+    std::vector<uint8_t> frame = nav_pvt();
+    frame[10] ^= 0xFF;
+    parser->feed(frame.data(), frame.size());
+    CPPUNIT_ASSERT(parser->get_errors() == 2);
+    CPPUNIT_ASSERT(fixes.empty());
+}
+
+void GNSSParserTest::navPvtTest() {
+    std::vector<uint8_t> frame = nav_pvt();
+    parser->feed(frame.data(), frame.size());
+    CPPUNIT_ASSERT(fixes.size() == 1);
+    const GPSFix& fix = fixes[0];
+    CPPUNIT_ASSERT(fix.time == 1553518452000000000ULL - 20000000ULL);
+    CPPUNIT_ASSERT(fix.mode == FIX_3D);
+    CPPUNIT_ASSERT(fix.status == DGPS_FIX);
+    CPPUNIT_ASSERT(fix.satellites_used == 11);
+    CPPUNIT_ASSERT(std::fabs(fix.latitude - 50.6164683) < 1e-9);
+    CPPUNIT_ASSERT(std::fabs(fix.longitude - 7.1319033) < 1e-9);
+    CPPUNIT_ASSERT(std::fabs(fix.altitude - 269.5) < 1e-9);
+    CPPUNIT_ASSERT(std::fabs(fix.latitude_uncertainty - 1.5) < 1e-9);
+    CPPUNIT_ASSERT(std::fabs(fix.vertical_speed + 0.25) < 1e-9);
+    CPPUNIT_ASSERT(std::fabs(fix.ground_speed - 1.2) < 1e-9);
+    CPPUNIT_ASSERT(std::fabs(fix.track - 90.0) < 1e-9);
+    // Split in two chunks
+    parser->feed(frame.data(), 30);
+    parser->feed(frame.data() + 30, frame.size() - 30);
+    CPPUNIT_ASSERT(fixes.size() == 2);
+    CPPUNIT_ASSERT(fixes[1].time == fixes[0].time);
+}
+
+void GNSSParserTest::mixedStreamTest() {
+    std::vector<uint8_t> frame = nav_pvt();
+    std::vector<uint8_t> stream(LOG.begin(), LOG.end());
+    stream.insert(stream.begin() + LOG.find("$GPRMC"), frame.begin(), frame.end());
+    stream.insert(stream.begin(), { 0x00, 0xB5, 'x', '\r', '\n' }); // noise
+    for (std::size_t i = 0; i < stream.size(); i += 7) {
+        parser->feed(stream.data() + i, std::min<std::size_t>(7, stream.size() - i));
+    }
+    // Once NAV-PVT is received, NMEA fixes are ignored, GSV still updates the satellites in view
+    CPPUNIT_ASSERT(fixes.size() == 1);
+    CPPUNIT_ASSERT(fixes[0].satellites_used == 11);
+    CPPUNIT_ASSERT(parser->get_errors() == 0);
+    parser->feed(frame.data(), frame.size());
+    CPPUNIT_ASSERT(fixes.size() == 2);
+    CPPUNIT_ASSERT(fixes[1].satellites_visible == 10);
+}
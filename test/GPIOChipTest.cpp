@@ -0,0 +1,68 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GPIOChipTest.h"
+
+#include <unistd.h>
+
+void GPIOChipTest::openErrorTest() {
+    bool received_exception = false;
+    try {
+        GPIOChip chip("/dev/gpiochip-does-not-exist");
+    }
+    catch (std::runtime_error&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+    received_exception = false;
+    try {
+        GPIOChip chip("/dev/null");
+    }
+    catch (std::runtime_error&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+}
+
+void GPIOChipTest::edgeEventTest() {
+    // The kernel queues gpioevent_data records: a pipe stands for the event request
+    int fds[2];
+    CPPUNIT_ASSERT(pipe(fds) == 0);
+    GPIOEdgeLine line(fds[0]);
+    GPIOEvent event;
+    CPPUNIT_ASSERT(!line.read_event(event));
+    CPPUNIT_ASSERT(!line.wait_event(event, 10));
+    gpioevent_data data[2];
+    data[0].timestamp = 1000;
+    data[0].id = GPIOEVENT_EVENT_RISING_EDGE;
+    data[1].timestamp = 2500;
+    data[1].id = GPIOEVENT_EVENT_FALLING_EDGE;
+    CPPUNIT_ASSERT(write(fds[1], data, sizeof(data)) == sizeof(data));
+    CPPUNIT_ASSERT(line.wait_event(event, 1000));
+    CPPUNIT_ASSERT(event.timestamp == 1000);
+    CPPUNIT_ASSERT(event.edge == EDGE_RISING);
+    CPPUNIT_ASSERT(line.read_event(event));
+    CPPUNIT_ASSERT(event.timestamp == 2500);
+    CPPUNIT_ASSERT(event.edge == EDGE_FALLING);
+    CPPUNIT_ASSERT(!line.read_event(event));
+    close(fds[1]);
+}
@@ -0,0 +1,93 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GPSDParserTest.h"
+
+#include <string>
+#include <cmath>
+
+static const std::string TPV = "{\"class\":\"TPV\",\"device\":\"/dev/ttyUSB0\",\"status\":2,\"mode\":3,"
+    "\"time\":\"2019-03-25T12:54:12.480Z\",\"ept\":0.005,\"lat\":50.616468333,\"lon\":7.131903333,"
+    "\"alt\":269.000,\"epx\":15.319,\"epy\":17.054,\"epv\":124.484,\"track\":10.3797,\"speed\":0.091,"
+    "\"climb\":-0.085,\"eps\":34.11,\"epc\":248.97}\n";
+
+void GPSDParserTest::setUp() {
+    fixes.clear();
+    parser = new GPSDParser([this](const GPSFix& fix) {
+        fixes.push_back(fix);
+    });
+}
+
+void GPSDParserTest::tearDown() {
+    delete parser;
+}
+
+void GPSDParserTest::parseTimeTest() {
+    uint64_t nanos = 0;
+    CPPUNIT_ASSERT(GPSDParser::parse_time("1970-01-01T00:00:01.5Z", nanos));
+    CPPUNIT_ASSERT(nanos == 1500000000ULL);
+    CPPUNIT_ASSERT(GPSDParser::parse_time("2019-03-25T12:54:12.480Z", nanos));
+    CPPUNIT_ASSERT(nanos == 1553518452480000000ULL);
+    CPPUNIT_ASSERT(!GPSDParser::parse_time("2019-03-25 12:54:12Z", nanos));
+    CPPUNIT_ASSERT(!GPSDParser::parse_time("2019-03", nanos));
+}
+
+void GPSDParserTest::fixTest() {
+    parser->feed(TPV.data(), TPV.size());
+    CPPUNIT_ASSERT(fixes.size() == 1);
+    const GPSFix& fix = fixes[0];
+    CPPUNIT_ASSERT(fix.mode == FIX_3D);
+    CPPUNIT_ASSERT(fix.status == DGPS_FIX);
+    CPPUNIT_ASSERT(fix.time == 1553518452480000000ULL);
+    CPPUNIT_ASSERT(std::fabs(fix.latitude - 50.616468333) < 1e-9);
+    CPPUNIT_ASSERT(std::fabs(fix.longitude - 7.131903333) < 1e-9);
+    CPPUNIT_ASSERT(fix.altitude == 269.0);
+    CPPUNIT_ASSERT(fix.longitude_uncertainty == 15.319);
+    CPPUNIT_ASSERT(fix.vertical_speed == -0.085);
+    CPPUNIT_ASSERT(std::isnan(fix.track_uncertainty));
+}
+
+void GPSDParserTest::partialFeedTest() {
+    std::string reports = "{\"class\":\"VERSION\",\"release\":\"3.17\"}\r\n" + TPV + TPV;
+    for (char c : reports) {
+        parser->feed(&c, 1);
+    }
+    CPPUNIT_ASSERT(fixes.size() == 2);
+    CPPUNIT_ASSERT(fixes[1].time == 1553518452480000000ULL);
+}
+
+void GPSDParserTest::skyTest() {
+    std::string sky = "{\"class\":\"SKY\",\"satellites\":[{\"PRN\":5,\"used\":true},"
+        "{\"PRN\":7,\"used\":false},{\"PRN\":13,\"used\":true}]}\n";
+    parser->feed(sky.data(), sky.size());
+    CPPUNIT_ASSERT(fixes.empty());
+    parser->feed(TPV.data(), TPV.size());
+    CPPUNIT_ASSERT(fixes.size() == 1);
+    CPPUNIT_ASSERT(fixes[0].satellites_visible == 3);
+    CPPUNIT_ASSERT(fixes[0].satellites_used == 2);
+}
+
+void GPSDParserTest::overflowTest() {
+    std::string garbage(GPSDParser::MAX_REPORT_SIZE + 10, 'x');
+    parser->feed(garbage.data(), garbage.size());
+    parser->feed(TPV.data(), TPV.size());
+    // The long line and the fix on the same line are discarded, the next fix is parsed
+    CPPUNIT_ASSERT(fixes.empty());
+    parser->feed(TPV.data(), TPV.size());
+    CPPUNIT_ASSERT(fixes.size() == 1);
+}
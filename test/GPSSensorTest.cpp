@@ -0,0 +1,98 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "GPSSensorTest.h"
+#include "Broker.h"
+#include "utils/LambdaListener.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+static const std::string TPV = "{\"class\":\"TPV\",\"device\":\"/dev/ttyUSB0\",\"status\":2,\"mode\":3,"
+    "\"time\":\"2019-03-25T12:54:12.480Z\",\"lat\":50.616468333,\"lon\":7.131903333,\"alt\":269.000}\n";
+
+void GPSSensorTest::setUp() {
+    listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    CPPUNIT_ASSERT(listener >= 0);
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    CPPUNIT_ASSERT(bind(listener, (struct sockaddr*)&address, sizeof(address)) == 0);
+    CPPUNIT_ASSERT(listen(listener, 4) == 0);
+    socklen_t length = sizeof(address);
+    CPPUNIT_ASSERT(getsockname(listener, (struct sockaddr*)&address, &length) == 0);
+    port = std::to_string(ntohs(address.sin_port));
+}
+
+void GPSSensorTest::tearDown() {
+    close(listener);
+}
+
+int GPSSensorTest::accept_watch() {
+    struct pollfd pfd = { listener, POLLIN, 0 };
+    CPPUNIT_ASSERT(poll(&pfd, 1, 1000) == 1);
+    int peer = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+    CPPUNIT_ASSERT(peer >= 0);
+    std::string received;
+    pfd.fd = peer;
+    while (received.find('\n') == std::string::npos && poll(&pfd, 1, 1000) > 0) {
+        char buffer[128];
+        ssize_t size = recv(peer, buffer, sizeof(buffer), 0);
+        if (size <= 0) {
+            break;
+        }
+        received.append(buffer, size);
+    }
+    CPPUNIT_ASSERT(received.compare(0, 7, "?WATCH=") == 0);
+    return peer;
+}
+
+void GPSSensorTest::reconnectTest() {
+    // Attached to a reactor, the sensor reconnects with a non-blocking connect
+    Reactor reactor;
+    std::thread loop(&Reactor::run, &reactor);
+    Broker broker;
+    std::atomic<int> received(0);
+    broker.subscribe("gps", std::make_shared<LambdaListener>([&](std::string topic, std::shared_ptr<Data> data) {
+        ++received;
+    }));
+    GPSSensor sensor("gps", "gps", 20000000, "127.0.0.1", port);
+    sensor.attach(reactor);
+    sensor.start();
+    for (int connection = 1; connection <= 2; ++connection) {
+        int peer = accept_watch();
+        CPPUNIT_ASSERT(send(peer, TPV.data(), TPV.size(), MSG_NOSIGNAL) == (ssize_t)TPV.size());
+        for (int i = 0; i < 100 && received < connection; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            sensor.fetch(&broker);
+        }
+        // gpsd goes away: the sensor retries the connection from the reactor
+        close(peer);
+    }
+    sensor.stop();
+    broker.stop();
+    reactor.stop();
+    loop.join();
+    CPPUNIT_ASSERT(received == 2);
+}
@@ -0,0 +1,156 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "HTTPWriterTest.h"
+
+#include <cstring>
+#include <string>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+void HTTPWriterTest::setUp() {
+    server_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    CPPUNIT_ASSERT(server_fd >= 0);
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    CPPUNIT_ASSERT(bind(server_fd, (sockaddr*)&addr, sizeof(addr)) == 0);
+    CPPUNIT_ASSERT(listen(server_fd, 16) == 0);
+    socklen_t size = sizeof(addr);
+    CPPUNIT_ASSERT(getsockname(server_fd, (sockaddr*)&addr, &size) == 0);
+    port = ntohs(addr.sin_port);
+    running = true;
+    requests = 0;
+    server = std::thread(&HTTPWriterTest::serve, this);
+}
+
+void HTTPWriterTest::tearDown() {
+    running = false;
+    server.join();
+    for (auto& connection : connections) {
+        connection.join();
+    }
+    connections.clear();
+    ::close(server_fd);
+}
+
+void HTTPWriterTest::serve() {
+    struct pollfd pfd = { server_fd, POLLIN, 0 };
+    while (running) {
+        if (poll(&pfd, 1, 50) <= 0) {
+            continue;
+        }
+        int client = accept(server_fd, nullptr, nullptr);
+        if (client >= 0) {
+            connections.emplace_back(&HTTPWriterTest::answer, this, client);
+        }
+    }
+}
+
+void HTTPWriterTest::answer(int client) {
+    // A minimal keep-alive HTTP/1.1 server: answers 200 to each POST
+    static const char RESPONSE[] = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+    std::string received;
+    char buffer[4096];
+    struct pollfd pfd = { client, POLLIN, 0 };
+    while (running) {
+        std::size_t end = received.find("\r\n\r\n");
+        if (end != std::string::npos) {
+            std::size_t length = 0;
+            std::size_t header = received.find("Content-Length: ");
+            if (header != std::string::npos && header < end) {
+                length = std::stoul(received.substr(header + 16));
+            }
+            if (received.size() >= end + 4 + length) {
+                received.erase(0, end + 4 + length);
+                ++requests;
+                if (send(client, RESPONSE, sizeof(RESPONSE) - 1, MSG_NOSIGNAL) < 0) {
+                    break;
+                }
+                continue;
+            }
+        }
+        if (poll(&pfd, 1, 50) <= 0) {
+            continue;
+        }
+        ssize_t size = recv(client, buffer, sizeof(buffer), 0);
+        if (size <= 0) {
+            break;
+        }
+        received.append(buffer, size);
+    }
+    ::close(client);
+}
+
+void HTTPWriterTest::attachedTest() {
+    HTTPWriter writer("http://127.0.0.1:" + std::to_string(port) + "/data");
+    writer.attach(Reactor::get_shared(), 8);
+    std::shared_ptr<Data> data = std::make_shared<Data>(Timestamp::now(), "http");
+    for (int i = 0; i < 20; ++i) {
+        while (writer.get_in_flight() >= 8) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        writer.write("http", data);
+    }
+    writer.flush();
+    CPPUNIT_ASSERT(writer.get_in_flight() == 0);
+    CPPUNIT_ASSERT(requests == 20);
+    writer.detach();
+    // Blocking requests again
+    writer.write("http", data);
+    CPPUNIT_ASSERT(requests == 21);
+    writer.close();
+}
+
+void HTTPWriterTest::failureTest() {
+    // Nobody listens on this port anymore: the requests fail in the reactor
+    int closed_port = port;
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t size = sizeof(addr);
+        CPPUNIT_ASSERT(bind(fd, (sockaddr*)&addr, sizeof(addr)) == 0);
+        CPPUNIT_ASSERT(getsockname(fd, (sockaddr*)&addr, &size) == 0);
+        closed_port = ntohs(addr.sin_port);
+        ::close(fd);
+    }
+    std::string url = "http://127.0.0.1:" + std::to_string(closed_port) + "/data";
+    HTTPWriter writer(url);
+    writer.attach(Reactor::get_shared(), 1);
+    Counter& errors = MetricsRegistry::get_default().counter("rtdata_writer_errors_total",
+        MetricsRegistry::label("writer", "http") + "," + MetricsRegistry::label("target", url));
+    uint64_t errors_before = errors.get();
+    std::shared_ptr<Data> data = std::make_shared<Data>(Timestamp::now(), "http");
+    for (int i = 0; i < 3; ++i) {
+        // Failures are counted, not thrown
+        writer.write("http", data);
+        writer.flush();
+    }
+    CPPUNIT_ASSERT(writer.get_in_flight() == 0);
+    CPPUNIT_ASSERT(errors.get() == errors_before + 3);
+    CPPUNIT_ASSERT(requests == 0);
+    writer.close();
+}
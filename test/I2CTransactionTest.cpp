@@ -0,0 +1,86 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "I2CTransactionTest.h"
+
+#include <stdexcept>
+
+void I2CTransactionTest::buildTest() {
+    uint8_t accelerometer[6];
+    uint8_t gyroscope[6];
+    uint8_t status;
+    I2CTransaction transaction;
+    transaction.read_register(0x68, 0x3B, accelerometer, sizeof(accelerometer))
+        .read_register(0x68, 0x43, gyroscope, sizeof(gyroscope))
+        .write(0x1E, { 0x02, 0x01 })
+        .read(0x1E, &status, 1);
+    CPPUNIT_ASSERT(transaction.size() == 6);
+    i2c_msg* messages = transaction.get_messages();
+    CPPUNIT_ASSERT(messages[0].addr == 0x68);
+    CPPUNIT_ASSERT(messages[0].flags == 0);
+    CPPUNIT_ASSERT(messages[0].len == 1);
+    CPPUNIT_ASSERT(messages[0].buf[0] == 0x3B);
+    CPPUNIT_ASSERT(messages[1].flags == I2C_M_RD);
+    CPPUNIT_ASSERT(messages[1].len == 6);
+    CPPUNIT_ASSERT(messages[1].buf == accelerometer);
+    CPPUNIT_ASSERT(messages[2].buf[0] == 0x43);
+    CPPUNIT_ASSERT(messages[3].buf == gyroscope);
+    CPPUNIT_ASSERT(messages[4].addr == 0x1E);
+    CPPUNIT_ASSERT(messages[4].len == 2);
+    CPPUNIT_ASSERT(messages[4].buf[0] == 0x02 && messages[4].buf[1] == 0x01);
+    CPPUNIT_ASSERT(messages[5].buf == &status);
+    transaction.clear();
+    CPPUNIT_ASSERT(transaction.size() == 0);
+}
+
+void I2CTransactionTest::limitTest() {
+    uint8_t buffer[2];
+    I2CTransaction transaction;
+    for (std::size_t i = 0; i < I2CTransaction::MAX_MESSAGES / 2; ++i) {
+        transaction.read_register(0x68, (uint8_t)i, buffer, sizeof(buffer));
+    }
+    bool received_exception = false;
+    try {
+        transaction.read(0x68, buffer, 1);
+    }
+    catch (std::invalid_argument&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+    CPPUNIT_ASSERT(transaction.size() == I2CTransaction::MAX_MESSAGES);
+}
+
+void I2CTransactionTest::transferErrorTest() {
+    // Not an I2C adapter: the ioctl fails
+    I2C bus("/dev/null");
+    uint8_t buffer[2];
+    I2CTransaction transaction;
+    transaction.read_register(0x68, 0x3B, buffer, sizeof(buffer));
+    bool received_exception = false;
+    try {
+        bus.transfer(transaction);
+    }
+    catch (std::runtime_error&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+}
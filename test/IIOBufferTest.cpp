@@ -0,0 +1,111 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "IIOBufferTest.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include <cstdlib>
+#include <sys/stat.h>
+
+void IIOBufferTest::setUp() {
+    // A fake IIO device: the sysfs attributes and the buffer device are regular files
+    char path[] = "/tmp/iiobuffertestXXXXXX";
+    root = mkdtemp(path);
+    std::string device = root + "/iio:device0";
+    mkdir(device.c_str(), 0755);
+    mkdir((device + "/scan_elements").c_str(), 0755);
+    mkdir((device + "/buffer").c_str(), 0755);
+    mkdir((root + "/dev").c_str(), 0755);
+    write_file(device + "/scan_elements/in_voltage0_index", "0\n");
+    write_file(device + "/scan_elements/in_voltage0_type", "le:s12/16>>4\n");
+    write_file(device + "/scan_elements/in_voltage0_en", "0\n");
+    write_file(device + "/scan_elements/in_timestamp_index", "1\n");
+    write_file(device + "/scan_elements/in_timestamp_type", "le:s64/64>>0\n");
+    write_file(device + "/scan_elements/in_timestamp_en", "0\n");
+    write_file(device + "/buffer/enable", "0\n");
+}
+
+void IIOBufferTest::tearDown() {
+    std::string command = "rm -rf " + root;
+    if (std::system(command.c_str()) != 0) {
+        // Nothing to do here...
+    }
+}
+
+void IIOBufferTest::write_file(const std::string& path, const std::string& content) {
+    std::ofstream out(path, std::ofstream::binary);
+    out << content;
+}
+
+void IIOBufferTest::parseTypeTest() {
+    IIOChannelType type = IIOBuffer::parse_type("be:u10/16>>6");
+    CPPUNIT_ASSERT(type.big_endian);
+    CPPUNIT_ASSERT(!type.is_signed);
+    CPPUNIT_ASSERT(type.real_bits == 10);
+    CPPUNIT_ASSERT(type.storage_bits == 16);
+    CPPUNIT_ASSERT(type.shift == 6);
+    bool received_exception = false;
+    try {
+        IIOBuffer::parse_type("le:s12/12>>0");
+    }
+    catch (const std::invalid_argument&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+}
+
+void IIOBufferTest::decodeTest() {
+    IIOChannelType type = IIOBuffer::parse_type("le:s12/16>>4");
+    // -2 in 12 bits, shifted 4 bits to the left: 0xFFE0
+    uint8_t negative[] = {0xE0, 0xFF};
+    CPPUNIT_ASSERT(IIOBuffer::decode(negative, type) == -2);
+    uint8_t positive[] = {0x50, 0x01};
+    CPPUNIT_ASSERT(IIOBuffer::decode(positive, type) == 0x15);
+    IIOChannelType big_endian = IIOBuffer::parse_type("be:u16/16>>0");
+    uint8_t value[] = {0x12, 0x34};
+    CPPUNIT_ASSERT(IIOBuffer::decode(value, big_endian) == 0x1234);
+}
+
+void IIOBufferTest::readScansTest() {
+    // Two scans of 16 bytes: the 2-byte sample, padding, and the 8-byte timestamp
+    std::vector<uint8_t> scans(32, 0);
+    scans[0] = 0x10; // 1 << 4
+    scans[8] = 100;
+    scans[16] = 0x20; // 2 << 4
+    scans[24] = 200;
+    write_file(root + "/dev/iio:device0", std::string(scans.begin(), scans.end()));
+    IIOBuffer buffer("iio:device0", root, root + "/dev");
+    buffer.enable_channel("in_timestamp");
+    buffer.enable_channel("in_voltage0");
+    CPPUNIT_ASSERT(buffer.get_scan_size() == 16);
+    CPPUNIT_ASSERT(buffer.get_channel_position("in_voltage0") == 0);
+    CPPUNIT_ASSERT(buffer.get_channel_position("in_timestamp") == 1);
+    buffer.open();
+    int64_t values[8];
+    CPPUNIT_ASSERT(buffer.read(values, 4) == 2);
+    CPPUNIT_ASSERT(values[0] == 1);
+    CPPUNIT_ASSERT(values[1] == 100);
+    CPPUNIT_ASSERT(values[2] == 2);
+    CPPUNIT_ASSERT(values[3] == 200);
+    CPPUNIT_ASSERT(buffer.read(values, 4) == 0);
+    buffer.close();
+}
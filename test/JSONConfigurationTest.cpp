@@ -65,4 +65,11 @@ void JSONConfigurationTest::setInt() {
     config["object"]["int_three"].set((int64_t)5);
     int64_t test = config["object"]["int_three"].get<int64_t>();
     CPPUNIT_ASSERT(test == 5);
-}
\ No newline at end of file
+}
+
+void JSONConfigurationTest::nullTest() {
+    CPPUNIT_ASSERT(config["null_value"].is_null());
+    CPPUNIT_ASSERT(!config["null_value"].is<int64_t>());
+    CPPUNIT_ASSERT(config["missing"].is_null());
+    CPPUNIT_ASSERT(!config["uint_three"].is_null());
+}
@@ -32,6 +32,7 @@ class JSONConfigurationTest : public CppUnit::TestFixture {
     CPPUNIT_TEST(getArrayTest);
     CPPUNIT_TEST(getNestedConfig);
     CPPUNIT_TEST(setInt);
+    CPPUNIT_TEST(nullTest);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -45,6 +46,7 @@ public:
             {"int_minus_three", -3},
             {"uint_three", (uint64_t)three},
             {"array", {3,4,5,6}},
+            {"null_value", nullptr},
             {"object", {
                 {"int_three", 3}
             }}
@@ -72,6 +74,8 @@ public:
 
     void setInt();
 
+    void nullTest();
+
 private:
 
     nlohmann::json file;
@@ -32,4 +32,18 @@ void JSONSerializationTest::dataSerializationTest() {
     d2.deserialize(&JSONSerialized);
     CPPUNIT_ASSERT(epoch == d2.get_timestamp());
     CPPUNIT_ASSERT(origin == d2.get_origin());
+}
+
+void JSONSerializationTest::sampleBlockSerializationTest() {
+    std::vector<int16_t> values = {-3, 0, 7, 32767};
+    SampleBlock<int16_t> block(Timestamp::epoch, "vibration", 100, values);
+    Serializer s;
+    JSONObject JSONSerialized = s.serialize<JSONObject>(block);
+    SampleBlock<int16_t> block2;
+    block2.deserialize(&JSONSerialized);
+    CPPUNIT_ASSERT(Timestamp::epoch == block2.get_timestamp());
+    CPPUNIT_ASSERT(block2.get_origin() == "vibration");
+    CPPUNIT_ASSERT(block2.get_period() == 100);
+    CPPUNIT_ASSERT(block2.get_values() == values);
+    CPPUNIT_ASSERT(block2.get_sample_time(2) == Timestamp(Timestamp::epoch.to_nanos() + 200));
 }
\ No newline at end of file
@@ -22,11 +22,13 @@
 #include "serialization/JSONObject.h"
 #include "serialization/Serializer.h"
 #include "Data.h"
+#include "SampleBlock.h"
 
 class JSONSerializationTest : public CppUnit::TestFixture {
 
     CPPUNIT_TEST_SUITE(JSONSerializationTest);
     CPPUNIT_TEST(dataSerializationTest);
+    CPPUNIT_TEST(sampleBlockSerializationTest);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -40,6 +42,8 @@ public:
 
     void dataSerializationTest();
 
+    void sampleBlockSerializationTest();
+
 
 private:
 
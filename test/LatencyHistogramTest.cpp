@@ -0,0 +1,72 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "LatencyHistogramTest.h"
+
+#include <sstream>
+
+void LatencyHistogramTest::emptyTest() {
+    LatencyHistogram histogram;
+    CPPUNIT_ASSERT(0 == histogram.get_count());
+    CPPUNIT_ASSERT(0 == histogram.get_min());
+    CPPUNIT_ASSERT(0 == histogram.get_max());
+    CPPUNIT_ASSERT(0 == histogram.get_percentile(50.0));
+}
+
+void LatencyHistogramTest::exactValuesTest() {
+    LatencyHistogram histogram;
+    histogram.record(3);
+    histogram.record(7);
+    histogram.record(20);
+    CPPUNIT_ASSERT(3 == histogram.get_count());
+    CPPUNIT_ASSERT(3 == histogram.get_min());
+    CPPUNIT_ASSERT(20 == histogram.get_max());
+    CPPUNIT_ASSERT(30 == histogram.get_sum());
+    // Values below 32 have their own bucket
+    CPPUNIT_ASSERT(7 == histogram.get_percentile(50.0));
+    CPPUNIT_ASSERT(20 == histogram.get_percentile(100.0));
+}
+
+void LatencyHistogramTest::percentileTest() {
+    LatencyHistogram histogram;
+    for (uint64_t i = 1; i <= 1000000; i += 1) {
+        histogram.record(i * 1000);
+    }
+    uint64_t p50 = histogram.get_percentile(50.0);
+    uint64_t p99 = histogram.get_percentile(99.0);
+    // ~3% relative error
+    CPPUNIT_ASSERT(p50 >= 500000000 * 0.97 && p50 <= 500000000 * 1.03);
+    CPPUNIT_ASSERT(p99 >= 990000000 * 0.97 && p99 <= 990000000 * 1.03);
+    CPPUNIT_ASSERT(histogram.get_percentile(100.0) == histogram.get_max());
+}
+
+void LatencyHistogramTest::traceAggregatorTest() {
+    TraceAggregator aggregator;
+    Trace trace;
+    trace.set(STAGE_READ, 1000);
+    trace.set(STAGE_DISPATCHED, 1010);
+    aggregator.record("topic", STAGE_DISPATCHED, trace);
+    // Not stamped, must be ignored
+    aggregator.record("topic", STAGE_WRITTEN, trace);
+    CPPUNIT_ASSERT(1 == aggregator.get_histogram("topic", STAGE_DISPATCHED).get_count());
+    CPPUNIT_ASSERT(10 == aggregator.get_histogram("topic", STAGE_DISPATCHED).get_max());
+    CPPUNIT_ASSERT(0 == aggregator.get_histogram("topic", STAGE_WRITTEN).get_count());
+    std::ostringstream out;
+    aggregator.dump(out);
+    CPPUNIT_ASSERT(out.str().find("topic dispatched 1 10") != std::string::npos);
+}
@@ -0,0 +1,119 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "MailboxTest.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static void run_all(Mailbox& mailbox) {
+    Task task;
+    while (mailbox.pop(task)) {
+        task();
+    }
+}
+
+void MailboxTest::unboundedTest() {
+    Mailbox mailbox;
+    std::vector<int> values;
+    for (int i = 0; i < 100; ++i) {
+        PushResult result = mailbox.push([&values, i]() { values.push_back(i); });
+        CPPUNIT_ASSERT(result.discarded == 0);
+        CPPUNIT_ASSERT(!result.waited);
+    }
+    CPPUNIT_ASSERT(mailbox.size() == 100);
+    run_all(mailbox);
+    CPPUNIT_ASSERT(values.size() == 100);
+    CPPUNIT_ASSERT(values.front() == 0);
+    CPPUNIT_ASSERT(values.back() == 99);
+    CPPUNIT_ASSERT(mailbox.empty());
+}
+
+void MailboxTest::dropOldestTest() {
+    Mailbox mailbox(3, OVERFLOW_DROP_OLDEST);
+    std::vector<int> values;
+    std::size_t discarded = 0;
+    for (int i = 0; i < 10; ++i) {
+        discarded += mailbox.push([&values, i]() { values.push_back(i); }).discarded;
+    }
+    CPPUNIT_ASSERT(discarded == 7);
+    CPPUNIT_ASSERT(mailbox.size() == 3);
+    run_all(mailbox);
+    CPPUNIT_ASSERT((values == std::vector<int>{7, 8, 9}));
+}
+
+void MailboxTest::conflateTest() {
+    Mailbox mailbox(3, OVERFLOW_CONFLATE);
+    std::vector<int> values;
+    for (int i = 0; i < 3; ++i) {
+        CPPUNIT_ASSERT(mailbox.push([&values, i]() { values.push_back(i); }).discarded == 0);
+    }
+    // Full: the waiting tasks are replaced by the latest one
+    CPPUNIT_ASSERT(mailbox.push([&values]() { values.push_back(3); }).discarded == 3);
+    CPPUNIT_ASSERT(mailbox.size() == 1);
+    run_all(mailbox);
+    CPPUNIT_ASSERT((values == std::vector<int>{3}));
+}
+
+void MailboxTest::sampleTest() {
+    Mailbox mailbox(2, OVERFLOW_SAMPLE, 4);
+    std::vector<int> values;
+    std::size_t discarded = 0;
+    for (int i = 0; i < 10; ++i) {
+        discarded += mailbox.push([&values, i]() { values.push_back(i); }).discarded;
+    }
+    // 0 and 1 fill the mailbox. Of the 8 pushed while full, 2 and 6 are kept.
+    CPPUNIT_ASSERT(discarded == 8);
+    run_all(mailbox);
+    CPPUNIT_ASSERT((values == std::vector<int>{2, 6}));
+}
+
+void MailboxTest::blockTest() {
+    Mailbox mailbox(1, OVERFLOW_BLOCK);
+    std::atomic<bool> pushed(false);
+    std::atomic<bool> waited(false);
+    mailbox.push([]() {});
+    std::thread producer([&]() {
+        waited = mailbox.push([]() {}).waited;
+        pushed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    // Waits for room
+    CPPUNIT_ASSERT(!pushed);
+    Task task;
+    CPPUNIT_ASSERT(mailbox.pop(task));
+    producer.join();
+    CPPUNIT_ASSERT(pushed);
+    CPPUNIT_ASSERT(waited);
+    CPPUNIT_ASSERT(mailbox.size() == 1);
+}
+
+void MailboxTest::sampleRateTest() {
+    bool received_exception = false;
+    try {
+        Mailbox mailbox(10, OVERFLOW_SAMPLE, 0);
+    }
+    catch (const std::invalid_argument&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+}
@@ -0,0 +1,81 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "MetricsRegistryTest.h"
+
+#include <thread>
+#include <vector>
+#include <stdexcept>
+
+void MetricsRegistryTest::counterTest() {
+    Counter counter;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&counter]() {
+            for (int j = 0; j < 10000; ++j) {
+                counter.increment();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    CPPUNIT_ASSERT(80000 == counter.get());
+    counter.reset();
+    CPPUNIT_ASSERT(0 == counter.get());
+}
+
+void MetricsRegistryTest::sameMetricTest() {
+    MetricsRegistry registry;
+    Counter& a = registry.counter("test_total", "id=\"a\"");
+    Counter& b = registry.counter("test_total", "id=\"b\"");
+    CPPUNIT_ASSERT(&a != &b);
+    CPPUNIT_ASSERT(&a == &registry.counter("test_total", "id=\"a\""));
+    Gauge& gauge = registry.gauge("test_gauge");
+    gauge.set(5);
+    gauge.decrement(2);
+    CPPUNIT_ASSERT(3 == registry.gauge("test_gauge").get());
+}
+
+void MetricsRegistryTest::typeMismatchTest() {
+    MetricsRegistry registry;
+    registry.counter("test_metric");
+    bool received_exception = false;
+    try {
+        registry.gauge("test_metric");
+    }
+    catch (const std::invalid_argument&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+}
+
+void MetricsRegistryTest::prometheusTest() {
+    MetricsRegistry registry;
+    registry.counter("test_total", MetricsRegistry::label("sensor", "a\"b"), "A test counter").increment(3);
+    registry.histogram("test_duration_ns").record(10);
+    std::string text = registry.to_prometheus();
+    CPPUNIT_ASSERT(text.find("# HELP test_total A test counter\n") != std::string::npos);
+    CPPUNIT_ASSERT(text.find("# TYPE test_total counter\n") != std::string::npos);
+    CPPUNIT_ASSERT(text.find("test_total{sensor=\"a\\\"b\"} 3\n") != std::string::npos);
+    CPPUNIT_ASSERT(text.find("# TYPE test_duration_ns summary\n") != std::string::npos);
+    CPPUNIT_ASSERT(text.find("test_duration_ns{quantile=\"0.5\"} 10\n") != std::string::npos);
+    CPPUNIT_ASSERT(text.find("test_duration_ns_count 1\n") != std::string::npos);
+}
@@ -0,0 +1,82 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "MultiChannelAnalogSensorTest.h"
+#include "serialization/Serializer.h"
+#include "serialization/ByteObject.h"
+#include "utils/JSONConfiguration.h"
+
+#include <cmath>
+#include <vector>
+
+void MultiChannelAnalogSensorTest::calibrateTest() {
+    // Cover the vectorized blocks and the scalar tail, starting at unaligned positions
+    for (std::size_t count = 0; count < 11; ++count) {
+        std::vector<double> values(count + 1);
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            values[i] = (double)(i * 100);
+        }
+        MultiChannelAnalogSensor::calibrate(values.data() + 1, count, 50.0, 0.25);
+        CPPUNIT_ASSERT(values[0] == 0.0);
+        for (std::size_t i = 1; i <= count; ++i) {
+            CPPUNIT_ASSERT(std::fabs(values[i] - ((double)(i * 100) - 50.0) * 0.25) < 1e-12);
+        }
+    }
+}
+
+void MultiChannelAnalogSensorTest::blockSerializationTest() {
+    AnalogBlockData block(Timestamp(1000), "block", 2, 3);
+    for (std::size_t s = 0; s < 3; ++s) {
+        block.set_sample_time(s, 1000 + s * 10);
+        block.get_channel(0)[s] = (double)s;
+        block.get_channel(1)[s] = (double)s + 0.5;
+    }
+    Serializer serializer;
+    ByteObject object = serializer.serialize<ByteObject>(block);
+    AnalogBlockData copy;
+    copy.deserialize(&object);
+    CPPUNIT_ASSERT(copy.get_origin() == "block");
+    CPPUNIT_ASSERT(copy.get_timestamp() == Timestamp(1000));
+    CPPUNIT_ASSERT(copy.get_channel_count() == 2);
+    CPPUNIT_ASSERT(copy.get_sample_count() == 3);
+    for (std::size_t s = 0; s < 3; ++s) {
+        CPPUNIT_ASSERT(copy.get_sample_time(s) == 1000 + s * 10);
+        CPPUNIT_ASSERT(copy.get_value(0, s) == (double)s);
+        CPPUNIT_ASSERT(copy.get_value(1, s) == (double)s + 0.5);
+    }
+}
+
+void MultiChannelAnalogSensorTest::configTest() {
+    nlohmann::json file = {
+        {"name", "adc"},
+        {"topic", "analog"},
+        {"sampling_rate", 1000000u},
+        {"quantization_bits", 12},
+        {"zero_voltage", 0},
+        {"span_voltage", 3.3},
+        {"spi_device", "/dev/spidev0.0"},
+        {"channels", {
+            {{"name", "pressure"}, {"zero", 0.0}, {"span", 3.3}, {"scale", 10.0}},
+            {{"name", "temperature"}, {"input", 4}, {"zero", 0.5}, {"span", 2.0}, {"scale", 100}}
+        }}
+    };
+    JSONConfiguration config(file);
+    MultiChannelAnalogSensor sensor(config);
+    CPPUNIT_ASSERT(sensor.get_name() == "adc");
+    CPPUNIT_ASSERT(sensor.get_channel_count() == 2);
+}
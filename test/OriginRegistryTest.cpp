@@ -0,0 +1,53 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "OriginRegistryTest.h"
+
+#include <stdexcept>
+
+void OriginRegistryTest::internTest() {
+    CPPUNIT_ASSERT(OriginRegistry::intern("unknown") == OriginRegistry::UNKNOWN);
+    OriginId first = OriginRegistry::intern("origin_registry_first");
+    OriginId second = OriginRegistry::intern("origin_registry_second");
+    CPPUNIT_ASSERT(first != second);
+    CPPUNIT_ASSERT(OriginRegistry::intern("origin_registry_first") == first);
+    CPPUNIT_ASSERT(OriginRegistry::get_name(first) == "origin_registry_first");
+    CPPUNIT_ASSERT(OriginRegistry::get_name(second) == "origin_registry_second");
+    bool received_exception = false;
+    try {
+        OriginRegistry::get_name((OriginId)OriginRegistry::size());
+    }
+    catch (const std::out_of_range&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+}
+
+void OriginRegistryTest::dataOriginTest() {
+    Data unknown;
+    CPPUNIT_ASSERT(unknown.get_origin_id() == OriginRegistry::UNKNOWN);
+    CPPUNIT_ASSERT(unknown.get_origin() == "unknown");
+    Data data("origin_registry_data");
+    Data copy(data);
+    CPPUNIT_ASSERT(copy.get_origin_id() == data.get_origin_id());
+    CPPUNIT_ASSERT(copy.get_origin() == "origin_registry_data");
+    copy.set_origin(OriginRegistry::UNKNOWN);
+    CPPUNIT_ASSERT(copy.get_origin() == "unknown");
+}
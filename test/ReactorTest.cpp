@@ -0,0 +1,157 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ReactorTest.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unistd.h>
+#include <fcntl.h>
+
+void ReactorTest::readableTest() {
+    int fds[2];
+    CPPUNIT_ASSERT(pipe2(fds, O_NONBLOCK | O_CLOEXEC) == 0);
+    Reactor reactor;
+    int calls = 0;
+    char received = 0;
+    reactor.add(fds[0], Reactor::READABLE, [&](uint32_t events) {
+        CPPUNIT_ASSERT(events & Reactor::READABLE);
+        CPPUNIT_ASSERT(::read(fds[0], &received, 1) == 1);
+        ++calls;
+    });
+    CPPUNIT_ASSERT(reactor.size() == 1);
+    CPPUNIT_ASSERT(reactor.run_once(0) == 0);
+    CPPUNIT_ASSERT(::write(fds[1], "x", 1) == 1);
+    CPPUNIT_ASSERT(reactor.run_once(1000) == 1);
+    CPPUNIT_ASSERT(calls == 1);
+    CPPUNIT_ASSERT(received == 'x');
+    reactor.remove(fds[0]);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+void ReactorTest::removeTest() {
+    int first[2];
+    int second[2];
+    CPPUNIT_ASSERT(pipe2(first, O_NONBLOCK | O_CLOEXEC) == 0);
+    CPPUNIT_ASSERT(pipe2(second, O_NONBLOCK | O_CLOEXEC) == 0);
+    Reactor reactor;
+    int calls = 0;
+    // Whichever handler runs first removes the other one: only one is called
+    reactor.add(first[0], Reactor::READABLE, [&](uint32_t) {
+        ++calls;
+        reactor.remove(first[0]);
+        reactor.remove(second[0]);
+    });
+    reactor.add(second[0], Reactor::READABLE, [&](uint32_t) {
+        ++calls;
+        reactor.remove(first[0]);
+        reactor.remove(second[0]);
+    });
+    CPPUNIT_ASSERT(::write(first[1], "x", 1) == 1);
+    CPPUNIT_ASSERT(::write(second[1], "x", 1) == 1);
+    reactor.run_once(1000);
+    CPPUNIT_ASSERT(calls == 1);
+    CPPUNIT_ASSERT(reactor.size() == 0);
+    CPPUNIT_ASSERT(reactor.run_once(0) == 0);
+    for (int fd : {first[0], first[1], second[0], second[1]}) {
+        close(fd);
+    }
+}
+
+void ReactorTest::stopTest() {
+    Reactor reactor;
+    std::thread loop([&reactor]() {
+        reactor.run();
+    });
+    reactor.stop();
+    loop.join();
+    // A stop() without a running loop makes the next run() return right away
+    reactor.stop();
+    reactor.run();
+}
+
+
+void ReactorTest::timerTest() {
+    Reactor reactor;
+    uint64_t expirations = 0;
+    int calls = 0;
+    int timer = reactor.add_timer(1000000, 1000000, [&](uint64_t count) {
+        expirations += count;
+        ++calls;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    // The missed periods are reported in a single call
+    CPPUNIT_ASSERT(reactor.run_once(1000) == 1);
+    CPPUNIT_ASSERT(calls == 1);
+    CPPUNIT_ASSERT(expirations >= 5);
+    reactor.set_timer(timer, 0, 0);
+    CPPUNIT_ASSERT(reactor.run_once(20) == 0);
+    reactor.set_timer(timer, 1000000, 0);
+    CPPUNIT_ASSERT(reactor.run_once(1000) == 1);
+    CPPUNIT_ASSERT(calls == 2);
+    reactor.remove_timer(timer);
+    CPPUNIT_ASSERT(reactor.size() == 0);
+}
+
+void ReactorTest::sharedTest() {
+    Reactor& shared = Reactor::get_shared();
+    CPPUNIT_ASSERT(&shared == &Reactor::get_shared());
+    std::mutex mtx;
+    std::condition_variable fired;
+    int calls = 0;
+    int timer = shared.add_timer(1000000, 0, [&](uint64_t) {
+        std::unique_lock<std::mutex> lck(mtx);
+        ++calls;
+        fired.notify_all();
+    });
+    {
+        std::unique_lock<std::mutex> lck(mtx);
+        CPPUNIT_ASSERT(fired.wait_for(lck, std::chrono::seconds(1), [&]() { return calls == 1; }));
+    }
+    shared.remove_timer(timer);
+}
+
+void ReactorTest::removeWaitsTest() {
+    Reactor reactor;
+    int fds[2];
+    CPPUNIT_ASSERT(pipe(fds) == 0);
+    std::atomic<bool> running(false);
+    std::atomic<bool> done(false);
+    reactor.add(fds[0], Reactor::READABLE, [&](uint32_t) {
+        running = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        done = true;
+    });
+    std::thread loop([&reactor]() {
+        reactor.run_once(1000);
+    });
+    CPPUNIT_ASSERT(::write(fds[1], "x", 1) == 1);
+    while (!running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    // Returns once the handler in progress in the loop thread has returned
+    reactor.remove(fds[0]);
+    CPPUNIT_ASSERT(done);
+    loop.join();
+    close(fds[0]);
+    close(fds[1]);
+}
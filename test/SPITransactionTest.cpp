@@ -0,0 +1,80 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SPITransactionTest.h"
+
+#include <stdexcept>
+
+void SPITransactionTest::buildTest() {
+    uint8_t commands[6] = { 0x06, 0x00, 0x00, 0x06, 0x40, 0x00 };
+    uint8_t responses[6];
+    uint8_t status[2];
+    SPITransaction transaction;
+    transaction.transfer(commands, responses, 3).cs_change()
+        .transfer(commands + 3, responses + 3, 3).cs_change().delay(10)
+        .read(status, 2).speed(500000);
+    CPPUNIT_ASSERT(transaction.size() == 3);
+    spi_ioc_transfer* segments = transaction.get_segments();
+    CPPUNIT_ASSERT(segments[0].tx_buf == (unsigned long)commands);
+    CPPUNIT_ASSERT(segments[0].rx_buf == (unsigned long)responses);
+    CPPUNIT_ASSERT(segments[0].len == 3);
+    CPPUNIT_ASSERT(segments[0].cs_change == 1);
+    CPPUNIT_ASSERT(segments[0].delay_usecs == 0);
+    CPPUNIT_ASSERT(segments[1].tx_buf == (unsigned long)(commands + 3));
+    CPPUNIT_ASSERT(segments[1].delay_usecs == 10);
+    CPPUNIT_ASSERT(segments[2].tx_buf == 0);
+    CPPUNIT_ASSERT(segments[2].rx_buf == (unsigned long)status);
+    CPPUNIT_ASSERT(segments[2].cs_change == 0);
+    CPPUNIT_ASSERT(segments[2].speed_hz == 500000);
+    CPPUNIT_ASSERT(segments[0].speed_hz == 0);
+    transaction.clear();
+    CPPUNIT_ASSERT(transaction.size() == 0);
+}
+
+void SPITransactionTest::emptyTest() {
+    SPITransaction transaction;
+    bool received_exception = false;
+    try {
+        transaction.cs_change();
+    }
+    catch (std::logic_error&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+}
+
+void SPITransactionTest::limitTest() {
+    uint8_t buffer[3];
+    SPITransaction transaction;
+    for (std::size_t i = 0; i < SPITransaction::MAX_SEGMENTS; ++i) {
+        transaction.read(buffer, sizeof(buffer));
+    }
+    bool received_exception = false;
+    try {
+        transaction.read(buffer, sizeof(buffer));
+    }
+    catch (std::invalid_argument&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+    CPPUNIT_ASSERT(SPITransaction::MAX_SEGMENTS == 511);
+}
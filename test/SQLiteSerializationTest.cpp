@@ -34,4 +34,19 @@ void SQLiteSerializationTest::dataSerializationTest() {
     CPPUNIT_ASSERT(origin == d2.get_origin());
     CPPUNIT_ASSERT(sqlite_object.get_insert() == std::string("INSERT INTO default (origin, timestamp) VALUES (:origin, :timestamp);"));
     CPPUNIT_ASSERT(sqlite_object.get_create_table() == std::string("CREATE TABLE default (origin, timestamp);"));
+}
+
+void SQLiteSerializationTest::sampleBlockSerializationTest() {
+    std::vector<int16_t> values = {-3, 0, 7, 32767};
+    SampleBlock<int16_t> block(Timestamp::epoch, "vibration", 100, values);
+    Serializer s;
+    SQLiteObject sqlite_object = s.serialize<SQLiteObject>(block);
+    SampleBlock<int16_t> block2;
+    block2.deserialize(&sqlite_object);
+    CPPUNIT_ASSERT(Timestamp::epoch == block2.get_timestamp());
+    CPPUNIT_ASSERT(block2.get_origin() == "vibration");
+    CPPUNIT_ASSERT(block2.get_period() == 100);
+    CPPUNIT_ASSERT(block2.get_values() == values);
+    CPPUNIT_ASSERT(block2.get_sample_time(2) == Timestamp(Timestamp::epoch.to_nanos() + 200));
+    CPPUNIT_ASSERT(sqlite_object.get_create_table() == std::string("CREATE TABLE default (origin, period, samples, timestamp);"));
 }
\ No newline at end of file
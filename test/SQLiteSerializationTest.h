@@ -22,11 +22,13 @@
 #include "serialization/SQLiteObject.h"
 #include "serialization/Serializer.h"
 #include "Data.h"
+#include "SampleBlock.h"
 
 class SQLiteSerializationTest : public CppUnit::TestFixture {
 
     CPPUNIT_TEST_SUITE(SQLiteSerializationTest);
     CPPUNIT_TEST(dataSerializationTest);
+    CPPUNIT_TEST(sampleBlockSerializationTest);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -40,6 +42,8 @@ public:
 
     void dataSerializationTest();
 
+    void sampleBlockSerializationTest();
+
 
 private:
 
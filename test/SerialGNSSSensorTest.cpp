@@ -0,0 +1,163 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SerialGNSSSensorTest.h"
+#include "Broker.h"
+#include "utils/JSONConfiguration.h"
+#include "utils/LambdaListener.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+static const std::string LOG =
+    "$GPGGA,125412.48,5036.9881,N,00707.9142,E,2,04,20.5,00269,M,,,,*17\r\n"
+    "$GPRMC,125412.48,A,5036.9881,N,00707.9142,E,00.0,000.0,230506,00,E*4F\r\n";
+
+void SerialGNSSSensorTest::setUp() {
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    CPPUNIT_ASSERT(master >= 0);
+    CPPUNIT_ASSERT(grantpt(master) == 0);
+    CPPUNIT_ASSERT(unlockpt(master) == 0);
+    device = ptsname(master);
+}
+
+void SerialGNSSSensorTest::tearDown() {
+    close(master);
+}
+
+void SerialGNSSSensorTest::rateCommandTest() {
+    // UBX-CFG-RATE, 100 ms, 1 cycle, GPS time
+    std::vector<uint8_t> expected = { 0xB5, 0x62, 0x06, 0x08, 0x06, 0x00, 0x64, 0x00, 0x01, 0x00, 0x01, 0x00, 0x7A, 0x12 };
+    CPPUNIT_ASSERT(SerialGNSSSensor::make_rate_command(10) == expected);
+    bool received_exception = false;
+    try {
+        SerialGNSSSensor::make_rate_command(0);
+    }
+    catch (std::invalid_argument&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+}
+
+void SerialGNSSSensorTest::configTest() {
+    nlohmann::json file = {
+        {"name", "gnss"},
+        {"topic", "gnss"},
+        {"sampling_rate", 1000000000u},
+        {"device", device},
+        {"baud_rate", 115200u},
+        {"update_rate", 25u}
+    };
+    JSONConfiguration config(file);
+    SerialGNSSSensor sensor(config);
+    CPPUNIT_ASSERT(sensor.get_device() == device);
+    CPPUNIT_ASSERT(sensor.get_update_rate() == 25);
+}
+
+void SerialGNSSSensorTest::ptyTest() {
+    Broker broker;
+    std::atomic<int> received(0);
+    std::atomic<double> latitude(0.0);
+    broker.subscribe("gnss", std::make_shared<LambdaListener>([&](std::string topic, std::shared_ptr<Data> data) {
+        latitude = std::static_pointer_cast<GPSData>(data)->get_latitude();
+        ++received;
+    }));
+    SerialGNSSSensor sensor("gnss", "gnss", 100000000, device, 115200, 10, true);
+    sensor.start();
+    // The configuration frames are sent on start
+    std::vector<uint8_t> expected = SerialGNSSSensor::make_rate_command(10);
+    std::vector<uint8_t> pvt = SerialGNSSSensor::make_nav_pvt_command();
+    expected.insert(expected.end(), pvt.begin(), pvt.end());
+    std::vector<uint8_t> sent;
+    struct pollfd pfd = { master, POLLIN, 0 };
+    while (sent.size() < expected.size() && poll(&pfd, 1, 1000) > 0) {
+        uint8_t buffer[64];
+        ssize_t size = read(master, buffer, sizeof(buffer));
+        if (size <= 0) {
+            break;
+        }
+        sent.insert(sent.end(), buffer, buffer + size);
+    }
+    CPPUNIT_ASSERT(sent == expected);
+    CPPUNIT_ASSERT(write(master, LOG.data(), LOG.size()) == (ssize_t)LOG.size());
+    for (int i = 0; i < 100 && received == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        sensor.fetch(&broker);
+    }
+    sensor.stop();
+    broker.stop();
+    CPPUNIT_ASSERT(received == 1);
+    CPPUNIT_ASSERT(latitude > 50.6 && latitude < 50.7);
+    CPPUNIT_ASSERT(sensor.get_parse_errors() == 0);
+}
+
+void SerialGNSSSensorTest::attachTest() {
+    // The port is watched by a reactor shared with other components
+    Reactor reactor;
+    std::thread loop(&Reactor::run, &reactor);
+    Broker broker;
+    std::atomic<int> received(0);
+    broker.subscribe("gnss", std::make_shared<LambdaListener>([&](std::string topic, std::shared_ptr<Data> data) {
+        ++received;
+    }));
+    SerialGNSSSensor sensor("gnss", "gnss", 100000000, device, 115200);
+    sensor.attach(reactor);
+    sensor.start();
+    CPPUNIT_ASSERT(write(master, LOG.data(), LOG.size()) == (ssize_t)LOG.size());
+    for (int i = 0; i < 100 && received == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        sensor.fetch(&broker);
+    }
+    sensor.stop();
+    broker.stop();
+    // The port and the retry timer are not watched anymore
+    std::size_t watched = reactor.size();
+    reactor.stop();
+    loop.join();
+    CPPUNIT_ASSERT(received == 1);
+    CPPUNIT_ASSERT(watched == 0);
+}
+
+void SerialGNSSSensorTest::hangupTest() {
+    // Closing the master hangs up the port, as unplugging a USB receiver does
+    Reactor reactor;
+    std::thread loop(&Reactor::run, &reactor);
+    SerialGNSSSensor sensor("gnss", "gnss", 100000000, device, 115200);
+    sensor.attach(reactor);
+    sensor.start();
+    CPPUNIT_ASSERT(reactor.size() == 2);
+    close(master);
+    master = -1;
+    for (int i = 0; i < 100 && reactor.size() > 1; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    // Only the retry timer is left
+    std::size_t watched = reactor.size();
+    sensor.stop();
+    reactor.stop();
+    loop.join();
+    CPPUNIT_ASSERT(watched == 1);
+}
@@ -0,0 +1,62 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include "sensors/SerialGNSSSensor.h"
+
+class SerialGNSSSensorTest : public CppUnit::TestFixture {
+
+    CPPUNIT_TEST_SUITE(SerialGNSSSensorTest);
+    CPPUNIT_TEST(rateCommandTest);
+    CPPUNIT_TEST(configTest);
+    CPPUNIT_TEST(ptyTest);
+    CPPUNIT_TEST(attachTest);
+    CPPUNIT_TEST(hangupTest);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+
+    void setUp();
+
+    void tearDown();
+
+    void rateCommandTest();
+
+    void configTest();
+
+    void ptyTest();
+
+    void attachTest();
+
+    void hangupTest();
+
+private:
+
+    // Master side of a pseudo terminal, the receiver
+    int master;
+
+    // Slave side, the serial port of the sensor
+    std::string device;
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( SerialGNSSSensorTest );
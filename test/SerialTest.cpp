@@ -0,0 +1,153 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "SerialTest.h"
+
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+void SerialTest::setUp() {
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    CPPUNIT_ASSERT(master >= 0);
+    CPPUNIT_ASSERT(grantpt(master) == 0);
+    CPPUNIT_ASSERT(unlockpt(master) == 0);
+    device = ptsname(master);
+}
+
+void SerialTest::tearDown() {
+    close(master);
+}
+
+void SerialTest::write_master(const std::string& data) {
+    CPPUNIT_ASSERT(write(master, data.data(), data.size()) == (ssize_t)data.size());
+}
+
+void SerialTest::receiveTest() {
+    Serial serial(device, 115200);
+    write_master("abcdef");
+    std::vector<uint8_t> out = { 'x' };
+    CPPUNIT_ASSERT(serial.receive(out, 4) == 4);
+    CPPUNIT_ASSERT(out.size() == 5);
+    CPPUNIT_ASSERT(std::string(out.begin(), out.end()) == "xabcd");
+    CPPUNIT_ASSERT(serial.receive() == 'e');
+    CPPUNIT_ASSERT(serial.receive() == 'f');
+}
+
+void SerialTest::timeoutTest() {
+    Serial serial(device, 250000); // Not a termios constant
+    serial.set_timeout(100);
+    write_master("ab");
+    std::vector<uint8_t> out;
+    // Returns what arrived before the timeout
+    CPPUNIT_ASSERT(serial.receive(out, 4) == 2);
+    CPPUNIT_ASSERT(out.size() == 2);
+    bool received_exception = false;
+    try {
+        serial.receive();
+    }
+    catch (std::runtime_error&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+}
+
+void SerialTest::asyncTest() {
+    Serial serial(device, 115200);
+    Reactor reactor;
+    std::vector<std::string> messages;
+    serial.attach(reactor, [&messages](Serial& port) {
+        std::vector<uint8_t> message;
+        while (port.extract_until(message, '\n')) {
+            messages.push_back(std::string(message.begin(), message.end()));
+        }
+    });
+    write_master("first\nsec");
+    CPPUNIT_ASSERT(reactor.run_once(1000) == 1);
+    CPPUNIT_ASSERT(messages.size() == 1);
+    CPPUNIT_ASSERT(messages[0] == "first");
+    CPPUNIT_ASSERT(serial.available() == 3);
+    write_master("ond\n\x01\x02");
+    CPPUNIT_ASSERT(reactor.run_once(1000) == 1);
+    CPPUNIT_ASSERT(messages.size() == 2);
+    CPPUNIT_ASSERT(messages[1] == "second");
+    std::vector<uint8_t> frame;
+    CPPUNIT_ASSERT(serial.extract(frame, 2));
+    CPPUNIT_ASSERT(frame[0] == 0x01 && frame[1] == 0x02);
+    // Nothing more to read: the non-blocking port does not wait
+    CPPUNIT_ASSERT(serial.fill() == 0);
+    serial.detach();
+    CPPUNIT_ASSERT(reactor.size() == 0);
+}
+
+void SerialTest::fullRingTest() {
+    Serial serial(device, 115200);
+    serial.set_receive_buffer_size(16);
+    Reactor reactor;
+    int calls = 0;
+    bool discard = true;
+    serial.attach(reactor, [&](Serial& port) {
+        ++calls;
+        if (discard && port.is_receive_buffer_full()) {
+            port.discard(port.available());
+        }
+    });
+    // A message without delimiter, longer than the ring
+    write_master(std::string(20, 'x'));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CPPUNIT_ASSERT(reactor.run_once(1000) == 1);
+    CPPUNIT_ASSERT(serial.available() == 0);
+    CPPUNIT_ASSERT(reactor.run_once(1000) == 1);
+    CPPUNIT_ASSERT(calls == 2);
+    CPPUNIT_ASSERT(serial.available() == 4);
+    // A handler that leaves the ring full does not stall the port
+    discard = false;
+    write_master(std::string(20, 'x'));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CPPUNIT_ASSERT(reactor.run_once(1000) == 1);
+    CPPUNIT_ASSERT(serial.available() == 0);
+    CPPUNIT_ASSERT(reactor.run_once(1000) == 1);
+    CPPUNIT_ASSERT(serial.available() == 8);
+    serial.detach();
+}
+
+void SerialTest::hangupTest() {
+    Serial serial(device, 115200);
+    Reactor reactor;
+    serial.attach(reactor, [](Serial&) {});
+    close(master);
+    master = -1;
+    bool received_exception = false;
+    try {
+        reactor.run_once(1000);
+    }
+    catch (std::runtime_error&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+    // Detached, instead of being reported again on every wait
+    CPPUNIT_ASSERT(reactor.size() == 0);
+    CPPUNIT_ASSERT(reactor.run_once(0) == 0);
+}
@@ -0,0 +1,64 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+
+#include "io/Serial.h"
+
+class SerialTest : public CppUnit::TestFixture {
+
+    CPPUNIT_TEST_SUITE(SerialTest);
+    CPPUNIT_TEST(receiveTest);
+    CPPUNIT_TEST(timeoutTest);
+    CPPUNIT_TEST(asyncTest);
+    CPPUNIT_TEST(fullRingTest);
+    CPPUNIT_TEST(hangupTest);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+
+    void setUp();
+
+    void tearDown();
+
+    void receiveTest();
+
+    void timeoutTest();
+
+    void asyncTest();
+
+    void fullRingTest();
+
+    void hangupTest();
+
+private:
+
+    void write_master(const std::string& data);
+
+    // Master side of a pseudo terminal, the device
+    int master;
+
+    // Slave side, the serial port
+    std::string device;
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( SerialTest );
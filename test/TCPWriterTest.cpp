@@ -0,0 +1,110 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TCPWriterTest.h"
+
+#include <poll.h>
+
+void TCPWriterTest::setUp() {
+    server_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    CPPUNIT_ASSERT(server_fd >= 0);
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    CPPUNIT_ASSERT(bind(server_fd, (sockaddr*)&addr, sizeof(addr)) == 0);
+    CPPUNIT_ASSERT(listen(server_fd, 1) == 0);
+    socklen_t size = sizeof(addr);
+    CPPUNIT_ASSERT(getsockname(server_fd, (sockaddr*)&addr, &size) == 0);
+    port = ntohs(addr.sin_port);
+}
+
+void TCPWriterTest::tearDown() {
+    ::close(server_fd);
+}
+
+std::size_t TCPWriterTest::receive_all(int fd, std::size_t expected) {
+    std::size_t received = 0;
+    char buffer[4096];
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    while (received < expected && poll(&pfd, 1, 2000) > 0) {
+        ssize_t size = recv(fd, buffer, sizeof(buffer), 0);
+        if (size <= 0) {
+            break;
+        }
+        received += size;
+    }
+    return received;
+}
+
+void TCPWriterTest::attachedTest() {
+    TCPWriter writer("127.0.0.1", port);
+    int client = accept(server_fd, nullptr, nullptr);
+    CPPUNIT_ASSERT(client >= 0);
+    writer.attach(Reactor::get_shared());
+    std::shared_ptr<Data> data = std::make_shared<Data>(Timestamp::now(), "tcp");
+    ByteObject serialized("default");
+    data->serialize(&serialized);
+    std::size_t size = serialized.get_bytes().size();
+    for (int i = 0; i < 100; ++i) {
+        writer.write(data);
+    }
+    writer.flush();
+    CPPUNIT_ASSERT(writer.get_pending() == 0);
+    CPPUNIT_ASSERT(receive_all(client, 100 * size) == 100 * size);
+    writer.detach();
+    // Blocking writes again
+    writer.write(data);
+    CPPUNIT_ASSERT(receive_all(client, size) == size);
+    writer.close();
+    ::close(client);
+}
+
+void TCPWriterTest::queueFullTest() {
+    TCPWriter writer("127.0.0.1", port);
+    int client = accept(server_fd, nullptr, nullptr);
+    CPPUNIT_ASSERT(client >= 0);
+    writer.attach(Reactor::get_shared(), 4096);
+    std::shared_ptr<Data> data = std::make_shared<Data>(Timestamp::now(), "tcp");
+    // Nothing is read: the socket buffers fill up, then the queue
+    std::size_t written = 0;
+    bool received_exception = false;
+    try {
+        for (int i = 0; i < 1000000; ++i) {
+            writer.write(data);
+            ++written;
+        }
+    }
+    catch (std::runtime_error&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+    CPPUNIT_ASSERT(writer.get_pending() > 0);
+    ByteObject serialized("default");
+    data->serialize(&serialized);
+    std::size_t size = serialized.get_bytes().size();
+    // The reactor sends the queue as the peer reads
+    CPPUNIT_ASSERT(receive_all(client, written * size) == written * size);
+    writer.flush();
+    CPPUNIT_ASSERT(writer.get_pending() == 0);
+    writer.close();
+    ::close(client);
+}
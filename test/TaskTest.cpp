@@ -0,0 +1,72 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TaskTest.h"
+
+#include <memory>
+#include <string>
+#include <array>
+
+void TaskTest::inlineTest() {
+    CPPUNIT_ASSERT(sizeof(Task) == 128);
+    std::shared_ptr<int> counter = std::make_shared<int>(0);
+    std::string topic = "a topic longer than the small string buffer";
+    auto function = [counter, topic]() {
+        *counter += (int)topic.size();
+    };
+    CPPUNIT_ASSERT(Task::fits_inline<decltype(function)>());
+    Task task(function);
+    CPPUNIT_ASSERT((bool)task);
+    CPPUNIT_ASSERT(counter.use_count() == 3);
+    Task moved(std::move(task));
+    CPPUNIT_ASSERT(!task);
+    CPPUNIT_ASSERT(counter.use_count() == 3);
+    moved();
+    CPPUNIT_ASSERT(*counter == (int)topic.size());
+    moved = Task();
+    CPPUNIT_ASSERT(counter.use_count() == 2);
+}
+
+void TaskTest::heapTest() {
+    std::shared_ptr<int> counter = std::make_shared<int>(0);
+    std::array<char, 256> large;
+    large.fill(1);
+    auto function = [counter, large]() {
+        *counter += large[0];
+    };
+    CPPUNIT_ASSERT(!Task::fits_inline<decltype(function)>());
+    Task task(function);
+    Task moved;
+    moved = std::move(task);
+    moved();
+    moved();
+    CPPUNIT_ASSERT(*counter == 2);
+    CPPUNIT_ASSERT(counter.use_count() == 3);
+    moved = Task();
+    CPPUNIT_ASSERT(counter.use_count() == 2);
+}
+
+void TaskTest::moveOnlyTest() {
+    std::unique_ptr<int> value(new int(42));
+    int result = 0;
+    Task task([value = std::move(value), &result]() {
+        result = *value;
+    });
+    task();
+    CPPUNIT_ASSERT(result == 42);
+}
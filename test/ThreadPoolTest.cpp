@@ -0,0 +1,128 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ThreadPoolTest.h"
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+void ThreadPoolTest::jobsTest() {
+    ThreadPool pool(4);
+    std::atomic<int> done(0);
+    for (int i = 0; i < 1000; ++i) {
+        pool.add_job([&done]() {
+            ++done;
+        });
+    }
+    for (int i = 0; i < 1000 && done < 1000; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CPPUNIT_ASSERT(done == 1000);
+}
+
+void ThreadPoolTest::parallelTest() {
+    // Each job waits for the others: only completes if the jobs run concurrently
+    ThreadPool pool(4);
+    std::atomic<int> started(0);
+    std::atomic<int> done(0);
+    for (int i = 0; i < 4; ++i) {
+        pool.add_job([&started, &done]() {
+            ++started;
+            for (int j = 0; j < 1000 && started < 4; ++j) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            if (started == 4) {
+                ++done;
+            }
+        });
+    }
+    for (int i = 0; i < 2000 && done < 4; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CPPUNIT_ASSERT(done == 4);
+}
+
+void ThreadPoolTest::priorityTest() {
+    ThreadPool pool(1);
+    std::atomic<bool> blocked(true);
+    std::atomic<bool> running(false);
+    std::mutex mtx;
+    std::vector<int> order;
+    // Keep the only thread busy while the jobs are queued
+    pool.add_job([&blocked, &running]() {
+        running = true;
+        while (blocked) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    while (!running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (int i = 0; i < 5; ++i) {
+        pool.add_job([&]() {
+            std::lock_guard<std::mutex> lck(mtx);
+            order.push_back(PRIORITY_LOW);
+        }, PRIORITY_LOW);
+        pool.add_job([&]() {
+            std::lock_guard<std::mutex> lck(mtx);
+            order.push_back(PRIORITY_NORMAL);
+        });
+    }
+    pool.add_job([&]() {
+        std::lock_guard<std::mutex> lck(mtx);
+        order.push_back(PRIORITY_HIGH);
+    }, PRIORITY_HIGH);
+    CPPUNIT_ASSERT(pool.queued(PRIORITY_LOW) == 5);
+    CPPUNIT_ASSERT(pool.queued(PRIORITY_NORMAL) == 5);
+    CPPUNIT_ASSERT(pool.queued(PRIORITY_HIGH) == 1);
+    blocked = false;
+    for (int i = 0; i < 1000; ++i) {
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            if (order.size() == 11) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::lock_guard<std::mutex> lck(mtx);
+    CPPUNIT_ASSERT(order.size() == 11);
+    CPPUNIT_ASSERT(order[0] == PRIORITY_HIGH);
+    for (int i = 1; i < 6; ++i) {
+        CPPUNIT_ASSERT(order[i] == PRIORITY_NORMAL);
+        CPPUNIT_ASSERT(order[i + 5] == PRIORITY_LOW);
+    }
+}
+
+void ThreadPoolTest::joinTest() {
+    ThreadPool pool(2);
+    std::atomic<int> done(0);
+    for (int i = 0; i < 50; ++i) {
+        pool.add_job([&pool, &done]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            // Jobs added by running jobs are run too
+            pool.add_job([&done]() {
+                ++done;
+            });
+        });
+    }
+    // The queued jobs are run before the threads are joined
+    pool.join();
+    CPPUNIT_ASSERT(done == 50);
+}
@@ -17,6 +17,9 @@
 */
 
 #include "ThreadTest.h"
+#include "utils/JSONConfiguration.h"
+
+#include <stdexcept>
 
 void ThreadTest::minPriorityTest() {
     int default_priority = Thread::get_min_scheduling_priority(DEFAULT);
@@ -67,4 +70,66 @@ void ThreadTest::priorityBoundsTest() {
     real_priority = th.get_current_priority();
     CPPUNIT_ASSERT(real_priority == max_priority);
     th.join();
-}
\ No newline at end of file
+}
+
+void ThreadTest::affinityTest() {
+    std::vector<int> allowed = this_thread::get_affinity();
+    CPPUNIT_ASSERT(!allowed.empty());
+    std::vector<int> cpus = {allowed.front()};
+    std::vector<int> real_cpus;
+    Thread th([&cpus, &real_cpus]{
+        this_thread::set_affinity(cpus);
+        real_cpus = this_thread::get_affinity();
+    });
+    th.join();
+    CPPUNIT_ASSERT(real_cpus == cpus);
+}
+
+void ThreadTest::cpuListTest() {
+    std::vector<int> expected = {0, 1, 2, 3, 6, 8, 9};
+    CPPUNIT_ASSERT(RealTime::parse_cpu_list("0-3,6,8-9\n") == expected);
+    CPPUNIT_ASSERT(RealTime::parse_cpu_list("").empty());
+    bool received_exception = false;
+    try {
+        RealTime::parse_cpu_list("3-1");
+    }
+    catch (const std::invalid_argument&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+}
+
+void ThreadTest::placementConfigurationTest() {
+    Placement previous = ThreadPlacement::get(ROLE_IO);
+    nlohmann::json json = nlohmann::json::parse(R"({"io": {"policy": "fifo", "priority": -3, "cpus": "0"}})");
+    JSONObjectConfiguration config(json);
+    ThreadPlacement::configure(config);
+    Placement placement = ThreadPlacement::get(ROLE_IO);
+    ThreadPlacement::set(ROLE_IO, previous);
+    CPPUNIT_ASSERT(placement.policy == RT_FIFO);
+    CPPUNIT_ASSERT(ThreadPlacement::resolve_priority(placement) == Thread::get_max_scheduling_priority(RT_FIFO) - 3);
+    CPPUNIT_ASSERT(placement.cpus == std::vector<int>({0}));
+    CPPUNIT_ASSERT(placement.numa_node == -1);
+    // Roles not in the configuration are not changed
+    CPPUNIT_ASSERT(ThreadPlacement::get(ROLE_SENSOR).policy == RT_ROUND_ROBIN);
+}
+
+void ThreadTest::deadlineParametersTest() {
+    bool received_exception = false;
+    Thread th([&received_exception]{
+        try {
+            // The runtime cannot exceed the deadline
+            this_thread::set_deadline_scheduling(2000000, 1000000, 10000000);
+        }
+        catch (const std::invalid_argument&) {
+            received_exception = true;
+        }
+    });
+    th.join();
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+    CPPUNIT_ASSERT(this_thread::get_current_scheduling_policy() != RT_DEADLINE);
+}
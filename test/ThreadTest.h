@@ -20,6 +20,8 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "concurrent/Thread.h"
+#include "concurrent/RealTime.h"
+#include "concurrent/ThreadPlacement.h"
 
 class ThreadTest : public CppUnit::TestFixture {
 
@@ -29,6 +31,10 @@ class ThreadTest : public CppUnit::TestFixture {
     //CPPUNIT_TEST(setPriorityTest);
     //CPPUNIT_TEST(setPolicyTest);
     //CPPUNIT_TEST(priorityBoundsTest);
+    CPPUNIT_TEST(affinityTest);
+    CPPUNIT_TEST(cpuListTest);
+    CPPUNIT_TEST(placementConfigurationTest);
+    CPPUNIT_TEST(deadlineParametersTest);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -47,6 +53,14 @@ public:
 
     void priorityBoundsTest();
 
+    void affinityTest();
+
+    void cpuListTest();
+
+    void placementConfigurationTest();
+
+    void deadlineParametersTest();
+
 private:
 
 
@@ -0,0 +1,75 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TopicTrieTest.h"
+
+#include <stdexcept>
+
+typedef std::vector<std::size_t> Values;
+
+void TopicTrieTest::exactTest() {
+    TopicTrie trie;
+    trie.insert("temperature", 0);
+    trie.insert("vehicle/imu/accel", 1);
+    trie.insert("vehicle/imu/accel", 2);
+    CPPUNIT_ASSERT((trie.match("temperature") == Values{0}));
+    CPPUNIT_ASSERT((trie.match("vehicle/imu/accel") == Values{1, 2}));
+    CPPUNIT_ASSERT(trie.match("vehicle/imu").empty());
+    CPPUNIT_ASSERT(trie.match("vehicle/imu/accel/x").empty());
+    CPPUNIT_ASSERT(trie.match("humidity").empty());
+}
+
+void TopicTrieTest::singleLevelTest() {
+    TopicTrie trie;
+    trie.insert("vehicle/*/accel", 0);
+    trie.insert("*", 1);
+    trie.insert("vehicle/imu/accel", 2);
+    CPPUNIT_ASSERT((trie.match("vehicle/imu/accel") == Values{0, 2}));
+    CPPUNIT_ASSERT((trie.match("vehicle/wheel/accel") == Values{0}));
+    CPPUNIT_ASSERT(trie.match("vehicle/accel").empty());
+    CPPUNIT_ASSERT((trie.match("vehicle") == Values{1}));
+}
+
+void TopicTrieTest::multiLevelTest() {
+    TopicTrie trie;
+    trie.insert("#", 0);
+    trie.insert("vehicle/#", 1);
+    trie.insert("vehicle/*/accel/#", 2);
+    CPPUNIT_ASSERT((trie.match("temperature") == Values{0}));
+    CPPUNIT_ASSERT((trie.match("vehicle") == Values{0, 1}));
+    CPPUNIT_ASSERT((trie.match("vehicle/gps") == Values{0, 1}));
+    CPPUNIT_ASSERT((trie.match("vehicle/imu/accel") == Values{0, 1, 2}));
+    CPPUNIT_ASSERT((trie.match("vehicle/imu/accel/x") == Values{0, 1, 2}));
+}
+
+void TopicTrieTest::invalidTest() {
+    const char* patterns[] = {"vehicle/#/accel", "vehicle/imu*", "vehicle/#x"};
+    for (const char* pattern : patterns) {
+        bool received_exception = false;
+        try {
+            TopicTrie trie;
+            trie.insert(pattern, 0);
+        }
+        catch (const std::invalid_argument&) {
+            received_exception = true;
+        }
+        if (!received_exception) {
+            CPPUNIT_FAIL("Exception expected");
+        }
+    }
+}
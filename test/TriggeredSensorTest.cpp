@@ -0,0 +1,174 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TriggeredSensorTest.h"
+
+#include <thread>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+
+void TriggeredSensorTest::eventTriggerTest() {
+    EventTrigger trigger;
+    uint64_t timestamp = 0;
+    CPPUNIT_ASSERT(trigger.consume(timestamp) == 0);
+    trigger.fire();
+    trigger.fire();
+    trigger.fire();
+    uint64_t before = Timestamp::now().to_nanos();
+    CPPUNIT_ASSERT(trigger.consume(timestamp) == 3);
+    CPPUNIT_ASSERT(timestamp >= before);
+    CPPUNIT_ASSERT(trigger.consume(timestamp) == 0);
+}
+
+void TriggeredSensorTest::fileTriggerTest() {
+    int fds[2];
+    CPPUNIT_ASSERT(pipe2(fds, O_NONBLOCK) == 0);
+    FileTrigger trigger(fds[0], true);
+    uint64_t timestamp = 0;
+    CPPUNIT_ASSERT(trigger.consume(timestamp) == 0);
+    CPPUNIT_ASSERT(write(fds[1], "abc", 3) == 3);
+    CPPUNIT_ASSERT(trigger.consume(timestamp) == 1);
+    CPPUNIT_ASSERT(trigger.consume(timestamp) == 0);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+void TriggeredSensorTest::gpioTriggerTest() {
+    int fds[2];
+    CPPUNIT_ASSERT(pipe(fds) == 0);
+    GPIOTrigger trigger(std::make_unique<GPIOEdgeLine>(fds[0]));
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t monotonic = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    gpioevent_data data[2];
+    data[0].timestamp = monotonic - 2000000;
+    data[0].id = GPIOEVENT_EVENT_RISING_EDGE;
+    data[1].timestamp = monotonic - 1000000;
+    data[1].id = GPIOEVENT_EVENT_FALLING_EDGE;
+    CPPUNIT_ASSERT(write(fds[1], data, sizeof(data)) == sizeof(data));
+    uint64_t now = Timestamp::now().to_nanos();
+    uint64_t timestamp = 0;
+    CPPUNIT_ASSERT(trigger.consume(timestamp) == 2);
+    // The last edge happened 1 ms before `monotonic`, in wall clock time
+    CPPUNIT_ASSERT(timestamp < now);
+    CPPUNIT_ASSERT(now - timestamp < 100000000);
+    CPPUNIT_ASSERT(trigger.consume(timestamp) == 0);
+    close(fds[1]);
+}
+
+void TriggeredSensorTest::sensorTest() {
+    TriggeredSensorStub sensor(1000000000);
+    EventTrigger* trigger = new EventTrigger();
+    sensor.add_trigger(std::unique_ptr<Trigger>(trigger));
+    sensor.start();
+    bool received_exception = false;
+    try {
+        sensor.add_trigger(std::make_unique<EventTrigger>());
+    }
+    catch (std::logic_error&) {
+        received_exception = true;
+    }
+    if (!received_exception) {
+        sensor.stop();
+        CPPUNIT_FAIL("Exception expected");
+    }
+    for (int i = 0; i < 3; ++i) {
+        trigger->fire();
+        for (int j = 0; j < 100 && sensor.get_triggered() < (uint64_t)i + 1; ++j) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+    sensor.stop();
+    CPPUNIT_ASSERT(sensor.get_triggered() == 3);
+    CPPUNIT_ASSERT(sensor.get_missed() == 0);
+    std::vector<uint64_t> timestamps = sensor.get_timestamps();
+    CPPUNIT_ASSERT(timestamps.size() == 3);
+    CPPUNIT_ASSERT(timestamps[0] <= timestamps[1] && timestamps[1] <= timestamps[2]);
+}
+
+void TriggeredSensorTest::timerTest() {
+    // Without triggers, the sensor is triggered every sampling period
+    TriggeredSensorStub sensor(5000000);
+    sensor.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    sensor.stop();
+    uint64_t total = sensor.get_triggered() + sensor.get_missed();
+    CPPUNIT_ASSERT(total >= 10 && total <= 25);
+}
+
+void TriggeredSensorTest::attachTest() {
+    // Served by a reactor shared with other components, without a thread of its own
+    Reactor reactor;
+    std::thread loop(&Reactor::run, &reactor);
+    TriggeredSensorStub sensor(1000000000);
+    EventTrigger* trigger = new EventTrigger();
+    sensor.add_trigger(std::unique_ptr<Trigger>(trigger));
+    sensor.attach(reactor);
+    CPPUNIT_ASSERT(sensor.is_attached());
+    sensor.start();
+    CPPUNIT_ASSERT(reactor.size() == 1);
+    bool received_exception = false;
+    try {
+        sensor.attach(reactor);
+    }
+    catch (std::logic_error&) {
+        received_exception = true;
+    }
+    for (int i = 0; i < 3; ++i) {
+        trigger->fire();
+        for (int j = 0; j < 100 && sensor.get_triggered() < (uint64_t)i + 1; ++j) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+    sensor.stop();
+    reactor.stop();
+    loop.join();
+    if (!received_exception) {
+        CPPUNIT_FAIL("Exception expected");
+    }
+    CPPUNIT_ASSERT(sensor.get_triggered() == 3);
+    CPPUNIT_ASSERT(sensor.get_timestamps().size() == 3);
+    // The triggers are not watched anymore
+    CPPUNIT_ASSERT(reactor.size() == 0);
+}
+
+void TriggeredSensorTest::hangupTest() {
+    // A trigger whose writer went away is dropped, instead of being reported on every wait
+    Reactor reactor;
+    std::thread loop(&Reactor::run, &reactor);
+    int fds[2];
+    CPPUNIT_ASSERT(pipe2(fds, O_NONBLOCK) == 0);
+    TriggeredSensorStub sensor(1000000000);
+    sensor.add_trigger(std::make_unique<FileTrigger>(fds[0], true));
+    sensor.attach(reactor);
+    sensor.start();
+    CPPUNIT_ASSERT(write(fds[1], "a", 1) == 1);
+    close(fds[1]);
+    for (int i = 0; i < 100 && reactor.size() > 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    std::size_t watched = reactor.size();
+    sensor.stop();
+    reactor.stop();
+    loop.join();
+    close(fds[0]);
+    CPPUNIT_ASSERT(watched == 0);
+    // The last byte was still read
+    CPPUNIT_ASSERT(sensor.get_triggered() == 1);
+}
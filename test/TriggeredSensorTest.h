@@ -0,0 +1,85 @@
+/**
+ * rt-data
+ * Copyright (C) 2019 Guillem Castro
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <mutex>
+#include <vector>
+
+#include "TriggeredSensor.h"
+
+class TriggeredSensorStub : public TriggeredSensor {
+
+public:
+
+    TriggeredSensorStub(uint64_t rate) : TriggeredSensor("triggered", "triggered", rate) {
+
+    }
+
+    std::vector<uint64_t> get_timestamps() {
+        std::lock_guard<std::mutex> lck(mtx);
+        return timestamps;
+    }
+
+protected:
+
+    virtual void on_trigger(Trigger&, uint64_t timestamp) override {
+        std::lock_guard<std::mutex> lck(mtx);
+        timestamps.push_back(timestamp);
+    }
+
+private:
+
+    std::mutex mtx;
+
+    std::vector<uint64_t> timestamps;
+
+};
+
+class TriggeredSensorTest : public CppUnit::TestFixture {
+
+    CPPUNIT_TEST_SUITE(TriggeredSensorTest);
+    CPPUNIT_TEST(eventTriggerTest);
+    CPPUNIT_TEST(fileTriggerTest);
+    CPPUNIT_TEST(gpioTriggerTest);
+    CPPUNIT_TEST(sensorTest);
+    CPPUNIT_TEST(timerTest);
+    CPPUNIT_TEST(attachTest);
+    CPPUNIT_TEST(hangupTest);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+
+    void eventTriggerTest();
+
+    void fileTriggerTest();
+
+    void gpioTriggerTest();
+
+    void sensorTest();
+
+    void timerTest();
+
+    void attachTest();
+
+    void hangupTest();
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TriggeredSensorTest );
@@ -25,7 +25,7 @@
 SQLiteWriter writer("database.db");
 
 void Application::setup() {
-    Log::log(INFO) << "Acceptance test config started";
+    RTDATA_LOG(INFO) << "Acceptance test config started";
     std::shared_ptr<Sensor> sensor = std::make_shared<AnalogSensor>(
         "./a.txt", // file
         "test", // topic
@@ -41,14 +41,14 @@ void Application::setup() {
     manager.add_sensor(sensor);
     broker.subscribe("test", std::make_shared<LambdaListener>([](std::string topic, std::shared_ptr<Data> data) {
         std::shared_ptr<AnalogData> analog_data = std::static_pointer_cast<AnalogData>(data);
-        Log::log(DEBUG) << "Received data with time " << analog_data->get_timestamp().to_nanos();
-        Log::log(DEBUG) << "Received data with value " << analog_data->get_value();
-        Log::log(DEBUG) << "Received data with origin " << data->get_origin().c_str();
+        RTDATA_LOG(DEBUG) << "Received data with time " << analog_data->get_timestamp().to_nanos();
+        RTDATA_LOG(DEBUG) << "Received data with value " << analog_data->get_value();
+        RTDATA_LOG(DEBUG) << "Received data with origin " << data->get_origin().c_str();
         writer.write(topic, data);
         writer.flush();
     }));
     manager.start();
-    Log::log(INFO) << "Acceptance test config ended";
+    RTDATA_LOG(INFO) << "Acceptance test config ended";
 }
 
 void Application::loop() {
@@ -31,7 +31,7 @@
 int main() {
 
     Log::init();
-    Log::log(INFO) << "Test executions started";
+    RTDATA_LOG(INFO) << "Test executions started";
 
     CppUnit::TestResultCollector result;
 
@@ -47,7 +47,7 @@ int main() {
 
     xmlOutputter.write();
 
-    Log::log(INFO) << "Test executions ended";
+    RTDATA_LOG(INFO) << "Test executions ended";
 
     return !wasSuccessful;
 }
\ No newline at end of file